@@ -798,7 +798,7 @@ auto ResourceDB::WriteBinaryResourcePackage(
     return false;
   }
 
-  auto const package_bytes{PackBinaryResourcePackage(imports)};
+  auto const package_bytes{PackBinaryResourcePackage(imports, App::Instance().GetJobSystem())};
 
   if (!package_bytes) {
     return false;
@@ -43,6 +43,61 @@ auto ModelImporterEditorDrawer::Draw(
       obj.SetMeshImportSettings(mesh_settings);
       changed = true;
     }
+    ImGui::TableNextColumn();
+
+    ImGui::Text("Quantize vertex streams");
+    ImGui::TableNextColumn();
+
+    if (ImGuiDisabled(!allow_edit, [&] {
+      return ImGui::Checkbox("##QuantizeVertexStreamsCheckbox", &mesh_settings.quantize_vertex_streams);
+    })) {
+      obj.SetMeshImportSettings(mesh_settings);
+      changed = true;
+    }
+    ImGui::TableNextColumn();
+
+    ImGui::Text("Deduplicate vertices");
+    ImGui::TableNextColumn();
+
+    if (ImGuiDisabled(!allow_edit, [&] {
+      return ImGui::Checkbox("##DeduplicateVerticesCheckbox", &mesh_settings.deduplicate_vertices);
+    })) {
+      obj.SetMeshImportSettings(mesh_settings);
+      changed = true;
+    }
+    ImGui::TableNextColumn();
+
+    ImGui::Text("Optimize vertex cache");
+    ImGui::TableNextColumn();
+
+    if (ImGuiDisabled(!allow_edit, [&] {
+      return ImGui::Checkbox("##OptimizeVertexCacheCheckbox", &mesh_settings.optimize_vertex_cache);
+    })) {
+      obj.SetMeshImportSettings(mesh_settings);
+      changed = true;
+    }
+    ImGui::TableNextColumn();
+
+    ImGui::Text("Optimize vertex fetch");
+    ImGui::TableNextColumn();
+
+    if (ImGuiDisabled(!allow_edit, [&] {
+      return ImGui::Checkbox("##OptimizeVertexFetchCheckbox", &mesh_settings.optimize_vertex_fetch);
+    })) {
+      obj.SetMeshImportSettings(mesh_settings);
+      changed = true;
+    }
+    ImGui::TableNextColumn();
+
+    ImGui::Text("LOD count");
+    ImGui::TableNextColumn();
+
+    if (ImGuiDisabled(!allow_edit, [&] {
+      return ImGui::SliderInt("##LodCountSlider", &mesh_settings.lod_count, 1, kMaxMeshLodCount);
+    })) {
+      obj.SetMeshImportSettings(mesh_settings);
+      changed = true;
+    }
 
     ImGui::EndTable();
   }
@@ -6,6 +6,7 @@
 #include <nfd.hpp>
 
 #include "char_encoding_helpers.hpp"
+#include "Component.hpp"
 #include "gui_helpers.hpp"
 #include "LoadingScreen.hpp"
 #include "Platform.hpp"
@@ -15,6 +16,8 @@
 #include "Window.hpp"
 #include "windows/PerformanceCounterWindow.hpp"
 
+#include <algorithm>
+
 extern auto ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) -> LRESULT;
 
 
@@ -52,6 +55,11 @@ EditorApp::EditorApp(std::span<std::string_view const> const args) :
 
   NFD::Init();
 
+  // Reproduces bugs in the game code without the nondeterminism of parallel updates
+  if (std::ranges::find(args, "-deterministic") != std::end(args)) {
+    update_scheduler_.SetDeterministic(true);
+  }
+
   auto project_loaded{false};
 
   for (auto const arg : args) {
@@ -102,11 +110,8 @@ auto EditorApp::Update() -> void {
     int static targetFrameRate{timing::GetTargetFrameRate()};
 
     if (game_is_running_) {
-      for (std::vector<SceneObject*> scene_objects; auto const so : Object::FindObjectsOfType(scene_objects)) {
-        if (so->IsUpdatable()) {
-          so->Update();
-        }
-      }
+      GetComponentRegistry().GetUpdateGroups(update_groups_);
+      update_scheduler_.Update(update_groups_);
 
       if (GetKeyDown(Key::Escape)) {
         game_is_running_ = false;
@@ -125,10 +130,10 @@ auto EditorApp::Update() -> void {
         targetFrameRate = timing::GetTargetFrameRate();
         timing::SetTargetFrameRate(-1);
 
-        for (std::vector<SceneObject*> scene_objects; auto const so : Object::FindObjectsOfType(scene_objects)) {
-          if (so->IsUpdatable()) {
-            so->Start();
-          }
+        GetComponentRegistry().GetUpdatableComponents(updatable_components_);
+
+        for (auto const component : updatable_components_) {
+          component->Start();
         }
       }
     }
@@ -279,6 +284,16 @@ auto EditorApp::IsEditorBusy() const noexcept -> bool {
 }
 
 
+auto EditorApp::GetUpdateScheduler() const noexcept -> UpdateScheduler const& {
+  return update_scheduler_;
+}
+
+
+auto EditorApp::GetUpdateScheduler() noexcept -> UpdateScheduler& {
+  return update_scheduler_;
+}
+
+
 auto EditorApp::IsGuiDarkMode() const noexcept -> bool {
   return dark_mode_;
 }
@@ -6,6 +6,7 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "app.hpp"
 #include "gui_helpers.hpp"
@@ -13,6 +14,7 @@
 #include "MainMenuBar.hpp"
 #include "ResourceDB.hpp"
 #include "Scene.hpp"
+#include "update_scheduler.hpp"
 #include "drawers/editor_drawer_registry.hpp"
 #include "rendering/imgui_renderer.hpp"
 #include "windows/EntityHierarchyWindow.hpp"
@@ -60,6 +62,9 @@ public:
 
   [[nodiscard]] auto IsEditorBusy() const noexcept -> bool;
 
+  [[nodiscard]] auto GetUpdateScheduler() const noexcept -> UpdateScheduler const&;
+  [[nodiscard]] auto GetUpdateScheduler() noexcept -> UpdateScheduler&;
+
   [[nodiscard]] auto IsGuiDarkMode() const noexcept -> bool;
   auto SetGuiDarkMode(bool darkMode) noexcept -> void;
 
@@ -95,6 +100,10 @@ private:
   EventListenerHandle<void> window_focus_gain_listener_{};
 
   bool game_is_running_{false};
+  // Reused across frames to avoid reallocating the update lists
+  std::vector<Component*> updatable_components_;
+  std::vector<UpdateGroup> update_groups_;
+  UpdateScheduler update_scheduler_{GetJobSystem(), GetTransformSystem()};
 
   ImGuiRenderer imgui_renderer_{GetGraphicsDevice(), GetSwapChain(), GetRenderManager()};
 
@@ -8,7 +8,7 @@
 namespace sorcery::mage {
 template<typename Callable>
 auto EditorApp::ExecuteInBusyEditor(Callable&& callable) -> void {
-  GetJobSystem().Run(GetJobSystem().CreateJob([this, callable = std::forward<Callable>(callable)] {
+  auto const job{GetJobSystem().CreateJob([this, callable = std::forward<Callable>(callable)] {
     BusyExecutionContext const exec_context{OnEnterBusyExecution()};
 
     try {
@@ -20,6 +20,9 @@ auto EditorApp::ExecuteInBusyEditor(Callable&& callable) -> void {
     }
 
     OnFinishBusyExecution(exec_context);
-  }));
+  })};
+
+  job->priority = JobPriority::kBackground;
+  GetJobSystem().Run(job);
 }
 }
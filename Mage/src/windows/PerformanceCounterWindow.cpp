@@ -1,14 +1,96 @@
 #include "PerformanceCounterWindow.hpp"
 
 #include <chrono>
+#include <fstream>
+#include <limits>
 #include <numeric>
+#include <vector>
 
 #include <implot.h>
 
+#include "app.hpp"
+#include "job_system.hpp"
+#include "resource_manager.hpp"
 #include "Timing.hpp"
 
 
 namespace sorcery::mage {
+namespace {
+auto DrawJobSystemCounters(float const frame_time_seconds) -> void {
+  auto const& job_system{App::Instance().GetJobSystem()};
+
+  if constexpr (!kJobSystemProfilingEnabled) {
+    ImGui::TextUnformatted("Job system profiling is compiled out.");
+    return;
+  }
+
+  std::vector<JobThreadCounters> static prevCounters;
+  auto const counters{job_system.GetProfilingCounters()};
+  prevCounters.resize(counters.size());
+
+  if (ImGui::BeginTable("##jobSystemCounterTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchSame)) {
+    ImGui::TableSetupColumn("Thread");
+    ImGui::TableSetupColumn("Busy");
+    ImGui::TableSetupColumn("Jobs");
+    ImGui::TableSetupColumn("Steals");
+    ImGui::TableSetupColumn("Parks");
+    ImGui::TableHeadersRow();
+
+    for (std::size_t i{0}; i < counters.size(); i++) {
+      auto const& cur{counters[i]};
+      auto const& prev{prevCounters[i]};
+      std::chrono::duration<float> const busy_time{cur.busy_time - prev.busy_time};
+
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%zu", i);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.0f%%", static_cast<double>(busy_time.count() / frame_time_seconds * 100.0f));
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", cur.executed_job_count - prev.executed_job_count);
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu/%llu", cur.successful_steal_count - prev.successful_steal_count,
+        cur.steal_attempt_count - prev.steal_attempt_count);
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", cur.park_count - prev.park_count);
+    }
+
+    ImGui::EndTable();
+  }
+
+  if (ImGui::Button("Export Chrome Trace")) {
+    std::ofstream out{"job_system_trace.json", std::ios::out | std::ios::trunc};
+    job_system.ExportChromeTrace(out);
+  }
+
+  prevCounters = counters;
+}
+
+
+auto DrawResourceCacheCounters() -> void {
+  auto const stats{App::Instance().GetResourceManager().GetCacheStats()};
+  auto const budget{App::Instance().GetResourceManager().GetMemoryBudget()};
+
+  auto const draw_memory_usage{
+    [](char const* const label, std::size_t const bytes, std::size_t const budget_bytes) {
+      auto constexpr bytes_per_mib{1024.0 * 1024.0};
+
+      if (budget_bytes == std::numeric_limits<std::size_t>::max()) {
+        ImGui::Text("%s: %.1f MiB", label, static_cast<double>(bytes) / bytes_per_mib);
+      } else {
+        ImGui::Text("%s: %.1f / %.1f MiB", label, static_cast<double>(bytes) / bytes_per_mib,
+          static_cast<double>(budget_bytes) / bytes_per_mib);
+      }
+    }
+  };
+
+  draw_memory_usage("CPU", stats.cpu_bytes, budget.cpu_bytes);
+  draw_memory_usage("GPU", stats.gpu_bytes, budget.gpu_bytes);
+  ImGui::Text("Hits: %llu, Misses: %llu, Evictions: %llu", stats.hit_count, stats.miss_count, stats.eviction_count);
+}
+}
+
+
 auto DrawPerformanceCounterWindow() -> void {
   ImGui::SetNextWindowSizeConstraints(ImVec2{150, 150}, ImVec2{
     std::numeric_limits<float>::max(), std::numeric_limits<float>::max()
@@ -33,6 +115,14 @@ auto DrawPerformanceCounterWindow() -> void {
     ImGui::Text("Average %.2f ms",
       std::reduce(std::begin(dataPoints), std::end(dataPoints), 0.0f) / static_cast<double>(dataPoints.size()));
 
+    if (ImGui::CollapsingHeader("Job System")) {
+      DrawJobSystemCounters(frameTimeSeconds.count());
+    }
+
+    if (ImGui::CollapsingHeader("Resources")) {
+      DrawResourceCacheCounters();
+    }
+
     if (ImPlot::BeginPlot("###frameTimeChart", ImGui::GetContentRegionAvail(),
       ImPlotFlags_NoInputs | ImPlotFlags_NoFrame)) {
       ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, static_cast<double>(*std::ranges::max_element(dataPoints)),
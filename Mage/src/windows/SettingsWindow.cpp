@@ -46,6 +46,11 @@ auto SettingsWindow::Draw() -> void {
     }
     ImGui::EndDisabled();
 
+    if (auto deterministic{mApp->GetUpdateScheduler().IsDeterministic()}; ImGui::Checkbox(
+      "Deterministic Component Updates", &deterministic)) {
+      mApp->GetUpdateScheduler().SetDeterministic(deterministic);
+    }
+
     ImGui::TreePop();
   }
 
@@ -60,6 +65,11 @@ auto SettingsWindow::Draw() -> void {
       App::Instance().GetSceneRenderer().SetGamma(gamma);
     }
 
+    if (auto lod_error_threshold{App::Instance().GetSceneRenderer().GetLodErrorThreshold()}; ImGui::DragFloat(
+      "LOD Error Threshold", &lod_error_threshold, 0.05f, 0.0f, 16.0f, "%.2f px", ImGuiSliderFlags_AlwaysClamp)) {
+      App::Instance().GetSceneRenderer().SetLodErrorThreshold(lod_error_threshold);
+    }
+
     ImGui::TreePop();
   }
 
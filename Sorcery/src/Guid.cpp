@@ -63,3 +63,12 @@ Guid::operator std::string() const {
   return strStream.str();
 }
 }
+
+
+auto std::hash<sorcery::Guid>::operator()(sorcery::Guid const& guid) const noexcept -> std::size_t {
+  // Built-in resources use small sequential guids, so the bits are mixed instead of just folded
+  auto x{guid.mLowBits ^ guid.mHighBits * 0x9E3779B97F4A7C15ull};
+  x = (x ^ x >> 30) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ x >> 27) * 0x94D049BB133111EBull;
+  return static_cast<std::size_t>(x ^ x >> 31);
+}
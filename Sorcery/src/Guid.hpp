@@ -2,11 +2,24 @@
 
 #include "Core.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <compare>
+#include <functional>
 #include <string>
 
 
+namespace sorcery {
+class Guid;
+}
+
+
+template<>
+struct std::hash<sorcery::Guid> {
+  [[nodiscard]] LEOPPHAPI auto operator()(sorcery::Guid const& guid) const noexcept -> std::size_t;
+};
+
+
 namespace sorcery {
 class Guid {
   std::uint64_t mLowBits{0};
@@ -28,5 +41,7 @@ public:
   [[nodiscard]] LEOPPHAPI auto IsValid() const noexcept -> bool;
 
   [[nodiscard]] LEOPPHAPI explicit operator std::string() const;
+
+  friend std::hash<Guid>;
 };
 }
@@ -1,7 +1,11 @@
 #include "Object.hpp"
 
+#include "handle.hpp"
+
+#include <algorithm>
 #include <cassert>
 #include <format>
+#include <ranges>
 
 RTTR_REGISTRATION {
   rttr::registration::class_<sorcery::Object>{"Object"}
@@ -10,27 +14,89 @@ RTTR_REGISTRATION {
 
 
 namespace sorcery {
-Object::Object() {
+Object::Object() :
+  slot_idx_{detail::ObjectSlotMap::Acquire(*this)} {
   std::unique_lock const lock{sAllObjectsMutex};
+  all_objects_idx_ = sAllObjects.size();
   sAllObjects.emplace_back(this);
 }
 
 
+Object::Object(Object const& other) :
+  name_{other.name_},
+  slot_idx_{detail::ObjectSlotMap::Acquire(*this)} {}
+
+
+Object::Object(Object&& other) noexcept :
+  name_{std::move(other.name_)},
+  slot_idx_{detail::ObjectSlotMap::Acquire(*this)} {}
+
+
 Object::~Object() {
-  std::unique_lock const lock{sAllObjectsMutex};
+  {
+    std::unique_lock const lock{sAllObjectsMutex};
 
-  std::erase(sAllObjects, this);
+    if (all_objects_idx_ != kNotInAllObjects) {
+      sAllObjects.back()->all_objects_idx_ = all_objects_idx_;
+      sAllObjects[all_objects_idx_] = sAllObjects.back();
+      sAllObjects.pop_back();
+    }
+
+    while (!references_.empty()) {
+      RemoveReference(references_.back());
+    }
 
-  for (auto const otherObj : sAllObjects) {
-    for (auto const prop : rttr::type::get(*otherObj).get_properties()) {
-      if (prop.get_type().is_pointer()) {
-        if (prop.get_value(*otherObj).get_value<Object*>() == this) {
-          [[maybe_unused]] auto const success{prop.set_value(*otherObj, nullptr)};
-          assert(success);
+    // Only the objects that reported a reference to this one have to be visited
+    if (auto const referrers{sReferrers.extract(this)}; !referrers.empty()) {
+      for (auto const referrer : referrers.mapped() | std::views::keys) {
+        for (auto const prop : rttr::type::get(*referrer).get_properties()) {
+          if (prop.get_type().is_pointer()) {
+            if (prop.get_value(*referrer).get_value<Object*>() == this) {
+              [[maybe_unused]] auto const success{prop.set_value(*referrer, nullptr)};
+              assert(success);
+            }
+          }
         }
+
+        // Drops references that the setters did not report as removed
+        std::erase(referrer->references_, this);
+      }
+    }
+
+#ifndef NDEBUG
+    // Pointer properties that bypass OnReferenceChanged would be left dangling
+    for (auto const obj : sAllObjects) {
+      for (auto const prop : rttr::type::get(*obj).get_properties()) {
+        assert(!prop.get_type().is_pointer() || prop.get_value(*obj).get_value<Object*>() != this);
       }
     }
+#endif
   }
+
+  // Last, because the setters above still count down the references to this object
+  detail::ObjectSlotMap::Release(slot_idx_);
+}
+
+
+auto Object::OnReferenceChanged(Object const* const old_target, Object const* const new_target) -> void {
+  if (old_target == new_target) {
+    return;
+  }
+
+  std::unique_lock const lock{sAllObjectsMutex};
+
+  if (old_target) {
+    RemoveReference(old_target);
+  }
+
+  if (new_target) {
+    AddReference(new_target);
+  }
+}
+
+
+auto Object::IsReferenced() const noexcept -> bool {
+  return detail::ObjectSlotMap::GetSlot(slot_idx_).GetReferenceCount() != 0;
 }
 
 
@@ -44,8 +110,43 @@ auto Object::SetName(std::string const& name) -> void {
 }
 
 
+auto Object::AddReference(Object const* const target) -> void {
+  references_.emplace_back(target);
+  ++sReferrers[target][this];
+  detail::ObjectSlotMap::GetSlot(target->slot_idx_).state.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+auto Object::RemoveReference(Object const* const target) -> void {
+  auto const ref_it{std::ranges::find(references_, target)};
+
+  // The target might have already dropped it while being destroyed
+  if (ref_it == std::end(references_)) {
+    return;
+  }
+
+  *ref_it = references_.back();
+  references_.pop_back();
+  // Targets release their slots only after their referrers gave back their references, so this is the target's count
+  detail::ObjectSlotMap::GetSlot(target->slot_idx_).state.fetch_sub(1, std::memory_order_release);
+
+  if (auto const it{sReferrers.find(target)}; it != std::end(sReferrers)) {
+    if (auto const count_it{it->second.find(this)}; count_it != std::end(it->second) && --count_it->second == 0) {
+      it->second.erase(count_it);
+
+      if (it->second.empty()) {
+        sReferrers.erase(it);
+      }
+    }
+  }
+}
+
+
 std::vector<Object*> Object::sAllObjects;
 
 
 std::recursive_mutex Object::sAllObjectsMutex;
+
+
+std::unordered_map<Object const*, Object::ReferrerCounts> Object::sReferrers;
 }
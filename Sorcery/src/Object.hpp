@@ -4,21 +4,38 @@
 #include "Reflection.hpp"
 
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 
 namespace sorcery {
+template<typename T>
+class Handle;
+
+
 class Object {
   RTTR_ENABLE()
   RTTR_REGISTRATION_FRIEND
 
+  template<typename T>
+  friend class Handle;
+
 protected:
   LEOPPHAPI Object();
-  Object(Object const& other) = default;
-  Object(Object&& other) noexcept = default;
+  // Copies are not referenced by anything, derived classes report the pointers they copy themselves
+  LEOPPHAPI Object(Object const& other);
+  LEOPPHAPI Object(Object&& other) noexcept;
+
+  // Plain references should be stored in a Handle. Setters of reflected pointer properties that have to run when
+  // the target is destroyed instead report every change here so that they can be called with nullptr.
+  // Destroyed objects only null the pointer properties reported here, debug builds assert that no other one is left.
+  LEOPPHAPI auto OnReferenceChanged(Object const* old_target, Object const* new_target) -> void;
 
 public:
   LEOPPHAPI virtual ~Object();
@@ -40,11 +57,28 @@ public:
   template<std::derived_from<Object> T>
   [[nodiscard]] auto FindObjectsOfType() -> std::vector<T*>;
 
+  // True while a Handle or a reported pointer property refers to the object. Does not lock.
+  [[nodiscard]] LEOPPHAPI auto IsReferenced() const noexcept -> bool;
+
 private:
+  constexpr static std::size_t kNotInAllObjects{std::numeric_limits<std::size_t>::max()};
+
+  // Referrers of a target mapped to the number of their properties pointing to it
+  using ReferrerCounts = std::unordered_map<Object*, std::uint32_t>;
+
+  auto AddReference(Object const* target) -> void;
+  auto RemoveReference(Object const* target) -> void;
+
   LEOPPHAPI static std::vector<Object*> sAllObjects;
   LEOPPHAPI static std::recursive_mutex sAllObjectsMutex;
+  // Only contains objects that are referenced
+  LEOPPHAPI static std::unordered_map<Object const*, ReferrerCounts> sReferrers;
 
   std::string name_{"New Object"};
+  std::size_t all_objects_idx_{kNotInAllObjects};
+  std::uint32_t slot_idx_;
+  // Targets of the reported pointer properties, once per property
+  std::vector<Object const*> references_;
 };
 
 
@@ -361,10 +361,14 @@ auto ReflectionDeserializeFromYaml(
 
   if (v.get_type().is_pointer() && v.get_type().get_raw_type().is_derived_from(rttr::type::get<Resource>())) {
     try {
-      if (auto const res{
-        App::Instance().GetResourceManager().GetOrLoad(
+      // Unlike GetOrLoad, this keeps the resource evictable once the deserialized object stops referencing it.
+      // The request pins it until the pointer is stored, entity deserialization holds its own requests until then.
+      auto const handle{
+        App::Instance().GetResourceManager().RequestLoad(
           DeserializeResourceId(node, ctx).value_or<ResourceId>(ResourceId::Invalid()))
-      }) {
+      };
+
+      if (auto const res{handle.Wait()}) {
         if (rttr::variant resVar{res}; resVar.can_convert(v.get_type())) {
           [[maybe_unused]] auto const success{resVar.convert(v.get_type())};
           assert(success);
@@ -1,11 +1,224 @@
 #include "Util.hpp"
 
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <array>
 #include <cctype>
+#include <cmath>
 #include <format>
 #include <stdexcept>
+#include <utility>
 
 
 namespace sorcery {
+namespace {
+// Relative length below which an orthogonalized tangent is considered parallel to the normal
+constexpr float kTangentEpsilon{1e-4f};
+// Faces and vertices per job, fixed so that the results do not depend on the number of threads
+constexpr std::size_t kGeometryChunkSize{16384};
+
+
+template<typename Func>
+auto ForEachChunk(ObserverPtr<JobSystem> const job_system, std::size_t const count, Func&& func) -> void {
+  auto const chunk_count{(count + kGeometryChunkSize - 1) / kGeometryChunkSize};
+
+  auto const process_chunk{
+    [&func, count](std::size_t const chunk_idx) {
+      auto const begin{chunk_idx * kGeometryChunkSize};
+      func(begin, std::min(begin + kGeometryChunkSize, count));
+    }
+  };
+
+  if (job_system) {
+    job_system->ParallelFor(0, chunk_count, process_chunk, 1);
+  } else {
+    for (std::size_t i{0}; i < chunk_count; i++) {
+      process_chunk(i);
+    }
+  }
+}
+
+
+// Faces of each vertex in compressed rows, in ascending order
+struct VertexFaceAdjacency {
+  std::vector<std::uint32_t> offsets;
+  std::vector<std::uint32_t> faces;
+
+
+  [[nodiscard]] auto GetFaces(std::size_t const vertex_idx) const noexcept -> std::span<std::uint32_t const> {
+    return std::span{faces}.subspan(offsets[vertex_idx], offsets[vertex_idx + 1] - offsets[vertex_idx]);
+  }
+};
+
+
+auto BuildVertexFaceAdjacency(std::span<unsigned const> const indices,
+                              std::size_t const vertex_count) -> VertexFaceAdjacency {
+  VertexFaceAdjacency adjacency;
+  adjacency.offsets.assign(vertex_count + 1, 0);
+
+  for (auto const idx : indices) {
+    if (idx >= vertex_count) {
+      throw std::runtime_error{
+        std::format("Vertex index {} is out of range, the mesh only has {} vertices.", idx, vertex_count)
+      };
+    }
+
+    adjacency.offsets[idx + 1] += 1;
+  }
+
+  for (std::size_t i{0}; i < vertex_count; i++) {
+    adjacency.offsets[i + 1] += adjacency.offsets[i];
+  }
+
+  adjacency.faces.resize(indices.size());
+  std::vector<std::uint32_t> write_offsets(std::begin(adjacency.offsets), std::end(adjacency.offsets) - 1);
+
+  for (std::size_t i{0}; i < indices.size(); i++) {
+    adjacency.faces[write_offsets[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+  }
+
+  return adjacency;
+}
+
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+// Four vectors in structure of arrays layout
+struct Vector3x4 {
+  __m128 x;
+  __m128 y;
+  __m128 z;
+};
+
+
+struct Vector2x4 {
+  __m128 x;
+  __m128 y;
+};
+
+
+[[nodiscard]] auto operator+(Vector3x4 const& left, Vector3x4 const& right) noexcept -> Vector3x4 {
+  return {_mm_add_ps(left.x, right.x), _mm_add_ps(left.y, right.y), _mm_add_ps(left.z, right.z)};
+}
+
+
+[[nodiscard]] auto operator-(Vector3x4 const& left, Vector3x4 const& right) noexcept -> Vector3x4 {
+  return {_mm_sub_ps(left.x, right.x), _mm_sub_ps(left.y, right.y), _mm_sub_ps(left.z, right.z)};
+}
+
+
+[[nodiscard]] auto operator-(Vector2x4 const& left, Vector2x4 const& right) noexcept -> Vector2x4 {
+  return {_mm_sub_ps(left.x, right.x), _mm_sub_ps(left.y, right.y)};
+}
+
+
+[[nodiscard]] auto operator*(Vector3x4 const& left, __m128 const right) noexcept -> Vector3x4 {
+  return {_mm_mul_ps(left.x, right), _mm_mul_ps(left.y, right), _mm_mul_ps(left.z, right)};
+}
+
+
+[[nodiscard]] auto Cross(Vector3x4 const& left, Vector3x4 const& right) noexcept -> Vector3x4 {
+  return {
+    _mm_sub_ps(_mm_mul_ps(left.y, right.z), _mm_mul_ps(left.z, right.y)),
+    _mm_sub_ps(_mm_mul_ps(left.z, right.x), _mm_mul_ps(left.x, right.z)),
+    _mm_sub_ps(_mm_mul_ps(left.x, right.y), _mm_mul_ps(left.y, right.x))
+  };
+}
+
+
+#endif
+
+
+// One vector per face, split into components so that four faces can be written at once
+struct FaceVectors {
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+
+
+  auto Resize(std::size_t const count) -> void {
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+  }
+
+
+  auto Store(std::size_t const idx, Vector3 const& vector) noexcept -> void {
+    x[idx] = vector[0];
+    y[idx] = vector[1];
+    z[idx] = vector[2];
+  }
+
+
+  [[nodiscard]] auto Load(std::size_t const idx) const noexcept -> Vector3 {
+    return Vector3{x[idx], y[idx], z[idx]};
+  }
+
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  auto Store(std::size_t const idx, Vector3x4 const& vectors) noexcept -> void {
+    _mm_storeu_ps(x.data() + idx, vectors.x);
+    _mm_storeu_ps(y.data() + idx, vectors.y);
+    _mm_storeu_ps(z.data() + idx, vectors.z);
+  }
+#endif
+};
+
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+// The corners of four consecutive faces
+[[nodiscard]] auto GatherFaces(std::span<Vector3 const> const vertices, std::span<unsigned const> const indices,
+                               std::size_t const first_face) noexcept -> std::array<Vector3x4, 3> {
+  std::array<Vector3x4, 3> corners;
+
+  for (std::size_t i{0}; i < 3; i++) {
+    auto const& v0{vertices[indices[first_face * 3 + i]]};
+    auto const& v1{vertices[indices[first_face * 3 + 3 + i]]};
+    auto const& v2{vertices[indices[first_face * 3 + 6 + i]]};
+    auto const& v3{vertices[indices[first_face * 3 + 9 + i]]};
+    corners[i] = {
+      _mm_setr_ps(v0[0], v1[0], v2[0], v3[0]), _mm_setr_ps(v0[1], v1[1], v2[1], v3[1]),
+      _mm_setr_ps(v0[2], v1[2], v2[2], v3[2])
+    };
+  }
+
+  return corners;
+}
+
+
+[[nodiscard]] auto GatherFaces(std::span<Vector2 const> const vertices, std::span<unsigned const> const indices,
+                               std::size_t const first_face) noexcept -> std::array<Vector2x4, 3> {
+  std::array<Vector2x4, 3> corners;
+
+  for (std::size_t i{0}; i < 3; i++) {
+    auto const& v0{vertices[indices[first_face * 3 + i]]};
+    auto const& v1{vertices[indices[first_face * 3 + 3 + i]]};
+    auto const& v2{vertices[indices[first_face * 3 + 6 + i]]};
+    auto const& v3{vertices[indices[first_face * 3 + 9 + i]]};
+    corners[i] = {_mm_setr_ps(v0[0], v1[0], v2[0], v3[0]), _mm_setr_ps(v0[1], v1[1], v2[1], v3[1])};
+  }
+
+  return corners;
+}
+
+
+template<typename T>
+[[nodiscard]] auto CalculateEdges(std::array<T, 3> const& face) noexcept -> std::pair<T, T> {
+  return {face[1] - face[0], face[2] - face[0]};
+}
+#endif
+
+
+// Branchless orthonormal basis construction by Duff et al.
+[[nodiscard]] auto CalculatePerpendicular(Vector3 const& n) noexcept -> Vector3 {
+  auto const sign{std::copysign(1.0f, n[2])};
+  auto const a{-1.0f / (sign + n[2])};
+  auto const b{n[0] * n[1] * a};
+  return Vector3{1.0f + sign * n[0] * n[0] * a, sign * b, -sign * n[0]};
+}
+}
+
+
 auto Contains(std::string_view const src, std::string_view const target) -> bool {
   if (target.empty()) {
     return true;
@@ -46,7 +259,7 @@ auto Trim(std::string_view const sv) -> std::string_view {
 
 
 auto CalculateNormals(std::span<Vector3 const> const positions, std::span<unsigned const> const indices,
-                      std::vector<Vector3>& out) -> std::vector<Vector3>& {
+                      std::vector<Vector3>& out, ObserverPtr<JobSystem> const job_system) -> std::vector<Vector3>& {
   if (indices.size() % 3 != 0) {
     throw std::runtime_error{
       std::format(
@@ -55,28 +268,55 @@ auto CalculateNormals(std::span<Vector3 const> const positions, std::span<unsign
     };
   }
 
+  auto const adjacency{BuildVertexFaceAdjacency(indices, positions.size())};
+  auto const face_count{indices.size() / 3};
+
+  // The cross product of the edges is the face normal weighted by twice the face area
+  FaceVectors face_normals;
+  face_normals.Resize(face_count);
+
+  ForEachChunk(job_system, face_count, [&](std::size_t const begin, std::size_t const end) {
+    auto face_idx{begin};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+    for (; face_idx + 4 <= end; face_idx += 4) {
+      auto const face{GatherFaces(positions, indices, face_idx)};
+      auto const [edge1, edge2]{CalculateEdges(face)};
+      auto const normal{Cross(edge1, edge2)};
+      face_normals.Store(face_idx, normal);
+    }
+#endif
+
+    for (; face_idx < end; face_idx++) {
+      Vector3 const& vertex1{positions[indices[face_idx * 3]]};
+      Vector3 const& vertex2{positions[indices[face_idx * 3 + 1]]};
+      Vector3 const& vertex3{positions[indices[face_idx * 3 + 2]]};
+      face_normals.Store(face_idx, Cross(vertex2 - vertex1, vertex3 - vertex1));
+    }
+  });
+
   out.resize(positions.size());
 
-  for (auto i = 0; i < std::ssize(indices); i += 3) {
-    Vector3 const& vertex1{positions[indices[i]]};
-    Vector3 const& vertex2{positions[indices[i + 1]]};
-    Vector3 const& vertex3{positions[indices[i + 2]]};
+  ForEachChunk(job_system, positions.size(), [&](std::size_t const begin, std::size_t const end) {
+    for (auto vertex_idx{begin}; vertex_idx < end; vertex_idx++) {
+      Vector3 normal{0};
 
-    Vector3 const edge1{Normalize(vertex2 - vertex1)};
-    Vector3 const edge2{Normalize(vertex3 - vertex1)};
-    Vector3 const normal{Normalize(Cross(edge1, edge2))};
+      for (auto const face_idx : adjacency.GetFaces(vertex_idx)) {
+        normal += face_normals.Load(face_idx);
+      }
 
-    for (auto j = 0; j < 3; j++) {
-      out[indices[i + j]] = normal;
+      // Vertices of degenerate faces only
+      out[vertex_idx] = Length(normal) > 0 ? Normalized(normal) : Vector3::Up();
     }
-  }
+  });
 
   return out;
 }
 
 
-auto CalculateTangents(std::span<Vector3 const> const positions, std::span<Vector2 const> const uvs,
-                       std::span<unsigned const> const indices, std::vector<Vector3>& out) -> void {
+auto CalculateTangents(std::span<Vector3 const> const positions, std::span<Vector3 const> const normals,
+                       std::span<Vector2 const> const uvs, std::span<unsigned const> const indices,
+                       std::vector<Vector4>& out, ObserverPtr<JobSystem> const job_system) -> void {
   if (indices.size() % 3 != 0) {
     throw std::runtime_error{
       std::format(
@@ -85,34 +325,93 @@ auto CalculateTangents(std::span<Vector3 const> const positions, std::span<Vecto
     };
   }
 
-  out.resize(positions.size());
-
-  for (auto i = 0; i < std::ssize(indices); i += 3) {
-    Vector3 const& vertex1{positions[indices[i]]};
-    Vector3 const& vertex2{positions[indices[i + 1]]};
-    Vector3 const& vertex3{positions[indices[i + 2]]};
+  if (normals.size() != positions.size() || uvs.size() != positions.size()) {
+    throw std::runtime_error{
+      std::format(
+        "Cannot calculate tangents because the number of normals ({}) or uvs ({}) does not match the number of positions ({}).",
+        normals.size(), uvs.size(), positions.size())
+    };
+  }
 
-    Vector3 const edge1{Normalize(vertex2 - vertex1)};
-    Vector3 const edge2{Normalize(vertex3 - vertex1)};
+  auto const adjacency{BuildVertexFaceAdjacency(indices, positions.size())};
+  auto const face_count{indices.size() / 3};
+
+  // The directions of increasing u and v, weighted by the face area in UV space.
+  // Faces with degenerate UVs have no effect.
+  FaceVectors face_tangents;
+  FaceVectors face_bitangents;
+  face_tangents.Resize(face_count);
+  face_bitangents.Resize(face_count);
+
+  ForEachChunk(job_system, face_count, [&](std::size_t const begin, std::size_t const end) {
+    auto face_idx{begin};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+    for (; face_idx + 4 <= end; face_idx += 4) {
+      auto const face{GatherFaces(positions, indices, face_idx)};
+      auto const [edge1, edge2]{CalculateEdges(face)};
+      auto const uv_face{GatherFaces(uvs, indices, face_idx)};
+      auto const [uv_edge1, uv_edge2]{CalculateEdges(uv_face)};
+
+      auto const zero{_mm_setzero_ps()};
+      auto const det{_mm_sub_ps(_mm_mul_ps(uv_edge1.x, uv_edge2.y), _mm_mul_ps(uv_edge2.x, uv_edge1.y))};
+      auto const sign{
+        _mm_or_ps(_mm_and_ps(_mm_cmpgt_ps(det, zero), _mm_set1_ps(1.0f)),
+          _mm_and_ps(_mm_cmplt_ps(det, zero), _mm_set1_ps(-1.0f)))
+      };
+
+      face_tangents.Store(face_idx, (edge1 * uv_edge2.y - edge2 * uv_edge1.y) * sign);
+      face_bitangents.Store(face_idx, (edge2 * uv_edge1.x - edge1 * uv_edge2.x) * sign);
+    }
+#endif
 
-    Vector2 const& uv1{uvs[indices[i]]};
-    Vector2 const& uv2{uvs[indices[i + 1]]};
-    Vector2 const& uv3{uvs[indices[i + 2]]};
+    for (; face_idx < end; face_idx++) {
+      auto const idx1{indices[face_idx * 3]};
+      auto const idx2{indices[face_idx * 3 + 1]};
+      auto const idx3{indices[face_idx * 3 + 2]};
 
-    Vector2 const deltaUv1{uv2 - uv1};
-    Vector2 const deltaUv2{uv3 - uv1};
+      Vector3 const edge1{positions[idx2] - positions[idx1]};
+      Vector3 const edge2{positions[idx3] - positions[idx1]};
+      Vector2 const uv_edge1{uvs[idx2] - uvs[idx1]};
+      Vector2 const uv_edge2{uvs[idx3] - uvs[idx1]};
 
-    float const f{1.0f / (deltaUv1[0] * deltaUv2[1] - deltaUv1[1] * deltaUv2[0])};
+      auto const det{uv_edge1[0] * uv_edge2[1] - uv_edge2[0] * uv_edge1[1]};
+      auto const sign{det > 0 ? 1.0f : det < 0 ? -1.0f : 0.0f};
 
-    Vector3 tangent;
-    for (auto j = 0; j < 3; j++) {
-      tangent[j] = f * (deltaUv2[1] * edge1[j] - deltaUv1[1] * edge2[j]);
+      face_tangents.Store(face_idx, (edge1 * uv_edge2[1] - edge2 * uv_edge1[1]) * sign);
+      face_bitangents.Store(face_idx, (edge2 * uv_edge1[0] - edge1 * uv_edge2[0]) * sign);
     }
+  });
 
-    for (auto j = 0; j < 3; j++) {
-      out[indices[i + j]] = tangent;
+  out.resize(positions.size());
+
+  ForEachChunk(job_system, positions.size(), [&](std::size_t const begin, std::size_t const end) {
+    for (auto vertex_idx{begin}; vertex_idx < end; vertex_idx++) {
+      Vector3 tangent{0};
+      Vector3 bitangent{0};
+
+      for (auto const face_idx : adjacency.GetFaces(vertex_idx)) {
+        tangent += face_tangents.Load(face_idx);
+        bitangent += face_bitangents.Load(face_idx);
+      }
+
+      // Gram-Schmidt, the normals may come from a scaling transform
+      auto const normal_length{Length(normals[vertex_idx])};
+      auto const normal{normal_length > 0 ? normals[vertex_idx] / normal_length : Vector3::Up()};
+      auto const ortho_tangent{tangent - normal * Dot(normal, tangent)};
+      auto const ortho_tangent_length{Length(ortho_tangent)};
+
+      // Tangents that are zero or parallel to the normal are replaced by an arbitrary perpendicular direction
+      auto const final_tangent{
+        ortho_tangent_length > kTangentEpsilon * Length(tangent)
+          ? ortho_tangent / ortho_tangent_length
+          : CalculatePerpendicular(normal)
+      };
+
+      auto const handedness{Dot(Cross(normal, final_tangent), bitangent) < 0 ? -1.0f : 1.0f};
+      out[vertex_idx] = Vector4{final_tangent[0], final_tangent[1], final_tangent[2], handedness};
     }
-  }
+  });
 }
 
 
@@ -11,9 +11,13 @@
 #include <vector>
 
 #include "Math.hpp"
+#include "observer_ptr.hpp"
 
 
 namespace sorcery {
+class JobSystem;
+
+
 template<std::integral To, std::integral From>
 [[nodiscard]] constexpr auto clamp_cast(From what) -> To;
 
@@ -29,10 +33,16 @@ template<class T> concept Scalar = std::is_scalar_v<T>;
 [[nodiscard]] SORCERYAPI
 auto Trim(std::string_view sv) -> std::string_view;
 
+// Area weighted vertex normals of a triangle list.
+// Faces are processed in parallel on the job system if one is passed, the results do not depend on it.
 LEOPPHAPI auto CalculateNormals(std::span<Vector3 const> positions, std::span<unsigned const> indices,
-                                std::vector<Vector3>& out) -> std::vector<Vector3>&;
-LEOPPHAPI auto CalculateTangents(std::span<Vector3 const> positions, std::span<Vector2 const> uvs,
-                                 std::span<unsigned const> indices, std::vector<Vector3>& out) -> void;
+                                std::vector<Vector3>& out,
+                                ObserverPtr<JobSystem> job_system = nullptr) -> std::vector<Vector3>&;
+// UV area weighted vertex tangents of a triangle list, orthonormalized against the normals.
+// The w component holds the handedness of the tangent frame, bitangent = cross(normal, tangent) * w.
+LEOPPHAPI auto CalculateTangents(std::span<Vector3 const> positions, std::span<Vector3 const> normals,
+                                 std::span<Vector2 const> uvs, std::span<unsigned const> indices,
+                                 std::vector<Vector4>& out, ObserverPtr<JobSystem> job_system = nullptr) -> void;
 
 // Appends an index to the specified file path to avoid name clashes
 [[nodiscard]] LEOPPHAPI auto GenerateUniquePath(std::filesystem::path const& absolutePath) -> std::filesystem::path;
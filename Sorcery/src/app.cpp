@@ -101,6 +101,16 @@ auto App::GetResourceManager() -> ResourceManager& {
 }
 
 
+auto App::GetTransformSystem() -> TransformSystem& {
+  return transform_system_;
+}
+
+
+auto App::GetComponentRegistry() -> ComponentRegistry& {
+  return component_registry_;
+}
+
+
 auto App::Run() -> void {
   while (!IsQuitSignaled()) {
     BeginFrame();
@@ -113,10 +123,13 @@ auto App::Run() -> void {
 
     EndFrame();
 
-    if (render_job_) {
+    if (render_job_.job) {
       job_system_.Wait(render_job_);
     }
 
+    // The previous frame's render job has finished with the resources, so this is a safe point to evict
+    resource_manager_.EnforceMemoryBudget();
+
     if (window_resized_) {
       if (auto const [width, height]{window_.GetClientAreaSize()}; width != 0 && height != 0) {
         graphics_device_.WaitIdle();
@@ -126,15 +139,22 @@ auto App::Run() -> void {
       window_resized_ = false;
     }
 
+    // World transforms changed during the frame are recalculated once before they are extracted for rendering
+    transform_system_.UpdateWorldData(job_system_);
+
     PrepareRender();
 
-    render_job_ = job_system_.CreateJob([this] {
-      Render();
-      graphics_device_.Present(*swap_chain_);
-      render_manager_.EndFrame();
-    });
+    auto const render_job{
+      job_system_.CreateJob([this] {
+        Render();
+        graphics_device_.Present(*swap_chain_);
+        render_manager_.EndFrame();
+      })
+    };
 
-    job_system_.Run(render_job_);
+    render_job->priority = JobPriority::kFrameCritical;
+    // Waited on next frame, long after the job completed and was possibly reused
+    render_job_ = job_system_.Run(render_job);
 
     timing::OnFrameEnd();
   }
@@ -151,7 +171,7 @@ auto App::Instance() -> App& {
 
 
 auto App::WaitRenderJob() -> void {
-  if (render_job_) {
+  if (render_job_.job) {
     job_system_.Wait(render_job_);
   }
 }
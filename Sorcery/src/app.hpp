@@ -8,6 +8,8 @@
 #include "rendering/graphics.hpp"
 #include "rendering/render_manager.hpp"
 #include "rendering/scene_renderer.hpp"
+#include "scene_objects/component_registry.hpp"
+#include "scene_objects/transform_system.hpp"
 
 #include <span>
 #include <string_view>
@@ -32,6 +34,8 @@ public:
   [[nodiscard]] LEOPPHAPI auto GetSceneRenderer() -> rendering::SceneRenderer&;
   [[nodiscard]] LEOPPHAPI auto GetJobSystem() -> JobSystem&;
   [[nodiscard]] LEOPPHAPI auto GetResourceManager() -> ResourceManager&;
+  [[nodiscard]] LEOPPHAPI auto GetTransformSystem() -> TransformSystem&;
+  [[nodiscard]] LEOPPHAPI auto GetComponentRegistry() -> ComponentRegistry&;
 
   LEOPPHAPI auto Run() -> void;
 
@@ -48,6 +52,9 @@ protected:
 
 private:
   JobSystem job_system_;
+  // Outlive the resources so that destroying their entities is safe
+  TransformSystem transform_system_;
+  ComponentRegistry component_registry_;
   graphics::GraphicsDevice graphics_device_;
   Window window_;
   graphics::SharedDeviceChildHandle<graphics::SwapChain> swap_chain_;
@@ -55,7 +62,7 @@ private:
   rendering::SceneRenderer scene_renderer_;
   ResourceManager resource_manager_;
   bool window_resized_{false};
-  ObserverPtr<Job> render_job_;
+  JobWaitHandle render_job_;
 
 
   static ObserverPtr<App> instance_;
@@ -1,7 +1,7 @@
 #include "entity_serialization.hpp"
 
 #include "app.hpp"
-#include "job_system.hpp"
+#include "resource_manager.hpp"
 #include "Serialization.hpp"
 #include "resources/Resource.hpp"
 #include "scene_objects/Component.hpp"
@@ -130,15 +130,12 @@ auto DeserializeEntitySet(
 
   required_resource_ids.erase(std::ranges::unique(required_resource_ids).begin(), required_resource_ids.end());
 
-  std::vector<ObserverPtr<Job>> resource_loading_jobs;
-  resource_loading_jobs.reserve(required_resource_ids.size());
+  // The loads proceed in the background, deserialization only waits for a resource once it reaches a reference to it
+  std::vector<ResourceHandle<>> resource_handles;
+  resource_handles.reserve(required_resource_ids.size());
 
   for (auto const& res_id : required_resource_ids) {
-    resource_loading_jobs.emplace_back(App::Instance().GetJobSystem().CreateJob([](ResourceId const& target_res_id) {
-      App::Instance().GetResourceManager().GetOrLoad<Resource>(target_res_id);
-    }, res_id));
-
-    App::Instance().GetJobSystem().Run(resource_loading_jobs.back());
+    resource_handles.emplace_back(App::Instance().GetResourceManager().RequestLoad(res_id));
   }
 
   // Deserialize the scene objects
@@ -161,10 +158,6 @@ auto DeserializeEntitySet(
       ctx, deserialize_scene_obj_ptr);
   }
 
-  for (auto const job : resource_loading_jobs) {
-    App::Instance().GetJobSystem().Wait(job);
-  }
-
   std::vector<std::unique_ptr<Entity>> ret;
 
   // Add the new entities to the returned vector
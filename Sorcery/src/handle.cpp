@@ -0,0 +1,53 @@
+#include "handle.hpp"
+
+#include <cassert>
+
+
+namespace sorcery::detail {
+auto ObjectSlotMap::Acquire(Object& object) -> std::uint32_t {
+  std::unique_lock const lock{mutex_};
+
+  std::uint32_t index;
+
+  if (!free_slots_.empty()) {
+    index = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    index = slot_count_++;
+    assert(index / kPageSize < kMaxPageCount);
+
+    if (auto& page{pages_[index / kPageSize]}; !page) {
+      page = std::make_unique<Page>();
+    }
+  }
+
+  auto& slot{(*pages_[index / kPageSize])[index % kPageSize]};
+  slot.object.store(&object, std::memory_order_release);
+  // References that the previous object never gave back do not carry over
+  slot.state.store(slot.state.load(std::memory_order_relaxed) & ~kReferenceCountMask, std::memory_order_release);
+  return index;
+}
+
+
+auto ObjectSlotMap::Release(std::uint32_t const index) -> void {
+  std::unique_lock const lock{mutex_};
+
+  auto& slot{(*pages_[index / kPageSize])[index % kPageSize]};
+  slot.object.store(nullptr, std::memory_order_relaxed);
+  // Keeps the count, handles of the old generation can no longer change it
+  slot.state.fetch_add(std::uint64_t{1} << kGenerationShift, std::memory_order_release);
+  free_slots_.emplace_back(index);
+}
+
+
+std::array<std::unique_ptr<ObjectSlotMap::Page>, ObjectSlotMap::kMaxPageCount> ObjectSlotMap::pages_;
+
+
+std::vector<std::uint32_t> ObjectSlotMap::free_slots_;
+
+
+std::uint32_t ObjectSlotMap::slot_count_{0};
+
+
+std::mutex ObjectSlotMap::mutex_;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Core.hpp"
+#include "Object.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace sorcery {
+namespace detail {
+// Every live object owns a slot. Releasing a slot bumps its generation, which invalidates the handles to it.
+// Slots are paged so that resolving a handle never races with the creation of other objects.
+class ObjectSlotMap {
+public:
+  struct Slot {
+    std::atomic<Object*> object;
+    // Generation in the upper half, live handles plus reported pointer properties pointing to the object in the lower
+    // half. Sharing one word keeps a handle that outlives its object from changing the count of the slot's next object.
+    mutable std::atomic<std::uint64_t> state;
+
+    [[nodiscard]] auto GetGeneration() const noexcept -> std::uint32_t;
+    [[nodiscard]] auto GetReferenceCount() const noexcept -> std::uint32_t;
+
+    // Only change the count while the slot is in the passed generation
+    auto TryAddReference(std::uint32_t generation) const noexcept -> bool;
+    auto TryRemoveReference(std::uint32_t generation) const noexcept -> bool;
+  };
+
+
+  constexpr static std::uint32_t kInvalidIndex{std::numeric_limits<std::uint32_t>::max()};
+
+  [[nodiscard]] LEOPPHAPI static auto Acquire(Object& object) -> std::uint32_t;
+  LEOPPHAPI static auto Release(std::uint32_t index) -> void;
+
+  [[nodiscard]] static auto GetSlot(std::uint32_t index) noexcept -> Slot const&;
+
+private:
+  constexpr static int kGenerationShift{32};
+  constexpr static std::uint64_t kReferenceCountMask{(std::uint64_t{1} << kGenerationShift) - 1};
+
+  constexpr static std::size_t kPageSize{4096};
+  constexpr static std::size_t kMaxPageCount{4096};
+
+  using Page = std::array<Slot, kPageSize>;
+
+  LEOPPHAPI static std::array<std::unique_ptr<Page>, kMaxPageCount> pages_;
+  LEOPPHAPI static std::vector<std::uint32_t> free_slots_;
+  LEOPPHAPI static std::uint32_t slot_count_;
+  LEOPPHAPI static std::mutex mutex_;
+};
+}
+
+
+// Index and generation of an object's slot. Resolves to nullptr once the object is destroyed.
+// Resolving is as thread safe as dereferencing a pointer: it must not race with the destruction of the target.
+// While a handle to a live object exists, Object::IsReferenced reports the object as referenced.
+// T only has to be complete where the handle is created or resolved.
+template<typename T>
+class Handle {
+public:
+  Handle() = default;
+  Handle(std::nullptr_t) noexcept;
+  Handle(T* object) noexcept;
+  Handle(Handle const& other) noexcept;
+  Handle(Handle&& other) noexcept;
+
+  ~Handle();
+
+  auto operator=(Handle const& other) noexcept -> Handle&;
+  auto operator=(Handle&& other) noexcept -> Handle&;
+
+  [[nodiscard]] auto Get() const noexcept -> T*;
+
+  [[nodiscard]] auto operator->() const noexcept -> T*;
+  [[nodiscard]] auto operator*() const noexcept -> T&;
+  [[nodiscard]] explicit operator bool() const noexcept;
+
+  [[nodiscard]] auto operator==(Handle const& other) const noexcept -> bool = default;
+  [[nodiscard]] auto operator==(std::nullptr_t) const noexcept -> bool;
+
+private:
+  auto Pin() const noexcept -> void;
+  auto Unpin() const noexcept -> void;
+
+  std::uint32_t index_{detail::ObjectSlotMap::kInvalidIndex};
+  std::uint32_t generation_{0};
+};
+}
+
+
+#include "handle.inl"
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <utility>
+
+
+namespace sorcery {
+namespace detail {
+inline auto ObjectSlotMap::Slot::GetGeneration() const noexcept -> std::uint32_t {
+  return static_cast<std::uint32_t>(state.load(std::memory_order_acquire) >> kGenerationShift);
+}
+
+
+inline auto ObjectSlotMap::Slot::GetReferenceCount() const noexcept -> std::uint32_t {
+  return static_cast<std::uint32_t>(state.load(std::memory_order_acquire) & kReferenceCountMask);
+}
+
+
+inline auto ObjectSlotMap::Slot::TryAddReference(std::uint32_t const generation) const noexcept -> bool {
+  auto expected{state.load(std::memory_order_relaxed)};
+
+  while (expected >> kGenerationShift == generation) {
+    if (state.compare_exchange_weak(expected, expected + 1, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+inline auto ObjectSlotMap::Slot::TryRemoveReference(std::uint32_t const generation) const noexcept -> bool {
+  auto expected{state.load(std::memory_order_relaxed)};
+
+  while (expected >> kGenerationShift == generation) {
+    if (state.compare_exchange_weak(expected, expected - 1, std::memory_order_release, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+inline auto ObjectSlotMap::GetSlot(std::uint32_t const index) noexcept -> Slot const& {
+  return (*pages_[index / kPageSize])[index % kPageSize];
+}
+}
+
+
+template<typename T>
+Handle<T>::Handle(std::nullptr_t) noexcept {}
+
+
+template<typename T>
+Handle<T>::Handle(T* const object) noexcept {
+  static_assert(std::derived_from<T, Object>);
+
+  if (object) {
+    index_ = static_cast<Object const*>(object)->slot_idx_;
+    generation_ = detail::ObjectSlotMap::GetSlot(index_).GetGeneration();
+    Pin();
+  }
+}
+
+
+template<typename T>
+Handle<T>::Handle(Handle const& other) noexcept :
+  index_{other.index_},
+  generation_{other.generation_} {
+  Pin();
+}
+
+
+template<typename T>
+Handle<T>::Handle(Handle&& other) noexcept :
+  index_{std::exchange(other.index_, detail::ObjectSlotMap::kInvalidIndex)},
+  generation_{other.generation_} {}
+
+
+template<typename T>
+Handle<T>::~Handle() {
+  Unpin();
+}
+
+
+template<typename T>
+auto Handle<T>::operator=(Handle const& other) noexcept -> Handle& {
+  if (this != &other) {
+    other.Pin();
+    Unpin();
+    index_ = other.index_;
+    generation_ = other.generation_;
+  }
+
+  return *this;
+}
+
+
+template<typename T>
+auto Handle<T>::operator=(Handle&& other) noexcept -> Handle& {
+  if (this != &other) {
+    Unpin();
+    index_ = std::exchange(other.index_, detail::ObjectSlotMap::kInvalidIndex);
+    generation_ = other.generation_;
+  }
+
+  return *this;
+}
+
+
+template<typename T>
+auto Handle<T>::Get() const noexcept -> T* {
+  static_assert(std::derived_from<T, Object>);
+
+  if (index_ == detail::ObjectSlotMap::kInvalidIndex) {
+    return nullptr;
+  }
+
+  auto const& slot{detail::ObjectSlotMap::GetSlot(index_)};
+
+  if (slot.GetGeneration() != generation_) {
+    return nullptr;
+  }
+
+  auto const object{slot.object.load(std::memory_order_acquire)};
+  // The slot might have been released and reused while the object was loaded
+  return slot.GetGeneration() == generation_ ? static_cast<T*>(object) : nullptr;
+}
+
+
+template<typename T>
+auto Handle<T>::operator->() const noexcept -> T* {
+  return Get();
+}
+
+
+template<typename T>
+auto Handle<T>::operator*() const noexcept -> T& {
+  return *Get();
+}
+
+
+template<typename T>
+Handle<T>::operator bool() const noexcept {
+  return Get() != nullptr;
+}
+
+
+template<typename T>
+auto Handle<T>::operator==(std::nullptr_t) const noexcept -> bool {
+  return Get() == nullptr;
+}
+
+
+template<typename T>
+auto Handle<T>::Pin() const noexcept -> void {
+  if (index_ == detail::ObjectSlotMap::kInvalidIndex) {
+    return;
+  }
+
+  // Handles to destroyed objects do not count towards the object that reuses the slot
+  detail::ObjectSlotMap::GetSlot(index_).TryAddReference(generation_);
+}
+
+
+template<typename T>
+auto Handle<T>::Unpin() const noexcept -> void {
+  if (index_ == detail::ObjectSlotMap::kInvalidIndex) {
+    return;
+  }
+
+  detail::ObjectSlotMap::GetSlot(index_).TryRemoveReference(generation_);
+}
+}
@@ -5,11 +5,11 @@
 
 namespace sorcery {
 namespace {
-template<typename T>
+template<typename Container>
 [[nodiscard]]
 auto ReadBinaryFileHelper(
   std::filesystem::path const& src,
-  std::vector<T>& out
+  Container& out
 ) -> bool {
   std::ifstream file{src, std::ios::binary | std::ios::ate};
 
@@ -50,4 +50,12 @@ auto ReadBinaryFile(
 ) -> bool {
   return ReadBinaryFileHelper(src, out);
 }
+
+
+auto ReadBinaryFile(
+  std::filesystem::path const& src,
+  std::string& out
+) -> bool {
+  return ReadBinaryFileHelper(src, out);
+}
 }
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <string>
 #include <vector>
 
 #include "Core.hpp"
@@ -19,4 +20,10 @@ auto ReadBinaryFile(
   std::filesystem::path const& src,
   std::vector<unsigned char>& out
 ) -> bool;
+
+[[nodiscard]] SORCERYAPI
+auto ReadBinaryFile(
+  std::filesystem::path const& src,
+  std::string& out
+) -> bool;
 }
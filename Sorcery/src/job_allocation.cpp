@@ -0,0 +1,116 @@
+#include "job_allocation.hpp"
+
+#include <algorithm>
+#include <bit>
+
+
+namespace sorcery {
+auto JobPool::Allocate() -> Job* {
+  if (!recycled_head_) {
+    CollectFreedJobs();
+  }
+
+  if (recycled_head_) {
+    auto const job{recycled_head_};
+    recycled_head_ = job->next_free;
+
+    if (!recycled_head_) {
+      recycled_tail_ = nullptr;
+    }
+
+    return job;
+  }
+
+  if (next_unused_job_idx_ == chunk_size_) {
+    chunks_.emplace_back(std::make_unique<Job[]>(chunk_size_));
+    next_unused_job_idx_ = 0;
+  }
+
+  return &chunks_.back()[next_unused_job_idx_++];
+}
+
+
+auto JobPool::Free(Job& job) -> void {
+  auto head{freed_head_.load(std::memory_order_relaxed)};
+
+  do {
+    job.next_free = head;
+  } while (!freed_head_.compare_exchange_weak(head, &job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+
+auto JobPool::CollectFreedJobs() -> void {
+  // Taking the whole stack at once means there is no ABA problem with concurrent frees
+  auto job{freed_head_.exchange(nullptr, std::memory_order_acquire)};
+
+  // The stack is newest first, reverse it so that the oldest jobs get recycled first
+  Job* oldest{nullptr};
+  Job* const newest{job};
+
+  while (job) {
+    auto const next{job->next_free};
+    job->next_free = oldest;
+    oldest = job;
+    job = next;
+  }
+
+  if (!oldest) {
+    return;
+  }
+
+  if (recycled_tail_) {
+    recycled_tail_->next_free = oldest;
+  } else {
+    recycled_head_ = oldest;
+  }
+
+  recycled_tail_ = newest;
+}
+
+
+auto JobDataArena::Allocate(std::size_t const size, std::size_t const alignment) -> void* {
+  auto const effective_alignment{std::max(alignment, alignof(Chunk*))};
+  auto const worst_case_size{size + effective_alignment + sizeof(Chunk*)};
+
+  if (!current_chunk_ || current_chunk_->size - current_chunk_->used_size < worst_case_size) {
+    current_chunk_ = &FindChunk(worst_case_size);
+  }
+
+  auto& chunk{*current_chunk_};
+  auto const chunk_begin{std::bit_cast<std::uintptr_t>(chunk.memory.get())};
+  auto const header_begin{chunk_begin + chunk.used_size};
+  auto const payload_begin{
+    (header_begin + sizeof(Chunk*) + effective_alignment - 1) & ~(effective_alignment - 1)
+  };
+
+  // The owning chunk is stored right before the payload so that any thread can release it
+  *std::bit_cast<Chunk**>(payload_begin - sizeof(Chunk*)) = &chunk;
+
+  chunk.used_size = payload_begin + size - chunk_begin;
+  chunk.live_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+  return std::bit_cast<void*>(payload_begin);
+}
+
+
+auto JobDataArena::Release(void* const ptr) -> void {
+  auto const chunk{*std::bit_cast<Chunk**>(std::bit_cast<std::uintptr_t>(ptr) - sizeof(Chunk*))};
+  chunk->live_allocation_count.fetch_sub(1, std::memory_order_release);
+}
+
+
+auto JobDataArena::FindChunk(std::size_t const min_size) -> Chunk& {
+  for (auto const& chunk : chunks_) {
+    if (chunk->size >= min_size && chunk->live_allocation_count.load(std::memory_order_acquire) == 0) {
+      chunk->used_size = 0;
+      return *chunk;
+    }
+  }
+
+  auto const chunk_size{std::max(chunk_size_, min_size)};
+  auto& chunk{
+    *chunks_.emplace_back(std::make_unique<Chunk>(std::make_unique<std::byte[]>(chunk_size), chunk_size, 0, 0))
+  };
+  return chunk;
+}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "job_system.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace sorcery {
+// Per-thread job allocator. Only the owning thread allocates, any thread can free.
+// Freed jobs are handed out again right away, waiters tell the runs of a job apart through its generation.
+class JobPool {
+public:
+  JobPool() = default;
+  JobPool(JobPool const&) = delete;
+  JobPool(JobPool&&) = delete;
+
+  ~JobPool() = default;
+
+  auto operator=(JobPool const&) -> void = delete;
+  auto operator=(JobPool&&) -> void = delete;
+
+  [[nodiscard]] auto Allocate() -> Job*;
+  // Can be called from any thread
+  auto Free(Job& job) -> void;
+
+private:
+  auto CollectFreedJobs() -> void;
+
+  constexpr static std::size_t chunk_size_{256};
+
+  std::vector<std::unique_ptr<Job[]>> chunks_;
+  std::size_t next_unused_job_idx_{chunk_size_};
+
+  // Owner side FIFO of freed jobs, linked through Job::next_free
+  Job* recycled_head_{nullptr};
+  Job* recycled_tail_{nullptr};
+
+  // Lock-free stack that other threads push freed jobs onto. Only the owner takes from it, always all at once.
+  alignas(64) std::atomic<Job*> freed_head_{nullptr};
+};
+
+
+// Per-thread arena for job payloads that do not fit into Job::data.
+// Allocations are bump allocated from chunks, chunks are reused once every allocation in them has been released.
+class JobDataArena {
+public:
+  JobDataArena() = default;
+  JobDataArena(JobDataArena const&) = delete;
+  JobDataArena(JobDataArena&&) = delete;
+
+  ~JobDataArena() = default;
+
+  auto operator=(JobDataArena const&) -> void = delete;
+  auto operator=(JobDataArena&&) -> void = delete;
+
+  [[nodiscard]] auto Allocate(std::size_t size, std::size_t alignment) -> void*;
+  // Can be called from any thread
+  static auto Release(void* ptr) -> void;
+
+private:
+  struct Chunk {
+    std::unique_ptr<std::byte[]> memory;
+    std::size_t size;
+    std::size_t used_size;
+    std::atomic<std::uint32_t> live_allocation_count;
+  };
+
+  [[nodiscard]] auto FindChunk(std::size_t min_size) -> Chunk&;
+
+  constexpr static std::size_t chunk_size_{64 * 1024};
+
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  Chunk* current_chunk_{nullptr};
+};
+}
@@ -0,0 +1,184 @@
+#include "job_profiler.hpp"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+
+
+namespace sorcery {
+JobProfiler::JobProfiler(unsigned const thread_count) :
+  thread_count_{thread_count},
+  thread_data_{std::make_unique<ThreadData[]>(thread_count)},
+  start_time_{Clock::now()} {
+  for (unsigned i{0}; i < thread_count_; i++) {
+    thread_data_[i].events = std::make_unique<Event[]>(event_capacity_);
+  }
+}
+
+
+JobProfiler::~JobProfiler() = default;
+
+
+auto JobProfiler::RecordEvent(unsigned const thread_idx, JobEventType const type, void const* const job) noexcept -> void {
+  auto& data{thread_data_[thread_idx]};
+  auto const timestamp{std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time_).count()};
+
+  // Single writer per thread, so plain load-store pairs are enough for the counters
+  auto const increment{
+    [](std::atomic<std::uint64_t>& counter) {
+      counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+  };
+
+  switch (type) {
+    case JobEventType::kJobBegin: {
+      if (data.job_depth++ == 0) {
+        data.outermost_job_begin = timestamp;
+      }
+      break;
+    }
+    case JobEventType::kJobEnd: {
+      increment(data.executed_job_count);
+
+      if (--data.job_depth == 0) {
+        data.busy_time.store(data.busy_time.load(std::memory_order_relaxed) + timestamp - data.outermost_job_begin,
+          std::memory_order_relaxed);
+      }
+      break;
+    }
+    case JobEventType::kSteal: {
+      increment(data.successful_steal_count);
+      break;
+    }
+    case JobEventType::kPark: {
+      increment(data.park_count);
+      data.park_begin = timestamp;
+      break;
+    }
+    case JobEventType::kUnpark: {
+      data.parked_time.store(data.parked_time.load(std::memory_order_relaxed) + timestamp - data.park_begin,
+        std::memory_order_relaxed);
+      break;
+    }
+  }
+
+  auto const event_idx{data.written_event_count.load(std::memory_order_relaxed)};
+  auto& event{data.events[event_idx % event_capacity_]};
+  event.timestamp.store(timestamp, std::memory_order_relaxed);
+  event.job.store(job, std::memory_order_relaxed);
+  event.type.store(type, std::memory_order_relaxed);
+  data.written_event_count.store(event_idx + 1, std::memory_order_release);
+}
+
+
+auto JobProfiler::RecordStealAttempt(unsigned const thread_idx) noexcept -> void {
+  auto& counter{thread_data_[thread_idx].steal_attempt_count};
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+auto JobProfiler::GetCounters() const -> std::vector<JobThreadCounters> {
+  std::vector<JobThreadCounters> counters;
+  counters.reserve(thread_count_);
+
+  for (unsigned i{0}; i < thread_count_; i++) {
+    auto const& data{thread_data_[i]};
+    auto const written_event_count{data.written_event_count.load(std::memory_order_relaxed)};
+
+    counters.emplace_back(JobThreadCounters{
+      .executed_job_count = data.executed_job_count.load(std::memory_order_relaxed),
+      .steal_attempt_count = data.steal_attempt_count.load(std::memory_order_relaxed),
+      .successful_steal_count = data.successful_steal_count.load(std::memory_order_relaxed),
+      .park_count = data.park_count.load(std::memory_order_relaxed),
+      .busy_time = std::chrono::nanoseconds{data.busy_time.load(std::memory_order_relaxed)},
+      .parked_time = std::chrono::nanoseconds{data.parked_time.load(std::memory_order_relaxed)},
+      .dropped_event_count = written_event_count > event_capacity_ ? written_event_count - event_capacity_ : 0
+    });
+  }
+
+  return counters;
+}
+
+
+auto JobProfiler::ExportChromeTrace(std::ostream& stream) const -> void {
+  stream << R"({"displayTimeUnit":"ns","traceEvents":[)";
+  auto first{true};
+
+  auto const write_separator{
+    [&stream, &first] {
+      if (!first) {
+        stream << ',';
+      }
+      first = false;
+    }
+  };
+
+  for (unsigned thread_idx{0}; thread_idx < thread_count_; thread_idx++) {
+    write_separator();
+    stream << std::format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"Job Thread {}"}}}})",
+      thread_idx, thread_idx);
+
+    for (auto const& event : TakeSnapshot(thread_data_[thread_idx])) {
+      // Chrome traces use microsecond timestamps
+      auto const ts{static_cast<double>(event.timestamp) / 1000.0};
+      write_separator();
+
+      switch (event.type) {
+        case JobEventType::kJobBegin: {
+          stream << std::format(R"({{"name":"Job","cat":"job","ph":"B","pid":0,"tid":{},"ts":{:.3f},"args":{{"job":"{}"}}}})",
+            thread_idx, ts, event.job);
+          break;
+        }
+        case JobEventType::kJobEnd: {
+          stream << std::format(R"({{"ph":"E","pid":0,"tid":{},"ts":{:.3f}}})", thread_idx, ts);
+          break;
+        }
+        case JobEventType::kSteal: {
+          stream << std::format(
+            R"({{"name":"Steal","cat":"scheduler","ph":"i","s":"t","pid":0,"tid":{},"ts":{:.3f},"args":{{"job":"{}"}}}})",
+            thread_idx, ts, event.job);
+          break;
+        }
+        case JobEventType::kPark: {
+          stream << std::format(R"({{"name":"Parked","cat":"scheduler","ph":"B","pid":0,"tid":{},"ts":{:.3f}}})",
+            thread_idx, ts);
+          break;
+        }
+        case JobEventType::kUnpark: {
+          stream << std::format(R"({{"ph":"E","pid":0,"tid":{},"ts":{:.3f}}})", thread_idx, ts);
+          break;
+        }
+      }
+    }
+  }
+
+  stream << "]}";
+}
+
+
+auto JobProfiler::TakeSnapshot(ThreadData const& thread_data) const -> std::vector<EventSnapshot> {
+  auto const end_idx{thread_data.written_event_count.load(std::memory_order_acquire)};
+  auto const begin_idx{end_idx > event_capacity_ ? end_idx - event_capacity_ : 0};
+
+  std::vector<EventSnapshot> snapshot;
+  snapshot.reserve(end_idx - begin_idx);
+
+  for (auto i{begin_idx}; i < end_idx; i++) {
+    auto const& event{thread_data.events[i % event_capacity_]};
+    snapshot.emplace_back(event.timestamp.load(std::memory_order_relaxed), event.job.load(std::memory_order_relaxed),
+      event.type.load(std::memory_order_relaxed));
+  }
+
+  // The writer may have lapped us while copying. Drop the slots it could have overwritten, including the one in flight.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  auto const new_end_idx{thread_data.written_event_count.load(std::memory_order_relaxed)};
+
+  if (auto const first_valid_idx{new_end_idx + 1 > event_capacity_ ? new_end_idx + 1 - event_capacity_ : 0};
+    first_valid_idx > begin_idx) {
+    snapshot.erase(std::begin(snapshot),
+      std::begin(snapshot) + static_cast<std::ptrdiff_t>(std::min(first_valid_idx - begin_idx, snapshot.size())));
+  }
+
+  return snapshot;
+}
+}
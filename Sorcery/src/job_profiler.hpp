@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Core.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// Job system instrumentation is compiled in for debug builds by default.
+// Define SORCERY_JOB_SYSTEM_PROFILING to force it on, or SORCERY_NO_JOB_SYSTEM_PROFILING to force it off.
+#if defined(SORCERY_JOB_SYSTEM_PROFILING) && defined(SORCERY_NO_JOB_SYSTEM_PROFILING)
+#error SORCERY_JOB_SYSTEM_PROFILING and SORCERY_NO_JOB_SYSTEM_PROFILING cannot be defined at the same time.
+#endif
+
+#if !defined(SORCERY_JOB_SYSTEM_PROFILING) && !defined(SORCERY_NO_JOB_SYSTEM_PROFILING) && !defined(NDEBUG)
+#define SORCERY_JOB_SYSTEM_PROFILING
+#endif
+
+
+namespace sorcery {
+#ifdef SORCERY_JOB_SYSTEM_PROFILING
+constexpr auto kJobSystemProfilingEnabled{true};
+#else
+constexpr auto kJobSystemProfilingEnabled{false};
+#endif
+
+
+enum class JobEventType : std::uint8_t {
+  kJobBegin = 0,
+  kJobEnd = 1,
+  kSteal = 2,
+  kPark = 3,
+  kUnpark = 4
+};
+
+
+// Cumulative counters of a single job system thread.
+struct JobThreadCounters {
+  std::uint64_t executed_job_count{0};
+  std::uint64_t steal_attempt_count{0};
+  std::uint64_t successful_steal_count{0};
+  std::uint64_t park_count{0};
+  // Time spent executing outermost jobs, nested jobs executed while waiting are not counted twice
+  std::chrono::nanoseconds busy_time{0};
+  std::chrono::nanoseconds parked_time{0};
+  // Events that were overwritten before they could be exported
+  std::uint64_t dropped_event_count{0};
+};
+
+
+// Records job system events into one ring buffer per thread.
+// Each thread only writes its own buffer, readers take a consistent snapshot without blocking the writer.
+class JobProfiler {
+public:
+  LEOPPHAPI explicit JobProfiler(unsigned thread_count);
+  JobProfiler(JobProfiler const&) = delete;
+  JobProfiler(JobProfiler&&) = delete;
+
+  LEOPPHAPI ~JobProfiler();
+
+  auto operator=(JobProfiler const&) -> void = delete;
+  auto operator=(JobProfiler&&) -> void = delete;
+
+  // Must only be called from the thread with the given index
+  LEOPPHAPI auto RecordEvent(unsigned thread_idx, JobEventType type, void const* job = nullptr) noexcept -> void;
+  LEOPPHAPI auto RecordStealAttempt(unsigned thread_idx) noexcept -> void;
+
+  [[nodiscard]] LEOPPHAPI auto GetCounters() const -> std::vector<JobThreadCounters>;
+  // Writes the buffered events in the Chrome trace event format, viewable in chrome://tracing or Perfetto
+  LEOPPHAPI auto ExportChromeTrace(std::ostream& stream) const -> void;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+
+  struct Event {
+    std::atomic<std::int64_t> timestamp;
+    std::atomic<void const*> job;
+    std::atomic<JobEventType> type;
+  };
+
+
+  struct EventSnapshot {
+    std::int64_t timestamp;
+    void const* job;
+    JobEventType type;
+  };
+
+
+  struct alignas(64) ThreadData {
+    std::unique_ptr<Event[]> events;
+    std::atomic<std::uint64_t> written_event_count{0};
+
+    std::atomic<std::uint64_t> executed_job_count{0};
+    std::atomic<std::uint64_t> steal_attempt_count{0};
+    std::atomic<std::uint64_t> successful_steal_count{0};
+    std::atomic<std::uint64_t> park_count{0};
+    std::atomic<std::int64_t> busy_time{0};
+    std::atomic<std::int64_t> parked_time{0};
+
+    // Only touched by the owning thread
+    std::int64_t outermost_job_begin{0};
+    std::int64_t park_begin{0};
+    unsigned job_depth{0};
+  };
+
+
+  [[nodiscard]] auto TakeSnapshot(ThreadData const& thread_data) const -> std::vector<EventSnapshot>;
+
+  constexpr static std::size_t event_capacity_{1 << 16};
+
+  unsigned thread_count_;
+  std::unique_ptr<ThreadData[]> thread_data_;
+  Clock::time_point start_time_;
+};
+}
@@ -1,21 +1,34 @@
 #include "job_system.hpp"
 
+#include "job_allocation.hpp"
+#include "mutex.hpp"
+
 #include <algorithm>
 #include <cstddef>
+#include <immintrin.h>
 #include <stdexcept>
+#include <vector>
 
 
 namespace sorcery {
-JobSystem::JobSystem(unsigned const max_thread_count) :
+JobSystem::JobSystem(unsigned const max_thread_count, unsigned const io_thread_count) :
   thread_count_{
     [max_thread_count] {
       auto const preferred_thread_count{std::max(std::jthread::hardware_concurrency(), 2u)};
       return max_thread_count == 0 ? preferred_thread_count : std::min(preferred_thread_count, max_thread_count);
     }()
   },
-  worker_count_{thread_count_ - 1} {
-  job_queues_ = std::make_unique<WorkStealingQueue<ObserverPtr<Job>>[]>(thread_count_);
+  worker_count_{thread_count_ - 1},
+  io_thread_count_{std::max(io_thread_count, 1u)} {
+  job_queues_ = std::make_unique<WorkStealingQueue<ObserverPtr<Job>>[]>(
+    static_cast<std::size_t>(thread_count_ + io_thread_count_) * kComputeJobPriorityCount);
+
+  if constexpr (kJobSystemProfilingEnabled) {
+    profiler_ = std::make_unique<JobProfiler>(thread_count_ + io_thread_count_);
+  }
+
   workers_ = std::make_unique<std::jthread[]>(worker_count_);
+  io_threads_ = std::make_unique<std::jthread[]>(io_thread_count_);
 
   for (unsigned i{0}; i < worker_count_; i++) {
     workers_[i] = std::jthread{
@@ -23,17 +36,40 @@ JobSystem::JobSystem(unsigned const max_thread_count) :
         this_thread_idx_ = thread_idx;
 
         while (!stop_token.stop_requested()) {
-          if (auto const job{FindJobToExecute()}) {
+          if (auto const job{WaitForJob(stop_token)}) {
             Execute(*job);
-          } else {
-            std::unique_lock lock{wake_threads_mutex_};
-            wake_threads_cond_var_.wait(lock);
           }
         }
       },
       i + 1
     };
   }
+
+  for (unsigned i{0}; i < io_thread_count_; i++) {
+    io_threads_[i] = std::jthread{
+      [this](std::stop_token const& stop_token, unsigned const thread_idx) {
+        this_thread_idx_ = thread_idx;
+
+        while (true) {
+          Job* job;
+
+          {
+            std::unique_lock lock{io_job_mutex_};
+
+            if (!io_job_cond_var_.wait(lock, stop_token, [this] { return !io_jobs_.empty(); })) {
+              return;
+            }
+
+            job = io_jobs_.front();
+            io_jobs_.pop_front();
+          }
+
+          Execute(*job);
+        }
+      },
+      thread_count_ + i
+    };
+  }
 }
 
 
@@ -42,33 +78,126 @@ JobSystem::~JobSystem() {
     workers_[i].request_stop();
   }
 
-  wake_threads_cond_var_.notify_all();
+  wake_epoch_.fetch_add(1, std::memory_order_release);
+  wake_epoch_.notify_all();
+
+  // Joined here instead of by the member destructors, which would destroy the I/O queue and the eventcount first.
+  // Workers finishing their last job might still push I/O jobs, so the I/O threads are stopped after them.
+  for (unsigned i{0}; i < worker_count_; i++) {
+    workers_[i].join();
+  }
+
+  for (unsigned i{0}; i < io_thread_count_; i++) {
+    io_threads_[i].request_stop();
+  }
+
+  for (unsigned i{0}; i < io_thread_count_; i++) {
+    io_threads_[i].join();
+  }
 }
 
 
-auto JobSystem::CreateJob(JobFuncType const func) -> ObserverPtr<Job> {
-  // This method of modulus only works when max_job_count_ is power of two
-  ObserverPtr const job{&jobs_[allocated_job_count_++ & max_job_count_ - 1]};
+namespace {
+struct ThreadJobAllocators {
+  JobPool job_pool;
+  JobDataArena job_data_arena;
+};
+
+
+// Jobs and payloads can be freed by other threads after the allocating thread exited, so the allocators are never
+// destroyed. An exiting thread hands its allocators over to the next thread that starts creating jobs.
+class ThreadJobAllocatorsHolder {
+public:
+  ThreadJobAllocatorsHolder() :
+    allocators_{Adopt()} {}
+
+  ThreadJobAllocatorsHolder(ThreadJobAllocatorsHolder const&) = delete;
+  ThreadJobAllocatorsHolder(ThreadJobAllocatorsHolder&&) = delete;
+
+
+  ~ThreadJobAllocatorsHolder() {
+    GetOrphans().Lock()->emplace_back(allocators_);
+  }
+
+
+  auto operator=(ThreadJobAllocatorsHolder const&) -> void = delete;
+  auto operator=(ThreadJobAllocatorsHolder&&) -> void = delete;
+
+
+  [[nodiscard]] auto Get() const noexcept -> ThreadJobAllocators& {
+    return *allocators_;
+  }
+
+private:
+  [[nodiscard]] static auto GetOrphans() -> Mutex<std::vector<ThreadJobAllocators*>>& {
+    // Leaked so that threads exiting during static destruction can still hand their allocators over
+    static auto* const orphans{new Mutex<std::vector<ThreadJobAllocators*>>{}};
+    return *orphans;
+  }
 
-  if (!job->is_complete) {
-    throw std::runtime_error{"Failed to allocate job: too many concurrent jobs!"};
+
+  [[nodiscard]] static auto Adopt() -> ThreadJobAllocators* {
+    if (auto orphans{GetOrphans().Lock()}; !orphans->empty()) {
+      auto const allocators{orphans->back()};
+      orphans->pop_back();
+      return allocators;
+    }
+
+    return new ThreadJobAllocators{};
   }
 
+
+  ThreadJobAllocators* allocators_;
+};
+
+
+thread_local ThreadJobAllocatorsHolder thread_job_allocators;
+}
+
+
+auto JobSystem::CreateJob(JobFuncType const func) -> ObserverPtr<Job> {
+  auto& job_pool{thread_job_allocators.Get().job_pool};
+  ObserverPtr const job{job_pool.Allocate()};
   job->func = func;
-  job->is_complete = false;
+  job->pool = &job_pool;
+  job->parent = nullptr;
+  job->continuation_count = 0;
+  job->priority = JobPriority::kNormal;
+  job->unfinished_job_count.store(1, std::memory_order_relaxed);
+  job->pending_dependency_count.store(1, std::memory_order_relaxed);
   return job;
 }
 
 
-auto JobSystem::Run(ObserverPtr<Job> job) -> void {
-  auto& queue{job_queues_[this_thread_idx_]};
-  queue.push(job);
-  wake_threads_cond_var_.notify_all();
+auto JobSystem::AddContinuation(ObserverPtr<Job> const ancestor, ObserverPtr<Job> const continuation) -> void {
+  if (ancestor->continuation_count == kMaxJobContinuationCount) {
+    throw std::runtime_error{"Failed to add job continuation: too many continuations!"};
+  }
+
+  ancestor->continuations[ancestor->continuation_count++] = continuation.Get();
+  continuation->pending_dependency_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+auto JobSystem::Run(ObserverPtr<Job> const job) -> JobWaitHandle {
+  // Taken before the job can run, afterwards it might already be complete and reused
+  auto const handle{GetWaitHandle(job)};
+
+  if (job->pending_dependency_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    Submit(*job);
+  }
+
+  return handle;
+}
+
+
+auto JobSystem::GetWaitHandle(ObserverPtr<Job const> const job) -> JobWaitHandle {
+  return JobWaitHandle{job.Get(), job->generation.load(std::memory_order_relaxed)};
 }
 
 
-auto JobSystem::Wait(ObserverPtr<Job const> const job) -> void {
-  while (!job->is_complete) {
+auto JobSystem::Wait(JobWaitHandle const handle) -> void {
+  while (handle.job->generation.load(std::memory_order_acquire) == handle.generation) {
     if (auto const new_job{FindJobToExecute()}) {
       Execute(*new_job);
     }
@@ -76,21 +205,171 @@ auto JobSystem::Wait(ObserverPtr<Job const> const job) -> void {
 }
 
 
+auto JobSystem::TryExecuteOneJob() -> bool {
+  if (auto const job{FindJobToExecute()}) {
+    Execute(*job);
+    return true;
+  }
+
+  return false;
+}
+
+
+auto JobSystem::GetProfilingCounters() const -> std::vector<JobThreadCounters> {
+  if constexpr (kJobSystemProfilingEnabled) {
+    return profiler_->GetCounters();
+  } else {
+    return {};
+  }
+}
+
+
+auto JobSystem::ExportChromeTrace(std::ostream& stream) const -> bool {
+  if constexpr (kJobSystemProfilingEnabled) {
+    profiler_->ExportChromeTrace(stream);
+    return true;
+  } else {
+    return false;
+  }
+}
+
+
+auto JobSystem::CalculateGrainSize(std::size_t const elem_count) const noexcept -> std::size_t {
+  constexpr auto chunk_count_per_thread{8};
+  return std::max<std::size_t>(elem_count / (thread_count_ * chunk_count_per_thread), 1);
+}
+
+
+auto JobSystem::CreateParallelForJob(ParallelForContextBase& ctx, std::size_t const begin,
+                                     std::size_t const end) -> ObserverPtr<Job> {
+  ctx.live_range_count.store(1, std::memory_order_relaxed);
+  auto const root{CreateJob(&ExecuteParallelForRange, ParallelForRange{&ctx, begin, end})};
+  ctx.root = root.Get();
+  return root;
+}
+
+
+auto JobSystem::ExecuteParallelForRange(void* const data) -> void {
+  auto range{*static_cast<ParallelForRange*>(data)};
+  auto& ctx{*range.ctx};
+
+  // Keep splitting off the upper half for others to steal until the remaining range fits into a single chunk
+  while (range.end - range.begin > ctx.grain_size) {
+    auto const chunk_count{(range.end - range.begin + ctx.grain_size - 1) / ctx.grain_size};
+    auto const mid{range.begin + chunk_count / 2 * ctx.grain_size};
+
+    ctx.live_range_count.fetch_add(1, std::memory_order_relaxed);
+    ctx.system->Run(CreateChildJob(ObserverPtr{ctx.root}, &ExecuteParallelForRange,
+      ParallelForRange{&ctx, mid, range.end}));
+
+    range.end = mid;
+  }
+
+  if (range.begin != range.end) {
+    ctx.invoke(ctx, range.begin, range.end);
+  }
+
+  if (ctx.live_range_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    ctx.destroy(ctx);
+  }
+}
+
+
+auto JobSystem::Submit(Job& job) -> void {
+  if (job.priority == JobPriority::kBlockingIo) {
+    {
+      std::scoped_lock const lock{io_job_mutex_};
+      io_jobs_.push_back(&job);
+    }
+
+    io_job_cond_var_.notify_one();
+    return;
+  }
+
+  GetJobQueue(this_thread_idx_, job.priority).push(ObserverPtr{&job});
+  WakeOneThread();
+}
+
+
 auto JobSystem::Execute(Job& job) -> void {
+  if constexpr (kJobSystemProfilingEnabled) {
+    profiler_->RecordEvent(this_thread_idx_, JobEventType::kJobBegin, &job);
+  }
+
   job.func(job.data.data());
-  job.is_complete = true;
+  Finish(job);
+
+  if constexpr (kJobSystemProfilingEnabled) {
+    profiler_->RecordEvent(this_thread_idx_, JobEventType::kJobEnd, &job);
+  }
 }
 
 
-auto JobSystem::FindJobToExecute() -> ObserverPtr<Job> {
-  if (auto const job{job_queues_[this_thread_idx_].pop()}) {
-    return *job;
+auto JobSystem::Finish(Job& job) -> void {
+  if (job.unfinished_job_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
   }
 
-  for (unsigned i{0}; i < thread_count_; i++) {
-    if (i != this_thread_idx_) {
-      if (auto const job{job_queues_[i].steal()}) {
-        return *job;
+  // The job's slot may be reused as soon as it completes, so copy out everything we still need
+  auto const parent{job.parent};
+  auto const continuation_count{job.continuation_count};
+  auto const continuations{job.continuations};
+  auto const pool{job.pool};
+
+  job.generation.fetch_add(1, std::memory_order_release);
+
+  for (std::uint8_t i{0}; i < continuation_count; i++) {
+    if (continuations[i]->pending_dependency_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      Submit(*continuations[i]);
+    }
+  }
+
+  if (parent) {
+    Finish(*parent);
+  }
+
+  pool->Free(job);
+}
+
+
+auto JobSystem::AllocateJobData(std::size_t const size, std::size_t const alignment) -> void* {
+  return thread_job_allocators.Get().job_data_arena.Allocate(size, alignment);
+}
+
+
+auto JobSystem::ReleaseJobData(void* const ptr) -> void {
+  JobDataArena::Release(ptr);
+}
+
+
+auto JobSystem::GetJobQueue(unsigned const thread_idx,
+                            JobPriority const priority) const -> WorkStealingQueue<ObserverPtr<Job>>& {
+  return job_queues_[static_cast<std::size_t>(thread_idx) * kComputeJobPriorityCount + static_cast<std::size_t>(
+                       priority)];
+}
+
+
+auto JobSystem::FindJobToExecute() -> ObserverPtr<Job> {
+  for (auto priority_idx{0}; priority_idx < kComputeJobPriorityCount; priority_idx++) {
+    auto const priority{static_cast<JobPriority>(priority_idx)};
+
+    if (auto const job{GetJobQueue(this_thread_idx_, priority).pop()}) {
+      return *job;
+    }
+
+    for (unsigned i{0}; i < thread_count_ + io_thread_count_; i++) {
+      if (i != this_thread_idx_) {
+        if constexpr (kJobSystemProfilingEnabled) {
+          profiler_->RecordStealAttempt(this_thread_idx_);
+        }
+
+        if (auto const job{GetJobQueue(i, priority).steal()}) {
+          if constexpr (kJobSystemProfilingEnabled) {
+            profiler_->RecordEvent(this_thread_idx_, JobEventType::kSteal, job->Get());
+          }
+
+          return *job;
+        }
       }
     }
   }
@@ -99,7 +378,52 @@ auto JobSystem::FindJobToExecute() -> ObserverPtr<Job> {
 }
 
 
-thread_local std::size_t JobSystem::allocated_job_count_{0};
-thread_local std::array<Job, JobSystem::max_job_count_> JobSystem::jobs_{};
+auto JobSystem::WaitForJob(std::stop_token const& stop_token) -> ObserverPtr<Job> {
+  for (auto i{0}; i < spin_count_before_park_; i++) {
+    if (auto const job{FindJobToExecute()}) {
+      return job;
+    }
+
+    _mm_pause();
+  }
+
+  // Read the epoch and announce parking before checking the queues one last time.
+  // A push that happens after the check sees the parked thread and changes the epoch, so the wait below returns.
+  auto const epoch{wake_epoch_.load(std::memory_order_acquire)};
+  parked_thread_count_.fetch_add(1, std::memory_order_relaxed);
+
+  // Pairs with the fence in WakeOneThread: either the pusher sees the increment, or the check below sees the push
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  auto job{FindJobToExecute()};
+
+  if (!job && !stop_token.stop_requested()) {
+    if constexpr (kJobSystemProfilingEnabled) {
+      profiler_->RecordEvent(this_thread_idx_, JobEventType::kPark);
+    }
+
+    wake_epoch_.wait(epoch, std::memory_order_acquire);
+
+    if constexpr (kJobSystemProfilingEnabled) {
+      profiler_->RecordEvent(this_thread_idx_, JobEventType::kUnpark);
+    }
+  }
+
+  parked_thread_count_.fetch_sub(1, std::memory_order_relaxed);
+  return job;
+}
+
+
+auto JobSystem::WakeOneThread() -> void {
+  // Pairs with the fence after the parked thread count increment in WaitForJob
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (parked_thread_count_.load(std::memory_order_relaxed) != 0) {
+    wake_epoch_.fetch_add(1, std::memory_order_release);
+    wake_epoch_.notify_one();
+  }
+}
+
+
 thread_local unsigned JobSystem::this_thread_idx_{0};
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core.hpp"
+#include "job_profiler.hpp"
 #include "observer_ptr.hpp"
 #include "wsq.hpp"
 
@@ -8,38 +9,90 @@
 #include <atomic>
 #include <concepts>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <ostream>
 #include <span>
 #include <thread>
 #include <type_traits>
+#include <vector>
 
 
 namespace sorcery {
 using JobFuncType = void(*)(void* data);
 constexpr auto kMaxJobDataSize{55};
+constexpr auto kMaxJobContinuationCount{4};
 
 
-struct Job {
+class JobPool;
+
+
+enum class JobPriority : std::uint8_t {
+  kFrameCritical = 0,
+  kNormal = 1,
+  kBackground = 2,
+  // Blocking file I/O. These jobs run on dedicated I/O threads and never occupy compute workers.
+  kBlockingIo = 3
+};
+
+
+constexpr auto kComputeJobPriorityCount{3};
+
+
+struct alignas(64) Job {
   JobFuncType func{nullptr};
-  std::array<char, kMaxJobDataSize> data{};
-  std::atomic_bool is_complete{true};
+
+  union {
+    // The parent only completes once all of its children have completed.
+    Job* parent{nullptr};
+    // Link in the owning pool's free list once the job has completed.
+    Job* next_free;
+  };
+
+  JobPool* pool{nullptr};
+  // Jobs that are submitted once this job and all of its children have completed.
+  std::array<Job*, kMaxJobContinuationCount> continuations{};
+  // The job itself plus its unfinished children.
+  std::atomic<std::int32_t> unfinished_job_count{0};
+  // Ancestors that have yet to complete plus one for the pending Run call.
+  std::atomic<std::int32_t> pending_dependency_count{0};
+  // Callables and arguments are constructed in place, so the buffer has to be aligned for them
+  alignas(std::max_align_t) std::array<char, kMaxJobDataSize> data{};
+  std::uint8_t continuation_count{0};
+  JobPriority priority{JobPriority::kNormal};
+  // Incremented every time the job completes. Never reset, so it tells apart the runs of a reused job.
+  std::atomic<std::uint32_t> generation{0};
 };
 
 
-static_assert(sizeof(Job) == 64);
+static_assert(sizeof(Job) == 128);
+
+
+// Refers to a single run of a job. Jobs are reused once they complete, so waiting needs the generation too.
+struct JobWaitHandle {
+  Job const* job{nullptr};
+  std::uint32_t generation{0};
+};
 
 template<typename T>
-concept JobArgument = sizeof(T) <= kMaxJobDataSize && std::is_copy_constructible_v<T> &&
-                      std::is_trivially_destructible_v<T>;
+concept JobArgument = sizeof(T) <= kMaxJobDataSize && alignof(T) <= alignof(std::max_align_t) &&
+                      std::is_copy_constructible_v<T> && std::is_trivially_destructible_v<T>;
 
 template<typename T>
 concept JobCallable = JobArgument<T> && std::invocable<T>;
 
+// Callables that do not fit into Job::data. They are stored in a per-thread arena and destroyed after running.
+template<typename T>
+concept LargeJobCallable = !JobCallable<T> && std::invocable<std::remove_cvref_t<T>&> && std::constructible_from<
+                             std::remove_cvref_t<T>, T> && !std::convertible_to<T, JobFuncType>;
+
 
 class JobSystem {
 public:
-  LEOPPHAPI explicit JobSystem(unsigned max_thread_count = 0);
+  LEOPPHAPI explicit JobSystem(unsigned max_thread_count = 0, unsigned io_thread_count = 2);
 
   JobSystem(JobSystem const&) = delete;
   JobSystem(JobSystem&&) = delete;
@@ -57,33 +110,145 @@ public:
   template<JobCallable Callable>
   [[nodiscard]] static auto CreateJob(Callable&& callable) -> ObserverPtr<Job>;
 
+  template<LargeJobCallable Callable>
+  [[nodiscard]] static auto CreateJob(Callable&& callable) -> ObserverPtr<Job>;
+
   template<JobArgument Callable, JobArgument Data> requires (
     std::invocable<Callable, Data> && !std::convertible_to<Callable, JobFuncType> && sizeof(Callable) + sizeof(Data) <=
     kMaxJobDataSize)
   [[nodiscard]] static auto CreateJob(Callable&& callable, Data&& data) -> ObserverPtr<Job>;
 
-  template<typename T>
-  [[nodiscard]] auto CreateParallelForJob(void (*func)(T& data), std::span<T> data) -> ObserverPtr<Job>;
+  // Creates a job that the parent waits for before completing.
+  // Must be called before the parent completes, e.g. before running it or from within its function.
+  template<typename... Args>
+  [[nodiscard]] static auto CreateChildJob(ObserverPtr<Job> parent, Args&&... args) -> ObserverPtr<Job> requires
+    requires { CreateJob(std::forward<Args>(args)...); };
+
+  // Makes the continuation run only after the ancestor and all of its children have completed.
+  // A continuation can have multiple ancestors, so arbitrary job graphs can be submitted up front.
+  // Must be called before either job is run.
+  LEOPPHAPI static auto AddContinuation(ObserverPtr<Job> ancestor, ObserverPtr<Job> continuation) -> void;
+
+  // Creates a job that calls func(idx) for every idx in [begin, end).
+  // The range is split recursively into chunks of at most grain_size indices that idle workers steal.
+  template<typename Func> requires std::invocable<Func&, std::size_t>
+  [[nodiscard]] auto CreateParallelForJob(std::size_t begin, std::size_t end, Func&& func,
+                                          std::size_t grain_size = kAutoGrainSize) -> ObserverPtr<Job>;
+
+  // Creates a job that calls func(elem) for every element of data.
+  template<typename T, typename Func> requires std::invocable<Func&, T&>
+  [[nodiscard]] auto CreateParallelForJob(std::span<T> data, Func&& func,
+                                          std::size_t grain_size = kAutoGrainSize) -> ObserverPtr<Job>;
 
-  LEOPPHAPI auto Run(ObserverPtr<Job> job) -> void;
+  // Blocking version of CreateParallelForJob. Ranges that fit into a single chunk are processed on the calling thread.
+  template<typename Func> requires std::invocable<Func&, std::size_t>
+  auto ParallelFor(std::size_t begin, std::size_t end, Func&& func, std::size_t grain_size = kAutoGrainSize) -> void;
 
-  LEOPPHAPI auto Wait(ObserverPtr<Job const> job) -> void;
+  template<typename T, typename Func> requires std::invocable<Func&, T&>
+  auto ParallelFor(std::span<T> data, Func&& func, std::size_t grain_size = kAutoGrainSize) -> void;
+
+  // Returns reduce(...reduce(reduce(identity, map(begin)), map(begin + 1))..., map(end - 1)) with the map and reduce
+  // steps distributed over chunks of at most grain_size indices. Reduce must be associative.
+  template<typename T, typename Map, typename Reduce> requires std::invocable<Map&, std::size_t> && std::invocable<
+                                                                Reduce&, T, T>
+  [[nodiscard]] auto ParallelReduce(std::size_t begin, std::size_t end, T identity, Map&& map, Reduce&& reduce,
+                                    std::size_t grain_size = kAutoGrainSize) -> T;
+
+  // Picks a grain size that yields a few chunks per thread.
+  [[nodiscard]] LEOPPHAPI auto CalculateGrainSize(std::size_t elem_count) const noexcept -> std::size_t;
+
+  constexpr static std::size_t kAutoGrainSize{0};
+
+  // Submits the job to the queue matching its priority.
+  // Jobs with incomplete ancestors are held back until the last ancestor completes.
+  // The returned handle stays valid for waiting after the job completed and got reused.
+  LEOPPHAPI auto Run(ObserverPtr<Job> job) -> JobWaitHandle;
+
+  // Must be called before the job can complete, i.e. before it is run.
+  [[nodiscard]] LEOPPHAPI static auto GetWaitHandle(ObserverPtr<Job const> job) -> JobWaitHandle;
+  LEOPPHAPI auto Wait(JobWaitHandle handle) -> void;
+  // Executes a single queued job on the calling thread if there is one. Lets callers help out while polling.
+  LEOPPHAPI auto TryExecuteOneJob() -> bool;
+
+  // One entry per compute and I/O thread, empty if profiling is compiled out.
+  [[nodiscard]] LEOPPHAPI auto GetProfilingCounters() const -> std::vector<JobThreadCounters>;
+  // Returns false if profiling is compiled out.
+  LEOPPHAPI auto ExportChromeTrace(std::ostream& stream) const -> bool;
 
 private:
-  static auto Execute(Job& job) -> void;
+  struct ParallelForContextBase {
+    JobSystem* system;
+    Job* root;
+    std::size_t grain_size;
+    // Range jobs that have yet to finish, the last one destroys the context
+    std::atomic<std::size_t> live_range_count{0};
+    auto (*invoke)(ParallelForContextBase& ctx, std::size_t begin, std::size_t end) -> void;
+    auto (*destroy)(ParallelForContextBase& ctx) -> void;
+  };
+
+
+  template<typename Func>
+  struct ParallelForContext : ParallelForContextBase {
+    template<typename F>
+    explicit ParallelForContext(F&& f) :
+      func{std::forward<F>(f)} {}
+
+
+    Func func;
+  };
 
+
+  struct ParallelForRange {
+    ParallelForContextBase* ctx;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+
+  // Gives every partial result of a reduction its own cache line, vector<bool> would pack them into shared words
+  template<typename T>
+  struct alignas(64) ParallelReducePartial {
+    T value;
+  };
+
+
+  [[nodiscard]] LEOPPHAPI auto CreateParallelForJob(ParallelForContextBase& ctx, std::size_t begin,
+                                                    std::size_t end) -> ObserverPtr<Job>;
+  static auto ExecuteParallelForRange(void* data) -> void;
+
+  auto Submit(Job& job) -> void;
+  auto Execute(Job& job) -> void;
+  auto Finish(Job& job) -> void;
+
+  [[nodiscard]] auto GetJobQueue(unsigned thread_idx, JobPriority priority) const -> WorkStealingQueue<ObserverPtr<Job>>&;
+  // Looks for a compute job in priority order, own queues first
   [[nodiscard]] auto FindJobToExecute() -> ObserverPtr<Job>;
+  // Spins, then parks the calling worker until a job is pushed or the system is stopped.
+  [[nodiscard]] auto WaitForJob(std::stop_token const& stop_token) -> ObserverPtr<Job>;
+  auto WakeOneThread() -> void;
 
   unsigned thread_count_;
   unsigned worker_count_;
+  unsigned io_thread_count_;
+  // One queue per compute priority for each compute and I/O thread. I/O threads only push continuations to theirs.
   std::unique_ptr<WorkStealingQueue<ObserverPtr<Job>>[]> job_queues_;
+  // Only created if profiling is compiled in. Declared before the threads so it outlives them.
+  std::unique_ptr<JobProfiler> profiler_;
   std::unique_ptr<std::jthread[]> workers_;
-  std::mutex wake_threads_mutex_;
-  std::condition_variable wake_threads_cond_var_;
+  // Any thread can push I/O jobs, so they go through a locked queue that only the I/O threads take from
+  std::mutex io_job_mutex_;
+  std::condition_variable_any io_job_cond_var_;
+  std::deque<Job*> io_jobs_;
+  std::unique_ptr<std::jthread[]> io_threads_;
+  // Eventcount: parked workers wait for the epoch to change, pushers bump it only if someone is parked
+  alignas(64) std::atomic<std::uint32_t> wake_epoch_{0};
+  alignas(64) std::atomic<std::uint32_t> parked_thread_count_{0};
+
+  constexpr static auto spin_count_before_park_{256};
+
+  [[nodiscard]] LEOPPHAPI static auto AllocateJobData(std::size_t size, std::size_t alignment) -> void*;
+  LEOPPHAPI static auto ReleaseJobData(void* ptr) -> void;
 
-  constexpr static auto max_job_count_{4096};
-  thread_local static std::size_t allocated_job_count_;
-  thread_local static std::array<Job, max_job_count_> jobs_;
   thread_local static unsigned this_thread_idx_;
 };
 }
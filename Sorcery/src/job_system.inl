@@ -2,7 +2,9 @@
 
 #include "observer_ptr.hpp"
 
+#include <algorithm>
 #include <bit>
+#include <cstddef>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -25,6 +27,23 @@ auto JobSystem::CreateJob(Callable&& callable) -> ObserverPtr<Job> {
 }
 
 
+template<LargeJobCallable Callable>
+auto JobSystem::CreateJob(Callable&& callable) -> ObserverPtr<Job> {
+  using CallableType = std::remove_cvref_t<Callable>;
+
+  auto const callable_ptr{
+    std::construct_at(static_cast<CallableType*>(AllocateJobData(sizeof(CallableType), alignof(CallableType))),
+      std::forward<Callable>(callable))
+  };
+
+  return CreateJob([](CallableType* const job_callable) {
+    (*job_callable)();
+    std::destroy_at(job_callable);
+    ReleaseJobData(job_callable);
+  }, callable_ptr);
+}
+
+
 template<JobArgument Callable, JobArgument Data> requires (
   std::invocable<Callable, Data> && !std::convertible_to<Callable, JobFuncType> && sizeof(Callable) + sizeof(Data) <=
   kMaxJobDataSize)
@@ -35,42 +54,107 @@ auto JobSystem::CreateJob(Callable&& callable, Data&& data) -> ObserverPtr<Job>
 }
 
 
-template<typename T>
-auto JobSystem::CreateParallelForJob(void (*func)(T& data), std::span<T> data) -> ObserverPtr<Job> {
-  struct JobData {
-    void (*func)(T& data);
-    JobSystem* system;
-    std::span<T> data;
-    unsigned thread_count;
+template<typename... Args>
+auto JobSystem::CreateChildJob(ObserverPtr<Job> const parent, Args&&... args) -> ObserverPtr<Job> requires requires {
+  CreateJob(std::forward<Args>(args)...);
+} {
+  auto const job{CreateJob(std::forward<Args>(args)...)};
+  job->parent = parent.Get();
+  parent->unfinished_job_count.fetch_add(1, std::memory_order_relaxed);
+  return job;
+}
+
+
+template<typename Func> requires std::invocable<Func&, std::size_t>
+auto JobSystem::CreateParallelForJob(std::size_t const begin, std::size_t const end, Func&& func,
+                                     std::size_t const grain_size) -> ObserverPtr<Job> {
+  using ContextType = ParallelForContext<std::remove_cvref_t<Func>>;
+
+  auto& ctx{
+    *std::construct_at(static_cast<ContextType*>(AllocateJobData(sizeof(ContextType), alignof(ContextType))),
+      std::forward<Func>(func))
   };
 
-  return CreateJob([](void const* const data_ptr) {
-    auto const& job_data{*std::bit_cast<JobData*>(data_ptr)};
-    auto const elem_count_per_job{job_data.data.size() / job_data.thread_count};
+  ctx.system = this;
+  ctx.grain_size = grain_size == kAutoGrainSize ? CalculateGrainSize(end - begin) : grain_size;
+  ctx.invoke = [](ParallelForContextBase& base_ctx, std::size_t const range_begin, std::size_t const range_end) {
+    auto& typed_ctx{static_cast<ContextType&>(base_ctx)};
+
+    for (auto i{range_begin}; i < range_end; i++) {
+      typed_ctx.func(i);
+    }
+  };
+  ctx.destroy = [](ParallelForContextBase& base_ctx) {
+    auto const typed_ctx{&static_cast<ContextType&>(base_ctx)};
+    std::destroy_at(typed_ctx);
+    ReleaseJobData(typed_ctx);
+  };
 
-    std::vector<ObserverPtr<Job>> sub_jobs;
-    sub_jobs.reserve(elem_count_per_job);
+  return CreateParallelForJob(ctx, begin, end);
+}
 
-    struct SubJobData {
-      void (*func)(T& data);
-      std::span<T> data;
-    };
 
-    for (unsigned i{0}; i < job_data.thread_count; i++) {
-      sub_jobs.emplace_back(job_data.system->CreateJob([](void* const sub_data_ptr) {
-        auto const& sub_job_data{*std::bit_cast<SubJobData*>(sub_data_ptr)};
+template<typename T, typename Func> requires std::invocable<Func&, T&>
+auto JobSystem::CreateParallelForJob(std::span<T> const data, Func&& func,
+                                     std::size_t const grain_size) -> ObserverPtr<Job> {
+  return CreateParallelForJob(0, data.size(), [data, func = std::forward<Func>(func)](std::size_t const idx) mutable {
+    func(data[idx]);
+  }, grain_size);
+}
 
-        for (auto& elem : sub_job_data.data) {
-          sub_job_data.func(elem);
-        }
-      }, SubJobData{job_data.func, job_data.data.subspan(i * elem_count_per_job, elem_count_per_job)}));
 
-      job_data.system->Run(sub_jobs.back());
+template<typename Func> requires std::invocable<Func&, std::size_t>
+auto JobSystem::ParallelFor(std::size_t const begin, std::size_t const end, Func&& func,
+                            std::size_t const grain_size) -> void {
+  if (end - begin <= (grain_size == kAutoGrainSize ? CalculateGrainSize(end - begin) : grain_size)) {
+    for (auto i{begin}; i < end; i++) {
+      func(i);
     }
+    return;
+  }
+
+  // The job does not outlive this call, so referencing the callable is enough
+  auto const job{
+    CreateParallelForJob(begin, end, [&func](std::size_t const idx) {
+      func(idx);
+    }, grain_size)
+  };
 
-    for (auto const sub_job : sub_jobs) {
-      job_data.system->Wait(sub_job);
+  Wait(Run(job));
+}
+
+
+template<typename T, typename Func> requires std::invocable<Func&, T&>
+auto JobSystem::ParallelFor(std::span<T> const data, Func&& func, std::size_t const grain_size) -> void {
+  ParallelFor(0, data.size(), [data, &func](std::size_t const idx) {
+    func(data[idx]);
+  }, grain_size);
+}
+
+
+template<typename T, typename Map, typename Reduce> requires std::invocable<Map&, std::size_t> && std::invocable<
+                                                              Reduce&, T, T>
+auto JobSystem::ParallelReduce(std::size_t const begin, std::size_t const end, T identity, Map&& map, Reduce&& reduce,
+                               std::size_t const grain_size) -> T {
+  auto const chunk_size{grain_size == kAutoGrainSize ? CalculateGrainSize(end - begin) : grain_size};
+  auto const chunk_count{(end - begin + chunk_size - 1) / chunk_size};
+
+  std::vector<ParallelReducePartial<T>> partials(chunk_count, ParallelReducePartial<T>{identity});
+
+  ParallelFor(0, chunk_count, [&](std::size_t const chunk_idx) {
+    auto const chunk_begin{begin + chunk_idx * chunk_size};
+    auto const chunk_end{std::min(chunk_begin + chunk_size, end)};
+    auto& partial{partials[chunk_idx].value};
+
+    for (auto i{chunk_begin}; i < chunk_end; i++) {
+      partial = reduce(std::move(partial), map(i));
     }
-  }, JobData{func, this, data, worker_count_ + 1});
+  }, 1);
+
+  for (auto& partial : partials) {
+    identity = reduce(std::move(identity), std::move(partial.value));
+  }
+
+  return identity;
 }
 }
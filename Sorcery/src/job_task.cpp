@@ -0,0 +1,83 @@
+#include "job_task.hpp"
+
+#include "io_helpers.hpp"
+
+
+namespace sorcery {
+ScheduleAwaiter::ScheduleAwaiter(JobSystem& job_system, JobPriority const priority) noexcept :
+  job_system_{&job_system},
+  priority_{priority} {}
+
+
+auto ScheduleAwaiter::await_ready() noexcept -> bool {
+  return false;
+}
+
+
+auto ScheduleAwaiter::await_suspend(std::coroutine_handle<> const handle) const -> void {
+  auto const job{
+    job_system_->CreateJob([handle] {
+      handle.resume();
+    })
+  };
+
+  job->priority = priority_;
+  job_system_->Run(job);
+}
+
+
+auto ScheduleAwaiter::await_resume() noexcept -> void {}
+
+
+JobAwaiter::JobAwaiter(JobSystem& job_system, ObserverPtr<Job> const job) noexcept :
+  job_system_{&job_system},
+  job_{job} {}
+
+
+auto JobAwaiter::await_ready() noexcept -> bool {
+  return false;
+}
+
+
+auto JobAwaiter::await_suspend(std::coroutine_handle<> const handle) const -> void {
+  auto const resume_job{
+    job_system_->CreateJob([handle] {
+      handle.resume();
+    })
+  };
+
+  // The awaiter may be destroyed as soon as the job is run, so copy what we need
+  auto const job_system{job_system_};
+  auto const job{job_};
+
+  JobSystem::AddContinuation(job, resume_job);
+  job_system->Run(resume_job);
+  job_system->Run(job);
+}
+
+
+auto JobAwaiter::await_resume() noexcept -> void {}
+
+
+auto ScheduleOn(JobSystem& job_system, JobPriority const priority) -> ScheduleAwaiter {
+  return ScheduleAwaiter{job_system, priority};
+}
+
+
+auto RunAndAwait(JobSystem& job_system, ObserverPtr<Job> const job) -> JobAwaiter {
+  return JobAwaiter{job_system, job};
+}
+
+
+auto ReadFileAsync(JobSystem& job_system, std::filesystem::path path) -> Task<std::optional<std::vector<std::byte>>> {
+  std::vector<std::byte> bytes;
+
+  if (co_await RunBlockingIo(job_system, [&path, &bytes] {
+    return ReadBinaryFile(path, bytes);
+  })) {
+    co_return std::optional{std::move(bytes)};
+  }
+
+  co_return std::nullopt;
+}
+}
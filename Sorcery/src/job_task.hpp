@@ -0,0 +1,223 @@
+#pragma once
+
+#include "Core.hpp"
+#include "job_system.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace sorcery {
+template<typename T = void>
+class Task;
+
+
+namespace detail {
+class TaskPromiseBase {
+public:
+  struct FinalAwaiter {
+    [[nodiscard]] static auto await_ready() noexcept -> bool;
+    template<typename Promise>
+    [[nodiscard]] static auto await_suspend(std::coroutine_handle<Promise> handle) noexcept -> std::coroutine_handle<>;
+    static auto await_resume() noexcept -> void;
+  };
+
+
+  [[nodiscard]] static auto initial_suspend() noexcept -> std::suspend_always;
+  [[nodiscard]] static auto final_suspend() noexcept -> FinalAwaiter;
+  auto unhandled_exception() noexcept -> void;
+
+  auto SetContinuation(std::coroutine_handle<> continuation) noexcept -> void;
+
+protected:
+  auto RethrowIfFailed() const -> void;
+
+private:
+  std::coroutine_handle<> continuation_;
+  std::exception_ptr exception_;
+};
+
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+  [[nodiscard]] auto get_return_object() noexcept -> Task<T>;
+
+  template<typename U> requires std::convertible_to<U&&, T>
+  auto return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>) -> void;
+
+  [[nodiscard]] auto GetResult() -> T;
+
+private:
+  std::optional<T> value_;
+};
+
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+  [[nodiscard]] auto get_return_object() noexcept -> Task<>;
+
+  static auto return_void() noexcept -> void;
+
+  auto GetResult() const -> void;
+};
+
+
+// Fire-and-forget coroutine that destroys itself when it finishes.
+class DetachedTask {
+public:
+  struct promise_type {
+    [[nodiscard]] auto get_return_object() noexcept -> DetachedTask;
+    [[nodiscard]] static auto initial_suspend() noexcept -> std::suspend_always;
+    [[nodiscard]] static auto final_suspend() noexcept -> std::suspend_never;
+    static auto return_void() noexcept -> void;
+    [[noreturn]] static auto unhandled_exception() noexcept -> void;
+  };
+
+
+  auto Start(JobSystem& job_system, JobPriority priority) && -> void;
+  // Runs the coroutine on the calling thread until its first suspension point
+  auto Start() && -> void;
+
+private:
+  explicit DetachedTask(std::coroutine_handle<promise_type> handle) noexcept;
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+
+// Destroys the suspended coroutine, then transfers control to the next one.
+struct DestroyAndContinueAwaiter {
+  std::coroutine_handle<> next;
+
+  [[nodiscard]] static auto await_ready() noexcept -> bool;
+  [[nodiscard]] auto await_suspend(std::coroutine_handle<> handle) const noexcept -> std::coroutine_handle<>;
+  static auto await_resume() noexcept -> void;
+};
+}
+
+
+// Lazily started coroutine. Awaiting it starts it on the awaiting thread, use ScheduleOn to move it to a worker.
+template<typename T>
+class [[nodiscard]] Task {
+public:
+  using promise_type = detail::TaskPromise<T>;
+
+  Task() = default;
+  Task(Task const&) = delete;
+  Task(Task&& other) noexcept;
+
+  ~Task();
+
+  auto operator=(Task const&) -> void = delete;
+  auto operator=(Task&& other) noexcept -> Task&;
+
+  [[nodiscard]] auto IsReady() const noexcept -> bool;
+
+  // Awaiting the task yields its result or rethrows its exception.
+  auto operator co_await() && noexcept;
+  // Awaits completion without retrieving the result.
+  [[nodiscard]] auto WhenReady() noexcept;
+
+  // Only valid once the task has completed.
+  [[nodiscard]] auto GetResult() -> T;
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) noexcept;
+
+  std::coroutine_handle<promise_type> handle_;
+
+  friend promise_type;
+};
+
+
+// Resumes the awaiting coroutine on a JobSystem worker.
+class ScheduleAwaiter {
+public:
+  LEOPPHAPI ScheduleAwaiter(JobSystem& job_system, JobPriority priority) noexcept;
+
+  [[nodiscard]] LEOPPHAPI static auto await_ready() noexcept -> bool;
+  LEOPPHAPI auto await_suspend(std::coroutine_handle<> handle) const -> void;
+  LEOPPHAPI static auto await_resume() noexcept -> void;
+
+private:
+  JobSystem* job_system_;
+  JobPriority priority_;
+};
+
+
+// Runs a job that has not been run yet and resumes the awaiting coroutine on a worker once it has completed.
+class JobAwaiter {
+public:
+  LEOPPHAPI JobAwaiter(JobSystem& job_system, ObserverPtr<Job> job) noexcept;
+
+  [[nodiscard]] LEOPPHAPI static auto await_ready() noexcept -> bool;
+  LEOPPHAPI auto await_suspend(std::coroutine_handle<> handle) const -> void;
+  LEOPPHAPI static auto await_resume() noexcept -> void;
+
+private:
+  JobSystem* job_system_;
+  ObserverPtr<Job> job_;
+};
+
+
+// Runs func on the I/O lane and resumes the awaiting coroutine on a compute worker with its result.
+template<std::invocable Func>
+class BlockingIoAwaiter {
+public:
+  BlockingIoAwaiter(JobSystem& job_system, Func func, JobPriority resume_priority);
+
+  [[nodiscard]] static auto await_ready() noexcept -> bool;
+  auto await_suspend(std::coroutine_handle<> handle) -> void;
+  auto await_resume() -> std::invoke_result_t<Func&>;
+
+private:
+  using FuncResultType = std::invoke_result_t<Func&>;
+  using ResultType = std::conditional_t<std::is_void_v<FuncResultType>, bool, FuncResultType>;
+
+  JobSystem* job_system_;
+  Func func_;
+  JobPriority resume_priority_;
+  std::optional<ResultType> result_;
+  std::exception_ptr exception_;
+};
+
+
+[[nodiscard]] LEOPPHAPI auto ScheduleOn(JobSystem& job_system,
+                                        JobPriority priority = JobPriority::kNormal) -> ScheduleAwaiter;
+
+[[nodiscard]] LEOPPHAPI auto RunAndAwait(JobSystem& job_system, ObserverPtr<Job> job) -> JobAwaiter;
+
+template<std::invocable Func>
+[[nodiscard]] auto RunBlockingIo(JobSystem& job_system, Func func,
+                                 JobPriority resume_priority = JobPriority::kNormal) -> BlockingIoAwaiter<Func>;
+
+[[nodiscard]] LEOPPHAPI auto ReadFileAsync(JobSystem& job_system,
+                                           std::filesystem::path path) -> Task<std::optional<std::vector<std::byte>>>;
+
+// Runs all tasks concurrently on the job system and completes once all of them have completed.
+template<typename T>
+[[nodiscard]] auto WhenAll(JobSystem& job_system, std::vector<Task<T>> tasks) -> Task<std::conditional_t<
+  std::is_void_v<T>, void, std::vector<T>>>;
+
+// Runs all tasks concurrently on the job system and completes as soon as one of them has completed.
+// Yields the index of the first task and its result. The rest keep running in the background.
+template<typename T>
+[[nodiscard]] auto WhenAny(JobSystem& job_system, std::vector<Task<T>> tasks) -> Task<std::conditional_t<
+  std::is_void_v<T>, std::size_t, std::pair<std::size_t, T>>>;
+
+// Blocks until the task completes while helping with the job system's work.
+template<typename T>
+auto SyncWait(JobSystem& job_system, Task<T> task) -> T;
+}
+
+
+#include "job_task.inl"
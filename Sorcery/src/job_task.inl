@@ -0,0 +1,557 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+
+
+namespace sorcery {
+namespace detail {
+inline auto TaskPromiseBase::FinalAwaiter::await_ready() noexcept -> bool {
+  return false;
+}
+
+
+template<typename Promise>
+auto TaskPromiseBase::FinalAwaiter::await_suspend(
+  std::coroutine_handle<Promise> const handle) noexcept -> std::coroutine_handle<> {
+  if (auto const continuation{handle.promise().continuation_}) {
+    return continuation;
+  }
+
+  return std::noop_coroutine();
+}
+
+
+inline auto TaskPromiseBase::FinalAwaiter::await_resume() noexcept -> void {}
+
+
+inline auto TaskPromiseBase::initial_suspend() noexcept -> std::suspend_always {
+  return {};
+}
+
+
+inline auto TaskPromiseBase::final_suspend() noexcept -> FinalAwaiter {
+  return {};
+}
+
+
+inline auto TaskPromiseBase::unhandled_exception() noexcept -> void {
+  exception_ = std::current_exception();
+}
+
+
+inline auto TaskPromiseBase::SetContinuation(std::coroutine_handle<> const continuation) noexcept -> void {
+  continuation_ = continuation;
+}
+
+
+inline auto TaskPromiseBase::RethrowIfFailed() const -> void {
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
+}
+
+
+template<typename T>
+auto TaskPromise<T>::get_return_object() noexcept -> Task<T> {
+  return Task<T>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+
+
+template<typename T>
+template<typename U> requires std::convertible_to<U&&, T>
+auto TaskPromise<T>::return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>) -> void {
+  value_.emplace(std::forward<U>(value));
+}
+
+
+template<typename T>
+auto TaskPromise<T>::GetResult() -> T {
+  RethrowIfFailed();
+  return std::move(*value_);
+}
+
+
+inline auto TaskPromise<void>::get_return_object() noexcept -> Task<> {
+  return Task<>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+
+
+inline auto TaskPromise<void>::return_void() noexcept -> void {}
+
+
+inline auto TaskPromise<void>::GetResult() const -> void {
+  RethrowIfFailed();
+}
+
+
+inline auto DetachedTask::promise_type::get_return_object() noexcept -> DetachedTask {
+  return DetachedTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+}
+
+
+inline auto DetachedTask::promise_type::initial_suspend() noexcept -> std::suspend_always {
+  return {};
+}
+
+
+inline auto DetachedTask::promise_type::final_suspend() noexcept -> std::suspend_never {
+  return {};
+}
+
+
+inline auto DetachedTask::promise_type::return_void() noexcept -> void {}
+
+
+inline auto DetachedTask::promise_type::unhandled_exception() noexcept -> void {
+  std::terminate();
+}
+
+
+inline auto DetachedTask::Start(JobSystem& job_system, JobPriority const priority) && -> void {
+  auto const job{
+    job_system.CreateJob([handle = std::coroutine_handle<>{handle_}] {
+      handle.resume();
+    })
+  };
+
+  job->priority = priority;
+  job_system.Run(job);
+}
+
+
+inline auto DetachedTask::Start() && -> void {
+  handle_.resume();
+}
+
+
+inline DetachedTask::DetachedTask(std::coroutine_handle<promise_type> const handle) noexcept :
+  handle_{handle} {}
+
+
+inline auto DestroyAndContinueAwaiter::await_ready() noexcept -> bool {
+  return false;
+}
+
+
+inline auto DestroyAndContinueAwaiter::await_suspend(
+  std::coroutine_handle<> const handle) const noexcept -> std::coroutine_handle<> {
+  auto const next_handle{next};
+  handle.destroy();
+  return next_handle;
+}
+
+
+inline auto DestroyAndContinueAwaiter::await_resume() noexcept -> void {}
+
+
+// Counts down the tasks of a WhenAll. The awaiting coroutine holds one extra count while it is starting the tasks.
+struct WhenAllLatch {
+  std::atomic<std::size_t> remaining;
+  std::coroutine_handle<> awaiting;
+
+
+  [[nodiscard]] auto Arrive() noexcept -> std::coroutine_handle<> {
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      return awaiting;
+    }
+
+    return std::noop_coroutine();
+  }
+};
+
+
+template<typename T>
+auto RunWhenAllTask(Task<T>& task, WhenAllLatch& latch) -> DetachedTask {
+  co_await task.WhenReady();
+  co_await DestroyAndContinueAwaiter{latch.Arrive()};
+}
+
+
+template<typename T>
+class WhenAllAwaiter {
+public:
+  WhenAllAwaiter(JobSystem& job_system, std::vector<Task<T>>& tasks) :
+    job_system_{&job_system},
+    tasks_{&tasks} {}
+
+
+  [[nodiscard]] auto await_ready() const noexcept -> bool {
+    return tasks_->empty();
+  }
+
+
+  auto await_suspend(std::coroutine_handle<> const handle) -> bool {
+    latch_.remaining.store(tasks_->size() + 1, std::memory_order_relaxed);
+    latch_.awaiting = handle;
+
+    for (auto& task : *tasks_) {
+      RunWhenAllTask(task, latch_).Start(*job_system_, JobPriority::kNormal);
+    }
+
+    // If every task has already completed, continue without suspending
+    return latch_.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+  }
+
+
+  static auto await_resume() noexcept -> void {}
+
+private:
+  JobSystem* job_system_;
+  std::vector<Task<T>>* tasks_;
+  WhenAllLatch latch_;
+};
+
+
+template<typename T>
+struct WhenAnyState {
+  std::vector<Task<T>> tasks;
+  std::atomic_bool has_winner{false};
+  std::size_t winner_idx{0};
+  std::coroutine_handle<> awaiting;
+};
+
+
+template<typename T>
+auto RunWhenAnyTask(std::shared_ptr<WhenAnyState<T>> state, std::size_t const idx) -> DetachedTask {
+  co_await state->tasks[idx].WhenReady();
+
+  std::coroutine_handle<> next{std::noop_coroutine()};
+
+  if (!state->has_winner.exchange(true, std::memory_order_acq_rel)) {
+    state->winner_idx = idx;
+    next = state->awaiting;
+  }
+
+  // Destroying the frame releases our reference to the state
+  co_await DestroyAndContinueAwaiter{next};
+}
+
+
+template<typename T>
+class WhenAnyAwaiter {
+public:
+  WhenAnyAwaiter(JobSystem& job_system, std::shared_ptr<WhenAnyState<T>> state) :
+    job_system_{&job_system},
+    state_{std::move(state)} {}
+
+
+  [[nodiscard]] static auto await_ready() noexcept -> bool {
+    return false;
+  }
+
+
+  auto await_suspend(std::coroutine_handle<> const handle) -> void {
+    state_->awaiting = handle;
+
+    // The awaiting coroutine may be resumed before the loop finishes, so it must not touch the awaiter afterwards
+    auto const job_system{job_system_};
+    auto const state{state_};
+
+    for (std::size_t i{0}; i < state->tasks.size(); i++) {
+      RunWhenAnyTask(state, i).Start(*job_system, JobPriority::kNormal);
+    }
+  }
+
+
+  static auto await_resume() noexcept -> void {}
+
+private:
+  JobSystem* job_system_;
+  std::shared_ptr<WhenAnyState<T>> state_;
+};
+
+
+// Signals a job from its final suspend point, so the waiting thread can safely destroy the frame afterwards
+class SyncWaitTask {
+public:
+  struct promise_type {
+    JobSystem* job_system{nullptr};
+    Job* done_job{nullptr};
+
+
+    struct FinalAwaiter {
+      [[nodiscard]] static auto await_ready() noexcept -> bool {
+        return false;
+      }
+
+
+      static auto await_suspend(std::coroutine_handle<promise_type> const handle) noexcept -> void {
+        handle.promise().job_system->Run(ObserverPtr{handle.promise().done_job});
+      }
+
+
+      static auto await_resume() noexcept -> void {}
+    };
+
+
+    [[nodiscard]] auto get_return_object() noexcept -> SyncWaitTask {
+      return SyncWaitTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+
+    [[nodiscard]] static auto initial_suspend() noexcept -> std::suspend_always {
+      return {};
+    }
+
+
+    [[nodiscard]] static auto final_suspend() noexcept -> FinalAwaiter {
+      return {};
+    }
+
+
+    static auto return_void() noexcept -> void {}
+
+
+    [[noreturn]] static auto unhandled_exception() noexcept -> void {
+      std::terminate();
+    }
+  };
+
+
+  SyncWaitTask(SyncWaitTask const&) = delete;
+  SyncWaitTask(SyncWaitTask&&) = delete;
+
+
+  ~SyncWaitTask() {
+    handle_.destroy();
+  }
+
+
+  auto operator=(SyncWaitTask const&) -> void = delete;
+  auto operator=(SyncWaitTask&&) -> void = delete;
+
+
+  auto Run(JobSystem& job_system) -> void {
+    auto const done_job{job_system.CreateJob([](void*) {})};
+    handle_.promise().job_system = &job_system;
+    handle_.promise().done_job = done_job.Get();
+    // The coroutine runs the job once it finishes, so the handle has to be taken before resuming it
+    auto const done_handle{JobSystem::GetWaitHandle(done_job)};
+    handle_.resume();
+    job_system.Wait(done_handle);
+  }
+
+private:
+  explicit SyncWaitTask(std::coroutine_handle<promise_type> const handle) noexcept :
+    handle_{handle} {}
+
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+
+template<typename T>
+auto MakeSyncWaitTask(Task<T>& task) -> SyncWaitTask {
+  co_await task.WhenReady();
+}
+}
+
+
+template<typename T>
+Task<T>::Task(Task&& other) noexcept :
+  handle_{std::exchange(other.handle_, nullptr)} {}
+
+
+template<typename T>
+Task<T>::~Task() {
+  if (handle_) {
+    handle_.destroy();
+  }
+}
+
+
+template<typename T>
+auto Task<T>::operator=(Task&& other) noexcept -> Task& {
+  if (this != &other) {
+    if (handle_) {
+      handle_.destroy();
+    }
+
+    handle_ = std::exchange(other.handle_, nullptr);
+  }
+
+  return *this;
+}
+
+
+template<typename T>
+auto Task<T>::IsReady() const noexcept -> bool {
+  return !handle_ || handle_.done();
+}
+
+
+template<typename T>
+auto Task<T>::operator co_await() && noexcept {
+  struct Awaiter {
+    std::coroutine_handle<promise_type> handle;
+
+
+    [[nodiscard]] auto await_ready() const noexcept -> bool {
+      return handle.done();
+    }
+
+
+    [[nodiscard]] auto await_suspend(std::coroutine_handle<> const awaiting) const noexcept -> std::coroutine_handle<> {
+      handle.promise().SetContinuation(awaiting);
+      return handle;
+    }
+
+
+    auto await_resume() const -> T {
+      return handle.promise().GetResult();
+    }
+  };
+
+  return Awaiter{handle_};
+}
+
+
+template<typename T>
+auto Task<T>::WhenReady() noexcept {
+  struct Awaiter {
+    std::coroutine_handle<promise_type> handle;
+
+
+    [[nodiscard]] auto await_ready() const noexcept -> bool {
+      return handle.done();
+    }
+
+
+    [[nodiscard]] auto await_suspend(std::coroutine_handle<> const awaiting) const noexcept -> std::coroutine_handle<> {
+      handle.promise().SetContinuation(awaiting);
+      return handle;
+    }
+
+
+    static auto await_resume() noexcept -> void {}
+  };
+
+  return Awaiter{handle_};
+}
+
+
+template<typename T>
+auto Task<T>::GetResult() -> T {
+  return handle_.promise().GetResult();
+}
+
+
+template<typename T>
+Task<T>::Task(std::coroutine_handle<promise_type> const handle) noexcept :
+  handle_{handle} {}
+
+
+template<std::invocable Func>
+BlockingIoAwaiter<Func>::BlockingIoAwaiter(JobSystem& job_system, Func func, JobPriority const resume_priority) :
+  job_system_{&job_system},
+  func_{std::move(func)},
+  resume_priority_{resume_priority} {}
+
+
+template<std::invocable Func>
+auto BlockingIoAwaiter<Func>::await_ready() noexcept -> bool {
+  return false;
+}
+
+
+template<std::invocable Func>
+auto BlockingIoAwaiter<Func>::await_suspend(std::coroutine_handle<> const handle) -> void {
+  auto const io_job{
+    job_system_->CreateJob([this] {
+      try {
+        if constexpr (std::is_void_v<FuncResultType>) {
+          func_();
+          result_.emplace(true);
+        } else {
+          result_.emplace(func_());
+        }
+      } catch (...) {
+        exception_ = std::current_exception();
+      }
+    })
+  };
+
+  io_job->priority = JobPriority::kBlockingIo;
+
+  // Resume on a compute worker instead of keeping the I/O thread busy
+  auto const resume_job{
+    job_system_->CreateJob([handle] {
+      handle.resume();
+    })
+  };
+
+  resume_job->priority = resume_priority_;
+  JobSystem::AddContinuation(io_job, resume_job);
+  job_system_->Run(resume_job);
+  job_system_->Run(io_job);
+}
+
+
+template<std::invocable Func>
+auto BlockingIoAwaiter<Func>::await_resume() -> std::invoke_result_t<Func&> {
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
+
+  if constexpr (!std::is_void_v<FuncResultType>) {
+    return std::move(*result_);
+  }
+}
+
+
+template<std::invocable Func>
+auto RunBlockingIo(JobSystem& job_system, Func func, JobPriority const resume_priority) -> BlockingIoAwaiter<Func> {
+  return BlockingIoAwaiter<Func>{job_system, std::move(func), resume_priority};
+}
+
+
+template<typename T>
+auto WhenAll(JobSystem& job_system, std::vector<Task<T>> tasks) -> Task<std::conditional_t<
+  std::is_void_v<T>, void, std::vector<T>>> {
+  co_await detail::WhenAllAwaiter<T>{job_system, tasks};
+
+  if constexpr (std::is_void_v<T>) {
+    for (auto& task : tasks) {
+      task.GetResult();
+    }
+  } else {
+    std::vector<T> results;
+    results.reserve(tasks.size());
+
+    for (auto& task : tasks) {
+      results.emplace_back(task.GetResult());
+    }
+
+    co_return results;
+  }
+}
+
+
+template<typename T>
+auto WhenAny(JobSystem& job_system, std::vector<Task<T>> tasks) -> Task<std::conditional_t<
+  std::is_void_v<T>, std::size_t, std::pair<std::size_t, T>>> {
+  if (tasks.empty()) {
+    throw std::invalid_argument{"WhenAny requires at least one task."};
+  }
+
+  auto const state{std::make_shared<detail::WhenAnyState<T>>(std::move(tasks))};
+  co_await detail::WhenAnyAwaiter<T>{job_system, state};
+
+  auto& winner{state->tasks[state->winner_idx]};
+
+  if constexpr (std::is_void_v<T>) {
+    winner.GetResult();
+    co_return state->winner_idx;
+  } else {
+    co_return std::pair<std::size_t, T>{state->winner_idx, winner.GetResult()};
+  }
+}
+
+
+template<typename T>
+auto SyncWait(JobSystem& job_system, Task<T> task) -> T {
+  detail::MakeSyncWaitTask(task).Run(job_system);
+  return task.GetResult();
+}
+}
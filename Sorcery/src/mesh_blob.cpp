@@ -0,0 +1,1050 @@
+#include "mesh_blob.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "Serialization.hpp"
+
+
+namespace sorcery {
+namespace {
+using mesh_blob::Stream;
+
+
+static_assert(std::is_trivially_copyable_v<MeshletData>);
+static_assert(std::is_trivially_copyable_v<MeshletTriangleData>);
+static_assert(std::is_trivially_copyable_v<MeshletCullData>);
+static_assert(std::is_trivially_copyable_v<SubmeshData>);
+static_assert(std::is_trivially_copyable_v<SubmeshLodData>);
+static_assert(std::is_trivially_copyable_v<Bone>);
+static_assert(std::is_trivially_copyable_v<AnimRotationKey>);
+static_assert(std::is_trivially_copyable_v<mesh_blob::SkeletonNodeRecord>);
+static_assert(std::is_trivially_copyable_v<mesh_blob::Header>);
+static_assert(sizeof(mesh_blob::Header) == 48 + sizeof(mesh_blob::StreamRange) * static_cast<std::size_t>(Stream::kCount));
+static_assert(sizeof(mesh_blob::SkeletonNodeRecord) == sizeof(mesh_blob::StringRef) + sizeof(Matrix4) + 8);
+
+
+constexpr std::array<std::size_t, static_cast<std::size_t>(Stream::kCount)> kStreamElementSizes{
+  sizeof(Vector3), sizeof(Vector3), sizeof(Vector4), sizeof(Vector2), sizeof(Vector4),
+  sizeof(Vector<std::uint32_t, 4>), sizeof(MeshletData), sizeof(std::uint8_t), sizeof(MeshletTriangleData),
+  sizeof(MeshletCullData), sizeof(mesh_blob::MaterialSlotRecord), sizeof(SubmeshData),
+  sizeof(mesh_blob::AnimationRecord), sizeof(mesh_blob::NodeAnimationRecord), sizeof(AnimPositionKey),
+  sizeof(AnimRotationKey), sizeof(AnimScalingKey), sizeof(mesh_blob::SkeletonNodeRecord), sizeof(Bone), sizeof(char),
+  sizeof(SubmeshLodData)
+};
+
+
+constexpr std::uint32_t kFirstVersionWithWideTangents{3};
+constexpr std::uint32_t kFirstVersionWithSubmeshLods{4};
+
+
+// Only the quantizable streams have entries
+constexpr std::array<std::size_t, static_cast<std::size_t>(Stream::kCount)> kPackedStreamElementSizes{
+  sizeof(PackedPosition), sizeof(PackedUnitVector), sizeof(PackedUnitVector), sizeof(PackedUv),
+  sizeof(PackedBoneWeights), sizeof(PackedBoneIndices)
+};
+
+
+// Tangents without handedness, either as Vector3s or as packed unit vectors
+[[nodiscard]] auto HasNarrowTangents(mesh_blob::Header const& header) -> bool {
+  return header.version < kFirstVersionWithWideTangents;
+}
+
+
+[[nodiscard]] auto GetStreamCount(mesh_blob::Header const& header) -> std::size_t {
+  return header.version < kFirstVersionWithSubmeshLods
+           ? static_cast<std::size_t>(Stream::kSubmeshLods)
+           : static_cast<std::size_t>(Stream::kCount);
+}
+
+
+[[nodiscard]] auto GetHeaderSize(mesh_blob::Header const& header) -> std::size_t {
+  return offsetof(mesh_blob::Header, streams) + sizeof(mesh_blob::StreamRange) * GetStreamCount(header);
+}
+
+
+// Streams that did not exist in the version of the blob are empty
+[[nodiscard]] auto GetStreamRange(mesh_blob::Header const& header, Stream const stream) -> mesh_blob::StreamRange {
+  auto const stream_idx{static_cast<std::size_t>(stream)};
+  return stream_idx < GetStreamCount(header) ? header.streams[stream_idx] : mesh_blob::StreamRange{};
+}
+
+
+[[nodiscard]] auto GetStreamElementSize(mesh_blob::Header const& header, std::size_t const stream_idx) -> std::size_t {
+  if (header.quantized_streams & (1u << stream_idx)) {
+    return kPackedStreamElementSizes[stream_idx];
+  }
+
+  if (stream_idx == static_cast<std::size_t>(Stream::kTangents) && HasNarrowTangents(header)) {
+    return sizeof(Vector3);
+  }
+
+  return kStreamElementSizes[stream_idx];
+}
+
+
+[[nodiscard]] auto GetStreamElementCount(mesh_blob::Header const& header, Stream const stream) -> std::size_t {
+  return GetStreamRange(header, stream).size / GetStreamElementSize(header, static_cast<std::size_t>(stream));
+}
+
+
+[[nodiscard]] constexpr auto AlignUp(std::uint64_t const value, std::uint64_t const alignment) -> std::uint64_t {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+
+// Overflow safe check of first + count <= size
+[[nodiscard]] constexpr auto IsRangeValid(std::uint64_t const first, std::uint64_t const count,
+                                          std::uint64_t const size) -> bool {
+  return first <= size && count <= size - first;
+}
+}
+
+
+auto MeshView::Parse(std::span<std::byte const> const bytes) noexcept -> std::optional<MeshView> {
+  if (!IsMeshBlob(bytes) || reinterpret_cast<std::uintptr_t>(bytes.data()) % mesh_blob::kStreamAlignment != 0) {
+    return std::nullopt;
+  }
+
+  MeshView view;
+  view.bytes_ = bytes;
+  view.header_ = reinterpret_cast<mesh_blob::Header const*>(bytes.data());
+
+  auto const& header{*view.header_};
+
+  if (header.version == 0 || header.version > mesh_blob::kLatestVersion || header.size != bytes.size() ||
+      bytes.size() < GetHeaderSize(header) || (header.quantized_streams & ~mesh_blob::kQuantizableStreams) != 0) {
+    return std::nullopt;
+  }
+
+  for (std::size_t i{0}; i < GetStreamCount(header); i++) {
+    if (auto const& [offset, size]{header.streams[i]};
+      offset % mesh_blob::kStreamAlignment != 0 || offset < GetHeaderSize(header) ||
+      !IsRangeValid(offset, size, bytes.size()) || size % GetStreamElementSize(header, i) != 0) {
+      return std::nullopt;
+    }
+  }
+
+  // Streams
+
+  auto const vertex_count{view.GetVertexCount()};
+
+  if (GetStreamElementCount(header, Stream::kNormals) != vertex_count ||
+      GetStreamElementCount(header, Stream::kTangents) != vertex_count ||
+      GetStreamElementCount(header, Stream::kUvs) != vertex_count) {
+    return std::nullopt;
+  }
+
+  if (auto const bone_weight_count{GetStreamElementCount(header, Stream::kBoneWeights)};
+    bone_weight_count != GetStreamElementCount(header, Stream::kBoneIndices) || (
+      bone_weight_count != 0 && bone_weight_count != vertex_count)) {
+    return std::nullopt;
+  }
+
+  if (view.GetCullData().size() != view.GetMeshlets().size()) {
+    return std::nullopt;
+  }
+
+  auto const vertex_idx_count{view.GetVertexIndices().size() / (view.Has32BitVertexIndices() ? 4 : 2)};
+
+  for (auto const& meshlet : view.GetMeshlets()) {
+    if (!IsRangeValid(meshlet.vert_offset, meshlet.vert_count, vertex_idx_count) ||
+        !IsRangeValid(meshlet.prim_offset, meshlet.prim_count, view.GetTriangleIndices().size())) {
+      return std::nullopt;
+    }
+  }
+
+  for (auto const& submesh : view.GetSubmeshes()) {
+    if (!IsRangeValid(submesh.first_meshlet, submesh.meshlet_count, view.GetMeshlets().size()) ||
+        submesh.material_idx >= view.GetMaterialSlots().size()) {
+      return std::nullopt;
+    }
+  }
+
+  for (auto const& lod : view.GetSubmeshLods()) {
+    if (lod.submesh_idx >= view.GetSubmeshes().size() ||
+        !IsRangeValid(lod.first_meshlet, lod.meshlet_count, view.GetMeshlets().size())) {
+      return std::nullopt;
+    }
+  }
+
+  if (!std::ranges::is_sorted(view.GetSubmeshLods(), {}, &SubmeshLodData::submesh_idx)) {
+    return std::nullopt;
+  }
+
+  // Tables
+
+  auto const string_table_size{GetStreamRange(header, Stream::kStrings).size};
+
+  auto const is_string_valid{
+    [string_table_size](mesh_blob::StringRef const& str) {
+      return IsRangeValid(str.offset, str.size, string_table_size);
+    }
+  };
+
+  if (!std::ranges::all_of(view.GetMaterialSlots(), [&](mesh_blob::MaterialSlotRecord const& slot) {
+    return is_string_valid(slot.name);
+  })) {
+    return std::nullopt;
+  }
+
+  for (auto const& anim : view.GetAnimations()) {
+    if (!is_string_valid(anim.name) ||
+        !IsRangeValid(anim.first_node_anim, anim.node_anim_count, view.GetNodeAnimations().size())) {
+      return std::nullopt;
+    }
+  }
+
+  auto const skeleton_size{view.GetSkeleton().size()};
+
+  for (auto const& node_anim : view.GetNodeAnimations()) {
+    if (node_anim.node_idx >= skeleton_size ||
+        !IsRangeValid(node_anim.first_position_key, node_anim.position_key_count, view.GetPositionKeys().size()) ||
+        !IsRangeValid(node_anim.first_rotation_key, node_anim.rotation_key_count, view.GetRotationKeys().size()) ||
+        !IsRangeValid(node_anim.first_scaling_key, node_anim.scaling_key_count, view.GetScalingKeys().size())) {
+      return std::nullopt;
+    }
+  }
+
+  for (auto const& node : view.GetSkeleton()) {
+    if (!is_string_valid(node.name) || (node.parent_idx != mesh_blob::kNoParent && node.parent_idx >= skeleton_size)) {
+      return std::nullopt;
+    }
+  }
+
+  if (!std::ranges::all_of(view.GetBones(), [skeleton_size](Bone const& bone) {
+    return bone.skeleton_node_idx < skeleton_size;
+  })) {
+    return std::nullopt;
+  }
+
+  return view;
+}
+
+
+auto MeshView::IsMeshBlob(std::span<std::byte const> const bytes) noexcept -> bool {
+  if (bytes.size() < offsetof(mesh_blob::Header, streams)) {
+    return false;
+  }
+
+  std::uint32_t magic;
+  std::memcpy(&magic, bytes.data(), sizeof(magic));
+  return magic == mesh_blob::kMagic;
+}
+
+
+auto MeshView::GetPositions() const noexcept -> std::span<Vector3 const> {
+  return GetFloatStream<Vector3>(Stream::kPositions);
+}
+
+
+auto MeshView::GetNormals() const noexcept -> std::span<Vector3 const> {
+  return GetFloatStream<Vector3>(Stream::kNormals);
+}
+
+
+auto MeshView::GetTangents() const noexcept -> std::span<Vector4 const> {
+  return HasNarrowTangents(*header_) ? std::span<Vector4 const>{} : GetFloatStream<Vector4>(Stream::kTangents);
+}
+
+
+auto MeshView::GetUvs() const noexcept -> std::span<Vector2 const> {
+  return GetFloatStream<Vector2>(Stream::kUvs);
+}
+
+
+auto MeshView::GetBoneWeights() const noexcept -> std::span<Vector4 const> {
+  return GetFloatStream<Vector4>(Stream::kBoneWeights);
+}
+
+
+auto MeshView::GetBoneIndices() const noexcept -> std::span<Vector<std::uint32_t, 4> const> {
+  return GetFloatStream<Vector<std::uint32_t, 4>>(Stream::kBoneIndices);
+}
+
+
+auto MeshView::GetMeshlets() const noexcept -> std::span<MeshletData const> {
+  return GetStream<MeshletData>(Stream::kMeshlets);
+}
+
+
+auto MeshView::GetVertexIndices() const noexcept -> std::span<std::uint8_t const> {
+  return GetStream<std::uint8_t>(Stream::kVertexIndices);
+}
+
+
+auto MeshView::GetTriangleIndices() const noexcept -> std::span<MeshletTriangleData const> {
+  return GetStream<MeshletTriangleData>(Stream::kTriangleIndices);
+}
+
+
+auto MeshView::GetCullData() const noexcept -> std::span<MeshletCullData const> {
+  return GetStream<MeshletCullData>(Stream::kCullData);
+}
+
+
+auto MeshView::GetMaterialSlots() const noexcept -> std::span<mesh_blob::MaterialSlotRecord const> {
+  return GetStream<mesh_blob::MaterialSlotRecord>(Stream::kMaterialSlots);
+}
+
+
+auto MeshView::GetSubmeshes() const noexcept -> std::span<SubmeshData const> {
+  return GetStream<SubmeshData>(Stream::kSubmeshes);
+}
+
+
+auto MeshView::GetSubmeshLods() const noexcept -> std::span<SubmeshLodData const> {
+  return GetStream<SubmeshLodData>(Stream::kSubmeshLods);
+}
+
+
+auto MeshView::GetAnimations() const noexcept -> std::span<mesh_blob::AnimationRecord const> {
+  return GetStream<mesh_blob::AnimationRecord>(Stream::kAnimations);
+}
+
+
+auto MeshView::GetNodeAnimations() const noexcept -> std::span<mesh_blob::NodeAnimationRecord const> {
+  return GetStream<mesh_blob::NodeAnimationRecord>(Stream::kNodeAnimations);
+}
+
+
+auto MeshView::GetPositionKeys() const noexcept -> std::span<AnimPositionKey const> {
+  return GetStream<AnimPositionKey>(Stream::kPositionKeys);
+}
+
+
+auto MeshView::GetRotationKeys() const noexcept -> std::span<AnimRotationKey const> {
+  return GetStream<AnimRotationKey>(Stream::kRotationKeys);
+}
+
+
+auto MeshView::GetScalingKeys() const noexcept -> std::span<AnimScalingKey const> {
+  return GetStream<AnimScalingKey>(Stream::kScalingKeys);
+}
+
+
+auto MeshView::GetSkeleton() const noexcept -> std::span<mesh_blob::SkeletonNodeRecord const> {
+  return GetStream<mesh_blob::SkeletonNodeRecord>(Stream::kSkeleton);
+}
+
+
+auto MeshView::GetBones() const noexcept -> std::span<Bone const> {
+  return GetStream<Bone>(Stream::kBones);
+}
+
+
+auto MeshView::GetString(mesh_blob::StringRef const& str) const noexcept -> std::string_view {
+  auto const strings{GetStream<char>(Stream::kStrings)};
+  return std::string_view{strings.data() + str.offset, str.size};
+}
+
+
+auto MeshView::GetPackedPositions() const noexcept -> std::span<PackedPosition const> {
+  return GetPackedStream<PackedPosition>(Stream::kPositions);
+}
+
+
+auto MeshView::GetPackedNormals() const noexcept -> std::span<PackedUnitVector const> {
+  return GetPackedStream<PackedUnitVector>(Stream::kNormals);
+}
+
+
+auto MeshView::GetPackedTangents() const noexcept -> std::span<PackedUnitVector const> {
+  return GetPackedStream<PackedUnitVector>(Stream::kTangents);
+}
+
+
+auto MeshView::GetPackedUvs() const noexcept -> std::span<PackedUv const> {
+  return GetPackedStream<PackedUv>(Stream::kUvs);
+}
+
+
+auto MeshView::GetPackedBoneWeights() const noexcept -> std::span<PackedBoneWeights const> {
+  return GetPackedStream<PackedBoneWeights>(Stream::kBoneWeights);
+}
+
+
+auto MeshView::GetPackedBoneIndices() const noexcept -> std::span<PackedBoneIndices const> {
+  return GetPackedStream<PackedBoneIndices>(Stream::kBoneIndices);
+}
+
+
+auto MeshView::GetBounds() const noexcept -> AABB const& {
+  return header_->bounds;
+}
+
+
+auto MeshView::Has32BitVertexIndices() const noexcept -> bool {
+  return header_->idx32 != 0;
+}
+
+
+auto MeshView::IsQuantized(Stream const stream) const noexcept -> bool {
+  return (header_->quantized_streams & mesh_blob::GetStreamBit(stream)) != 0;
+}
+
+
+auto MeshView::GetVertexCount() const noexcept -> std::size_t {
+  return GetStreamElementCount(*header_, Stream::kPositions);
+}
+
+
+auto MeshView::ToPositions() const -> std::vector<Vector3> {
+  if (!IsQuantized(Stream::kPositions)) {
+    return std::vector(std::begin(GetPositions()), std::end(GetPositions()));
+  }
+
+  std::vector<Vector3> positions(GetPackedPositions().size());
+  DecodePositions(GetPackedPositions(), GetBounds(), positions);
+  return positions;
+}
+
+
+auto MeshView::ToNormals() const -> std::vector<Vector3> {
+  if (!IsQuantized(Stream::kNormals)) {
+    return std::vector(std::begin(GetNormals()), std::end(GetNormals()));
+  }
+
+  std::vector<Vector3> normals(GetPackedNormals().size());
+  DecodeUnitVectors(GetPackedNormals(), normals);
+  return normals;
+}
+
+
+auto MeshView::ToTangents() const -> std::vector<Vector4> {
+  if (HasNarrowTangents(*header_)) {
+    std::vector<Vector3> narrow_tangents;
+
+    if (IsQuantized(Stream::kTangents)) {
+      narrow_tangents.resize(GetPackedTangents().size());
+      DecodeUnitVectors(GetPackedTangents(), narrow_tangents);
+    } else {
+      auto const stream{GetStream<Vector3>(Stream::kTangents)};
+      narrow_tangents.assign(std::begin(stream), std::end(stream));
+    }
+
+    std::vector<Vector4> tangents;
+    tangents.reserve(narrow_tangents.size());
+
+    for (auto const& tangent : narrow_tangents) {
+      tangents.emplace_back(tangent[0], tangent[1], tangent[2], 1.0f);
+    }
+
+    return tangents;
+  }
+
+  if (!IsQuantized(Stream::kTangents)) {
+    return std::vector(std::begin(GetTangents()), std::end(GetTangents()));
+  }
+
+  std::vector<Vector4> tangents(GetPackedTangents().size());
+  DecodeTangents(GetPackedTangents(), tangents);
+  return tangents;
+}
+
+
+auto MeshView::ToUvs() const -> std::vector<Vector2> {
+  if (!IsQuantized(Stream::kUvs)) {
+    return std::vector(std::begin(GetUvs()), std::end(GetUvs()));
+  }
+
+  std::vector<Vector2> uvs(GetPackedUvs().size());
+  DecodeUvs(GetPackedUvs(), uvs);
+  return uvs;
+}
+
+
+auto MeshView::ToBoneWeights() const -> std::vector<Vector4> {
+  if (!IsQuantized(Stream::kBoneWeights)) {
+    return std::vector(std::begin(GetBoneWeights()), std::end(GetBoneWeights()));
+  }
+
+  std::vector<Vector4> bone_weights(GetPackedBoneWeights().size());
+  DecodeBoneWeights(GetPackedBoneWeights(), bone_weights);
+  return bone_weights;
+}
+
+
+auto MeshView::ToBoneIndices() const -> std::vector<Vector<std::uint32_t, 4>> {
+  if (!IsQuantized(Stream::kBoneIndices)) {
+    return std::vector(std::begin(GetBoneIndices()), std::end(GetBoneIndices()));
+  }
+
+  std::vector<Vector<std::uint32_t, 4>> bone_indices(GetPackedBoneIndices().size());
+  DecodeBoneIndices(GetPackedBoneIndices(), bone_indices);
+  return bone_indices;
+}
+
+
+auto MeshView::ToMaterialSlots() const -> std::vector<MaterialSlotInfo> {
+  std::vector<MaterialSlotInfo> mtl_slots;
+  mtl_slots.reserve(GetMaterialSlots().size());
+
+  for (auto const& slot : GetMaterialSlots()) {
+    mtl_slots.emplace_back(std::string{GetString(slot.name)});
+  }
+
+  return mtl_slots;
+}
+
+
+auto MeshView::ToAnimations() const -> std::vector<Animation> {
+  auto const node_anims{GetNodeAnimations()};
+  auto const pos_keys{GetPositionKeys()};
+  auto const rot_keys{GetRotationKeys()};
+  auto const scale_keys{GetScalingKeys()};
+
+  std::vector<Animation> anims;
+  anims.reserve(GetAnimations().size());
+
+  for (auto const& anim_record : GetAnimations()) {
+    auto& anim{anims.emplace_back()};
+    anim.name = GetString(anim_record.name);
+    anim.duration = anim_record.duration;
+    anim.ticks_per_second = anim_record.ticks_per_second;
+    anim.node_anims.reserve(anim_record.node_anim_count);
+
+    for (auto const& node_anim : node_anims.subspan(anim_record.first_node_anim, anim_record.node_anim_count)) {
+      auto const node_pos_keys{pos_keys.subspan(node_anim.first_position_key, node_anim.position_key_count)};
+      auto const node_rot_keys{rot_keys.subspan(node_anim.first_rotation_key, node_anim.rotation_key_count)};
+      auto const node_scale_keys{scale_keys.subspan(node_anim.first_scaling_key, node_anim.scaling_key_count)};
+
+      anim.node_anims.emplace_back(std::vector(std::begin(node_pos_keys), std::end(node_pos_keys)),
+        std::vector(std::begin(node_rot_keys), std::end(node_rot_keys)),
+        std::vector(std::begin(node_scale_keys), std::end(node_scale_keys)), node_anim.node_idx);
+    }
+  }
+
+  return anims;
+}
+
+
+auto MeshView::ToSkeleton() const -> std::vector<SkeletonNode> {
+  std::vector<SkeletonNode> skeleton;
+  skeleton.reserve(GetSkeleton().size());
+
+  for (auto const& node : GetSkeleton()) {
+    skeleton.emplace_back(std::string{GetString(node.name)}, node.transform,
+      node.parent_idx == mesh_blob::kNoParent ? std::nullopt : std::optional{node.parent_idx});
+  }
+
+  return skeleton;
+}
+
+
+auto MeshView::ToMeshData() const -> MeshData {
+  auto const to_vector{
+    []<typename T>(std::span<T const> const span) {
+      return std::vector<T>(std::begin(span), std::end(span));
+    }
+  };
+
+  return MeshData{
+    .positions = ToPositions(),
+    .normals = ToNormals(),
+    .tangents = ToTangents(),
+    .uvs = ToUvs(),
+    .bone_weights = ToBoneWeights(),
+    .bone_indices = ToBoneIndices(),
+    .meshlets = to_vector(GetMeshlets()),
+    .vertex_indices = to_vector(GetVertexIndices()),
+    .triangle_indices = to_vector(GetTriangleIndices()),
+    .cull_data = to_vector(GetCullData()),
+    .material_slots = ToMaterialSlots(),
+    .submeshes = to_vector(GetSubmeshes()),
+    .submesh_lods = to_vector(GetSubmeshLods()),
+    .animations = ToAnimations(),
+    .skeleton = ToSkeleton(),
+    .bones = to_vector(GetBones()),
+    .bounds = GetBounds(),
+    .idx32 = Has32BitVertexIndices()
+  };
+}
+
+
+template<typename T>
+auto MeshView::GetStream(Stream const stream) const noexcept -> std::span<T const> {
+  auto const [offset, size]{GetStreamRange(*header_, stream)};
+  return std::span{reinterpret_cast<T const*>(bytes_.data() + offset), size / sizeof(T)};
+}
+
+
+template<typename T>
+auto MeshView::GetFloatStream(Stream const stream) const noexcept -> std::span<T const> {
+  return IsQuantized(stream) ? std::span<T const>{} : GetStream<T>(stream);
+}
+
+
+template<typename T>
+auto MeshView::GetPackedStream(Stream const stream) const noexcept -> std::span<T const> {
+  return IsQuantized(stream) ? GetStream<T>(stream) : std::span<T const>{};
+}
+
+
+auto SerializeMeshBlob(MeshData const& mesh_data, bool const quantize_vertex_streams) -> std::vector<std::byte> {
+  // Flatten the nested tables
+
+  std::string strings;
+
+  auto const add_string{
+    [&strings](std::string_view const str) {
+      mesh_blob::StringRef const ref{strings.size(), str.size()};
+      strings.append(str);
+      return ref;
+    }
+  };
+
+  std::vector<mesh_blob::MaterialSlotRecord> mtl_slots;
+  mtl_slots.reserve(mesh_data.material_slots.size());
+
+  for (auto const& slot : mesh_data.material_slots) {
+    mtl_slots.emplace_back(add_string(slot.name));
+  }
+
+  std::vector<mesh_blob::AnimationRecord> anims;
+  std::vector<mesh_blob::NodeAnimationRecord> node_anims;
+  std::vector<AnimPositionKey> pos_keys;
+  std::vector<AnimRotationKey> rot_keys;
+  std::vector<AnimScalingKey> scale_keys;
+
+  anims.reserve(mesh_data.animations.size());
+
+  for (auto const& anim : mesh_data.animations) {
+    anims.emplace_back(add_string(anim.name), anim.duration, anim.ticks_per_second,
+      static_cast<std::uint32_t>(node_anims.size()), static_cast<std::uint32_t>(anim.node_anims.size()));
+
+    for (auto const& node_anim : anim.node_anims) {
+      node_anims.emplace_back(node_anim.node_idx,
+        static_cast<std::uint32_t>(pos_keys.size()), static_cast<std::uint32_t>(node_anim.position_keys.size()),
+        static_cast<std::uint32_t>(rot_keys.size()), static_cast<std::uint32_t>(node_anim.rotation_keys.size()),
+        static_cast<std::uint32_t>(scale_keys.size()), static_cast<std::uint32_t>(node_anim.scaling_keys.size()));
+
+      pos_keys.insert(std::end(pos_keys), std::begin(node_anim.position_keys), std::end(node_anim.position_keys));
+      rot_keys.insert(std::end(rot_keys), std::begin(node_anim.rotation_keys), std::end(node_anim.rotation_keys));
+      scale_keys.insert(std::end(scale_keys), std::begin(node_anim.scaling_keys), std::end(node_anim.scaling_keys));
+    }
+  }
+
+  std::vector<mesh_blob::SkeletonNodeRecord> skeleton;
+  skeleton.reserve(mesh_data.skeleton.size());
+
+  for (auto const& node : mesh_data.skeleton) {
+    skeleton.emplace_back(add_string(node.name), node.transform, node.parent_idx.value_or(mesh_blob::kNoParent), 0);
+  }
+
+  // Lay out the streams
+
+  std::array<std::span<std::byte const>, static_cast<std::size_t>(Stream::kCount)> streams{
+    as_bytes(std::span{mesh_data.positions}), as_bytes(std::span{mesh_data.normals}),
+    as_bytes(std::span{mesh_data.tangents}), as_bytes(std::span{mesh_data.uvs}),
+    as_bytes(std::span{mesh_data.bone_weights}), as_bytes(std::span{mesh_data.bone_indices}),
+    as_bytes(std::span{mesh_data.meshlets}), as_bytes(std::span{mesh_data.vertex_indices}),
+    as_bytes(std::span{mesh_data.triangle_indices}), as_bytes(std::span{mesh_data.cull_data}),
+    as_bytes(std::span{mtl_slots}), as_bytes(std::span{mesh_data.submeshes}), as_bytes(std::span{anims}),
+    as_bytes(std::span{node_anims}), as_bytes(std::span{pos_keys}), as_bytes(std::span{rot_keys}),
+    as_bytes(std::span{scale_keys}), as_bytes(std::span{skeleton}), as_bytes(std::span{mesh_data.bones}),
+    as_bytes(std::span{strings}), as_bytes(std::span{mesh_data.submesh_lods})
+  };
+
+  mesh_blob::Header header{
+    .magic = mesh_blob::kMagic,
+    .version = mesh_blob::kLatestVersion,
+    .size = 0,
+    .bounds = mesh_data.bounds,
+    .idx32 = mesh_data.idx32 ? 1u : 0u,
+    .quantized_streams = 0,
+    .streams = {}
+  };
+
+  std::vector<PackedPosition> packed_positions;
+  std::vector<PackedUnitVector> packed_normals;
+  std::vector<PackedUnitVector> packed_tangents;
+  std::vector<PackedUv> packed_uvs;
+  std::vector<PackedBoneWeights> packed_bone_weights;
+  std::vector<PackedBoneIndices> packed_bone_indices;
+
+  if (quantize_vertex_streams) {
+    auto const use_packed{
+      [&streams, &header](Stream const stream, auto const& packed) {
+        streams[static_cast<std::size_t>(stream)] = as_bytes(std::span{packed});
+        header.quantized_streams |= mesh_blob::GetStreamBit(stream);
+      }
+    };
+
+    packed_positions.resize(mesh_data.positions.size());
+    EncodePositions(mesh_data.positions, mesh_data.bounds, packed_positions);
+    use_packed(Stream::kPositions, packed_positions);
+
+    packed_normals.resize(mesh_data.normals.size());
+    EncodeUnitVectors(mesh_data.normals, packed_normals);
+    use_packed(Stream::kNormals, packed_normals);
+
+    packed_tangents.resize(mesh_data.tangents.size());
+    EncodeTangents(mesh_data.tangents, packed_tangents);
+    use_packed(Stream::kTangents, packed_tangents);
+
+    packed_uvs.resize(mesh_data.uvs.size());
+    EncodeUvs(mesh_data.uvs, packed_uvs);
+    use_packed(Stream::kUvs, packed_uvs);
+
+    packed_bone_weights.resize(mesh_data.bone_weights.size());
+    EncodeBoneWeights(mesh_data.bone_weights, packed_bone_weights);
+    use_packed(Stream::kBoneWeights, packed_bone_weights);
+
+    packed_bone_indices.resize(mesh_data.bone_indices.size());
+
+    if (EncodeBoneIndices(mesh_data.bone_indices, packed_bone_indices)) {
+      use_packed(Stream::kBoneIndices, packed_bone_indices);
+    }
+  }
+
+  auto offset{AlignUp(sizeof(mesh_blob::Header), mesh_blob::kStreamAlignment)};
+
+  for (std::size_t i{0}; i < streams.size(); i++) {
+    header.streams[i] = mesh_blob::StreamRange{.offset = offset, .size = streams[i].size()};
+    offset = AlignUp(offset + streams[i].size(), mesh_blob::kStreamAlignment);
+  }
+
+  header.size = offset;
+
+  // The blob is sized once and every stream is copied in with a single memcpy, alignment padding stays zeroed
+  std::vector<std::byte> bytes(offset);
+  std::memcpy(bytes.data(), &header, sizeof(header));
+
+  for (std::size_t i{0}; i < streams.size(); i++) {
+    if (!streams[i].empty()) {
+      std::memcpy(bytes.data() + header.streams[i].offset, streams[i].data(), streams[i].size());
+    }
+  }
+
+  return bytes;
+}
+
+auto DeserializeLegacyMeshData(std::span<std::byte const> const bytes) -> std::optional<MeshData> {
+  auto cur_bytes{as_bytes(std::span{bytes})};
+
+  // Element counts
+
+  std::uint64_t vert_count;
+
+  if (!DeserializeFromBinary(cur_bytes, vert_count)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof vert_count);
+  std::uint64_t meshlet_count;
+
+  if (!DeserializeFromBinary(cur_bytes, meshlet_count)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof meshlet_count);
+  std::uint64_t vtx_idx_count;
+
+  if (!DeserializeFromBinary(cur_bytes, vtx_idx_count)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof vtx_idx_count);
+  std::uint64_t prim_idx_count;
+
+  if (!DeserializeFromBinary(cur_bytes, prim_idx_count)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof prim_idx_count);
+  std::uint64_t material_slot_count;
+
+  if (!DeserializeFromBinary(cur_bytes, material_slot_count)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof material_slot_count);
+  std::uint64_t submesh_count;
+
+  if (!DeserializeFromBinary(cur_bytes, submesh_count)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof submesh_count);
+  std::uint64_t anim_count;
+
+  if (!DeserializeFromBinary(cur_bytes, anim_count)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof anim_count);
+  std::uint64_t skeleton_size;
+
+  if (!DeserializeFromBinary(cur_bytes, skeleton_size)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof skeleton_size);
+  std::uint64_t bone_count;
+
+  if (!DeserializeFromBinary(cur_bytes, bone_count)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof bone_count);
+  MeshData mesh_data;
+
+  // Geometry data
+
+  mesh_data.positions.resize(vert_count);
+  std::memcpy(mesh_data.positions.data(), cur_bytes.data(), vert_count * sizeof(Vector3));
+  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector3));
+
+  mesh_data.normals.resize(vert_count);
+  std::memcpy(mesh_data.normals.data(), cur_bytes.data(), vert_count * sizeof(Vector3));
+  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector3));
+
+  // Tangents were stored without their handedness, assume right-handed frames
+  mesh_data.tangents.reserve(vert_count);
+
+  for (std::size_t i{0}; i < vert_count; i++) {
+    Vector3 tangent;
+    std::memcpy(&tangent, cur_bytes.data(), sizeof(Vector3));
+    cur_bytes = cur_bytes.subspan(sizeof(Vector3));
+    mesh_data.tangents.emplace_back(tangent[0], tangent[1], tangent[2], 1.0f);
+  }
+
+  mesh_data.uvs.resize(vert_count);
+  std::memcpy(mesh_data.uvs.data(), cur_bytes.data(), vert_count * sizeof(Vector2));
+  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector2));
+
+  mesh_data.bone_weights.resize(vert_count);
+  std::memcpy(mesh_data.bone_weights.data(), cur_bytes.data(), vert_count * sizeof(Vector4));
+  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector4));
+
+  mesh_data.bone_indices.resize(vert_count);
+  std::memcpy(mesh_data.bone_indices.data(), cur_bytes.data(),
+    vert_count * sizeof(Vector<std::uint32_t, 4>));
+  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector<std::uint32_t, 4>));
+
+  mesh_data.meshlets.resize(meshlet_count);
+  std::memcpy(mesh_data.meshlets.data(), cur_bytes.data(), meshlet_count * sizeof(MeshletData));
+  cur_bytes = cur_bytes.subspan(meshlet_count * sizeof(MeshletData));
+
+  mesh_data.vertex_indices.resize(vtx_idx_count);
+  std::memcpy(mesh_data.vertex_indices.data(), cur_bytes.data(), vtx_idx_count);
+  cur_bytes = cur_bytes.subspan(vtx_idx_count);
+
+  mesh_data.triangle_indices.resize(prim_idx_count);
+  std::memcpy(mesh_data.triangle_indices.data(), cur_bytes.data(),
+    prim_idx_count * sizeof(MeshletTriangleData));
+  cur_bytes = cur_bytes.subspan(prim_idx_count * sizeof(MeshletTriangleData));
+
+  mesh_data.cull_data.resize(meshlet_count);
+  std::memcpy(mesh_data.cull_data.data(), cur_bytes.data(), meshlet_count * sizeof(MeshletCullData));
+  cur_bytes = cur_bytes.subspan(meshlet_count * sizeof(MeshletCullData));
+
+  // Material slots
+
+  mesh_data.material_slots.resize(material_slot_count);
+
+  for (auto i{0ull}; i < material_slot_count; i++) {
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.material_slots[i].name)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(mesh_data.material_slots[i].name.size() + 8);
+  }
+
+  // Submeshes
+
+  mesh_data.submeshes.resize(submesh_count);
+
+  for (auto i{0ull}; i < submesh_count; i++) {
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].first_meshlet)) {
+      return std::nullopt;
+    }
+    cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
+
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].meshlet_count)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
+
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].base_vertex)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
+
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].material_idx)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
+
+    for (auto j{0}; j < 3; j++) {
+      if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].bounds.min[j])) {
+        return std::nullopt;
+      }
+
+      cur_bytes = cur_bytes.subspan(sizeof(float));
+    }
+
+    for (auto j{0}; j < 3; j++) {
+      if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].bounds.max[j])) {
+        return std::nullopt;
+      }
+
+      cur_bytes = cur_bytes.subspan(sizeof(float));
+    }
+  }
+
+  // Animations
+
+  mesh_data.animations.resize(anim_count);
+
+  for (auto i{0ull}; i < anim_count; i++) {
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.animations[i].name)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(mesh_data.animations[i].name.size() + 8);
+
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.animations[i].duration)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(sizeof(float));
+
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.animations[i].ticks_per_second)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(sizeof(float));
+    std::uint64_t node_anim_count;
+
+    if (!DeserializeFromBinary(cur_bytes, node_anim_count)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(sizeof node_anim_count);
+    mesh_data.animations[i].node_anims.resize(node_anim_count);
+
+    for (auto j{0ull}; j < node_anim_count; j++) {
+      if (!DeserializeFromBinary(cur_bytes, mesh_data.animations[i].node_anims[j].node_idx)) {
+        return std::nullopt;
+      }
+
+      cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
+      std::uint64_t pos_key_count;
+
+      if (!DeserializeFromBinary(cur_bytes, pos_key_count)) {
+        return std::nullopt;
+      }
+
+      cur_bytes = cur_bytes.subspan(sizeof pos_key_count);
+      std::uint64_t rot_key_count;
+
+      if (!DeserializeFromBinary(cur_bytes, rot_key_count)) {
+        return std::nullopt;
+      }
+
+      cur_bytes = cur_bytes.subspan(sizeof rot_key_count);
+      std::uint64_t scale_key_count;
+
+      if (!DeserializeFromBinary(cur_bytes, scale_key_count)) {
+        return std::nullopt;
+      }
+
+      cur_bytes = cur_bytes.subspan(sizeof scale_key_count);
+
+      mesh_data.animations[i].node_anims[j].position_keys.resize(pos_key_count);
+      std::memcpy(mesh_data.animations[i].node_anims[j].position_keys.data(), cur_bytes.data(),
+        pos_key_count * sizeof(AnimPositionKey));
+      cur_bytes = cur_bytes.subspan(pos_key_count * sizeof(AnimPositionKey));
+
+
+      mesh_data.animations[i].node_anims[j].rotation_keys.resize(rot_key_count);
+      std::memcpy(mesh_data.animations[i].node_anims[j].rotation_keys.data(), cur_bytes.data(),
+        rot_key_count * sizeof(AnimRotationKey));
+      cur_bytes = cur_bytes.subspan(rot_key_count * sizeof(AnimRotationKey));
+
+      mesh_data.animations[i].node_anims[j].scaling_keys.resize(scale_key_count);
+      std::memcpy(mesh_data.animations[i].node_anims[j].scaling_keys.data(), cur_bytes.data(),
+        scale_key_count * sizeof(AnimScalingKey));
+      cur_bytes = cur_bytes.subspan(scale_key_count * sizeof(AnimScalingKey));
+    }
+  }
+
+  // Skeleton nodes
+
+  mesh_data.skeleton.resize(skeleton_size);
+
+  for (auto i{0ull}; i < skeleton_size; i++) {
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.skeleton[i].name)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(mesh_data.skeleton[i].name.size() + 8);
+    bool has_parent;
+
+    if (!DeserializeFromBinary(cur_bytes, has_parent)) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(sizeof has_parent);
+
+    if (has_parent) {
+      std::uint32_t parent_idx;
+
+      if (!DeserializeFromBinary(cur_bytes, parent_idx)) {
+        return std::nullopt;
+      }
+
+      mesh_data.skeleton[i].parent_idx = parent_idx;
+      cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
+    }
+
+    std::memcpy(mesh_data.skeleton[i].transform.GetData(), cur_bytes.data(), sizeof(Matrix4));
+    cur_bytes = cur_bytes.subspan(sizeof(Matrix4));
+  }
+
+  // Bones
+
+  mesh_data.bones.resize(bone_count);
+  std::memcpy(mesh_data.bones.data(), cur_bytes.data(), bone_count * sizeof(Bone));
+  cur_bytes = cur_bytes.subspan(bone_count * sizeof(Bone));
+
+  // Bounds
+
+  for (auto j{0}; j < 3; j++) {
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.bounds.min[j])) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(sizeof(float));
+  }
+
+  for (auto j{0}; j < 3; j++) {
+    if (!DeserializeFromBinary(cur_bytes, mesh_data.bounds.max[j])) {
+      return std::nullopt;
+    }
+
+    cur_bytes = cur_bytes.subspan(sizeof(float));
+  }
+
+  // Index format
+
+  if (!DeserializeFromBinary(cur_bytes, mesh_data.idx32)) {
+    return std::nullopt;
+  }
+
+  cur_bytes = cur_bytes.subspan(sizeof mesh_data.idx32);
+
+  assert(cur_bytes.empty());
+
+  return mesh_data;
+}
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Core.hpp"
+#include "mesh_data.hpp"
+#include "vertex_quantization.hpp"
+
+
+namespace sorcery {
+namespace mesh_blob {
+constexpr std::uint32_t kMagic{0x48534D53};
+// Version 2 added quantized vertex streams, version 3 widened tangents to carry their handedness, version 4 added
+// submesh LODs. Older blobs are still read, their tangents are assumed to be right-handed.
+constexpr std::uint32_t kLatestVersion{4};
+// Streams start at multiples of this relative to the start of the blob, which must be aligned to it as well
+constexpr std::uint64_t kStreamAlignment{16};
+constexpr std::uint32_t kNoParent{0xFFFFFFFF};
+
+
+enum class Stream : std::uint32_t {
+  kPositions       = 0,
+  kNormals         = 1,
+  kTangents        = 2,
+  kUvs             = 3,
+  kBoneWeights     = 4,
+  kBoneIndices     = 5,
+  kMeshlets        = 6,
+  kVertexIndices   = 7,
+  kTriangleIndices = 8,
+  kCullData        = 9,
+  kMaterialSlots   = 10,
+  kSubmeshes       = 11,
+  kAnimations      = 12,
+  kNodeAnimations  = 13,
+  kPositionKeys    = 14,
+  kRotationKeys    = 15,
+  kScalingKeys     = 16,
+  kSkeleton        = 17,
+  kBones           = 18,
+  kStrings         = 19,
+  kSubmeshLods     = 20,
+  kCount           = 21
+};
+
+
+struct StreamRange {
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+
+// Range of the string table
+struct StringRef {
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+
+struct MaterialSlotRecord {
+  StringRef name;
+};
+
+
+struct AnimationRecord {
+  StringRef name;
+  float duration;
+  float ticks_per_second;
+  std::uint32_t first_node_anim;
+  std::uint32_t node_anim_count;
+};
+
+
+// Keys are ranges of the flat key streams
+struct NodeAnimationRecord {
+  std::uint32_t node_idx;
+  std::uint32_t first_position_key;
+  std::uint32_t position_key_count;
+  std::uint32_t first_rotation_key;
+  std::uint32_t rotation_key_count;
+  std::uint32_t first_scaling_key;
+  std::uint32_t scaling_key_count;
+};
+
+
+struct SkeletonNodeRecord {
+  StringRef name;
+  Matrix4 transform;
+  std::uint32_t parent_idx;
+  // Keeps the record free of padding so that blobs are byte for byte reproducible
+  std::uint32_t reserved;
+};
+
+
+// Stream bit in Header::quantized_streams
+[[nodiscard]] constexpr auto GetStreamBit(Stream const stream) noexcept -> std::uint32_t {
+  return 1u << static_cast<std::uint32_t>(stream);
+}
+
+
+// Streams that can be stored in the packed formats of vertex_quantization.hpp
+constexpr std::uint32_t kQuantizableStreams{
+  GetStreamBit(Stream::kPositions) | GetStreamBit(Stream::kNormals) | GetStreamBit(Stream::kTangents) |
+  GetStreamBit(Stream::kUvs) | GetStreamBit(Stream::kBoneWeights) | GetStreamBit(Stream::kBoneIndices)
+};
+
+
+struct Header {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint64_t size;
+  AABB bounds;
+  std::uint32_t idx32;
+  // Positions are quantized to the bounds
+  std::uint32_t quantized_streams;
+  // Blobs older than version 4 end the header after the range of the string table
+  std::array<StreamRange, static_cast<std::size_t>(Stream::kCount)> streams;
+};
+}
+
+
+// Reads a mesh blob in place, e.g. straight from a mapped resource package.
+// Only valid while the underlying bytes are alive. Full MeshData is only built when ToMeshData is called.
+// The getters of quantized vertex streams return empty spans, use the packed getters or the To functions for those.
+// The same goes for the narrow tangents of blobs older than version 3.
+class MeshView {
+public:
+  // Validates the header, the stream ranges and the cross references between the tables
+  [[nodiscard]] SORCERYAPI static auto Parse(std::span<std::byte const> bytes) noexcept -> std::optional<MeshView>;
+  // Only checks the magic number, used to tell blobs apart from meshes serialized before the format existed
+  [[nodiscard]] SORCERYAPI static auto IsMeshBlob(std::span<std::byte const> bytes) noexcept -> bool;
+
+  [[nodiscard]] SORCERYAPI auto GetPositions() const noexcept -> std::span<Vector3 const>;
+  [[nodiscard]] SORCERYAPI auto GetNormals() const noexcept -> std::span<Vector3 const>;
+  [[nodiscard]] SORCERYAPI auto GetTangents() const noexcept -> std::span<Vector4 const>;
+  [[nodiscard]] SORCERYAPI auto GetUvs() const noexcept -> std::span<Vector2 const>;
+  [[nodiscard]] SORCERYAPI auto GetBoneWeights() const noexcept -> std::span<Vector4 const>;
+  [[nodiscard]] SORCERYAPI auto GetBoneIndices() const noexcept -> std::span<Vector<std::uint32_t, 4> const>;
+  [[nodiscard]] SORCERYAPI auto GetMeshlets() const noexcept -> std::span<MeshletData const>;
+  [[nodiscard]] SORCERYAPI auto GetVertexIndices() const noexcept -> std::span<std::uint8_t const>;
+  [[nodiscard]] SORCERYAPI auto GetTriangleIndices() const noexcept -> std::span<MeshletTriangleData const>;
+  [[nodiscard]] SORCERYAPI auto GetCullData() const noexcept -> std::span<MeshletCullData const>;
+  [[nodiscard]] SORCERYAPI auto GetMaterialSlots() const noexcept -> std::span<mesh_blob::MaterialSlotRecord const>;
+  [[nodiscard]] SORCERYAPI auto GetSubmeshes() const noexcept -> std::span<SubmeshData const>;
+  [[nodiscard]] SORCERYAPI auto GetSubmeshLods() const noexcept -> std::span<SubmeshLodData const>;
+  [[nodiscard]] SORCERYAPI auto GetAnimations() const noexcept -> std::span<mesh_blob::AnimationRecord const>;
+  [[nodiscard]] SORCERYAPI auto GetNodeAnimations() const noexcept -> std::span<mesh_blob::NodeAnimationRecord const>;
+  [[nodiscard]] SORCERYAPI auto GetPositionKeys() const noexcept -> std::span<AnimPositionKey const>;
+  [[nodiscard]] SORCERYAPI auto GetRotationKeys() const noexcept -> std::span<AnimRotationKey const>;
+  [[nodiscard]] SORCERYAPI auto GetScalingKeys() const noexcept -> std::span<AnimScalingKey const>;
+  [[nodiscard]] SORCERYAPI auto GetSkeleton() const noexcept -> std::span<mesh_blob::SkeletonNodeRecord const>;
+  [[nodiscard]] SORCERYAPI auto GetBones() const noexcept -> std::span<Bone const>;
+  [[nodiscard]] SORCERYAPI auto GetString(mesh_blob::StringRef const& str) const noexcept -> std::string_view;
+
+  [[nodiscard]] SORCERYAPI auto GetPackedPositions() const noexcept -> std::span<PackedPosition const>;
+  [[nodiscard]] SORCERYAPI auto GetPackedNormals() const noexcept -> std::span<PackedUnitVector const>;
+  [[nodiscard]] SORCERYAPI auto GetPackedTangents() const noexcept -> std::span<PackedUnitVector const>;
+  [[nodiscard]] SORCERYAPI auto GetPackedUvs() const noexcept -> std::span<PackedUv const>;
+  [[nodiscard]] SORCERYAPI auto GetPackedBoneWeights() const noexcept -> std::span<PackedBoneWeights const>;
+  [[nodiscard]] SORCERYAPI auto GetPackedBoneIndices() const noexcept -> std::span<PackedBoneIndices const>;
+
+  [[nodiscard]] SORCERYAPI auto GetBounds() const noexcept -> AABB const&;
+  [[nodiscard]] SORCERYAPI auto Has32BitVertexIndices() const noexcept -> bool;
+  [[nodiscard]] SORCERYAPI auto IsQuantized(mesh_blob::Stream stream) const noexcept -> bool;
+  [[nodiscard]] SORCERYAPI auto GetVertexCount() const noexcept -> std::size_t;
+
+  // Decode quantized streams, copy the rest
+  [[nodiscard]] SORCERYAPI auto ToPositions() const -> std::vector<Vector3>;
+  [[nodiscard]] SORCERYAPI auto ToNormals() const -> std::vector<Vector3>;
+  [[nodiscard]] SORCERYAPI auto ToTangents() const -> std::vector<Vector4>;
+  [[nodiscard]] SORCERYAPI auto ToUvs() const -> std::vector<Vector2>;
+  [[nodiscard]] SORCERYAPI auto ToBoneWeights() const -> std::vector<Vector4>;
+  [[nodiscard]] SORCERYAPI auto ToBoneIndices() const -> std::vector<Vector<std::uint32_t, 4>>;
+
+  [[nodiscard]] SORCERYAPI auto ToMaterialSlots() const -> std::vector<MaterialSlotInfo>;
+  [[nodiscard]] SORCERYAPI auto ToAnimations() const -> std::vector<Animation>;
+  [[nodiscard]] SORCERYAPI auto ToSkeleton() const -> std::vector<SkeletonNode>;
+  [[nodiscard]] SORCERYAPI auto ToMeshData() const -> MeshData;
+
+private:
+  MeshView() = default;
+
+  template<typename T>
+  [[nodiscard]] auto GetStream(mesh_blob::Stream stream) const noexcept -> std::span<T const>;
+  // Empty if the stream is quantized
+  template<typename T>
+  [[nodiscard]] auto GetFloatStream(mesh_blob::Stream stream) const noexcept -> std::span<T const>;
+  // Empty unless the stream is quantized
+  template<typename T>
+  [[nodiscard]] auto GetPackedStream(mesh_blob::Stream stream) const noexcept -> std::span<T const>;
+
+  std::span<std::byte const> bytes_;
+  mesh_blob::Header const* header_{nullptr};
+};
+
+
+// Lays the mesh out as a single blob that MeshView can read without any per-field parsing.
+// Quantized blobs store bone indices at full width if the mesh has more than 256 bones.
+[[nodiscard]] SORCERYAPI auto SerializeMeshBlob(MeshData const& mesh_data,
+                                                bool quantize_vertex_streams = false) -> std::vector<std::byte>;
+
+// Reads meshes serialized field by field, before the blob format existed.
+// Their tangents were stored without handedness and are assumed to be right-handed.
+[[nodiscard]] SORCERYAPI auto DeserializeLegacyMeshData(std::span<std::byte const> bytes) -> std::optional<MeshData>;
+}
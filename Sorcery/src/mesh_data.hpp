@@ -98,12 +98,24 @@ struct SubmeshData {
 };
 
 
+// A simplified version of a submesh that uses the same vertices. LOD 0 is the submesh itself.
+struct SubmeshLodData {
+  std::uint32_t submesh_idx;
+  std::uint32_t first_meshlet;
+  std::uint32_t meshlet_count;
+  // Object space distance between the simplified and the original surface, the sum of the per-collapse distances
+  // along the chain of simplifications. Conservative, so it can be projected to a screen space bound.
+  float error;
+};
+
+
 // A mesh is a list of submeshes, material slots, animations, and a skeleton.
 // Bones refer to the skeleton hierarchy, and animations operate on the nodes of the hierarchy.
 struct MeshData {
   std::vector<Vector3> positions;
   std::vector<Vector3> normals;
-  std::vector<Vector3> tangents;
+  // w holds the handedness of the tangent frame, bitangent = cross(normal, tangent) * w
+  std::vector<Vector4> tangents;
   std::vector<Vector2> uvs;
   std::vector<Vector4> bone_weights;
   std::vector<Vector<std::uint32_t, 4>> bone_indices;
@@ -113,6 +125,8 @@ struct MeshData {
   std::vector<MeshletCullData> cull_data;
   std::vector<MaterialSlotInfo> material_slots;
   std::vector<SubmeshData> submeshes;
+  // Grouped by submesh, increasingly coarse within a group
+  std::vector<SubmeshLodData> submesh_lods;
   std::vector<Animation> animations;
   std::vector<SkeletonNode> skeleton;
   std::vector<Bone> bones;
@@ -0,0 +1,336 @@
+#include "mesh_optimization.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <numeric>
+#include <stdexcept>
+
+
+namespace sorcery {
+namespace {
+// Tuning constants of Forsyth's vertex scoring
+constexpr float kCacheDecayPower{1.5f};
+constexpr float kLastTriangleScore{0.75f};
+constexpr float kValenceBoostScale{2.0f};
+constexpr float kValenceBoostPower{0.5f};
+// Vertices with more remaining triangles than this share the same boost
+constexpr std::size_t kMaxScoredValence{32};
+// The triangle being added temporarily pushes this many extra entries into the simulated cache
+constexpr std::size_t kCacheSlack{3};
+constexpr std::uint32_t kNoTriangle{0xFFFFFFFF};
+
+constexpr std::uint64_t kFnvOffsetBasis{0xCBF29CE484222325};
+constexpr std::uint64_t kFnvPrime{0x100000001B3};
+
+
+[[nodiscard]] auto HashBytes(std::span<std::byte const> const bytes) noexcept -> std::uint64_t {
+  auto hash{kFnvOffsetBasis};
+
+  for (auto const byte : bytes) {
+    hash = (hash ^ static_cast<std::uint64_t>(byte)) * kFnvPrime;
+  }
+
+  return hash;
+}
+
+
+auto ValidateTriangleList(std::span<unsigned const> const indices, std::size_t const vertex_count) -> void {
+  if (indices.size() % 3 != 0) {
+    throw std::runtime_error{
+      std::format("The number of indices ({}) is not divisible by 3. Only triangle lists are supported.", indices.size())
+    };
+  }
+
+  if (auto const it{std::ranges::find_if(indices, [vertex_count](unsigned const idx) {
+    return idx >= vertex_count;
+  })}; it != std::end(indices)) {
+    throw std::runtime_error{
+      std::format("Vertex index {} is out of range, the mesh only has {} vertices.", *it, vertex_count)
+    };
+  }
+}
+
+
+class VertexScoreTable {
+public:
+  VertexScoreTable() {
+    for (std::size_t i{0}; i < cache_scores_.size(); i++) {
+      if (i < 3) {
+        // The vertices of the last triangle get a fixed score so that strips are not favored over fans
+        cache_scores_[i] = kLastTriangleScore;
+      } else if (i < kVertexCacheSize) {
+        auto const scaler{1.0f / static_cast<float>(kVertexCacheSize - 3)};
+        cache_scores_[i] = std::pow(1.0f - static_cast<float>(i - 3) * scaler, kCacheDecayPower);
+      } else {
+        cache_scores_[i] = 0;
+      }
+    }
+
+    valence_scores_[0] = 0;
+
+    for (std::size_t i{1}; i < valence_scores_.size(); i++) {
+      // Vertices with few remaining triangles are boosted to get rid of them quickly
+      valence_scores_[i] = kValenceBoostScale * std::pow(static_cast<float>(i), -kValenceBoostPower);
+    }
+  }
+
+
+  // Vertices outside the cache have a negative position
+  [[nodiscard]] auto GetScore(int const cache_pos, std::size_t const remaining_valence) const noexcept -> float {
+    if (remaining_valence == 0) {
+      return -1.0f;
+    }
+
+    return (cache_pos < 0 ? 0.0f : cache_scores_[cache_pos]) + valence_scores_[
+             std::min(remaining_valence, kMaxScoredValence)];
+  }
+
+private:
+  std::array<float, kVertexCacheSize + kCacheSlack> cache_scores_;
+  std::array<float, kMaxScoredValence + 1> valence_scores_;
+};
+}
+
+
+auto GenerateVertexRemap(std::span<VertexStream const> const streams, std::size_t const vertex_count,
+                         std::vector<std::uint32_t>& out_remap) -> std::size_t {
+  std::size_t vertex_size{0};
+
+  for (auto const& stream : streams) {
+    if (stream.data.size() < stream.stride * vertex_count) {
+      throw std::runtime_error{
+        std::format("Vertex stream of {} bytes is too short for {} vertices with a stride of {}.", stream.data.size(),
+          vertex_count, stream.stride)
+      };
+    }
+
+    vertex_size += stream.stride;
+  }
+
+  // The attributes of each vertex are gathered next to each other so that they can be hashed and compared at once
+  std::vector<std::byte> keys(vertex_count * vertex_size);
+
+  for (std::size_t offset{0}; auto const& stream : streams) {
+    for (std::size_t i{0}; i < vertex_count; i++) {
+      std::memcpy(keys.data() + i * vertex_size + offset, stream.data.data() + i * stream.stride, stream.stride);
+    }
+
+    offset += stream.stride;
+  }
+
+  auto const get_key{
+    [&keys, vertex_size](std::size_t const vertex) {
+      return std::span{keys}.subspan(vertex * vertex_size, vertex_size);
+    }
+  };
+
+  // Open addressing with linear probing, at most half full
+  std::vector<std::uint32_t> table(std::bit_ceil(std::max<std::size_t>(vertex_count * 2, 1)), kUnusedVertex);
+  auto const table_mask{table.size() - 1};
+
+  out_remap.resize(vertex_count);
+  std::size_t unique_count{0};
+
+  for (std::size_t i{0}; i < vertex_count; i++) {
+    auto const key{get_key(i)};
+
+    for (auto slot{HashBytes(key) & table_mask};; slot = (slot + 1) & table_mask) {
+      if (table[slot] == kUnusedVertex) {
+        table[slot] = static_cast<std::uint32_t>(i);
+        out_remap[i] = static_cast<std::uint32_t>(unique_count++);
+        break;
+      }
+
+      if (std::ranges::equal(get_key(table[slot]), key)) {
+        out_remap[i] = out_remap[table[slot]];
+        break;
+      }
+    }
+  }
+
+  return unique_count;
+}
+
+
+auto OptimizeVertexCache(std::span<unsigned> const indices, std::size_t const vertex_count) -> void {
+  ValidateTriangleList(indices, vertex_count);
+
+  auto const tri_count{indices.size() / 3};
+
+  if (tri_count == 0) {
+    return;
+  }
+
+  static VertexScoreTable const score_table;
+
+  // Triangles of each vertex in compressed rows, the first remaining_valence entries of a row are not emitted yet
+  std::vector<std::uint32_t> offsets(vertex_count + 1, 0);
+
+  for (auto const idx : indices) {
+    offsets[idx + 1] += 1;
+  }
+
+  std::inclusive_scan(std::begin(offsets), std::end(offsets), std::begin(offsets));
+
+  std::vector<std::uint32_t> remaining_valence(vertex_count, 0);
+  std::vector<std::uint32_t> adjacent_tris(indices.size());
+
+  for (std::size_t i{0}; i < indices.size(); i++) {
+    adjacent_tris[offsets[indices[i]] + remaining_valence[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+  }
+
+  std::vector<float> vertex_scores(vertex_count);
+
+  for (std::size_t i{0}; i < vertex_count; i++) {
+    vertex_scores[i] = score_table.GetScore(-1, remaining_valence[i]);
+  }
+
+  std::vector<bool> emitted(tri_count, false);
+
+  auto const calculate_tri_score{
+    [&](std::uint32_t const tri) {
+      return vertex_scores[indices[tri * 3]] + vertex_scores[indices[tri * 3 + 1]] +
+             vertex_scores[indices[tri * 3 + 2]];
+    }
+  };
+
+  auto best_tri{kNoTriangle};
+  auto best_score{-1.0f};
+
+  for (std::uint32_t i{0}; i < tri_count; i++) {
+    if (auto const score{calculate_tri_score(i)}; score > best_score) {
+      best_tri = i;
+      best_score = score;
+    }
+  }
+
+  std::vector<std::uint32_t> cache;
+  std::vector<std::uint32_t> new_cache;
+  cache.reserve(kVertexCacheSize + kCacheSlack);
+  new_cache.reserve(kVertexCacheSize + kCacheSlack);
+
+  std::vector<unsigned> optimized_indices;
+  optimized_indices.reserve(indices.size());
+  std::size_t next_unemitted_tri{0};
+
+  for (std::size_t emitted_count{0}; emitted_count < tri_count; emitted_count++) {
+    // Nothing in the cache has remaining triangles, continue in input order
+    if (best_tri == kNoTriangle) {
+      while (emitted[next_unemitted_tri]) {
+        next_unemitted_tri += 1;
+      }
+
+      best_tri = static_cast<std::uint32_t>(next_unemitted_tri);
+    }
+
+    emitted[best_tri] = true;
+    new_cache.clear();
+
+    for (std::size_t i{0}; i < 3; i++) {
+      auto const vertex{indices[best_tri * 3 + i]};
+      optimized_indices.emplace_back(vertex);
+
+      // Degenerate triangles appear in the row of a vertex once per reference
+      auto const row{std::span{adjacent_tris}.subspan(offsets[vertex], remaining_valence[vertex])};
+      std::ranges::iter_swap(std::ranges::find(row, best_tri), std::prev(std::end(row)));
+      remaining_valence[vertex] -= 1;
+
+      if (std::ranges::find(new_cache, vertex) == std::end(new_cache)) {
+        new_cache.emplace_back(vertex);
+      }
+    }
+
+    for (auto const vertex : cache) {
+      if (std::ranges::find(new_cache, vertex) == std::end(new_cache)) {
+        new_cache.emplace_back(vertex);
+      }
+    }
+
+    // Vertices that fall out of the cache lose their cache score
+    for (auto i{std::min(new_cache.size(), kVertexCacheSize)}; i < new_cache.size(); i++) {
+      vertex_scores[new_cache[i]] = score_table.GetScore(-1, remaining_valence[new_cache[i]]);
+    }
+
+    new_cache.resize(std::min(new_cache.size(), kVertexCacheSize));
+    std::swap(cache, new_cache);
+
+    for (std::size_t i{0}; i < cache.size(); i++) {
+      vertex_scores[cache[i]] = score_table.GetScore(static_cast<int>(i), remaining_valence[cache[i]]);
+    }
+
+    best_tri = kNoTriangle;
+    best_score = -1.0f;
+
+    for (auto const vertex : cache) {
+      for (auto const tri : std::span{adjacent_tris}.subspan(offsets[vertex], remaining_valence[vertex])) {
+        if (auto const score{calculate_tri_score(tri)}; score > best_score) {
+          best_tri = tri;
+          best_score = score;
+        }
+      }
+    }
+  }
+
+  std::ranges::copy(optimized_indices, std::begin(indices));
+}
+
+
+auto OptimizeVertexFetch(std::span<unsigned> const indices, std::size_t const vertex_count,
+                         std::vector<std::uint32_t>& out_remap) -> std::size_t {
+  ValidateTriangleList(indices, vertex_count);
+
+  out_remap.assign(vertex_count, kUnusedVertex);
+  std::size_t referenced_count{0};
+
+  for (auto& idx : indices) {
+    if (out_remap[idx] == kUnusedVertex) {
+      out_remap[idx] = static_cast<std::uint32_t>(referenced_count++);
+    }
+
+    idx = out_remap[idx];
+  }
+
+  return referenced_count;
+}
+
+
+auto AnalyzeVertexCache(std::span<unsigned const> const indices, std::size_t const vertex_count,
+                        std::size_t const cache_size) -> VertexCacheStatistics {
+  ValidateTriangleList(indices, vertex_count);
+
+  // A vertex is still cached if fewer than cache_size misses happened since it was last transformed
+  std::vector<std::size_t> timestamps(vertex_count, 0);
+  std::vector<bool> referenced(vertex_count, false);
+  auto time{cache_size + 1};
+  std::size_t miss_count{0};
+  std::size_t referenced_count{0};
+
+  for (auto const idx : indices) {
+    if (time - timestamps[idx] > cache_size) {
+      timestamps[idx] = time++;
+      miss_count += 1;
+    }
+
+    if (!referenced[idx]) {
+      referenced[idx] = true;
+      referenced_count += 1;
+    }
+  }
+
+  return VertexCacheStatistics{
+    .acmr = indices.empty() ? 0.0f : static_cast<float>(miss_count) / static_cast<float>(indices.size() / 3),
+    .atvr = referenced_count == 0 ? 0.0f : static_cast<float>(miss_count) / static_cast<float>(referenced_count)
+  };
+}
+
+
+auto RemapIndices(std::span<unsigned> const indices, std::span<std::uint32_t const> const remap) -> void {
+  for (auto& idx : indices) {
+    idx = remap[idx];
+  }
+}
+}
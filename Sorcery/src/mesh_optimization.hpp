@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Core.hpp"
+
+
+namespace sorcery {
+// Entries of remap tables for vertices that are not referenced by any triangle
+constexpr std::uint32_t kUnusedVertex{0xFFFFFFFF};
+// Post-transform cache size that the triangle order is optimized for and that the statistics simulate
+constexpr std::size_t kVertexCacheSize{32};
+
+
+struct VertexStream {
+  std::span<std::byte const> data;
+  std::size_t stride;
+};
+
+
+struct VertexCacheStatistics {
+  // Average cache miss ratio, transformed vertices per triangle. 0.5 is the ideal for large regular grids, 3 is the worst.
+  float acmr;
+  // Average transform to vertex ratio, transformed vertices per vertex. 1 is ideal.
+  float atvr;
+};
+
+
+// Maps every vertex to the first vertex whose attributes are bitwise identical in all streams.
+// Unique vertices keep their relative order. Returns the number of unique vertices.
+LEOPPHAPI auto GenerateVertexRemap(std::span<VertexStream const> streams, std::size_t vertex_count,
+                                   std::vector<std::uint32_t>& out_remap) -> std::size_t;
+
+// Reorders the triangles of a triangle list in place to reuse recently transformed vertices, using Forsyth's algorithm
+LEOPPHAPI auto OptimizeVertexCache(std::span<unsigned> indices, std::size_t vertex_count) -> void;
+
+// Renumbers the vertices in the order the triangles first reference them and rewrites the indices accordingly.
+// Returns the number of referenced vertices, the rest are mapped to kUnusedVertex.
+LEOPPHAPI auto OptimizeVertexFetch(std::span<unsigned> indices, std::size_t vertex_count,
+                                   std::vector<std::uint32_t>& out_remap) -> std::size_t;
+
+// Simulates a FIFO cache of the given size
+[[nodiscard]] LEOPPHAPI auto AnalyzeVertexCache(std::span<unsigned const> indices, std::size_t vertex_count,
+                                                std::size_t cache_size = kVertexCacheSize) -> VertexCacheStatistics;
+
+LEOPPHAPI auto RemapIndices(std::span<unsigned> indices, std::span<std::uint32_t const> remap) -> void;
+
+// Moves every vertex to its remapped position and drops unused ones
+template<typename T>
+auto RemapVertices(std::vector<T>& vertices, std::span<std::uint32_t const> remap, std::size_t unique_count) -> void;
+}
+
+
+#include "mesh_optimization.inl"
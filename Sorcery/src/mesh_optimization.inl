@@ -0,0 +1,20 @@
+#pragma once
+
+#include <utility>
+
+
+namespace sorcery {
+template<typename T>
+auto RemapVertices(std::vector<T>& vertices, std::span<std::uint32_t const> const remap,
+                   std::size_t const unique_count) -> void {
+  std::vector<T> remapped(unique_count);
+
+  for (std::size_t i{0}; i < vertices.size(); i++) {
+    if (remap[i] != kUnusedVertex) {
+      remapped[remap[i]] = vertices[i];
+    }
+  }
+
+  vertices = std::move(remapped);
+}
+}
@@ -0,0 +1,342 @@
+#include "mesh_simplification.hpp"
+
+#include "mesh_optimization.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <numeric>
+#include <stdexcept>
+
+
+namespace sorcery {
+namespace {
+// Collapses are rejected if they turn any remaining triangle further than this, measured as the cosine of the angle
+constexpr float kMinCollapseNormalDot{0.01f};
+
+
+// Sum of the squared distances to a set of area weighted planes
+class Quadric {
+public:
+  Quadric() = default;
+
+
+  Quadric(Vector3 const& p0, Vector3 const& p1, Vector3 const& p2) noexcept {
+    auto const normal{Cross(p1 - p0, p2 - p0)};
+    auto const double_area{Length(normal)};
+
+    if (double_area == 0) {
+      return;
+    }
+
+    std::array<double, 4> const plane{
+      normal[0] / double_area, normal[1] / double_area, normal[2] / double_area,
+      -Dot(normal, p0) / double_area
+    };
+
+    auto const area{static_cast<double>(double_area) * 0.5};
+
+    for (std::size_t i{0}, k{0}; i < 4; i++) {
+      for (auto j{i}; j < 4; j++) {
+        coeffs_[k++] = plane[i] * plane[j] * area;
+      }
+    }
+
+    weight_ = area;
+  }
+
+
+  auto operator+=(Quadric const& other) noexcept -> Quadric& {
+    for (std::size_t i{0}; i < coeffs_.size(); i++) {
+      coeffs_[i] += other.coeffs_[i];
+    }
+
+    weight_ += other.weight_;
+    return *this;
+  }
+
+
+  [[nodiscard]] auto operator+(Quadric const& other) const noexcept -> Quadric {
+    auto ret{*this};
+    ret += other;
+    return ret;
+  }
+
+
+  // Mean squared distance to the planes, weighted by their areas
+  [[nodiscard]] auto Evaluate(Vector3 const& point) const noexcept -> float {
+    if (weight_ == 0) {
+      return 0;
+    }
+
+    std::array<double, 4> const p{point[0], point[1], point[2], 1};
+    double sum{0};
+
+    for (std::size_t i{0}, k{0}; i < 4; i++) {
+      for (auto j{i}; j < 4; j++) {
+        sum += coeffs_[k++] * p[i] * p[j] * (i == j ? 1 : 2);
+      }
+    }
+
+    return static_cast<float>(std::max(sum / weight_, 0.0));
+  }
+
+private:
+  // Upper triangle of the symmetric 4x4 matrix
+  std::array<double, 10> coeffs_{};
+  double weight_{0};
+};
+
+
+struct Collapse {
+  float cost;
+  std::uint32_t from;
+  std::uint32_t to;
+};
+}
+
+
+auto SimplifyMesh(std::span<unsigned const> const indices, std::span<Vector3 const> const positions,
+                  std::size_t const target_index_count, float const max_error,
+                  std::vector<unsigned>& out_indices) -> float {
+  if (indices.size() % 3 != 0) {
+    throw std::runtime_error{
+      std::format("The number of indices ({}) is not divisible by 3. Only triangle lists are supported.", indices.size())
+    };
+  }
+
+  if (auto const it{std::ranges::find_if(indices, [&positions](unsigned const idx) {
+    return idx >= positions.size();
+  })}; it != std::end(indices)) {
+    throw std::runtime_error{
+      std::format("Vertex index {} is out of range, the mesh only has {} vertices.", *it, positions.size())
+    };
+  }
+
+  out_indices.assign(std::begin(indices), std::end(indices));
+
+  if (out_indices.size() <= target_index_count) {
+    return 0;
+  }
+
+  auto const vertex_count{positions.size()};
+
+  // Vertices split along attribute seams share their position and form a group
+
+  std::vector<std::uint32_t> groups;
+  auto const group_count{
+    GenerateVertexRemap(std::array{VertexStream{std::as_bytes(positions), sizeof(Vector3)}}, vertex_count, groups)
+  };
+
+  std::vector<std::uint32_t> group_sizes(group_count, 0);
+
+  for (auto const group : groups) {
+    group_sizes[group] += 1;
+  }
+
+  std::vector<bool> locked(vertex_count, false);
+
+  for (std::size_t i{0}; i < vertex_count; i++) {
+    locked[i] = group_sizes[groups[i]] > 1;
+  }
+
+  // Edges without a single opposite edge are on a border or are non-manifold
+
+  std::vector<std::uint64_t> edges;
+  edges.reserve(out_indices.size());
+
+  for (std::size_t i{0}; i < out_indices.size(); i += 3) {
+    for (std::size_t j{0}; j < 3; j++) {
+      std::uint64_t const from{groups[out_indices[i + j]]};
+      std::uint64_t const to{groups[out_indices[i + (j + 1) % 3]]};
+      edges.emplace_back(from << 32 | to);
+    }
+  }
+
+  std::ranges::sort(edges);
+
+  auto const count_edges{
+    [&edges](std::uint64_t const from_group, std::uint64_t const to_group) {
+      return std::ranges::equal_range(edges, from_group << 32 | to_group).size();
+    }
+  };
+
+  for (std::size_t i{0}; i < out_indices.size(); i += 3) {
+    for (std::size_t j{0}; j < 3; j++) {
+      auto const from{out_indices[i + j]};
+      auto const to{out_indices[i + (j + 1) % 3]};
+
+      if (count_edges(groups[from], groups[to]) != 1 || count_edges(groups[to], groups[from]) != 1) {
+        locked[from] = true;
+        locked[to] = true;
+      }
+    }
+  }
+
+  edges.clear();
+  edges.shrink_to_fit();
+
+  std::vector<Quadric> quadrics(group_count);
+
+  for (std::size_t i{0}; i < out_indices.size(); i += 3) {
+    Quadric const quadric{
+      positions[out_indices[i]], positions[out_indices[i + 1]], positions[out_indices[i + 2]]
+    };
+
+    for (std::size_t j{0}; j < 3; j++) {
+      quadrics[groups[out_indices[i + j]]] += quadric;
+    }
+  }
+
+  // Distance between the surface around a vertex and the original surface, accumulated over the collapses into it
+  std::vector<float> group_errors(group_count, 0);
+  auto error{0.0f};
+
+  std::vector<std::uint32_t> offsets(vertex_count + 1);
+  std::vector<std::uint32_t> adjacent_tris;
+  std::vector<Collapse> collapses;
+  std::vector<std::uint32_t> targets(vertex_count);
+  std::vector<bool> touched;
+
+  // Each pass collapses an independent set of the cheapest edges
+  while (out_indices.size() > target_index_count) {
+    std::ranges::fill(offsets, 0);
+
+    for (auto const idx : out_indices) {
+      offsets[idx + 1] += 1;
+    }
+
+    std::inclusive_scan(std::begin(offsets), std::end(offsets), std::begin(offsets));
+    adjacent_tris.resize(out_indices.size());
+
+    for (std::size_t i{0}; i < out_indices.size(); i++) {
+      adjacent_tris[offsets[out_indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+    }
+
+    std::shift_right(std::begin(offsets), std::end(offsets), 1);
+    offsets[0] = 0;
+
+    // Interior edges appear in both directions, so every edge is only considered once
+
+    collapses.clear();
+
+    for (std::size_t i{0}; i < out_indices.size(); i += 3) {
+      for (std::size_t j{0}; j < 3; j++) {
+        auto const v0{out_indices[i + j]};
+        auto const v1{out_indices[i + (j + 1) % 3]};
+
+        if (v0 > v1 || (locked[v0] && locked[v1])) {
+          continue;
+        }
+
+        auto const quadric{quadrics[groups[v0]] + quadrics[groups[v1]]};
+        auto const cost01{quadric.Evaluate(positions[v1])};
+        auto const cost10{quadric.Evaluate(positions[v0])};
+
+        if (!locked[v0] && (locked[v1] || cost01 <= cost10)) {
+          collapses.emplace_back(cost01, v0, v1);
+        } else {
+          collapses.emplace_back(cost10, v1, v0);
+        }
+      }
+    }
+
+    std::ranges::sort(collapses, {}, &Collapse::cost);
+
+    std::iota(std::begin(targets), std::end(targets), 0);
+    touched.assign(vertex_count, false);
+
+    if (collapses.empty()) {
+      break;
+    }
+
+    // A collapse removes two triangles in the interior, this avoids overshooting the target much
+    auto const collapse_limit{std::max<std::size_t>((out_indices.size() - target_index_count) / 6, 1)};
+    // Edges blocked by an earlier collapse of the pass are not replaced by more expensive ones, they get another chance
+    // in the next pass with updated costs instead
+    auto const pass_max_cost{collapses[std::min(collapse_limit, collapses.size()) - 1].cost};
+    std::size_t collapse_count{0};
+
+    for (auto const& [cost, from, to] : collapses) {
+      if (cost > pass_max_cost || collapse_count == collapse_limit) {
+        break;
+      }
+
+      if (touched[from] || touched[to]) {
+        continue;
+      }
+
+      // Largest distance that the collapse moves the remaining triangles of the removed vertex along their normals
+      auto distance{0.0f};
+      auto flips{false};
+
+      for (auto const tri : std::span{adjacent_tris}.subspan(offsets[from], offsets[from + 1] - offsets[from])) {
+        std::array<Vector3, 3> old_corners;
+        std::array<Vector3, 3> new_corners;
+        auto degenerates{false};
+
+        for (std::size_t j{0}; j < 3; j++) {
+          auto const vertex{out_indices[tri * 3 + j]};
+          degenerates = degenerates || groups[vertex] == groups[to];
+          old_corners[j] = positions[targets[vertex]];
+          new_corners[j] = vertex == from ? positions[to] : old_corners[j];
+        }
+
+        auto const old_normal{Cross(old_corners[1] - old_corners[0], old_corners[2] - old_corners[0])};
+        auto const old_length{Length(old_normal)};
+
+        if (degenerates || old_length == 0) {
+          continue;
+        }
+
+        auto const new_normal{Cross(new_corners[1] - new_corners[0], new_corners[2] - new_corners[0])};
+
+        if (Dot(old_normal, new_normal) <= kMinCollapseNormalDot * old_length * Length(new_normal)) {
+          flips = true;
+          break;
+        }
+
+        distance = std::max(distance, std::abs(Dot(old_normal, positions[to] - positions[from])) / old_length);
+      }
+
+      // Moving already displaced triangles adds to their displacement
+      auto const collapse_error{std::max(group_errors[groups[from]], group_errors[groups[to]]) + distance};
+
+      if (flips || collapse_error > max_error) {
+        continue;
+      }
+
+      targets[from] = to;
+      touched[from] = true;
+      touched[to] = true;
+      quadrics[groups[to]] += quadrics[groups[from]];
+      group_errors[groups[to]] = collapse_error;
+      error = std::max(error, collapse_error);
+      collapse_count += 1;
+    }
+
+    if (collapse_count == 0) {
+      break;
+    }
+
+    // Drop the triangles that became degenerate
+
+    std::size_t kept_index_count{0};
+
+    for (std::size_t i{0}; i < out_indices.size(); i += 3) {
+      std::array const tri{targets[out_indices[i]], targets[out_indices[i + 1]], targets[out_indices[i + 2]]};
+
+      if (groups[tri[0]] != groups[tri[1]] && groups[tri[1]] != groups[tri[2]] && groups[tri[2]] != groups[tri[0]]) {
+        std::ranges::copy(tri, std::begin(out_indices) + kept_index_count);
+        kept_index_count += 3;
+      }
+    }
+
+    out_indices.resize(kept_index_count);
+  }
+
+  return error;
+}
+}
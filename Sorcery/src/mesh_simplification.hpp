@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "Core.hpp"
+#include "Math.hpp"
+
+
+namespace sorcery {
+// Collapses the edges of a triangle list in the order of their quadric error until the index count drops to the target
+// or no edge can be collapsed within the error limit. The remaining triangles reference the original vertices.
+// Vertices on open borders and attribute seams, i.e. the ones sharing their position with other vertices, stay in place.
+// Collapses are ordered by their quadric error, but limited by and measured in the object space distance that they move
+// the surface along its normals, summed over the collapses that move the same part of the surface. Returns the largest
+// such distance, a conservative estimate of how far the simplified surface is from the original one.
+[[nodiscard]] LEOPPHAPI auto SimplifyMesh(std::span<unsigned const> indices, std::span<Vector3 const> positions,
+                                          std::size_t target_index_count, float max_error,
+                                          std::vector<unsigned>& out_indices) -> float;
+}
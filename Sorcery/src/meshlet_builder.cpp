@@ -0,0 +1,510 @@
+#include "meshlet_builder.hpp"
+
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+
+namespace sorcery {
+namespace {
+constexpr std::uint16_t kNoSlot{0xFFFF};
+constexpr std::uint32_t kNoTriangle{0xFFFFFFFF};
+// Cones that are wider than this cannot cull enough to be worth testing
+constexpr float kMinConeCosine{0.1f};
+constexpr std::uint8_t kDegenerateConeCutoff{0xFF};
+constexpr float kUnorm8Max{255.0f};
+constexpr float kMortonGridSize{1023.0f};
+
+
+// Interleaves the lower 10 bits with two zero bits each
+[[nodiscard]] auto SpreadBits(std::uint32_t x) noexcept -> std::uint32_t {
+  x &= 0x3FF;
+  x = (x | x << 16) & 0x030000FF;
+  x = (x | x << 8) & 0x0300F00F;
+  x = (x | x << 4) & 0x030C30C3;
+  x = (x | x << 2) & 0x09249249;
+  return x;
+}
+
+
+// Zero for degenerate triangles
+[[nodiscard]] auto CalculateFaceNormal(Vector3 const& p0, Vector3 const& p1, Vector3 const& p2) noexcept -> Vector3 {
+  auto const normal{Cross(p1 - p0, p2 - p0)};
+  auto const length{Length(normal)};
+  return length > 0 ? normal / length : Vector3{0};
+}
+
+
+struct PartitionMeshlets {
+  std::vector<MeshletData> meshlets;
+  std::vector<std::uint32_t> vertex_indices;
+  std::vector<MeshletTriangleData> triangles;
+  std::vector<MeshletCullData> cull_data;
+};
+
+
+class PartitionBuilder {
+public:
+  PartitionBuilder(std::span<std::uint32_t const> const indices, std::span<Vector3 const> const positions,
+                   std::span<std::uint32_t const> const triangles, std::span<Vector3 const> const centroids,
+                   std::uint16_t const max_verts, std::uint16_t const max_prims) :
+    indices_{indices},
+    positions_{positions},
+    triangles_{triangles},
+    centroids_{centroids},
+    max_verts_{max_verts},
+    max_prims_{max_prims} {}
+
+
+  [[nodiscard]] auto Build() -> PartitionMeshlets {
+    BuildAdjacency();
+
+    slots_.assign(local_vertices_.size(), kNoSlot);
+    emitted_.assign(triangles_.size(), false);
+    candidate_stamps_.assign(triangles_.size(), kNoTriangle);
+    normals_.resize(triangles_.size());
+
+    for (std::size_t i{0}; i < triangles_.size(); i++) {
+      normals_[i] = CalculateFaceNormal(positions_[indices_[triangles_[i] * 3]],
+        positions_[indices_[triangles_[i] * 3 + 1]], positions_[indices_[triangles_[i] * 3 + 2]]);
+    }
+
+    std::size_t next_seed{0};
+
+    for (std::size_t emitted_count{0}; emitted_count < triangles_.size(); emitted_count++) {
+      auto tri{FindBestCandidate()};
+
+      // Nothing adjacent is left, continue with the next triangle along the space filling curve
+      if (tri == kNoTriangle) {
+        while (emitted_[next_seed]) {
+          next_seed += 1;
+        }
+
+        tri = static_cast<std::uint32_t>(next_seed);
+      }
+
+      if (cur_verts_.size() + CountNewVertices(tri) > max_verts_ || cur_tris_.size() + 1 > max_prims_) {
+        Flush();
+      }
+
+      Add(tri);
+    }
+
+    Flush();
+    return std::move(out_);
+  }
+
+private:
+  // Sorting the corners by vertex yields both the local vertex indices and the rows of the adjacency
+  auto BuildAdjacency() -> void {
+    std::vector<std::uint64_t> keys(triangles_.size() * 3);
+
+    for (std::size_t i{0}; i < keys.size(); i++) {
+      keys[i] = static_cast<std::uint64_t>(indices_[triangles_[i / 3] * 3 + i % 3]) << 32 | i;
+    }
+
+    std::ranges::sort(keys);
+
+    corners_.resize(keys.size());
+    adjacent_tris_.resize(keys.size());
+    offsets_.clear();
+
+    for (std::size_t i{0}; i < keys.size(); i++) {
+      auto const vertex{static_cast<std::uint32_t>(keys[i] >> 32)};
+      auto const corner{static_cast<std::uint32_t>(keys[i])};
+
+      if (local_vertices_.empty() || local_vertices_.back() != vertex) {
+        local_vertices_.emplace_back(vertex);
+        offsets_.emplace_back(static_cast<std::uint32_t>(i));
+      }
+
+      corners_[corner] = static_cast<std::uint32_t>(local_vertices_.size() - 1);
+      adjacent_tris_[i] = corner / 3;
+    }
+
+    offsets_.emplace_back(static_cast<std::uint32_t>(keys.size()));
+  }
+
+
+  [[nodiscard]] auto CountNewVertices(std::uint32_t const tri) const noexcept -> std::size_t {
+    auto const c0{corners_[tri * 3]};
+    auto const c1{corners_[tri * 3 + 1]};
+    auto const c2{corners_[tri * 3 + 2]};
+
+    return static_cast<std::size_t>(slots_[c0] == kNoSlot) + (slots_[c1] == kNoSlot && c1 != c0) + (
+             slots_[c2] == kNoSlot && c2 != c0 && c2 != c1);
+  }
+
+
+  // Prefers triangles that need the fewest new vertices, then the ones closest to the meshlet that face its way.
+  // Removes the returned triangle from the candidates, the rest of them can only be emitted through this function.
+  [[nodiscard]] auto FindBestCandidate() -> std::uint32_t {
+    auto best_candidate_idx{candidates_.size()};
+    auto best_new_vert_count{std::numeric_limits<std::size_t>::max()};
+    auto best_score{std::numeric_limits<float>::max()};
+
+    auto const center{cur_centroid_sum_ / static_cast<float>(std::max<std::size_t>(cur_tris_.size(), 1))};
+    auto const normal_sum_length{Length(cur_normal_sum_)};
+    auto const axis{normal_sum_length > 0 ? cur_normal_sum_ / normal_sum_length : Vector3{0}};
+
+    for (std::size_t i{0}; i < candidates_.size(); i++) {
+      auto const tri{candidates_[i]};
+      auto const new_vert_count{CountNewVertices(tri)};
+
+      if (new_vert_count > best_new_vert_count) {
+        continue;
+      }
+
+      auto const to_center{centroids_[triangles_[tri]] - center};
+      auto const score{Dot(to_center, to_center) * (1.0f + kMeshletConeWeight * (1.0f - Dot(normals_[tri], axis)))};
+
+      if (new_vert_count < best_new_vert_count || score < best_score) {
+        best_candidate_idx = i;
+        best_new_vert_count = new_vert_count;
+        best_score = score;
+      }
+    }
+
+    if (best_candidate_idx == candidates_.size()) {
+      return kNoTriangle;
+    }
+
+    auto const best_tri{candidates_[best_candidate_idx]};
+    candidates_[best_candidate_idx] = candidates_.back();
+    candidates_.pop_back();
+    return best_tri;
+  }
+
+
+  auto Add(std::uint32_t const tri) -> void {
+    // Before the neighbors are collected, so that the triangle does not end up among its own candidates
+    emitted_[tri] = true;
+    std::array<std::uint32_t, 3> tri_slots{};
+
+    for (std::size_t i{0}; i < 3; i++) {
+      auto const vertex{corners_[tri * 3 + i]};
+
+      if (slots_[vertex] == kNoSlot) {
+        slots_[vertex] = static_cast<std::uint16_t>(cur_verts_.size());
+        cur_verts_.emplace_back(vertex);
+
+        for (auto j{offsets_[vertex]}; j < offsets_[vertex + 1]; j++) {
+          if (auto const adjacent_tri{adjacent_tris_[j]};
+            !emitted_[adjacent_tri] && candidate_stamps_[adjacent_tri] != meshlet_stamp_) {
+            candidate_stamps_[adjacent_tri] = meshlet_stamp_;
+            candidates_.emplace_back(adjacent_tri);
+          }
+        }
+      }
+
+      tri_slots[i] = slots_[vertex];
+    }
+
+    cur_tris_.emplace_back(MeshletTriangleData{.idx0 = tri_slots[0], .idx1 = tri_slots[1], .idx2 = tri_slots[2]});
+    cur_centroid_sum_ += centroids_[triangles_[tri]];
+    cur_normal_sum_ += normals_[tri];
+  }
+
+
+  auto Flush() -> void {
+    if (cur_tris_.empty()) {
+      return;
+    }
+
+    auto const vert_offset{out_.vertex_indices.size()};
+    auto const prim_offset{out_.triangles.size()};
+
+    out_.meshlets.emplace_back(MeshletData{
+      .vert_count = static_cast<std::uint32_t>(cur_verts_.size()),
+      .vert_offset = static_cast<std::uint32_t>(vert_offset),
+      .prim_count = static_cast<std::uint32_t>(cur_tris_.size()),
+      .prim_offset = static_cast<std::uint32_t>(prim_offset)
+    });
+
+    for (auto const vertex : cur_verts_) {
+      out_.vertex_indices.emplace_back(local_vertices_[vertex]);
+      slots_[vertex] = kNoSlot;
+    }
+
+    out_.triangles.insert(std::end(out_.triangles), std::begin(cur_tris_), std::end(cur_tris_));
+    out_.cull_data.emplace_back(CalculateMeshletCullData(positions_,
+      std::span{out_.vertex_indices}.subspan(vert_offset), std::span{out_.triangles}.subspan(prim_offset)));
+
+    cur_verts_.clear();
+    cur_tris_.clear();
+    cur_centroid_sum_ = Vector3{0};
+    cur_normal_sum_ = Vector3{0};
+    candidates_.clear();
+    meshlet_stamp_ += 1;
+  }
+
+
+  std::span<std::uint32_t const> indices_;
+  std::span<Vector3 const> positions_;
+  // Global triangle indices in Morton order, everything else is indexed by the position in this list
+  std::span<std::uint32_t const> triangles_;
+  std::span<Vector3 const> centroids_;
+  std::uint16_t max_verts_;
+  std::uint16_t max_prims_;
+
+  // Sorted global indices of the vertices referenced by the partition
+  std::vector<std::uint32_t> local_vertices_;
+  // Local vertex indices of the triangle corners
+  std::vector<std::uint32_t> corners_;
+  std::vector<std::uint32_t> offsets_;
+  std::vector<std::uint32_t> adjacent_tris_;
+  std::vector<Vector3> normals_;
+
+  // Position of the vertex in the current meshlet
+  std::vector<std::uint16_t> slots_;
+  std::vector<bool> emitted_;
+  // Triangles are only added to the candidates once per meshlet
+  std::vector<std::uint32_t> candidate_stamps_;
+  std::uint32_t meshlet_stamp_{0};
+  std::vector<std::uint32_t> candidates_;
+
+  std::vector<std::uint32_t> cur_verts_;
+  std::vector<MeshletTriangleData> cur_tris_;
+  Vector3 cur_centroid_sum_{0};
+  Vector3 cur_normal_sum_{0};
+
+  PartitionMeshlets out_;
+};
+}
+
+
+auto BuildMeshlets(std::span<std::uint32_t const> const indices, std::span<Vector3 const> const positions,
+                   std::vector<MeshletData>& out_meshlets, std::vector<std::uint32_t>& out_vertex_indices,
+                   std::vector<MeshletTriangleData>& out_triangles, std::vector<MeshletCullData>& out_cull_data,
+                   std::uint16_t const max_verts_per_meshlet, std::uint16_t const max_prims_per_meshlet,
+                   ObserverPtr<JobSystem> const job_system) -> bool {
+  if (max_verts_per_meshlet < 3 || max_verts_per_meshlet > kMeshletVertexLimit || max_prims_per_meshlet < 1 ||
+      indices.size() % 3 != 0 || std::ranges::any_of(indices, [&positions](std::uint32_t const idx) {
+        return idx >= positions.size();
+      })) {
+    return false;
+  }
+
+  out_meshlets.clear();
+  out_vertex_indices.clear();
+  out_triangles.clear();
+  out_cull_data.clear();
+
+  auto const tri_count{indices.size() / 3};
+
+  std::vector<Vector3> centroids(tri_count);
+  Vector3 centroid_min{std::numeric_limits<float>::max()};
+  Vector3 centroid_max{std::numeric_limits<float>::lowest()};
+
+  for (std::size_t i{0}; i < tri_count; i++) {
+    centroids[i] = (positions[indices[i * 3]] + positions[indices[i * 3 + 1]] + positions[indices[i * 3 + 2]]) / 3.0f;
+
+    for (std::size_t j{0}; j < 3; j++) {
+      centroid_min[j] = std::min(centroid_min[j], centroids[i][j]);
+      centroid_max[j] = std::max(centroid_max[j], centroids[i][j]);
+    }
+  }
+
+  // The triangle index in the lower half makes the order total
+  std::vector<std::uint64_t> keys(tri_count);
+  auto const extent{centroid_max - centroid_min};
+  auto const max_extent{std::max({extent[0], extent[1], extent[2]})};
+  auto const grid_scale{max_extent > 0 ? kMortonGridSize / max_extent : 0.0f};
+
+  for (std::size_t i{0}; i < tri_count; i++) {
+    auto const cell{(centroids[i] - centroid_min) * grid_scale};
+    auto const to_grid{
+      [](float const coord) {
+        return static_cast<std::uint32_t>(std::min(coord, kMortonGridSize));
+      }
+    };
+    auto const code{SpreadBits(to_grid(cell[0])) | SpreadBits(to_grid(cell[1])) << 1 | SpreadBits(to_grid(cell[2])) << 2};
+    keys[i] = static_cast<std::uint64_t>(code) << 32 | i;
+  }
+
+  std::ranges::sort(keys);
+
+  std::vector<std::uint32_t> sorted_tris(tri_count);
+  std::ranges::transform(keys, std::begin(sorted_tris), [](std::uint64_t const key) {
+    return static_cast<std::uint32_t>(key);
+  });
+
+  auto const partition_count{(tri_count + kMeshletPartitionSize - 1) / kMeshletPartitionSize};
+  std::vector<PartitionMeshlets> partitions(partition_count);
+
+  auto const build_partition{
+    [&](std::size_t const partition_idx) {
+      auto const first_tri{partition_idx * kMeshletPartitionSize};
+      partitions[partition_idx] = PartitionBuilder{
+        indices, positions,
+        std::span{sorted_tris}.subspan(first_tri, std::min<std::size_t>(kMeshletPartitionSize, tri_count - first_tri)),
+        centroids, max_verts_per_meshlet, max_prims_per_meshlet
+      }.Build();
+    }
+  };
+
+  if (job_system) {
+    job_system->ParallelFor(0, partition_count, build_partition, 1);
+  } else {
+    for (std::size_t i{0}; i < partition_count; i++) {
+      build_partition(i);
+    }
+  }
+
+  for (auto const& partition : partitions) {
+    auto const vert_offset{static_cast<std::uint32_t>(out_vertex_indices.size())};
+    auto const prim_offset{static_cast<std::uint32_t>(out_triangles.size())};
+
+    for (auto meshlet : partition.meshlets) {
+      meshlet.vert_offset += vert_offset;
+      meshlet.prim_offset += prim_offset;
+      out_meshlets.emplace_back(meshlet);
+    }
+
+    out_vertex_indices.insert(std::end(out_vertex_indices), std::begin(partition.vertex_indices),
+      std::end(partition.vertex_indices));
+    out_triangles.insert(std::end(out_triangles), std::begin(partition.triangles), std::end(partition.triangles));
+    out_cull_data.insert(std::end(out_cull_data), std::begin(partition.cull_data), std::end(partition.cull_data));
+  }
+
+  return true;
+}
+
+
+auto CalculateMeshletCullData(std::span<Vector3 const> const positions,
+                              std::span<std::uint32_t const> const vertex_indices,
+                              std::span<MeshletTriangleData const> const triangles) noexcept -> MeshletCullData {
+  MeshletCullData cull_data{
+    .bounding_sphere = BoundingSphere{Vector3{0}, 0},
+    .normal_cone = Vector<std::uint8_t, 4>{0, 0, 0, kDegenerateConeCutoff},
+    .apex_offset = 0
+  };
+
+  if (vertex_indices.empty()) {
+    return cull_data;
+  }
+
+  // Ritter's bounding sphere, seeded with the most distant pair of the extremal points along the axes
+
+  std::array<std::uint32_t, 3> min_vertices{};
+  std::array<std::uint32_t, 3> max_vertices{};
+
+  for (std::uint32_t i{0}; i < vertex_indices.size(); i++) {
+    auto const& pos{positions[vertex_indices[i]]};
+
+    for (std::size_t j{0}; j < 3; j++) {
+      if (pos[j] < positions[vertex_indices[min_vertices[j]]][j]) {
+        min_vertices[j] = i;
+      }
+
+      if (pos[j] > positions[vertex_indices[max_vertices[j]]][j]) {
+        max_vertices[j] = i;
+      }
+    }
+  }
+
+  std::size_t seed_axis{0};
+  auto seed_distance{0.0f};
+
+  for (std::size_t j{0}; j < 3; j++) {
+    if (auto const distance{
+      Length(positions[vertex_indices[max_vertices[j]]] - positions[vertex_indices[min_vertices[j]]])
+    }; distance > seed_distance) {
+      seed_axis = j;
+      seed_distance = distance;
+    }
+  }
+
+  auto center{
+    (positions[vertex_indices[min_vertices[seed_axis]]] + positions[vertex_indices[max_vertices[seed_axis]]]) * 0.5f
+  };
+  auto radius{seed_distance * 0.5f};
+
+  for (auto const vertex : vertex_indices) {
+    if (auto const distance{Length(positions[vertex] - center)}; distance > radius) {
+      auto const new_radius{(radius + distance) * 0.5f};
+      center += (positions[vertex] - center) * ((new_radius - radius) / distance);
+      radius = new_radius;
+    }
+  }
+
+  // Growing the sphere is not exact in floating point
+  for (auto const vertex : vertex_indices) {
+    radius = std::max(radius, Length(positions[vertex] - center));
+  }
+
+  cull_data.bounding_sphere = BoundingSphere{center, radius};
+
+  // Normal cone around the average normal
+
+  auto const get_triangle_positions{
+    [&positions, &vertex_indices](MeshletTriangleData const& tri) {
+      return std::array{
+        positions[vertex_indices[tri.idx0]], positions[vertex_indices[tri.idx1]], positions[vertex_indices[tri.idx2]]
+      };
+    }
+  };
+
+  Vector3 normal_sum{0};
+
+  for (auto const& tri : triangles) {
+    auto const [p0, p1, p2]{get_triangle_positions(tri)};
+    normal_sum += CalculateFaceNormal(p0, p1, p2);
+  }
+
+  if (Length(normal_sum) <= 0) {
+    return cull_data;
+  }
+
+  // The cone is built around the quantized axis that the shaders see
+  Vector<std::uint8_t, 4> packed_cone;
+  Vector3 axis;
+
+  for (std::size_t j{0}; j < 3; j++) {
+    packed_cone[j] = static_cast<std::uint8_t>(std::nearbyint(
+      std::clamp(Normalized(normal_sum)[j] * 0.5f + 0.5f, 0.0f, 1.0f) * kUnorm8Max));
+    axis[j] = static_cast<float>(packed_cone[j]) / kUnorm8Max * 2.0f - 1.0f;
+  }
+
+  if (Length(axis) <= 0) {
+    return cull_data;
+  }
+
+  axis = Normalized(axis);
+  auto min_cosine{1.0f};
+  auto apex_offset{0.0f};
+
+  for (auto const& tri : triangles) {
+    auto const [p0, p1, p2]{get_triangle_positions(tri)};
+    auto const normal{CalculateFaceNormal(p0, p1, p2)};
+
+    if (Length(normal) <= 0) {
+      continue;
+    }
+
+    auto const cosine{Dot(axis, normal)};
+    min_cosine = std::min(min_cosine, cosine);
+
+    // Distance along the axis behind the center where the triangle turns its back
+    if (cosine > 0) {
+      apex_offset = std::max(apex_offset, Dot(center - p0, normal) / cosine);
+    }
+  }
+
+  if (min_cosine <= kMinConeCosine) {
+    return cull_data;
+  }
+
+  // The shaders cull if the view direction is within the inverted cone widened by 90 degrees, which is sin of the angle.
+  // Rounding up keeps the quantized cone conservative.
+  auto const cutoff{std::sqrt(1.0f - min_cosine * min_cosine)};
+  packed_cone[3] = static_cast<std::uint8_t>(std::min(kUnorm8Max, std::ceil(cutoff * kUnorm8Max)));
+
+  cull_data.normal_cone = packed_cone;
+  cull_data.apex_offset = apex_offset;
+  return cull_data;
+}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Core.hpp"
+#include "Math.hpp"
+#include "mesh_data.hpp"
+#include "observer_ptr.hpp"
+
+
+namespace sorcery {
+class JobSystem;
+
+
+// Triangles of a single meshlet can address this many vertices through MeshletTriangleData
+constexpr std::uint32_t kMeshletVertexLimit{1024};
+// Scales the penalty of adding triangles that face away from the meshlet, higher values yield tighter normal cones
+constexpr float kMeshletConeWeight{0.5f};
+// Meshes with more triangles than this are split into spatially coherent partitions that are built in parallel
+constexpr std::uint32_t kMeshletPartitionSize{1u << 16};
+
+
+// Greedily grows meshlets over the triangle adjacency of the mesh.
+// Triangles are visited in the Morton order of their centroids, so disconnected pieces still end up in compact meshlets.
+// The vertex indices are the indices of the mesh vertices referenced by the meshlets, in the order of the meshlets.
+// Fails if the limits are out of range or an index does not refer to a position.
+// The output does not depend on whether a job system is passed.
+[[nodiscard]] LEOPPHAPI auto BuildMeshlets(std::span<std::uint32_t const> indices, std::span<Vector3 const> positions,
+                                           std::vector<MeshletData>& out_meshlets,
+                                           std::vector<std::uint32_t>& out_vertex_indices,
+                                           std::vector<MeshletTriangleData>& out_triangles,
+                                           std::vector<MeshletCullData>& out_cull_data,
+                                           std::uint16_t max_verts_per_meshlet,
+                                           std::uint16_t max_prims_per_meshlet,
+                                           ObserverPtr<JobSystem> job_system = nullptr) -> bool;
+
+// Bounding sphere and normal cone of a single meshlet, the cone is quantized conservatively
+[[nodiscard]] LEOPPHAPI auto CalculateMeshletCullData(std::span<Vector3 const> positions,
+                                                      std::span<std::uint32_t const> vertex_indices,
+                                                      std::span<MeshletTriangleData const> triangles) noexcept ->
+  MeshletCullData;
+}
@@ -1233,6 +1233,11 @@ auto Resource::GetInternalResource() const -> ID3D12Resource2* {
 }
 
 
+auto Resource::GetAllocationSize() const -> UINT64 {
+  return allocation_ ? allocation_->GetSize() : 0;
+}
+
+
 Resource::Resource(ComPtr<D3D12MA::Allocation> allocation, ComPtr<ID3D12Resource2> resource,
                    std::optional<UINT> const srv, std::optional<UINT> const uav) :
   allocation_{std::move(allocation)},
@@ -395,6 +395,9 @@ public:
   LEOPPHAPI auto GetUnorderedAccess() const -> UINT;
   [[nodiscard]]
   LEOPPHAPI auto GetInternalResource() const -> ID3D12Resource2*;
+  // Size of the memory backing the resource, including alignment padding
+  [[nodiscard]]
+  LEOPPHAPI auto GetAllocationSize() const -> UINT64;
 
 protected:
   Resource(Microsoft::WRL::ComPtr<D3D12MA::Allocation> allocation, Microsoft::WRL::ComPtr<ID3D12Resource2> resource,
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <cstring>
 #include <iterator>
+#include <limits>
 #include <random>
 
 #include "ShadowCascadeBoundary.hpp"
@@ -129,39 +130,48 @@ auto SceneRenderer::CullLights(Frustum const& frustum_ws, std::span<LightData co
                                std::vector<unsigned>& visible_light_indices) -> void {
   visible_light_indices.clear();
 
-  for (unsigned light_idx = 0; light_idx < static_cast<unsigned>(lights.size()); light_idx++) {
-    switch (auto const light{lights[light_idx]}; light.type) {
-      case LightComponent::Type::Directional: {
-        visible_light_indices.emplace_back(light_idx);
-        break;
-      }
+  std::vector<std::uint8_t> light_visibility(lights.size(), 0);
 
-      case LightComponent::Type::Spot: {
-        auto const light_vertices_ws{
-          [light] {
-            auto vertices{CalculateSpotLightLocalVertices(light.range, light.outer_angle)};
+  App::Instance().GetJobSystem().ParallelFor(0, lights.size(),
+    [&frustum_ws, lights, &light_visibility](std::size_t const light_idx) {
+      switch (auto const light{lights[light_idx]}; light.type) {
+        case LightComponent::Type::Directional: {
+          light_visibility[light_idx] = 1;
+          break;
+        }
 
-            for (auto const model_mtx_no_scale{light.local_to_world_mtx_no_scale}; auto& vertex : vertices) {
-              vertex = Vector3{Vector4{vertex, 1} * model_mtx_no_scale};
-            }
+        case LightComponent::Type::Spot: {
+          auto const light_vertices_ws{
+            [light] {
+              auto vertices{CalculateSpotLightLocalVertices(light.range, light.outer_angle)};
 
-            return vertices;
-          }()
-        };
+              for (auto const model_mtx_no_scale{light.local_to_world_mtx_no_scale}; auto& vertex : vertices) {
+                vertex = Vector3{Vector4{vertex, 1} * model_mtx_no_scale};
+              }
 
-        if (frustum_ws.Intersects(AABB::FromVertices(light_vertices_ws))) {
-          visible_light_indices.emplace_back(light_idx);
-        }
+              return vertices;
+            }()
+          };
 
-        break;
-      }
+          if (frustum_ws.Intersects(AABB::FromVertices(light_vertices_ws))) {
+            light_visibility[light_idx] = 1;
+          }
 
-      case LightComponent::Type::Point: {
-        if (BoundingSphere const bounds_ws{Vector3{light.position}, light.range}; frustum_ws.Intersects(bounds_ws)) {
-          visible_light_indices.emplace_back(light_idx);
+          break;
+        }
+
+        case LightComponent::Type::Point: {
+          if (BoundingSphere const bounds_ws{Vector3{light.position}, light.range}; frustum_ws.Intersects(bounds_ws)) {
+            light_visibility[light_idx] = 1;
+          }
+          break;
         }
-        break;
       }
+    }, light_cull_grain_size_);
+
+  for (unsigned light_idx = 0; light_idx < static_cast<unsigned>(lights.size()); light_idx++) {
+    if (light_visibility[light_idx]) {
+      visible_light_indices.emplace_back(light_idx);
     }
   }
 }
@@ -1206,16 +1216,19 @@ auto SceneRenderer::ExtractCurrentState() -> void {
   packet.bone_data.clear();
   packet.skinned_mesh_data.clear();
 
-  packet.light_data.reserve(lights_.size());
+  packet.light_data.resize(lights_.size());
 
-  for (auto const light : lights_) {
-    packet.light_data.emplace_back(light->GetColor(), light->GetIntensity(), light->GetDirection(),
+  App::Instance().GetJobSystem().ParallelFor(0, lights_.size(), [this, &packet](std::size_t const light_idx) {
+    auto const light{lights_[light_idx]};
+    packet.light_data[light_idx] = LightData{
+      light->GetColor(), light->GetIntensity(), light->GetDirection(),
       light->GetEntity()->GetTransform().GetWorldPosition(), light->GetType(), light->GetRange(),
       light->GetInnerAngle(),
       light->GetOuterAngle(), light->IsCastingShadow(), light->GetShadowNearPlane(), light->GetShadowNormalBias(),
       light->GetShadowDepthBias(), light->GetShadowExtension(),
-      light->GetEntity()->GetTransform().CalculateLocalToWorldMatrixWithoutScale());
-  }
+      light->GetEntity()->GetTransform().CalculateLocalToWorldMatrixWithoutScale()
+    };
+  }, light_extract_grain_size_);
 
   packet.mesh_data.reserve(static_mesh_components_.size());
 
@@ -1249,8 +1262,56 @@ auto SceneRenderer::ExtractCurrentState() -> void {
     }
   };
 
+  // Instances use the coarsest LOD whose error stays below the threshold in every view.
+  // Perspective views tolerate an error that grows linearly with the distance, orthographic ones a constant error.
+
+  struct LodView {
+    Vector3 position;
+    float error_per_distance;
+    float min_error;
+  };
+
+  std::vector<LodView> lod_views;
+  lod_views.reserve(cameras_.size());
+
+  for (auto const cam : cameras_) {
+    auto const& cam_rt{cam->GetRenderTarget()};
+
+    if (!cam_rt && !render_global_cameras_) {
+      continue;
+    }
+
+    auto const& view_rt{cam_rt ? cam_rt : rt_override_ ? rt_override_ : main_rt_};
+    auto const view_height{static_cast<float>(view_rt->GetDesc().height) * GetHeight(cam->GetViewport())};
+
+    if (cam->GetType() == Camera::Type::Perspective) {
+      lod_views.emplace_back(cam->GetPosition(),
+        lod_error_threshold_ * 2.0f * std::tan(ToRadians(cam->GetVerticalPerspectiveFov()) / 2.0f) / view_height, 0.0f);
+    } else {
+      lod_views.emplace_back(cam->GetPosition(), 0.0f,
+        lod_error_threshold_ * cam->GetVerticalOrthographicSize() / view_height);
+    }
+  }
+
+  auto const calculate_max_lod_error{
+    [&lod_views](AABB const& bounds, Matrix4 const& local_to_world_mtx, float const max_abs_scale) {
+      auto const center{Vector3{Vector4{(bounds.min + bounds.max) / 2.0f, 1} * local_to_world_mtx}};
+      auto const radius{Length(bounds.max - bounds.min) / 2.0f * max_abs_scale};
+      auto max_error{std::numeric_limits<float>::max()};
+
+      for (auto const& [position, error_per_distance, min_error] : lod_views) {
+        auto const distance{std::max(Distance(center, position) - radius, 0.0f)};
+        max_error = std::min(max_error, distance * error_per_distance + min_error);
+      }
+
+      // LOD errors are in object space
+      return max_abs_scale > 0 ? max_error / max_abs_scale : max_error;
+    }
+  };
+
   auto const extract_from_mesh_comp{
-    [&find_or_emplace_back_buffer, &packet, &find_or_emplace_back_texture](MeshComponentBase* const comp) {
+    [&find_or_emplace_back_buffer, &packet, &find_or_emplace_back_texture, &calculate_max_lod_error](
+    MeshComponentBase* const comp) {
       auto const mesh{comp->GetMesh()};
 
       if (!mesh) {
@@ -1277,7 +1338,7 @@ auto SceneRenderer::ExtractCurrentState() -> void {
       auto const max_abs_scale{std::max({std::abs(scaling[0]), std::abs(scaling[1]), std::abs(scaling[2])})};
 
       for (auto const& submesh : mesh->GetSubmeshes()) {
-        auto const mtl{comp->GetMaterials()[submesh.GetMaterialIndex()]};
+        auto const mtl{comp->GetMaterial(static_cast<int>(submesh.GetMaterialIndex()))};
 
         if (!mtl) {
           continue;
@@ -1294,8 +1355,13 @@ auto SceneRenderer::ExtractCurrentState() -> void {
           }
         }
 
-        packet.submesh_data.emplace_back(static_cast<unsigned>(packet.mesh_data.size() - 1), submesh.GetFirstMeshlet(),
-          submesh.GetMeshletCount(), submesh.GetBaseVertex(), mtl_buf_local_idx, submesh.GetBounds());
+        auto const lod{
+          submesh.SelectLod(calculate_max_lod_error(submesh.GetBounds(), local_to_world_mtx, max_abs_scale))
+        };
+
+        packet.submesh_data.emplace_back(static_cast<unsigned>(packet.mesh_data.size() - 1),
+          submesh.GetFirstMeshlet(lod), submesh.GetMeshletCount(lod), submesh.GetBaseVertex(), mtl_buf_local_idx,
+          submesh.GetBounds());
 
         packet.instance_data.emplace_back(static_cast<unsigned>(packet.submesh_data.size() - 1),
           local_to_world_mtx, sorcery::detail::GetPrevModelMtx(*comp), max_abs_scale);
@@ -2574,6 +2640,16 @@ auto SceneRenderer::SetGamma(f32 const gamma) noexcept -> void {
 }
 
 
+auto SceneRenderer::GetLodErrorThreshold() const noexcept -> float {
+  return lod_error_threshold_;
+}
+
+
+auto SceneRenderer::SetLodErrorThreshold(float const threshold) noexcept -> void {
+  lod_error_threshold_ = std::max(0.0f, threshold);
+}
+
+
 auto SceneRenderer::Register(StaticMeshComponent& static_mesh_component) noexcept -> void {
   static_mesh_components_.emplace_back(std::addressof(static_mesh_component));
 }
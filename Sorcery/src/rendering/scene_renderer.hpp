@@ -122,6 +122,10 @@ public:
   [[nodiscard]] LEOPPHAPI auto GetGamma() const noexcept -> float;
   LEOPPHAPI auto SetGamma(float gamma) noexcept -> void;
 
+  // Screen space error in pixels that the LODs of mesh instances may introduce
+  [[nodiscard]] LEOPPHAPI auto GetLodErrorThreshold() const noexcept -> float;
+  LEOPPHAPI auto SetLodErrorThreshold(float threshold) noexcept -> void;
+
   LEOPPHAPI auto Register(StaticMeshComponent& static_mesh_component) noexcept -> void;
   LEOPPHAPI auto Unregister(StaticMeshComponent const& static_mesh_component) noexcept -> void;
 
@@ -397,6 +401,8 @@ private:
   static constexpr UINT irradiance_map_size_{64};
   static constexpr UINT prefiltered_env_map_size_{1024};
   static constexpr UINT brdf_integration_map_size_{128};
+  static constexpr std::size_t light_extract_grain_size_{64};
+  static constexpr std::size_t light_cull_grain_size_{32};
 
   ObserverPtr<RenderManager> render_manager_;
   ObserverPtr<Window> window_;
@@ -472,6 +478,7 @@ private:
   ShadowParams shadow_params_{{0.1f, 0.3f, 0.6f}, 4, false, 100, ShadowFilteringMode::kPcfTent5X5};
 
   float inv_gamma_{1.f / 2.2f};
+  float lod_error_threshold_{1.0f};
 
   bool ssao_enabled_{true};
   bool ssr_enabled_{false};
@@ -56,7 +56,7 @@ class VertexProcessor {
     float4 const tan_os = tangents[vertex_idx];
     float3 tan_ws = normalize(mul(tan_os.xyz, (float3x3)per_draw_cb.modelMtx));
     tan_ws = normalize(tan_ws - dot(tan_ws, norm_ws) * norm_ws);
-    float3 const bitan_ws = cross(norm_ws, tan_ws);
+    float3 const bitan_ws = cross(norm_ws, tan_ws) * (tan_os.w < 0 ? -1 : 1);
     float3x3 const tbn_mtx_ws = float3x3(tan_ws, bitan_ws, norm_ws);
 
     StructuredBuffer<float2> const uvs = ResourceDescriptorHeap[g_params.uv_buf_idx];
@@ -43,5 +43,6 @@ void main(uint3 const id : SV_DispatchThreadID) {
 
   skinned_vtx_buf[vtx_idx] = skinned_vtx;
   skinned_norm_buf[vtx_idx] = normalize(skinned_norm);
-  skinned_tan_buf[vtx_idx] = normalize(skinned_tan);
+  // Skinning does not change the handedness of the tangent frame
+  skinned_tan_buf[vtx_idx] = float4(normalize(skinned_tan.xyz), tan.w);
 }
@@ -52,3 +52,10 @@ auto operator==(ResourceId const& lhs, ResourceId const& rhs) noexcept -> bool {
   return lhs.GetGuid() == rhs.GetGuid() && lhs.GetIdxInFile() == rhs.GetIdxInFile();
 }
 }
+
+
+auto std::hash<sorcery::ResourceId>::operator()(sorcery::ResourceId const& res_id) const noexcept -> std::size_t {
+  auto const guid_hash{std::hash<sorcery::Guid>{}(res_id.GetGuid())};
+  auto const idx_hash{std::hash<int>{}(res_id.GetIdxInFile())};
+  return guid_hash ^ (idx_hash + 0x9E3779B97F4A7C15ull + (guid_hash << 6) + (guid_hash >> 2));
+}
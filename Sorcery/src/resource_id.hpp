@@ -3,6 +3,9 @@
 #include "Core.hpp"
 #include "Guid.hpp"
 
+#include <cstddef>
+#include <functional>
+
 
 namespace sorcery {
 class ResourceId {
@@ -29,3 +32,9 @@ private:
 [[nodiscard]] LEOPPHAPI auto operator<=>(ResourceId const& lhs, ResourceId const& rhs) noexcept -> std::strong_ordering;
 [[nodiscard]] LEOPPHAPI auto operator==(ResourceId const& lhs, ResourceId const& rhs) noexcept -> bool;
 }
+
+
+template<>
+struct std::hash<sorcery::ResourceId> {
+  [[nodiscard]] LEOPPHAPI auto operator()(sorcery::ResourceId const& res_id) const noexcept -> std::size_t;
+};
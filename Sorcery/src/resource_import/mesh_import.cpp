@@ -6,5 +6,10 @@ RTTR_REGISTRATION {
   rttr::registration::class_<sorcery::MeshImportSettings>("Mesh Import Settings")
     .constructor<>()(rttr::policy::ctor::as_object)
     .property("Fuse Submeshes", &sorcery::MeshImportSettings::fuse_submeshes)
-    .property("Force 32-bit Indices", &sorcery::MeshImportSettings::force_idx32);
+    .property("Force 32-bit Indices", &sorcery::MeshImportSettings::force_idx32)
+    .property("Quantize Vertex Streams", &sorcery::MeshImportSettings::quantize_vertex_streams)
+    .property("Deduplicate Vertices", &sorcery::MeshImportSettings::deduplicate_vertices)
+    .property("Optimize Vertex Cache", &sorcery::MeshImportSettings::optimize_vertex_cache)
+    .property("Optimize Vertex Fetch", &sorcery::MeshImportSettings::optimize_vertex_fetch)
+    .property("LOD Count", &sorcery::MeshImportSettings::lod_count);
 }
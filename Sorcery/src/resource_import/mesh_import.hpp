@@ -1,8 +1,21 @@
 #pragma once
 
 namespace sorcery {
+constexpr int kMaxMeshLodCount{8};
+
+
 struct MeshImportSettings {
   bool fuse_submeshes{false};
   bool force_idx32{false};
+  // Stores vertex streams in the packed formats of vertex_quantization.hpp, they are decoded when the mesh is loaded
+  bool quantize_vertex_streams{false};
+  // Merges vertices whose attributes are identical
+  bool deduplicate_vertices{true};
+  // Reorders triangles for the post-transform vertex cache
+  bool optimize_vertex_cache{true};
+  // Reorders vertices in the order the triangles reference them
+  bool optimize_vertex_fetch{true};
+  // Levels of detail per submesh including the original geometry, each one has about half the triangles of the previous
+  int lod_count{4};
 };
 }
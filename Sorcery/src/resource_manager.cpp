@@ -1,14 +1,24 @@
 #include "resource_manager.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <optional>
 #include <ranges>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <utility>
 
 #include <DirectXTex.h>
+#include <spdlog/spdlog.h>
 #include <wrl/client.h>
 
 #include "app.hpp"
+#include "io_helpers.hpp"
 #include "job_system.hpp"
+#include "job_task.hpp"
+#include "mesh_blob.hpp"
 #include "Reflection.hpp"
 #include "resource_package.hpp"
 #include "rendering/render_manager.hpp"
@@ -56,21 +66,155 @@ std::vector<std::uint32_t> const kCubeIndices{
 }
 
 
-ResourceManager::ResourceManager(JobSystem& job_system) :
-  job_system_{&job_system} {}
+ResourceLoadRequest::ResourceLoadRequest(JobSystem& job_system, ResourceId const& res_id) :
+  job_system_{&job_system},
+  res_id_{res_id} {}
 
 
-auto ResourceManager::Unload(ResourceId const& res_id) -> void {
-  auto resources{loaded_resources_.Lock()};
+auto ResourceLoadRequest::GetId() const noexcept -> ResourceId const& {
+  return res_id_;
+}
+
+
+auto ResourceLoadRequest::GetState() const noexcept -> ResourceLoadState {
+  return state_.load(std::memory_order_acquire);
+}
+
+
+auto ResourceLoadRequest::GetResource() const noexcept -> Resource* {
+  return GetState() == ResourceLoadState::kReady ? resource_.Get() : nullptr;
+}
+
+
+auto ResourceLoadRequest::OnComplete(std::function<void(Resource*)> callback) -> void {
+  {
+    auto callbacks{callbacks_.Lock()};
+
+    if (GetState() == ResourceLoadState::kPending) {
+      callbacks->emplace_back(std::move(callback));
+      return;
+    }
+  }
+
+  callback(GetResource());
+}
+
+
+auto ResourceLoadRequest::ResumeOnComplete(std::coroutine_handle<> const handle) -> bool {
+  auto callbacks{callbacks_.Lock()};
+
+  if (GetState() != ResourceLoadState::kPending) {
+    return false;
+  }
+
+  callbacks->emplace_back([handle](Resource*) {
+    handle.resume();
+  });
+  return true;
+}
+
+
+auto ResourceLoadRequest::Wait() const -> void {
+  while (GetState() == ResourceLoadState::kPending) {
+    // Executing jobs picks the highest priority ones, which would leave the load's own step queued behind them
+    if (!ResumeQueuedStep() && !job_system_->TryExecuteOneJob()) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+
+auto ResourceLoadRequest::Complete(Resource* const resource) -> void {
+  std::vector<std::function<void(Resource*)>> callbacks;
+
+  {
+    auto locked_callbacks{callbacks_.Lock()};
+    resource_ = resource;
+    state_.store(resource ? ResourceLoadState::kReady : ResourceLoadState::kFailed, std::memory_order_release);
+    callbacks = std::move(*locked_callbacks);
+  }
+
+  for (auto const& callback : callbacks) {
+    callback(resource);
+  }
+}
+
 
-  if (auto const it{resources->find(res_id)}; it != std::end(*resources)) {
-    resources->erase(it);
+auto ResourceLoadRequest::ResumeQueuedStep() const -> bool {
+  if (auto const step{queued_step_.exchange(nullptr, std::memory_order_acq_rel)}) {
+    step.resume();
+    return true;
   }
+
+  return false;
+}
+
+
+LoadIoAwaiter::LoadIoAwaiter(std::shared_ptr<ResourceLoadRequest> request, std::function<bool()> read) :
+  request_{std::move(request)},
+  read_{std::move(read)} {}
+
+
+auto LoadIoAwaiter::await_ready() noexcept -> bool {
+  return false;
+}
+
+
+auto LoadIoAwaiter::await_suspend(std::coroutine_handle<> const handle) -> void {
+  auto& job_system{*request_->job_system_};
+
+  auto const read_job{
+    job_system.CreateJob([this, handle] {
+      read_succeeded_ = read_();
+      // Whoever resumes the load may destroy the awaiter right after this
+      request_->queued_step_.store(handle, std::memory_order_release);
+    })
+  };
+
+  read_job->priority = JobPriority::kBlockingIo;
+
+  // A waiting thread might have resumed the load long before this runs, and the request pins its resource
+  auto const resume_job{
+    job_system.CreateJob([weak_request = std::weak_ptr{request_}] {
+      if (auto const request{weak_request.lock()}) {
+        request->ResumeQueuedStep();
+      }
+    })
+  };
+
+  resume_job->priority = JobPriority::kBackground;
+
+  JobSystem::AddContinuation(read_job, resume_job);
+  job_system.Run(resume_job);
+  job_system.Run(read_job);
+}
+
+
+auto LoadIoAwaiter::await_resume() const noexcept -> bool {
+  return read_succeeded_;
+}
+
+
+auto RunLoadIo(std::shared_ptr<ResourceLoadRequest> request, std::function<bool()> read) -> LoadIoAwaiter {
+  return LoadIoAwaiter{std::move(request), std::move(read)};
+}
+
+
+ResourceManager::ResourceManager(JobSystem& job_system, std::unique_ptr<ResourceLoader> loader) :
+  mappings_{std::make_shared<Mappings const>()},
+  loader_{std::move(loader)},
+  job_system_{&job_system} {}
+
+
+auto ResourceManager::Unload(ResourceId const& res_id) -> void {
+  GetLoadedResourceShard(res_id).resources.Lock()->erase(res_id);
 }
 
 
 auto ResourceManager::UnloadAll() -> void {
-  loaded_resources_.Lock()->clear();
+  for (auto& shard : loaded_resource_shards_) {
+    shard.resources.Lock()->clear();
+  }
 }
 
 
@@ -81,22 +225,118 @@ auto ResourceManager::IsLoaded(ResourceId const& res_id) -> bool {
     }
   }
 
-  return loaded_resources_.LockShared()->contains(res_id);
+  return GetLoadedResourceShard(res_id).resources.LockShared()->contains(res_id);
+}
+
+
+auto ResourceManager::GetMemoryBudget() const noexcept -> MemoryBudget {
+  return MemoryBudget{
+    .cpu_bytes = cpu_budget_.load(std::memory_order_relaxed),
+    .gpu_bytes = gpu_budget_.load(std::memory_order_relaxed)
+  };
+}
+
+
+auto ResourceManager::SetMemoryBudget(MemoryBudget const& budget) noexcept -> void {
+  cpu_budget_.store(budget.cpu_bytes, std::memory_order_relaxed);
+  gpu_budget_.store(budget.gpu_bytes, std::memory_order_relaxed);
+}
+
+
+auto ResourceManager::EnforceMemoryBudget() -> void {
+  auto const [cpu_budget, gpu_budget]{GetMemoryBudget()};
+
+  if (cpu_budget == std::numeric_limits<std::size_t>::max() && gpu_budget == std::numeric_limits<std::size_t>::max()) {
+    return;
+  }
+
+  auto [cpu_bytes, gpu_bytes]{CalculateMemoryUsage()};
+
+  auto const over_budget{
+    [&] {
+      return cpu_bytes > cpu_budget || gpu_bytes > gpu_budget;
+    }
+  };
+
+  if (!over_budget()) {
+    return;
+  }
+
+  // Destroying a resource locks the object registry, so evicted ones are only destroyed once the shards are unlocked
+  std::vector<std::unique_ptr<Resource>> evicted_resources;
+
+  // The hand sweeps at most one revolution per call, so a resource that was just looked up survives until the next frame
+  for (std::size_t i{0}; i < loaded_resource_shard_count_ && over_budget(); i++) {
+    auto& shard{loaded_resource_shards_[clock_hand_]};
+    clock_hand_ = (clock_hand_ + 1) % loaded_resource_shard_count_;
+
+    auto resources{shard.resources.Lock()};
+
+    for (auto it{std::begin(*resources)}; it != std::end(*resources) && over_budget();) {
+      auto& entry{it->second};
+
+      // Handles, including the ones held by load requests, and reported pointer properties pin the resource.
+      // New ones are only created under the shared lock of the shard, so the check cannot race with them.
+      if (!entry.evictable.load(std::memory_order_relaxed) || entry.resource->IsReferenced()) {
+        ++it;
+        continue;
+      }
+
+      // Second chance
+      if (entry.recently_used.exchange(false, std::memory_order_relaxed)) {
+        ++it;
+        continue;
+      }
+
+      auto const res_cpu_bytes{entry.resource->GetCpuMemoryUsage()};
+      auto const res_gpu_bytes{entry.resource->GetGpuMemoryUsage()};
+
+      // Evicting a resource that occupies no memory, e.g. a scene, would only force a reload
+      if (res_cpu_bytes == 0 && res_gpu_bytes == 0) {
+        ++it;
+        continue;
+      }
+
+      cpu_bytes -= std::min(cpu_bytes, res_cpu_bytes);
+      gpu_bytes -= std::min(gpu_bytes, res_gpu_bytes);
+      evicted_resources.emplace_back(std::move(entry.resource));
+      it = resources->erase(it);
+      shard.eviction_count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+
+auto ResourceManager::GetCacheStats() -> CacheStats {
+  CacheStats stats;
+
+  for (auto const& shard : loaded_resource_shards_) {
+    stats.hit_count += shard.hit_count.load(std::memory_order_relaxed);
+    stats.miss_count += shard.miss_count.load(std::memory_order_relaxed);
+    stats.eviction_count += shard.eviction_count.load(std::memory_order_relaxed);
+  }
+
+  std::tie(stats.cpu_bytes, stats.gpu_bytes) = CalculateMemoryUsage();
+  return stats;
 }
 
 
 auto ResourceManager::UpdateMappings(std::map<ResourceId, ResourceDescription> res_mappings,
                                      std::map<Guid, std::filesystem::path> file_mappings) -> void {
-  while (true) {
-    auto self_res_mappings{res_mappings_.TryLock()};
-    auto self_file_mappings{file_mappings_.TryLock()};
-
-    if (self_res_mappings && self_file_mappings) {
-      **self_res_mappings = std::move(res_mappings);
-      **self_file_mappings = std::move(file_mappings);
-      break;
-    }
+  auto const mappings{std::make_shared<Mappings>()};
+
+  mappings->resources.reserve(res_mappings.size());
+  for (auto& [res_id, desc] : res_mappings) {
+    mappings->resources.emplace(res_id, std::move(desc));
+  }
+
+  mappings->files.reserve(file_mappings.size());
+  for (auto& [guid, path] : file_mappings) {
+    mappings->files.emplace(guid, std::move(path));
   }
+
+  // Readers still holding the previous snapshot keep it alive until they are done with it
+  mappings_.store(mappings, std::memory_order_release);
 }
 
 
@@ -109,24 +349,22 @@ auto ResourceManager::GetInfoForResourcesOfType(rttr::type const& type, std::vec
   }
 
   // File mappings
-  for (auto const& [guid, desc] : *res_mappings_.LockShared()) {
+  auto const mappings{mappings_.load(std::memory_order_acquire)};
+
+  for (auto const& [res_id, desc] : mappings->resources) {
     if (desc.type.is_derived_from(type)) {
-      out.emplace_back(guid, desc.name, desc.type);
+      out.emplace_back(res_id, desc.name, desc.type);
     }
   }
 
   // Other, loaded resources that don't come from files
-  for (auto const& res : *loaded_resources_.LockShared()) {
-    auto contains{false};
-    for (auto const& res_info : out) {
-      if (res_info.id == res->GetId()) {
-        contains = true;
-        break;
-      }
-    }
+  for (auto& shard : loaded_resource_shards_) {
+    auto const resources{shard.resources.LockShared()};
 
-    if (!contains && rttr::type::get(*res).is_derived_from(type)) {
-      out.emplace_back(res->GetId(), res->GetName(), res->get_type());
+    for (auto const& [res_id, entry] : *resources) {
+      if (!mappings->resources.contains(res_id) && rttr::type::get(*entry.resource).is_derived_from(type)) {
+        out.emplace_back(res_id, entry.resource->GetName(), entry.resource->get_type());
+      }
     }
   }
 }
@@ -165,7 +403,7 @@ auto ResourceManager::CreateDefaultResources() -> void {
 
     cube_data.positions = kCubePositions;
     CalculateNormals(kCubePositions, kCubeIndices, cube_data.normals);
-    CalculateTangents(kCubePositions, kCubeUvs, kCubeIndices, cube_data.tangents);
+    CalculateTangents(kCubePositions, cube_data.normals, kCubeUvs, kCubeIndices, cube_data.tangents);
     cube_data.uvs = kCubeUvs;
 
     if (!ComputeMeshlets<std::uint32_t, Vector3>(kCubeIndices, kCubePositions, cube_data.meshlets,
@@ -192,7 +430,7 @@ auto ResourceManager::CreateDefaultResources() -> void {
 
     plane_data.positions = kQuadPositions;
     CalculateNormals(kQuadPositions, kQuadIndices, plane_data.normals);
-    CalculateTangents(kQuadPositions, kQuadUvs, kQuadIndices, plane_data.tangents);
+    CalculateTangents(kQuadPositions, plane_data.normals, kQuadUvs, kQuadIndices, plane_data.tangents);
     plane_data.uvs = kQuadUvs;
 
     if (!ComputeMeshlets<std::uint32_t, Vector3>(kQuadIndices, kQuadPositions, plane_data.meshlets,
@@ -220,7 +458,7 @@ auto ResourceManager::CreateDefaultResources() -> void {
 
     rendering::GenerateSphereMesh(1, 50, 50, sphere_data.positions, sphere_data.normals,
       sphere_data.uvs, sphere_indices);
-    CalculateTangents(sphere_data.positions, sphere_data.uvs, sphere_indices,
+    CalculateTangents(sphere_data.positions, sphere_data.normals, sphere_data.uvs, sphere_indices,
       sphere_data.tangents);
 
     if (!ComputeMeshlets<std::uint32_t, Vector3>(sphere_indices, sphere_data.positions, sphere_data.meshlets,
@@ -244,477 +482,280 @@ auto ResourceManager::CreateDefaultResources() -> void {
 }
 
 
-auto ResourceManager::ResourceIdLess::operator()(std::unique_ptr<Resource> const& lhs,
-                                                 std::unique_ptr<Resource> const& rhs) const noexcept -> bool {
-  return lhs->GetId() < rhs->GetId();
-}
-
-
-auto ResourceManager::ResourceIdLess::operator()(std::unique_ptr<Resource> const& lhs,
-                                                 ResourceId const& rhs) const noexcept -> bool {
-  return lhs->GetId() < rhs;
-}
-
-
-auto ResourceManager::ResourceIdLess::operator()(ResourceId const& lhs,
-                                                 std::unique_ptr<Resource> const& rhs) const noexcept -> bool {
-  return lhs < rhs->GetId();
-}
-
-
-auto ResourceManager::InternalLoadResource(ResourceId const& res_id,
-                                           ResourceDescription const& desc) -> ObserverPtr<Resource> {
-  ObserverPtr<Job> loader_job;
-  auto created_job{false};
-
-  struct JobData {
-    ResourceId const* res_id;
-    ResourceDescription const* desc;
-    std::filesystem::path path_abs;
-  };
-
-  JobData job_data;
-
-  {
-    auto loader_jobs{loader_jobs_.Lock()};
-
-    if (auto const job_it{loader_jobs->find(res_id)}; job_it != loader_jobs->end()) {
-      loader_job = job_it->second;
-    } else {
-      auto const file_mappings{file_mappings_.LockShared()};
-
-      if (auto const file_it{file_mappings->find(res_id.GetGuid())}; file_it != file_mappings->end()) {
-        job_data.res_id = &res_id;
-        job_data.desc = &desc;
-        job_data.path_abs = file_it->second;
-
-        loader_job = job_system_->CreateJob([this, &job_data] {
-          std::unique_ptr<Resource> res;
-
-          YamlDeserializeContext const ctx{
-            .current_guid = job_data.res_id->GetGuid()
-          };
-
-          if (job_data.path_abs.extension() == EXTERNAL_RESOURCE_EXT) {
-            auto const subresource{
-              LoadBinaryResourcePackageSubresource(job_data.path_abs, job_data.res_id->GetIdxInFile())
-            };
-
-            if (!subresource) {
-              return;
-            }
-
-            switch (subresource->payload_kind) {
-              case ResourcePackagePayloadKind::kTexture: {
-                res = LoadTexture(subresource->bytes);
-                break;
-              }
-
-              case ResourcePackagePayloadKind::kMesh: {
-                res = LoadMesh(subresource->bytes);
-                break;
-              }
-
-              case ResourcePackagePayloadKind::kMaterial: {
-                res = LoadMaterial(subresource->bytes, ctx);
-                break;
-              }
-
-              case ResourcePackagePayloadKind::kPrefab: {
-                res = LoadPrefab(subresource->bytes, ctx);
-              }
-
-              case ResourcePackagePayloadKind::kInvalid: {
-                // TODO Log error
-                break;
-              }
-            }
-          } else if (job_data.path_abs.extension() == SCENE_RESOURCE_EXT) {
-            auto scene = std::make_unique<Scene>();
-            scene->Deserialize(YAML::LoadFile(job_data.path_abs.string()), ctx);
-            res = std::move(scene);
-          } else if (job_data.path_abs.extension() == MATERIAL_RESOURCE_EXT) {
-            auto mtl = std::make_unique<Material>(GpuResidencyPolicy::kDeferUpload);
-            mtl->Deserialize(YAML::LoadFile(job_data.path_abs.string()), ctx);
-            res = std::move(mtl);
-          }
-
-          if (res) {
-            res->SetId(*job_data.res_id);
-            res->SetName(job_data.desc->name);
-
-            auto const [it, inserted]{loaded_resources_.Lock()->emplace(std::move(res))};
-            assert(inserted);
-          }
-        });
-        created_job = true;
-        loader_jobs->emplace(res_id, loader_job);
-        job_system_->Run(loader_job);
-      }
-    }
-  }
-
-  assert(loader_job);
-  job_system_->Wait(loader_job);
-
-  if (created_job) {
-    loader_jobs_.Lock()->erase(res_id);
-  }
-
-  {
-    auto const resources{loaded_resources_.LockShared()};
-    auto const it{resources->find(res_id)};
-    return ObserverPtr{it != resources->end() ? it->get() : nullptr};
-  }
+auto ResourceManager::GetLoadedResourceShard(ResourceId const& res_id) -> LoadedResourceShard& {
+  // The maps bucket by the low bits of the hash, so shards are picked by the high ones
+  constexpr auto shard_bits{std::bit_width(loaded_resource_shard_count_ - 1)};
+  auto const shard_idx{std::hash<ResourceId>{}(res_id) >> (sizeof(std::size_t) * 8 - shard_bits)};
+  return loaded_resource_shards_[shard_idx];
 }
 
 
-auto ResourceManager::LoadTexture(
-  std::span<std::byte const> const bytes) noexcept -> MaybeNull<std::unique_ptr<Resource>> {
-  DirectX::TexMetadata meta;
-  DirectX::ScratchImage img;
-  if (FAILED(LoadFromDDSMemory(bytes.data(), bytes.size(), DirectX::DDS_FLAGS_NONE, &meta, img))) {
-    return nullptr;
-  }
-
-  auto tex{App::Instance().GetRenderManager().CreateReadOnlyTexture(img)};
+auto ResourceManager::CalculateMemoryUsage() -> std::pair<std::size_t, std::size_t> {
+  std::size_t cpu_bytes{0};
+  std::size_t gpu_bytes{0};
 
-  if (!tex) {
-    return nullptr;
+  for (auto const& res : default_resources_) {
+    cpu_bytes += res->GetCpuMemoryUsage();
+    gpu_bytes += res->GetGpuMemoryUsage();
   }
 
-  std::unique_ptr<Resource> ret;
+  for (auto& shard : loaded_resource_shards_) {
+    auto const resources{shard.resources.LockShared()};
 
-  if (meta.dimension == DirectX::TEX_DIMENSION_TEXTURE2D) {
-    if (meta.IsCubemap()) {
-      ret = std::make_unique<Cubemap>(std::move(tex));
-    } else {
-      ret = std::make_unique<Texture2D>(std::move(tex));
+    for (auto const& entry : *resources | std::views::values) {
+      cpu_bytes += entry.resource->GetCpuMemoryUsage();
+      gpu_bytes += entry.resource->GetGpuMemoryUsage();
     }
-  } else {
-    return nullptr;
   }
 
-  return ret;
+  return {cpu_bytes, gpu_bytes};
 }
 
 
-auto ResourceManager::LoadMesh(std::span<std::byte const> const bytes) -> MaybeNull<std::unique_ptr<Resource>> {
-  auto cur_bytes{as_bytes(std::span{bytes})};
-
-  // Element counts
-
-  std::uint64_t vert_count;
-
-  if (!DeserializeFromBinary(cur_bytes, vert_count)) {
-    return nullptr;
-  }
-
-  cur_bytes = cur_bytes.subspan(sizeof vert_count);
-  std::uint64_t meshlet_count;
-
-  if (!DeserializeFromBinary(cur_bytes, meshlet_count)) {
-    return nullptr;
-  }
-
-  cur_bytes = cur_bytes.subspan(sizeof meshlet_count);
-  std::uint64_t vtx_idx_count;
-
-  if (!DeserializeFromBinary(cur_bytes, vtx_idx_count)) {
-    return nullptr;
-  }
-
-  cur_bytes = cur_bytes.subspan(sizeof vtx_idx_count);
-  std::uint64_t prim_idx_count;
-
-  if (!DeserializeFromBinary(cur_bytes, prim_idx_count)) {
-    return nullptr;
-  }
-
-  cur_bytes = cur_bytes.subspan(sizeof prim_idx_count);
-  std::uint64_t material_slot_count;
-
-  if (!DeserializeFromBinary(cur_bytes, material_slot_count)) {
-    return nullptr;
-  }
-
-  cur_bytes = cur_bytes.subspan(sizeof material_slot_count);
-  std::uint64_t submesh_count;
-
-  if (!DeserializeFromBinary(cur_bytes, submesh_count)) {
-    return nullptr;
-  }
-
-  cur_bytes = cur_bytes.subspan(sizeof submesh_count);
-  std::uint64_t anim_count;
-
-  if (!DeserializeFromBinary(cur_bytes, anim_count)) {
-    return nullptr;
-  }
-
-  cur_bytes = cur_bytes.subspan(sizeof anim_count);
-  std::uint64_t skeleton_size;
-
-  if (!DeserializeFromBinary(cur_bytes, skeleton_size)) {
-    return nullptr;
-  }
-
-  cur_bytes = cur_bytes.subspan(sizeof skeleton_size);
-  std::uint64_t bone_count;
+auto ResourceManager::InternalRequestLoad(ResourceId const& res_id) -> std::shared_ptr<ResourceLoadRequest> {
+  auto const request{std::make_shared<ResourceLoadRequest>(*job_system_, res_id)};
 
-  if (!DeserializeFromBinary(cur_bytes, bone_count)) {
-    return nullptr;
+  for (auto const& def_res : default_resources_) {
+    if (def_res->GetId() == res_id) {
+      request->Complete(def_res.Get());
+      return request;
+    }
   }
 
-  cur_bytes = cur_bytes.subspan(sizeof bone_count);
-  MeshData mesh_data;
-
-  // Geometry data
-
-  mesh_data.positions.resize(vert_count);
-  std::memcpy(mesh_data.positions.data(), cur_bytes.data(), vert_count * sizeof(Vector3));
-  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector3));
-
-  mesh_data.normals.resize(vert_count);
-  std::memcpy(mesh_data.normals.data(), cur_bytes.data(), vert_count * sizeof(Vector3));
-  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector3));
-
-  mesh_data.tangents.resize(vert_count);
-  std::memcpy(mesh_data.tangents.data(), cur_bytes.data(), vert_count * sizeof(Vector3));
-  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector3));
+  std::optional<ResourceDescription> desc;
+  std::optional<std::filesystem::path> path_abs;
 
-  mesh_data.uvs.resize(vert_count);
-  std::memcpy(mesh_data.uvs.data(), cur_bytes.data(), vert_count * sizeof(Vector2));
-  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector2));
-
-  mesh_data.bone_weights.resize(vert_count);
-  std::memcpy(mesh_data.bone_weights.data(), cur_bytes.data(), vert_count * sizeof(Vector4));
-  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector4));
-
-  mesh_data.bone_indices.resize(vert_count);
-  std::memcpy(mesh_data.bone_indices.data(), cur_bytes.data(),
-    vert_count * sizeof(Vector<std::uint32_t, 4>));
-  cur_bytes = cur_bytes.subspan(vert_count * sizeof(Vector<std::uint32_t, 4>));
-
-  mesh_data.meshlets.resize(meshlet_count);
-  std::memcpy(mesh_data.meshlets.data(), cur_bytes.data(), meshlet_count * sizeof(MeshletData));
-  cur_bytes = cur_bytes.subspan(meshlet_count * sizeof(MeshletData));
-
-  mesh_data.vertex_indices.resize(vtx_idx_count);
-  std::memcpy(mesh_data.vertex_indices.data(), cur_bytes.data(), vtx_idx_count);
-  cur_bytes = cur_bytes.subspan(vtx_idx_count);
-
-  mesh_data.triangle_indices.resize(prim_idx_count);
-  std::memcpy(mesh_data.triangle_indices.data(), cur_bytes.data(),
-    prim_idx_count * sizeof(MeshletTriangleData));
-  cur_bytes = cur_bytes.subspan(prim_idx_count * sizeof(MeshletTriangleData));
-
-  mesh_data.cull_data.resize(meshlet_count);
-  std::memcpy(mesh_data.cull_data.data(), cur_bytes.data(), meshlet_count * sizeof(MeshletCullData));
-  cur_bytes = cur_bytes.subspan(meshlet_count * sizeof(MeshletCullData));
-
-  // Material slots
-
-  mesh_data.material_slots.resize(material_slot_count);
+  {
+    auto load_requests{load_requests_.Lock()};
 
-  for (auto i{0ull}; i < material_slot_count; i++) {
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.material_slots[i].name)) {
-      return nullptr;
+    // Loads publish their resource and retire their request under the request lock, so checking both here cannot miss
+    if (auto const it{load_requests->find(res_id)}; it != load_requests->end()) {
+      return it->second;
     }
 
-    cur_bytes = cur_bytes.subspan(mesh_data.material_slots[i].name.size() + 8);
-  }
-
-  // Submeshes
-
-  mesh_data.submeshes.resize(submesh_count);
+    auto& shard{GetLoadedResourceShard(res_id)};
 
-  for (auto i{0ull}; i < submesh_count; i++) {
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].first_meshlet)) {
-      return nullptr;
+    if (auto const resources{shard.resources.LockShared()}; resources->contains(res_id)) {
+      auto const& entry{resources->find(res_id)->second};
+      entry.recently_used.store(true, std::memory_order_relaxed);
+      shard.hit_count.fetch_add(1, std::memory_order_relaxed);
+      request->Complete(entry.resource.get());
+      return request;
     }
-    cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
 
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].meshlet_count)) {
-      return nullptr;
-    }
+    shard.miss_count.fetch_add(1, std::memory_order_relaxed);
 
-    cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
+    auto const mappings{mappings_.load(std::memory_order_acquire)};
 
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].base_vertex)) {
-      return nullptr;
+    if (auto const it{mappings->resources.find(res_id)}; it != std::end(mappings->resources)) {
+      desc = it->second;
     }
 
-    cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
+    if (auto const it{mappings->files.find(res_id.GetGuid())}; it != std::end(mappings->files)) {
+      path_abs = it->second;
+    }
 
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].material_idx)) {
-      return nullptr;
+    if (desc && path_abs) {
+      load_requests->emplace(res_id, request);
     }
+  }
 
-    cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
+  if (!desc || !path_abs) {
+    request->Complete(nullptr);
+    return request;
+  }
 
-    for (auto j{0}; j < 3; j++) {
-      if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].bounds.min[j])) {
-        return nullptr;
-      }
+  Load(request, std::move(*desc), std::move(*path_abs)).Start();
+  return request;
+}
 
-      cur_bytes = cur_bytes.subspan(sizeof(float));
-    }
 
-    for (auto j{0}; j < 3; j++) {
-      if (!DeserializeFromBinary(cur_bytes, mesh_data.submeshes[i].bounds.max[j])) {
-        return nullptr;
-      }
+auto ResourceManager::Load(std::shared_ptr<ResourceLoadRequest> request, ResourceDescription desc,
+                           std::filesystem::path path_abs) -> detail::DetachedTask {
+  std::unique_ptr<Resource> res;
 
-      cur_bytes = cur_bytes.subspan(sizeof(float));
-    }
+  if (loader_) {
+    res = co_await loader_->Load(request, path_abs);
+  } else {
+    res = co_await LoadFromFile(request, path_abs);
   }
 
-  // Animations
-
-  mesh_data.animations.resize(anim_count);
+  // A null resource fails the request. Pinned from publishing until the request holds it.
+  Handle<Resource> loaded_res;
 
-  for (auto i{0ull}; i < anim_count; i++) {
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.animations[i].name)) {
-      return nullptr;
-    }
+  {
+    auto load_requests{load_requests_.Lock()};
 
-    cur_bytes = cur_bytes.subspan(mesh_data.animations[i].name.size() + 8);
+    if (res) {
+      res->SetId(request->GetId());
+      res->SetName(desc.name);
 
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.animations[i].duration)) {
-      return nullptr;
+      auto const res_id{res->GetId()};
+      auto resources{GetLoadedResourceShard(res_id).resources.Lock()};
+      auto const [it, inserted]{resources->try_emplace(res_id, std::move(res), true)};
+      assert(inserted);
+      loaded_res = it->second.resource.get();
     }
 
-    cur_bytes = cur_bytes.subspan(sizeof(float));
-
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.animations[i].ticks_per_second)) {
-      return nullptr;
-    }
+    load_requests->erase(request->GetId());
+  }
 
-    cur_bytes = cur_bytes.subspan(sizeof(float));
-    std::uint64_t node_anim_count;
+  request->Complete(loaded_res.Get());
+}
 
-    if (!DeserializeFromBinary(cur_bytes, node_anim_count)) {
-      return nullptr;
-    }
 
-    cur_bytes = cur_bytes.subspan(sizeof node_anim_count);
-    mesh_data.animations[i].node_anims.resize(node_anim_count);
+auto ResourceManager::LoadFromFile(std::shared_ptr<ResourceLoadRequest> request,
+                                   std::filesystem::path const path_abs) -> Task<MaybeNull<std::unique_ptr<Resource>>> {
+  auto const res_id{request->GetId()};
+  std::shared_ptr<ResourcePackageView const> package;
+  std::optional<ResourcePackageSubresourceView> subresource;
+  std::string text;
+
+  // Reading the file blocks, so it happens on the I/O lane and decoding continues on the compute workers
+  auto const read_succeeded{
+    co_await RunLoadIo(std::move(request), [&] {
+      if (path_abs.extension() == EXTERNAL_RESOURCE_EXT) {
+        // The payload is decoded straight from the mapping, so only page it in and check it here
+        if ((package = ResourcePackageView::Open(path_abs))) {
+          auto const entry_idx{res_id.GetIdxInFile()};
+          package->Prefetch(entry_idx);
+
+          if (package->VerifyChecksum(entry_idx)) {
+            subresource = package->GetSubresource(entry_idx);
+          }
+        }
 
-    for (auto j{0ull}; j < node_anim_count; j++) {
-      if (!DeserializeFromBinary(cur_bytes, mesh_data.animations[i].node_anims[j].node_idx)) {
-        return nullptr;
+        return subresource.has_value();
       }
 
-      cur_bytes = cur_bytes.subspan(sizeof(std::uint32_t));
-      std::uint64_t pos_key_count;
+      return ReadBinaryFile(path_abs, text);
+    })
+  };
 
-      if (!DeserializeFromBinary(cur_bytes, pos_key_count)) {
-        return nullptr;
-      }
+  std::unique_ptr<Resource> res;
 
-      cur_bytes = cur_bytes.subspan(sizeof pos_key_count);
-      std::uint64_t rot_key_count;
+  if (read_succeeded) {
+    YamlDeserializeContext const ctx{
+      .current_guid = res_id.GetGuid()
+    };
 
-      if (!DeserializeFromBinary(cur_bytes, rot_key_count)) {
-        return nullptr;
-      }
+    if (path_abs.extension() == EXTERNAL_RESOURCE_EXT) {
+      auto payload{subresource->bytes};
+      std::vector<std::byte> decompressed_payload;
+      auto decompressed{true};
 
-      cur_bytes = cur_bytes.subspan(sizeof rot_key_count);
-      std::uint64_t scale_key_count;
+      if (subresource->codec != ResourcePackageCodec::kNone) {
+        decompressed_payload.resize(subresource->uncompressed_size);
+        decompressed = DecompressResourcePackagePayload(*subresource, decompressed_payload, job_system_);
 
-      if (!DeserializeFromBinary(cur_bytes, scale_key_count)) {
-        return nullptr;
+        if (decompressed) {
+          payload = decompressed_payload;
+        } else {
+          spdlog::error("Failed to decompress resource [{}] from package [{}].",
+            res_id.ToString(), ToUntypedStdSv(path_abs.u8string()));
+        }
       }
 
-      cur_bytes = cur_bytes.subspan(sizeof scale_key_count);
+      if (decompressed) {
+        switch (subresource->payload_kind) {
+          case ResourcePackagePayloadKind::kTexture: {
+            res = LoadTexture(payload);
+            break;
+          }
 
-      mesh_data.animations[i].node_anims[j].position_keys.resize(pos_key_count);
-      std::memcpy(mesh_data.animations[i].node_anims[j].position_keys.data(), cur_bytes.data(),
-        pos_key_count * sizeof(AnimPositionKey));
-      cur_bytes = cur_bytes.subspan(pos_key_count * sizeof(AnimPositionKey));
+          case ResourcePackagePayloadKind::kMesh: {
+            res = LoadMesh(payload);
+            break;
+          }
 
+          case ResourcePackagePayloadKind::kMaterial: {
+            res = co_await LoadMaterial(payload, ctx);
+            break;
+          }
 
-      mesh_data.animations[i].node_anims[j].rotation_keys.resize(rot_key_count);
-      std::memcpy(mesh_data.animations[i].node_anims[j].rotation_keys.data(), cur_bytes.data(),
-        rot_key_count * sizeof(AnimRotationKey));
-      cur_bytes = cur_bytes.subspan(rot_key_count * sizeof(AnimRotationKey));
+          case ResourcePackagePayloadKind::kPrefab: {
+            res = LoadPrefab(payload, ctx);
+            break;
+          }
 
-      mesh_data.animations[i].node_anims[j].scaling_keys.resize(scale_key_count);
-      std::memcpy(mesh_data.animations[i].node_anims[j].scaling_keys.data(), cur_bytes.data(),
-        scale_key_count * sizeof(AnimScalingKey));
-      cur_bytes = cur_bytes.subspan(scale_key_count * sizeof(AnimScalingKey));
+          case ResourcePackagePayloadKind::kInvalid: {
+            spdlog::error("Resource [{}] in package [{}] has an invalid payload kind.",
+              res_id.ToString(), ToUntypedStdSv(path_abs.u8string()));
+            break;
+          }
+        }
+      }
+    } else if (path_abs.extension() == SCENE_RESOURCE_EXT) {
+      auto scene = std::make_unique<Scene>();
+      scene->Deserialize(YAML::Load(text), ctx);
+      res = std::move(scene);
+    } else if (path_abs.extension() == MATERIAL_RESOURCE_EXT) {
+      auto mtl = std::make_unique<Material>(GpuResidencyPolicy::kDeferUpload);
+      co_await mtl->DeserializeAsync(YAML::Load(text), ctx);
+      res = std::move(mtl);
     }
   }
 
-  // Skeleton nodes
-
-  mesh_data.skeleton.resize(skeleton_size);
-
-  for (auto i{0ull}; i < skeleton_size; i++) {
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.skeleton[i].name)) {
-      return nullptr;
-    }
+  co_return std::move(res);
+}
 
-    cur_bytes = cur_bytes.subspan(mesh_data.skeleton[i].name.size() + 8);
-    bool has_parent;
 
-    if (!DeserializeFromBinary(cur_bytes, has_parent)) {
-      return nullptr;
-    }
+auto ResourceManager::LoadTexture(
+  std::span<std::byte const> const bytes) noexcept -> MaybeNull<std::unique_ptr<Resource>> {
+  DirectX::TexMetadata meta;
+  DirectX::ScratchImage img;
+  if (FAILED(LoadFromDDSMemory(bytes.data(), bytes.size(), DirectX::DDS_FLAGS_NONE, &meta, img))) {
+    return nullptr;
+  }
 
-    cur_bytes = cur_bytes.subspan(sizeof has_parent);
+  auto tex{App::Instance().GetRenderManager().CreateReadOnlyTexture(img)};
 
-    if (has_parent) {
-      std::uint32_t parent_idx;
+  if (!tex) {
+    return nullptr;
+  }
 
-      if (!DeserializeFromBinary(cur_bytes, parent_idx)) {
-        return nullptr;
-      }
+  std::unique_ptr<Resource> ret;
 
-      mesh_data.skeleton[i].parent_idx = parent_idx;
-      cur_bytes = cur_bytes.subspan(sizeof std::uint32_t);
+  if (meta.dimension == DirectX::TEX_DIMENSION_TEXTURE2D) {
+    if (meta.IsCubemap()) {
+      ret = std::make_unique<Cubemap>(std::move(tex));
+    } else {
+      ret = std::make_unique<Texture2D>(std::move(tex));
     }
-
-    std::memcpy(mesh_data.skeleton[i].transform.GetData(), cur_bytes.data(), sizeof(Matrix4));
-    cur_bytes = cur_bytes.subspan(sizeof Matrix4);
+  } else {
+    return nullptr;
   }
 
-  // Bones
+  return ret;
+}
 
-  mesh_data.bones.resize(bone_count);
-  std::memcpy(mesh_data.bones.data(), cur_bytes.data(), bone_count * sizeof(Bone));
-  cur_bytes = cur_bytes.subspan(bone_count * sizeof(Bone));
 
-  // Bounds
+auto ResourceManager::LoadMesh(std::span<std::byte const> const bytes) -> MaybeNull<std::unique_ptr<Resource>> {
+  if (!MeshView::IsMeshBlob(bytes)) {
+    return LoadLegacyMesh(bytes);
+  }
 
-  for (auto j{0}; j < 3; j++) {
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.bounds.min[j])) {
-      return nullptr;
-    }
+  auto const view{MeshView::Parse(bytes)};
 
-    cur_bytes = cur_bytes.subspan(sizeof(float));
+  if (!view) {
+    return nullptr;
   }
 
-  for (auto j{0}; j < 3; j++) {
-    if (!DeserializeFromBinary(cur_bytes, mesh_data.bounds.max[j])) {
-      return nullptr;
-    }
+  return std::make_unique<Mesh>(*view, ResourceResidencyPolicy{
+    .gpu = GpuResidencyPolicy::kMakeResident, .cpu = CpuResidencyPolicy::kReleaseAfterUpload
+  });
+}
 
-    cur_bytes = cur_bytes.subspan(sizeof(float));
-  }
 
-  // Index format
+auto ResourceManager::LoadLegacyMesh(
+  std::span<std::byte const> const bytes) -> MaybeNull<std::unique_ptr<Resource>> {
+  auto mesh_data{DeserializeLegacyMeshData(bytes)};
 
-  if (!DeserializeFromBinary(cur_bytes, mesh_data.idx32)) {
+  if (!mesh_data) {
     return nullptr;
   }
 
-  cur_bytes = cur_bytes.subspan(sizeof mesh_data.idx32);
-
-  assert(cur_bytes.empty());
-
-  return std::make_unique<Mesh>(std::move(mesh_data), ResourceResidencyPolicy{
+  return std::make_unique<Mesh>(std::move(*mesh_data), ResourceResidencyPolicy{
     .gpu = GpuResidencyPolicy::kMakeResident, .cpu = CpuResidencyPolicy::kReleaseAfterUpload
   });
 }
@@ -722,14 +763,14 @@ auto ResourceManager::LoadMesh(std::span<std::byte const> const bytes) -> MaybeN
 
 auto ResourceManager::LoadMaterial(
   std::span<std::byte const> const bytes,
-  YamlDeserializeContext const& ctx
-) -> MaybeNull<std::unique_ptr<Resource>> {
+  YamlDeserializeContext const ctx
+) -> Task<MaybeNull<std::unique_ptr<Resource>>> {
   // TODO rewrite this to spanstream when upgrading to C++23
   auto mtl = std::make_unique<Material>(GpuResidencyPolicy::kDeferUpload);
-  mtl->Deserialize(YAML::Load(std::string{
+  co_await mtl->DeserializeAsync(YAML::Load(std::string{
     reinterpret_cast<char const*>(bytes.data()), bytes.size()
   }), ctx);
-  return mtl;
+  co_return std::move(mtl);
 }
 
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core.hpp"
+#include "handle.hpp"
 #include "mutex.hpp"
 #include "observer_ptr.hpp"
 #include "Serialization.hpp"
@@ -8,17 +9,143 @@
 #include "resources/Mesh.hpp"
 #include "Resources/Resource.hpp"
 
+#include <array>
+#include <atomic>
 #include <concepts>
+#include <coroutine>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 
 namespace sorcery {
 class JobSystem;
-struct Job;
+class LoadIoAwaiter;
+class ResourceManager;
+
+
+template<typename T>
+class Task;
+
+
+namespace detail {
+class DetachedTask;
+}
+
+
+enum class ResourceLoadState : std::uint8_t {
+  kPending = 0,
+  kReady   = 1,
+  kFailed  = 2
+};
+
+
+// Shared state of a single resource load, jointly owned by the manager while the load is in flight and by all handles.
+// A load only completes after the loads it started while decoding, e.g. the textures of a material, have completed.
+class ResourceLoadRequest {
+public:
+  LEOPPHAPI ResourceLoadRequest(JobSystem& job_system, ResourceId const& res_id);
+
+  [[nodiscard]] LEOPPHAPI auto GetId() const noexcept -> ResourceId const&;
+  [[nodiscard]] LEOPPHAPI auto GetState() const noexcept -> ResourceLoadState;
+  // Null unless the load has succeeded. The resource is not evicted while the request exists.
+  [[nodiscard]] LEOPPHAPI auto GetResource() const noexcept -> Resource*;
+
+  // The callback is invoked exactly once on the thread that completes the load,
+  // or immediately on the calling thread if the load has already completed.
+  LEOPPHAPI auto OnComplete(std::function<void(Resource*)> callback) -> void;
+  // Registers the coroutine to be resumed on the thread that completes the load.
+  // Returns false without registering it if the load has already completed.
+  [[nodiscard]] LEOPPHAPI auto ResumeOnComplete(std::coroutine_handle<> handle) -> bool;
+  // Blocks until the load completes while executing jobs on the calling thread.
+  // Steps of the load that are queued at background priority are run first.
+  LEOPPHAPI auto Wait() const -> void;
+
+private:
+  LEOPPHAPI auto Complete(Resource* resource) -> void;
+  // Resumes the load if it has a step waiting in the background queue
+  auto ResumeQueuedStep() const -> bool;
+
+  ObserverPtr<JobSystem> job_system_;
+  ResourceId res_id_;
+  // Written before the state is published
+  Handle<Resource> resource_;
+  std::atomic<ResourceLoadState> state_{ResourceLoadState::kPending};
+  Mutex<std::vector<std::function<void(Resource*)>>> callbacks_;
+  // Whoever exchanges it first, a background job or a waiting thread, resumes the load
+  mutable std::atomic<std::coroutine_handle<>> queued_step_;
+
+  friend LoadIoAwaiter;
+  friend ResourceManager;
+};
+
+
+// Runs read on the I/O lane, then resumes the awaiting load at background priority with its result.
+// A thread that waits for the request resumes the load itself instead of queueing behind higher priority work.
+class LoadIoAwaiter {
+public:
+  LEOPPHAPI LoadIoAwaiter(std::shared_ptr<ResourceLoadRequest> request, std::function<bool()> read);
+
+  [[nodiscard]] LEOPPHAPI static auto await_ready() noexcept -> bool;
+  LEOPPHAPI auto await_suspend(std::coroutine_handle<> handle) -> void;
+  [[nodiscard]] LEOPPHAPI auto await_resume() const noexcept -> bool;
+
+private:
+  std::shared_ptr<ResourceLoadRequest> request_;
+  std::function<bool()> read_;
+  bool read_succeeded_{false};
+};
+
+
+[[nodiscard]] LEOPPHAPI auto RunLoadIo(std::shared_ptr<ResourceLoadRequest> request,
+                                       std::function<bool()> read) -> LoadIoAwaiter;
+
+
+template<std::derived_from<Resource> ResType = Resource>
+class ResourceHandle {
+public:
+  ResourceHandle() = default;
+  explicit ResourceHandle(std::shared_ptr<ResourceLoadRequest> request) noexcept;
+
+  // Empty handles report kFailed
+  [[nodiscard]] auto GetState() const noexcept -> ResourceLoadState;
+  [[nodiscard]] auto IsPending() const noexcept -> bool;
+  [[nodiscard]] auto IsReady() const noexcept -> bool;
+  [[nodiscard]] auto IsFailed() const noexcept -> bool;
+
+  // Null unless the load has succeeded and the resource is a ResType
+  [[nodiscard]] auto Get() const noexcept -> ResType*;
+
+  template<std::invocable<ResType*> Callback>
+  auto OnComplete(Callback&& callback) const -> void;
+  auto Wait() const -> ResType*;
+
+  // Suspends the awaiting coroutine until the load completes, then yields the same as Get
+  [[nodiscard]] auto operator co_await() const noexcept;
+
+private:
+  std::shared_ptr<ResourceLoadRequest> request_;
+};
+
+
+// Replaces reading and decoding the files of the project, e.g. in tests
+class ResourceLoader {
+public:
+  virtual ~ResourceLoader() = default;
+
+  // Awaited on the job system. A null resource fails the load.
+  // Blocking reads should go through RunLoadIo so that threads waiting for the request can speed the load up.
+  [[nodiscard]] virtual auto Load(std::shared_ptr<ResourceLoadRequest> request,
+                                  std::filesystem::path path_abs) -> Task<MaybeNull<std::unique_ptr<Resource>>> = 0;
+};
 
 
 class ResourceManager {
@@ -36,16 +163,47 @@ public:
   };
 
 
-  LEOPPHAPI explicit ResourceManager(JobSystem& job_system);
+  struct MemoryBudget {
+    std::size_t cpu_bytes{std::numeric_limits<std::size_t>::max()};
+    std::size_t gpu_bytes{std::numeric_limits<std::size_t>::max()};
+  };
+
+
+  struct CacheStats {
+    std::uint64_t hit_count{0};
+    std::uint64_t miss_count{0};
+    std::uint64_t eviction_count{0};
+    std::size_t cpu_bytes{0};
+    std::size_t gpu_bytes{0};
+  };
 
+
+  LEOPPHAPI explicit ResourceManager(JobSystem& job_system, std::unique_ptr<ResourceLoader> loader = nullptr);
+
+  // Blocks until the resource is loaded. The returned pointer is not tracked, so the resource is never evicted.
+  // Prefer RequestLoad, or storing the resource in a Handle, for resources that may be evicted.
   template<std::derived_from<Resource> ResType = Resource>
   auto GetOrLoad(ResourceId const& res_id) -> ResType*;
 
+  // Starts loading the resource in the background if it is not loaded or being loaded already.
+  // Requests for the same resource share a single load.
+  template<std::derived_from<Resource> ResType = Resource>
+  [[nodiscard]] auto RequestLoad(ResourceId const& res_id) -> ResourceHandle<ResType>;
+
   LEOPPHAPI auto Unload(ResourceId const& res_id) -> void;
   LEOPPHAPI auto UnloadAll() -> void;
 
   [[nodiscard]] LEOPPHAPI auto IsLoaded(ResourceId const& res_id) -> bool;
 
+  [[nodiscard]] LEOPPHAPI auto GetMemoryBudget() const noexcept -> MemoryBudget;
+  LEOPPHAPI auto SetMemoryBudget(MemoryBudget const& budget) noexcept -> void;
+
+  // Evicts resources loaded from files that nothing references, in CLOCK order, until usage fits the budget.
+  // Resources used since the previous call get a second chance. Called by App once per frame.
+  LEOPPHAPI auto EnforceMemoryBudget() -> void;
+
+  [[nodiscard]] LEOPPHAPI auto GetCacheStats() -> CacheStats;
+
   template<std::derived_from<Resource> ResType>
   auto Add(std::unique_ptr<ResType> resource) -> ObserverPtr<ResType>;
 
@@ -72,22 +230,44 @@ public:
   constexpr static std::string_view MATERIAL_RESOURCE_EXT{".mtl"};
 
 private:
-  struct ResourceIdLess {
-    using is_transparent = void;
+  // Immutable snapshot of the mappings. Readers load it without locking, UpdateMappings publishes a new one.
+  struct Mappings {
+    std::unordered_map<ResourceId, ResourceDescription> resources;
+    std::unordered_map<Guid, std::filesystem::path> files;
+  };
+
+
+  struct LoadedResource {
+    std::unique_ptr<Resource> resource;
+    // Only resources that can be loaded again from their files are evicted.
+    // Cleared under the shared lock once GetOrLoad hands out an untracked pointer.
+    mutable std::atomic<bool> evictable;
+    // CLOCK reference bit, set on every lookup
+    mutable std::atomic<bool> recently_used{true};
+  };
+
 
-    [[nodiscard]] LEOPPHAPI auto operator()(std::unique_ptr<Resource> const& lhs,
-                                            std::unique_ptr<Resource> const& rhs) const noexcept -> bool;
+  using LoadedResourceMap = std::unordered_map<ResourceId, LoadedResource>;
 
-    [[nodiscard]] LEOPPHAPI auto operator()(std::unique_ptr<Resource> const& lhs,
-                                            ResourceId const& rhs) const noexcept -> bool;
 
-    [[nodiscard]] LEOPPHAPI auto operator()(ResourceId const& lhs,
-                                            std::unique_ptr<Resource> const& rhs) const noexcept -> bool;
+  // Loaded resources are spread over independently locked shards so lookups of different resources don't contend
+  struct alignas(64) LoadedResourceShard {
+    Mutex<LoadedResourceMap, true> resources;
+    std::atomic<std::uint64_t> hit_count{0};
+    std::atomic<std::uint64_t> miss_count{0};
+    std::atomic<std::uint64_t> eviction_count{0};
   };
 
 
-  [[nodiscard]] LEOPPHAPI auto InternalLoadResource(ResourceId const& res_id,
-                                                    ResourceDescription const& desc) -> ObserverPtr<Resource>;
+  [[nodiscard]] LEOPPHAPI auto GetLoadedResourceShard(ResourceId const& res_id) -> LoadedResourceShard&;
+  [[nodiscard]] auto CalculateMemoryUsage() -> std::pair<std::size_t, std::size_t>;
+  [[nodiscard]] LEOPPHAPI auto InternalRequestLoad(ResourceId const& res_id) -> std::shared_ptr<ResourceLoadRequest>;
+  // Publishes the loaded resource and completes the request
+  auto Load(std::shared_ptr<ResourceLoadRequest> request, ResourceDescription desc,
+            std::filesystem::path path_abs) -> detail::DetachedTask;
+  // Reads on the I/O lane and decodes on the compute workers
+  [[nodiscard]] auto LoadFromFile(std::shared_ptr<ResourceLoadRequest> request,
+                                  std::filesystem::path path_abs) -> Task<MaybeNull<std::unique_ptr<Resource>>>;
   [[nodiscard]] static auto LoadTexture(
     std::span<std::byte const> bytes
   ) noexcept -> MaybeNull<std::unique_ptr<Resource>>;
@@ -96,10 +276,16 @@ private:
     std::span<std::byte const> bytes
   ) -> MaybeNull<std::unique_ptr<Resource>>;
 
-  [[nodiscard]] static auto LoadMaterial(
-    std::span<std::byte const> bytes, YamlDeserializeContext const& ctx
+  // Meshes serialized field by field, before the mesh blob format
+  [[nodiscard]] static auto LoadLegacyMesh(
+    std::span<std::byte const> bytes
   ) -> MaybeNull<std::unique_ptr<Resource>>;
 
+  // Completes once the textures of the material have loaded
+  [[nodiscard]] static auto LoadMaterial(
+    std::span<std::byte const> bytes, YamlDeserializeContext ctx
+  ) -> Task<MaybeNull<std::unique_ptr<Resource>>>;
+
   [[nodiscard]] static auto LoadPrefab(
     std::span<std::byte const> bytes, YamlDeserializeContext const& ctx
   ) -> MaybeNull<std::unique_ptr<Resource>>;
@@ -109,19 +295,28 @@ private:
   inline static Guid const plane_mesh_guid_{3, 0};
   inline static Guid const sphere_mesh_guid_{4, 0};
 
-  Mutex<std::set<std::unique_ptr<Resource>, ResourceIdLess>, true> loaded_resources_;
+  constexpr static std::size_t loaded_resource_shard_count_{16};
+
+  std::array<LoadedResourceShard, loaded_resource_shard_count_> loaded_resource_shards_;
   std::vector<ObserverPtr<Resource>> default_resources_;
 
-  Mutex<std::map<ResourceId, ResourceDescription>, true> res_mappings_;
-  Mutex<std::map<Guid, std::filesystem::path>, true> file_mappings_;
+  std::atomic<std::shared_ptr<Mappings const>> mappings_;
+
+  std::atomic<std::size_t> cpu_budget_{std::numeric_limits<std::size_t>::max()};
+  std::atomic<std::size_t> gpu_budget_{std::numeric_limits<std::size_t>::max()};
+  // Shard the next eviction sweep starts at
+  std::size_t clock_hand_{0};
 
-  Mutex<std::map<ResourceId, ObserverPtr<Job>>, true> loader_jobs_;
+  // In-flight loads. Locked before the loaded resource shards when both are needed.
+  Mutex<std::map<ResourceId, std::shared_ptr<ResourceLoadRequest>>> load_requests_;
 
   std::unique_ptr<Material> default_mtl_;
   std::unique_ptr<Mesh> cube_mesh_;
   std::unique_ptr<Mesh> plane_mesh_;
   std::unique_ptr<Mesh> sphere_mesh_;
 
+  // Null if resources are loaded from their files
+  std::unique_ptr<ResourceLoader> loader_;
   ObserverPtr<JobSystem> job_system_;
 };
 }
@@ -2,10 +2,107 @@
 
 #include "Util.hpp"
 
+#include <functional>
 #include <utility>
 
 
 namespace sorcery {
+template<std::derived_from<Resource> ResType>
+ResourceHandle<ResType>::ResourceHandle(std::shared_ptr<ResourceLoadRequest> request) noexcept :
+  request_{std::move(request)} {}
+
+
+template<std::derived_from<Resource> ResType>
+auto ResourceHandle<ResType>::GetState() const noexcept -> ResourceLoadState {
+  return request_ ? request_->GetState() : ResourceLoadState::kFailed;
+}
+
+
+template<std::derived_from<Resource> ResType>
+auto ResourceHandle<ResType>::IsPending() const noexcept -> bool {
+  return GetState() == ResourceLoadState::kPending;
+}
+
+
+template<std::derived_from<Resource> ResType>
+auto ResourceHandle<ResType>::IsReady() const noexcept -> bool {
+  return GetState() == ResourceLoadState::kReady;
+}
+
+
+template<std::derived_from<Resource> ResType>
+auto ResourceHandle<ResType>::IsFailed() const noexcept -> bool {
+  return GetState() == ResourceLoadState::kFailed;
+}
+
+
+template<std::derived_from<Resource> ResType>
+auto ResourceHandle<ResType>::Get() const noexcept -> ResType* {
+  if (!request_) {
+    return nullptr;
+  }
+
+  if constexpr (!std::is_same_v<ResType, Resource>) {
+    return rttr::rttr_cast<ResType*>(request_->GetResource());
+  } else {
+    return request_->GetResource();
+  }
+}
+
+
+template<std::derived_from<Resource> ResType>
+template<std::invocable<ResType*> Callback>
+auto ResourceHandle<ResType>::OnComplete(Callback&& callback) const -> void {
+  if (!request_) {
+    std::invoke(std::forward<Callback>(callback), nullptr);
+    return;
+  }
+
+  request_->OnComplete([callback{std::forward<Callback>(callback)}](Resource* const res) mutable {
+    if constexpr (!std::is_same_v<ResType, Resource>) {
+      std::invoke(callback, rttr::rttr_cast<ResType*>(res));
+    } else {
+      std::invoke(callback, res);
+    }
+  });
+}
+
+
+template<std::derived_from<Resource> ResType>
+auto ResourceHandle<ResType>::Wait() const -> ResType* {
+  if (request_) {
+    request_->Wait();
+  }
+
+  return Get();
+}
+
+
+template<std::derived_from<Resource> ResType>
+auto ResourceHandle<ResType>::operator co_await() const noexcept {
+  struct Awaiter {
+    ResourceHandle handle;
+
+
+    [[nodiscard]] auto await_ready() const noexcept -> bool {
+      return !handle.IsPending();
+    }
+
+
+    [[nodiscard]] auto await_suspend(std::coroutine_handle<> const awaiting) const -> bool {
+      return handle.request_->ResumeOnComplete(awaiting);
+    }
+
+
+    [[nodiscard]] auto await_resume() const noexcept -> ResType* {
+      return handle.Get();
+    }
+  };
+
+  return Awaiter{*this};
+}
+
+
 template<std::derived_from<Resource> ResType>
 auto ResourceManager::GetOrLoad(ResourceId const& res_id) -> ResType* {
   // Check default resources
@@ -21,48 +118,49 @@ auto ResourceManager::GetOrLoad(ResourceId const& res_id) -> ResType* {
 
   // Check loaded resources
   {
-    auto const resources{loaded_resources_.LockShared()};
+    auto& shard{GetLoadedResourceShard(res_id)};
+    auto const resources{shard.resources.LockShared()};
 
     if (auto const it{resources->find(res_id)}; it != std::end(*resources)) {
+      it->second.recently_used.store(true, std::memory_order_relaxed);
+      it->second.evictable.store(false, std::memory_order_relaxed);
+      shard.hit_count.fetch_add(1, std::memory_order_relaxed);
+
       if constexpr (!std::is_same_v<ResType, Resource>) {
-        return rttr::rttr_cast<ResType*>(it->get());
+        return rttr::rttr_cast<ResType*>(it->second.resource.get());
       } else {
-        return it->get();
+        return it->second.resource.get();
       }
     }
   }
 
-  // Check in file mappings
+  // Load resource. The request pins it until it is marked as not evictable.
+  auto const handle{RequestLoad<ResType>(res_id)};
 
-  std::optional<ResourceDescription> desc;
+  if (handle.Wait()) {
+    auto const resources{GetLoadedResourceShard(res_id).resources.LockShared()};
 
-  {
-    auto const mappings{res_mappings_.LockShared()};
-    if (auto const it{mappings->find(res_id)}; it != std::end(*mappings)) {
-      desc = it->second;
+    if (auto const it{resources->find(res_id)}; it != std::end(*resources)) {
+      it->second.evictable.store(false, std::memory_order_relaxed);
     }
   }
 
-  // Load resource
+  return handle.Get();
+}
 
-  if (desc) {
-    if (auto const res{InternalLoadResource(res_id, *desc)}) {
-      if constexpr (!std::is_same_v<ResType, Resource>) {
-        return rttr::rttr_cast<ResType*>(res.Get());
-      } else {
-        return res.Get();
-      }
-    }
-  }
 
-  return nullptr;
+template<std::derived_from<Resource> ResType>
+auto ResourceManager::RequestLoad(ResourceId const& res_id) -> ResourceHandle<ResType> {
+  return ResourceHandle<ResType>{InternalRequestLoad(res_id)};
 }
 
 
 template<std::derived_from<Resource> ResType>
 auto ResourceManager::Add(std::unique_ptr<ResType> resource) -> ObserverPtr<ResType> {
   if (resource && resource->GetId().IsValid()) {
-    return ObserverPtr{loaded_resources_.Lock()->emplace(std::move(resource)).first->get()};
+    auto const res_id{resource->GetId()};
+    auto resources{GetLoadedResourceShard(res_id).resources.Lock()};
+    return ObserverPtr{resources->try_emplace(res_id, std::move(resource), false).first->second.resource.get()};
   }
 
   return nullptr;
@@ -71,19 +169,17 @@ auto ResourceManager::Add(std::unique_ptr<ResType> resource) -> ObserverPtr<ResT
 
 template<std::derived_from<Resource> ResType>
 auto ResourceManager::Remove(ResourceId const& res_id) -> std::unique_ptr<ResType> {
-  auto resources{loaded_resources_.Lock()};
+  auto resources{GetLoadedResourceShard(res_id).resources.Lock()};
 
-  if (auto const it{
-    std::ranges::find_if(*resources, [&res_id](std::unique_ptr<Resource> const& res) {
-      if constexpr (std::is_same_v<ResType, Resource>) {
-        return res->GetId() == res_id;
-      } else {
-        return res->GetId() == res_id && rttr::type::get(*res).get_raw_type().is_derived_from<ResType>();
+  if (auto const it{resources->find(res_id)}; it != std::end(*resources)) {
+    if constexpr (!std::is_same_v<ResType, Resource>) {
+      if (!rttr::type::get(*it->second.resource).get_raw_type().is_derived_from<ResType>()) {
+        return nullptr;
       }
-    })
-  }; it != std::end(*resources)) {
+    }
+
     auto node{resources->extract(it)};
-    return static_unique_ptr_cast<ResType>(std::move(node.value()));
+    return static_unique_ptr_cast<ResType>(std::move(node.mapped().resource));
   }
 
   return nullptr;
@@ -1,8 +1,25 @@
 #include "resource_package.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <map>
+#include <string_view>
 
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+
+#include "job_system.hpp"
+#include "mutex.hpp"
 #include "Serialization.hpp"
 #include "vector_stream.hpp"
 #include "resources/Cubemap.hpp"
@@ -64,12 +81,116 @@ namespace {
 }
 
 
+// XXH64, used for both payload checksums and name lookup
+class Xxh64 {
+public:
+  [[nodiscard]] static auto Hash(std::span<std::byte const> const bytes, std::uint64_t const seed) noexcept -> std::uint64_t {
+    auto data{bytes.data()};
+    auto const end{data + bytes.size()};
+    std::uint64_t hash;
+
+    if (bytes.size() >= 32) {
+      std::array acc{seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1};
+
+      for (; end - data >= 32; data += 32) {
+        for (std::size_t i{0}; i < acc.size(); i++) {
+          acc[i] = Round(acc[i], Read<std::uint64_t>(data + i * 8));
+        }
+      }
+
+      hash = std::rotl(acc[0], 1) + std::rotl(acc[1], 7) + std::rotl(acc[2], 12) + std::rotl(acc[3], 18);
+
+      for (auto const lane : acc) {
+        hash = (hash ^ Round(0, lane)) * kPrime1 + kPrime4;
+      }
+    } else {
+      hash = seed + kPrime5;
+    }
+
+    hash += bytes.size();
+
+    for (; end - data >= 8; data += 8) {
+      hash = std::rotl(hash ^ Round(0, Read<std::uint64_t>(data)), 27) * kPrime1 + kPrime4;
+    }
+
+    if (end - data >= 4) {
+      hash = std::rotl(hash ^ Read<std::uint32_t>(data) * kPrime1, 23) * kPrime2 + kPrime3;
+      data += 4;
+    }
+
+    for (; data != end; ++data) {
+      hash = std::rotl(hash ^ std::to_integer<std::uint64_t>(*data) * kPrime5, 11) * kPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+  }
+
+private:
+  template<typename T>
+  [[nodiscard]] static auto Read(std::byte const* const data) noexcept -> T {
+    T ret;
+    std::memcpy(&ret, data, sizeof(T));
+    return ret;
+  }
+
+
+  [[nodiscard]] static auto Round(std::uint64_t const acc, std::uint64_t const input) noexcept -> std::uint64_t {
+    return std::rotl(acc + input * kPrime2, 31) * kPrime1;
+  }
+
+
+  constexpr static std::uint64_t kPrime1{0x9E3779B185EBCA87};
+  constexpr static std::uint64_t kPrime2{0xC2B2AE3D27D4EB4F};
+  constexpr static std::uint64_t kPrime3{0x165667B19E3779F9};
+  constexpr static std::uint64_t kPrime4{0x85EBCA77C2B2AE63};
+  constexpr static std::uint64_t kPrime5{0x27D4EB2F165667C5};
+};
+
+
+[[nodiscard]] auto HashEntryName(std::string_view const name, ResourceRuntimeType const runtime_type) -> std::uint64_t {
+  return Xxh64::Hash(std::as_bytes(std::span{name}), static_cast<std::uint64_t>(runtime_type));
+}
+
+
+[[nodiscard]] auto ComputePayloadChecksum(std::span<std::byte const> const payload) -> std::uint64_t {
+  return Xxh64::Hash(payload, 0);
+}
+
+
+[[nodiscard]] constexpr auto AlignUp(std::uint64_t const value, std::uint64_t const alignment) -> std::uint64_t {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+
+constexpr std::uint32_t kEmptyLookupBucket{std::numeric_limits<std::uint32_t>::max()};
+constexpr std::uint64_t kLookupTableAlignment{alignof(std::uint32_t)};
+
+
+template<typename T>
+[[nodiscard]] auto WriteValue(T const& value, std::ostream& os) -> bool {
+  return static_cast<bool>(os.write(reinterpret_cast<char const*>(&value), sizeof(value)));
+}
+
+
+template<typename T>
+[[nodiscard]] auto ReadValue(T& value, std::istream& is) -> bool {
+  return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+
 struct HeaderSerializer {
   [[nodiscard]] static
   auto Write(resource_package::Header const& header, std::ostream& os) -> bool {
-    return os.write(reinterpret_cast<char const* const>(&header.magic), sizeof(header.magic)) &&
-           os.write(reinterpret_cast<char const* const>(&header.version), sizeof(header.version)) &&
-           os.write(reinterpret_cast<char const* const>(&header.resource_count), sizeof(header.resource_count));
+    return WriteValue(header.magic, os) &&
+           WriteValue(header.version, os) &&
+           WriteValue(header.resource_count, os) &&
+           WriteValue(header.lookup_bucket_count, os) &&
+           WriteValue(header.lookup_table_offset, os);
   }
 
 
@@ -81,7 +202,7 @@ struct HeaderSerializer {
 
     resource_package::Header header;
 
-    if (!is.read(reinterpret_cast<char*>(&header.magic), sizeof(header.magic))) {
+    if (!ReadValue(header.magic, is)) {
       return std::nullopt;
     }
 
@@ -89,15 +210,21 @@ struct HeaderSerializer {
       return std::nullopt;
     }
 
-    if (!is.read(reinterpret_cast<char*>(&header.version), sizeof(header.version))) {
+    if (!ReadValue(header.version, is)) {
       return std::nullopt;
     }
 
-    if (header.version != 1) {
+    if (header.version < 1 || header.version > resource_package::kLatestVersion) {
       return std::nullopt;
     }
 
-    if (!is.read(reinterpret_cast<char*>(&header.resource_count), sizeof(header.resource_count))) {
+    if (!ReadValue(header.resource_count, is)) {
+      return std::nullopt;
+    }
+
+    // Version 1 headers end here
+    if (header.version >= 2 && !(ReadValue(header.lookup_bucket_count, is) &&
+                                 ReadValue(header.lookup_table_offset, is))) {
       return std::nullopt;
     }
 
@@ -105,100 +232,463 @@ struct HeaderSerializer {
   }
 
 
-  constexpr static auto kHeaderSize{3 * sizeof(std::uint32_t)};
+  [[nodiscard]] static constexpr auto GetSize(std::uint32_t const version) -> std::size_t {
+    return version >= 2 ? 4 * sizeof(std::uint32_t) + sizeof(std::uint64_t) : 3 * sizeof(std::uint32_t);
+  }
 };
 
 
 struct EntrySerializer {
   [[nodiscard]] static
   auto Write(resource_package::Entry const& entry, std::ostream& os) -> bool {
-    return os.write(reinterpret_cast<char const* const>(&entry.payload_kind), sizeof(entry.payload_kind)) &&
-           os.write(reinterpret_cast<char const* const>(&entry.runtime_type), sizeof(entry.runtime_type)) &&
-           os.write(reinterpret_cast<char const* const>(&entry.name_offset), sizeof(entry.name_offset)) &&
-           os.write(reinterpret_cast<char const* const>(&entry.name_size), sizeof(entry.name_size)) &&
-           os.write(reinterpret_cast<char const* const>(&entry.data_offset), sizeof(entry.data_offset)) &&
-           os.write(reinterpret_cast<char const* const>(&entry.data_size), sizeof(entry.data_size));
+    return WriteValue(entry.payload_kind, os) &&
+           WriteValue(entry.runtime_type, os) &&
+           WriteValue(entry.name_offset, os) &&
+           WriteValue(entry.name_size, os) &&
+           WriteValue(entry.data_offset, os) &&
+           WriteValue(entry.data_size, os) &&
+           WriteValue(entry.name_hash, os) &&
+           WriteValue(entry.checksum, os) &&
+           WriteValue(entry.codec, os) &&
+           WriteValue(entry.uncompressed_size, os);
   }
 
 
   [[nodiscard]] static
-  auto Read(std::istream& is, std::size_t const idx) -> std::optional<resource_package::Entry> {
-    if (!is.seekg(HeaderSerializer::kHeaderSize + idx * kEntrySize, std::ios::beg)) {
+  auto Read(std::istream& is, std::uint32_t const version,
+            std::size_t const idx) -> std::optional<resource_package::Entry> {
+    if (!is.seekg(HeaderSerializer::GetSize(version) + idx * GetSize(version), std::ios::beg)) {
       return std::nullopt;
     }
 
     resource_package::Entry entry;
 
-    if (!is.read(reinterpret_cast<char*>(&entry.payload_kind), sizeof(entry.payload_kind))) {
+    if (!ReadValue(entry.payload_kind, is) ||
+        !ReadValue(entry.runtime_type, is) ||
+        !ReadValue(entry.name_offset, is) ||
+        !ReadValue(entry.name_size, is) ||
+        !ReadValue(entry.data_offset, is) ||
+        !ReadValue(entry.data_size, is)) {
       return std::nullopt;
     }
 
-    if (!is.read(reinterpret_cast<char*>(&entry.runtime_type), sizeof(entry.runtime_type))) {
+    // Version 1 entries end here
+    if (version >= 2 && !(ReadValue(entry.name_hash, is) && ReadValue(entry.checksum, is))) {
       return std::nullopt;
     }
 
-    if (!is.read(reinterpret_cast<char*>(&entry.name_offset), sizeof(entry.name_offset))) {
-      return std::nullopt;
+    // Version 2 entries end here
+    if (version >= 3) {
+      if (!ReadValue(entry.codec, is) || !ReadValue(entry.uncompressed_size, is)) {
+        return std::nullopt;
+      }
+    } else {
+      entry.uncompressed_size = entry.data_size;
     }
 
-    if (!is.read(reinterpret_cast<char*>(&entry.name_size), sizeof(entry.name_size))) {
-      return std::nullopt;
+    return entry;
+  }
+
+
+  [[nodiscard]] static constexpr auto GetSize(std::uint32_t const version) -> std::size_t {
+    return sizeof(ResourcePackagePayloadKind) + sizeof(ResourceRuntimeType) + (version >= 2 ? 6 : 4) * sizeof(
+             std::uint64_t) + (version >= 3 ? sizeof(ResourcePackageCodec) + sizeof(std::uint64_t) : 0);
+  }
+};
+
+
+[[nodiscard]] auto ComputeNameTableOffset(std::size_t const subresource_count) -> std::size_t {
+  return HeaderSerializer::GetSize(resource_package::kLatestVersion) + EntrySerializer::GetSize(
+           resource_package::kLatestVersion) * subresource_count;
+}
+
+
+[[nodiscard]] auto IsEntryValid(resource_package::Entry const& entry, std::size_t const package_size) -> bool {
+  return !(entry.name_offset > package_size ||
+           entry.name_size > package_size - entry.name_offset ||
+           entry.data_offset > package_size ||
+           entry.data_size > package_size - entry.data_offset ||
+           entry.codec > ResourcePackageCodec::kZstd ||
+           (entry.codec == ResourcePackageCodec::kNone && entry.uncompressed_size != entry.data_size));
+}
+
+
+constexpr auto kLz4HcCompressionLevel{LZ4HC_CLEVEL_DEFAULT};
+constexpr auto kZstdCompressionLevel{9};
+
+
+[[nodiscard]] auto GetCompressionChunkCount(std::uint64_t const uncompressed_size) -> std::uint64_t {
+  return (uncompressed_size + resource_package::kCompressionChunkSize - 1) / resource_package::kCompressionChunkSize;
+}
+
+
+// Returns an empty vector on failure
+[[nodiscard]] auto CompressChunk(ResourcePackageCodec const codec, int const compression_level,
+                                 std::span<std::byte const> const src) -> std::vector<std::byte> {
+  std::vector<std::byte> dst;
+
+  switch (codec) {
+    case ResourcePackageCodec::kLz4: {
+      dst.resize(LZ4_compressBound(static_cast<int>(src.size())));
+      auto const size{
+        LZ4_compress_HC(reinterpret_cast<char const*>(src.data()), reinterpret_cast<char*>(dst.data()),
+          static_cast<int>(src.size()), static_cast<int>(dst.size()),
+          compression_level != 0 ? compression_level : kLz4HcCompressionLevel)
+      };
+      dst.resize(size > 0 ? static_cast<std::size_t>(size) : 0);
+      break;
     }
 
-    if (!is.read(reinterpret_cast<char*>(&entry.data_offset), sizeof(entry.data_offset))) {
-      return std::nullopt;
+    case ResourcePackageCodec::kZstd: {
+      dst.resize(ZSTD_compressBound(src.size()));
+      auto const size{
+        ZSTD_compress(dst.data(), dst.size(), src.data(), src.size(),
+          compression_level != 0 ? compression_level : kZstdCompressionLevel)
+      };
+      dst.resize(ZSTD_isError(size) ? 0 : size);
+      break;
+    }
+
+    case ResourcePackageCodec::kNone: {
+      break;
+    }
+  }
+
+  return dst;
+}
+
+
+[[nodiscard]] auto DecompressChunk(ResourcePackageCodec const codec, std::span<std::byte const> const src,
+                                   std::span<std::byte> const dst) -> bool {
+  switch (codec) {
+    case ResourcePackageCodec::kLz4: {
+      return LZ4_decompress_safe(reinterpret_cast<char const*>(src.data()), reinterpret_cast<char*>(dst.data()),
+               static_cast<int>(src.size()), static_cast<int>(dst.size())) == static_cast<int>(dst.size());
+    }
+
+    case ResourcePackageCodec::kZstd: {
+      return ZSTD_decompress(dst.data(), dst.size(), src.data(), src.size()) == dst.size();
+    }
+
+    case ResourcePackageCodec::kNone: {
+      break;
     }
+  }
+
+  return false;
+}
+
 
-    if (!is.read(reinterpret_cast<char*>(&entry.data_size), sizeof(entry.data_size))) {
+[[nodiscard]] auto IsLookupTableValid(resource_package::Header const& header, std::size_t const package_size) -> bool {
+  if (header.version < 2) {
+    return true;
+  }
+
+  // A power of two bucket count with at least one empty bucket, so probing always terminates
+  return std::has_single_bit(header.lookup_bucket_count) &&
+         header.lookup_bucket_count > header.resource_count &&
+         header.lookup_table_offset <= package_size &&
+         header.lookup_bucket_count * sizeof(std::uint32_t) <= package_size - header.lookup_table_offset;
+}
+
+
+struct PackageTables {
+  resource_package::Header header;
+  std::vector<resource_package::Entry> entries;
+};
+
+
+[[nodiscard]] auto ReadPackageTables(std::istream& is, std::size_t const package_size) -> std::optional<PackageTables> {
+  auto const header{HeaderSerializer::Read(is)};
+
+  if (!header || !IsLookupTableValid(*header, package_size)) {
+    return std::nullopt;
+  }
+
+  PackageTables tables{.header = *header};
+  tables.entries.reserve(header->resource_count);
+
+  for (std::size_t i{0}; i < header->resource_count; ++i) {
+    auto const entry{EntrySerializer::Read(is, header->version, i)};
+
+    if (!entry || !IsEntryValid(*entry, package_size)) {
       return std::nullopt;
     }
 
-    return entry;
+    tables.entries.push_back(*entry);
   }
 
+  return tables;
+}
+
 
-  constexpr static auto kEntrySize{
-    sizeof(ResourcePackagePayloadKind) + sizeof(ResourceRuntimeType) + 4 * sizeof(std::uint64_t)
+// Packages that are currently mapped, keyed by their absolute path
+Mutex<std::map<std::filesystem::path, std::weak_ptr<ResourcePackageView const>>> mapped_packages;
+}
+
+
+auto ResourcePackageView::Open(
+  std::filesystem::path const& file_path_abs
+) -> std::shared_ptr<ResourcePackageView const> {
+  {
+    auto const package_views{mapped_packages.Lock()};
+
+    if (auto const it{package_views->find(file_path_abs)}; it != package_views->end()) {
+      if (auto view{it->second.lock()}) {
+        return view;
+      }
+    }
+  }
+
+  // Opening, mapping and validating happen outside the lock so that loads of other packages are not held up.
+  // The destructor releases whatever was acquired so far if any of the steps below fail
+  std::shared_ptr<ResourcePackageView> view{new ResourcePackageView{}};
+
+  auto const file{
+    CreateFileW(file_path_abs.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+      nullptr)
   };
-};
 
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
 
-[[nodiscard]] auto ComputeNameTableOffset(std::size_t const subresource_count) -> std::size_t {
-  return HeaderSerializer::kHeaderSize + EntrySerializer::kEntrySize * subresource_count;
+  view->file_ = file;
+
+  LARGE_INTEGER file_size;
+
+  // Empty files cannot be mapped
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+    return nullptr;
+  }
+
+  view->mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+  if (!view->mapping_) {
+    return nullptr;
+  }
+
+  auto const data{MapViewOfFile(view->mapping_, FILE_MAP_READ, 0, 0, 0)};
+
+  if (!data) {
+    return nullptr;
+  }
+
+  view->bytes_ = std::span{static_cast<std::byte const*>(data), static_cast<std::size_t>(file_size.QuadPart)};
+
+  ByteSpanIstream is{view->bytes_};
+  auto tables{ReadPackageTables(is, view->bytes_.size())};
+
+  if (!tables) {
+    return nullptr;
+  }
+
+  view->header_ = tables->header;
+  view->entries_ = std::move(tables->entries);
+
+  auto package_views{mapped_packages.Lock()};
+
+  // Another thread might have mapped the same file in the meantime, the views have to be shared
+  if (auto const it{package_views->find(file_path_abs)}; it != package_views->end()) {
+    if (auto mapped_view{it->second.lock()}) {
+      return mapped_view;
+    }
+  }
+
+  std::erase_if(*package_views, [](auto const& mapped_package) {
+    return mapped_package.second.expired();
+  });
+
+  package_views->insert_or_assign(file_path_abs, view);
+  return view;
 }
 
 
-[[nodiscard]] auto IsEntryValid(resource_package::Entry const& entry, std::size_t const package_size) -> bool {
-  return !(entry.name_offset > package_size ||
-           entry.name_size > package_size - entry.name_offset ||
-           entry.data_offset > package_size ||
-           entry.data_size > package_size - entry.data_offset);
+ResourcePackageView::~ResourcePackageView() {
+  if (!bytes_.empty()) {
+    UnmapViewOfFile(bytes_.data());
+  }
+
+  if (mapping_) {
+    CloseHandle(mapping_);
+  }
+
+  if (file_) {
+    CloseHandle(file_);
+  }
+}
+
+
+auto ResourcePackageView::GetEntryCount() const noexcept -> std::size_t {
+  return entries_.size();
 }
+
+
+auto ResourcePackageView::GetSubresource(
+  std::size_t const entry_idx
+) const noexcept -> std::optional<ResourcePackageSubresourceView> {
+  if (entry_idx >= entries_.size()) {
+    return std::nullopt;
+  }
+
+  auto const& entry{entries_[entry_idx]};
+
+  return ResourcePackageSubresourceView{
+    .name = std::string_view{reinterpret_cast<char const*>(bytes_.data() + entry.name_offset), entry.name_size},
+    .bytes = bytes_.subspan(entry.data_offset, entry.data_size),
+    .payload_kind = entry.payload_kind,
+    .codec = entry.codec,
+    .uncompressed_size = entry.uncompressed_size
+  };
+}
+
+
+auto ResourcePackageView::FindEntry(std::string_view const name,
+                                    ResourceRuntimeType const runtime_type) const noexcept -> std::optional<std::size_t> {
+  auto const matches{
+    [this, name, runtime_type](std::size_t const entry_idx) {
+      auto const& entry{entries_[entry_idx]};
+      return entry.runtime_type == runtime_type && std::string_view{
+               reinterpret_cast<char const*>(bytes_.data() + entry.name_offset), entry.name_size
+             } == name;
+    }
+  };
+
+  if (header_.version < 2) {
+    for (std::size_t i{0}; i < entries_.size(); i++) {
+      if (matches(i)) {
+        return i;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  auto const hash{HashEntryName(name, runtime_type)};
+  auto const bucket_mask{header_.lookup_bucket_count - 1};
+  auto const buckets{bytes_.data() + header_.lookup_table_offset};
+
+  for (auto bucket_idx{static_cast<std::uint32_t>(hash) & bucket_mask};; bucket_idx = (bucket_idx + 1) & bucket_mask) {
+    std::uint32_t entry_idx;
+    std::memcpy(&entry_idx, buckets + bucket_idx * sizeof(std::uint32_t), sizeof(entry_idx));
+
+    if (entry_idx == kEmptyLookupBucket || entry_idx >= entries_.size()) {
+      return std::nullopt;
+    }
+
+    if (entries_[entry_idx].name_hash == hash && matches(entry_idx)) {
+      return entry_idx;
+    }
+  }
+}
+
+
+auto ResourcePackageView::VerifyChecksum(std::size_t const entry_idx) const noexcept -> bool {
+  if (entry_idx >= entries_.size()) {
+    return false;
+  }
+
+  if (header_.version < 2) {
+    return true;
+  }
+
+  auto const& entry{entries_[entry_idx]};
+  return ComputePayloadChecksum(bytes_.subspan(entry.data_offset, entry.data_size)) == entry.checksum;
+}
+
+
+auto ResourcePackageView::Prefetch(std::size_t const entry_idx) const noexcept -> void {
+  if (entry_idx >= entries_.size()) {
+    return;
+  }
+
+  auto const& entry{entries_[entry_idx]};
+
+  WIN32_MEMORY_RANGE_ENTRY range{
+    .VirtualAddress = const_cast<std::byte*>(bytes_.data() + entry.data_offset),
+    .NumberOfBytes = entry.data_size
+  };
+
+  // Failing here is harmless, the pages are faulted in on first access instead
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
 }
 
 
 auto PackBinaryResourcePackage(
-  std::span<ResourceImportResult const> const imports
+  std::span<ResourceImportResult const> const imports,
+  JobSystem& job_system,
+  ResourcePackageCodec const codec,
+  int const compression_level
 ) -> std::optional<std::vector<std::byte>> {
-  std::vector<std::byte> package_bytes;
-  ByteVectorOstream os{package_bytes};
+  // Compress every chunk of every payload independently so that the work spreads evenly across the workers
 
-  resource_package::Header const header{
-    .magic = resource_package::kMagic,
-    .version = 1,
-    .resource_count = static_cast<std::uint32_t>(imports.size())
+  struct CompressionChunk {
+    std::size_t import_idx;
+    std::span<std::byte const> src;
+    std::vector<std::byte> dst;
   };
 
-  if (!HeaderSerializer::Write(header, os)) {
-    return std::nullopt;
+  std::vector<CompressionChunk> chunks;
+
+  if (codec != ResourcePackageCodec::kNone) {
+    for (std::size_t i{0}; i < imports.size(); i++) {
+      for (std::uint64_t offset{0}; offset < imports[i].bytes.size(); offset += resource_package::kCompressionChunkSize) {
+        chunks.emplace_back(i, std::span{imports[i].bytes}.subspan(offset,
+          std::min(resource_package::kCompressionChunkSize, imports[i].bytes.size() - offset)));
+      }
+    }
+
+    job_system.ParallelFor(0, chunks.size(), [&chunks, codec, compression_level](std::size_t const chunk_idx) {
+      chunks[chunk_idx].dst = CompressChunk(codec, compression_level, chunks[chunk_idx].src);
+    }, 1);
   }
 
+  // Assemble the stored payloads, falling back to the raw bytes for payloads that did not shrink
+
+  std::vector<std::vector<std::byte>> compressed_payloads(imports.size());
+
+  for (auto chunk_it{std::begin(chunks)}; chunk_it != std::end(chunks);) {
+    auto const import_idx{chunk_it->import_idx};
+    auto const chunks_end{
+      std::find_if(chunk_it, std::end(chunks), [import_idx](CompressionChunk const& chunk) {
+        return chunk.import_idx != import_idx;
+      })
+    };
+
+    std::vector<std::uint64_t> chunk_end_offsets;
+    std::uint64_t chunk_data_size{0};
+    auto failed{false};
+
+    for (auto it{chunk_it}; it != chunks_end; ++it) {
+      failed = failed || it->dst.empty();
+      chunk_data_size += it->dst.size();
+      chunk_end_offsets.emplace_back(chunk_data_size);
+    }
+
+    if (auto const offset_table_size{chunk_end_offsets.size() * sizeof(std::uint64_t)};
+      !failed && offset_table_size + chunk_data_size < imports[import_idx].bytes.size()) {
+      auto& payload{compressed_payloads[import_idx]};
+      payload.reserve(offset_table_size + chunk_data_size);
+      std::ranges::copy(std::as_bytes(std::span{chunk_end_offsets}), std::back_inserter(payload));
+
+      for (auto it{chunk_it}; it != chunks_end; ++it) {
+        std::ranges::copy(it->dst, std::back_inserter(payload));
+      }
+    }
+
+    chunk_it = chunks_end;
+  }
+
+  chunks.clear();
+
   std::vector<resource_package::Entry> entries;
+  entries.reserve(imports.size());
 
   auto const name_table_offset{ComputeNameTableOffset(imports.size())};
   std::uint64_t name_table_size{0};
 
-  for (auto const& import_data : imports) {
+  for (std::size_t i{0}; i < imports.size(); i++) {
+    auto const& import_data{imports[i]};
     auto const runtime_type = ToRuntimeType(import_data.runtime_type);
 
     if (!runtime_type) {
@@ -206,18 +696,56 @@ auto PackBinaryResourcePackage(
       return std::nullopt;
     }
 
-    // Data offsets will be filled in later when we know the size of the name table
+    auto const is_compressed{!compressed_payloads[i].empty()};
+    std::span const stored_bytes{is_compressed ? compressed_payloads[i] : import_data.bytes};
+
+    // Data offsets will be filled in later when we know the size of the name and lookup tables
     entries.emplace_back(import_data.payload_kind, *runtime_type, name_table_offset + name_table_size,
-      import_data.name.size(), 0, import_data.bytes.size());
+      import_data.name.size(), 0, stored_bytes.size(), HashEntryName(import_data.name, *runtime_type),
+      ComputePayloadChecksum(stored_bytes), is_compressed ? codec : ResourcePackageCodec::kNone,
+      import_data.bytes.size());
     name_table_size += import_data.name.size();
   }
 
-  auto const data_table_offset{name_table_offset + name_table_size};
-  std::uint64_t data_table_size{0};
+  // Keep the load factor at or below one half
+  auto const bucket_count{std::bit_ceil(static_cast<std::uint32_t>(imports.size()) * 2 + 1)};
+  std::vector lookup_table(bucket_count, kEmptyLookupBucket);
 
-  for (std::size_t i{0}; i < imports.size(); ++i) {
-    entries[i].data_offset = data_table_offset + data_table_size;
-    data_table_size += entries[i].data_size;
+  for (std::uint32_t i{0}; i < entries.size(); i++) {
+    auto bucket_idx{static_cast<std::uint32_t>(entries[i].name_hash) & (bucket_count - 1)};
+
+    while (lookup_table[bucket_idx] != kEmptyLookupBucket) {
+      bucket_idx = (bucket_idx + 1) & (bucket_count - 1);
+    }
+
+    lookup_table[bucket_idx] = i;
+  }
+
+  auto const lookup_table_offset{AlignUp(name_table_offset + name_table_size, kLookupTableAlignment)};
+  auto const lookup_table_size{lookup_table.size() * sizeof(std::uint32_t)};
+
+  // Payloads are aligned so that they can be used in place from a mapping of the package
+  auto data_table_size{AlignUp(lookup_table_offset + lookup_table_size, resource_package::kPayloadAlignment)};
+
+  for (auto& entry : entries) {
+    entry.data_offset = data_table_size;
+    data_table_size = AlignUp(data_table_size + entry.data_size, resource_package::kPayloadAlignment);
+  }
+
+  resource_package::Header const header{
+    .magic = resource_package::kMagic,
+    .version = resource_package::kLatestVersion,
+    .resource_count = static_cast<std::uint32_t>(imports.size()),
+    .lookup_bucket_count = bucket_count,
+    .lookup_table_offset = lookup_table_offset
+  };
+
+  std::vector<std::byte> package_bytes;
+  package_bytes.reserve(data_table_size);
+  ByteVectorOstream os{package_bytes};
+
+  if (!HeaderSerializer::Write(header, os)) {
+    return std::nullopt;
   }
 
   for (auto const& entry : entries) {
@@ -231,40 +759,92 @@ auto PackBinaryResourcePackage(
       std::back_inserter(package_bytes));
   }
 
-  for (auto const& import_data : imports) {
-    std::ranges::copy_n(import_data.bytes.begin(), import_data.bytes.size(), std::back_inserter(package_bytes));
+  package_bytes.resize(lookup_table_offset);
+  std::ranges::copy(std::as_bytes(std::span{lookup_table}), std::back_inserter(package_bytes));
+
+  for (std::size_t i{0}; i < imports.size(); i++) {
+    package_bytes.resize(entries[i].data_offset);
+    std::ranges::copy(compressed_payloads[i].empty() ? imports[i].bytes : compressed_payloads[i],
+      std::back_inserter(package_bytes));
   }
 
+  package_bytes.resize(data_table_size);
   return package_bytes;
 }
 
 
-auto UnpackBinaryResourcePackageEntries(
-  std::span<std::byte const> file_bytes
-) -> std::optional<std::vector<resource_package::Entry>> {
-  auto const package_size{file_bytes.size()};
-  ByteSpanIstream is{file_bytes};
+auto DecompressResourcePackagePayload(
+  ResourcePackageSubresourceView const& subresource,
+  std::span<std::byte> const out,
+  ObserverPtr<JobSystem> const job_system
+) -> bool {
+  if (out.size() != subresource.uncompressed_size) {
+    return false;
+  }
 
-  auto const header{HeaderSerializer::Read(is)};
+  if (subresource.codec == ResourcePackageCodec::kNone) {
+    if (subresource.bytes.size() != out.size()) {
+      return false;
+    }
 
-  if (!header) {
-    return std::nullopt;
+    std::ranges::copy(subresource.bytes, out.begin());
+    return true;
   }
 
-  std::vector<resource_package::Entry> entries;
-  entries.reserve(header->resource_count);
+  auto const chunk_count{GetCompressionChunkCount(subresource.uncompressed_size)};
+  auto const offset_table_size{chunk_count * sizeof(std::uint64_t)};
 
-  for (std::size_t i{0}; i < header->resource_count; ++i) {
-    auto const entry{EntrySerializer::Read(is, i)};
+  if (subresource.bytes.size() < offset_table_size) {
+    return false;
+  }
 
-    if (!entry || !IsEntryValid(*entry, package_size)) {
-      return std::nullopt;
+  std::vector<std::uint64_t> chunk_end_offsets(chunk_count);
+  std::memcpy(chunk_end_offsets.data(), subresource.bytes.data(), offset_table_size);
+
+  auto const chunk_data{subresource.bytes.subspan(offset_table_size)};
+
+  if (!std::ranges::is_sorted(chunk_end_offsets) || (chunk_count > 0 && chunk_end_offsets.back() > chunk_data.size())) {
+    return false;
+  }
+
+  std::atomic_bool succeeded{true};
+
+  auto const decompress_chunk{
+    [&](std::size_t const chunk_idx) {
+      auto const src_begin{chunk_idx == 0 ? 0 : chunk_end_offsets[chunk_idx - 1]};
+      auto const dst_begin{chunk_idx * resource_package::kCompressionChunkSize};
+
+      if (!DecompressChunk(subresource.codec,
+        chunk_data.subspan(src_begin, chunk_end_offsets[chunk_idx] - src_begin),
+        out.subspan(dst_begin, std::min(resource_package::kCompressionChunkSize, out.size() - dst_begin)))) {
+        succeeded.store(false, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  if (job_system) {
+    job_system->ParallelFor(0, chunk_count, decompress_chunk, 1);
+  } else {
+    for (std::size_t i{0}; i < chunk_count; i++) {
+      decompress_chunk(i);
     }
+  }
+
+  return succeeded.load(std::memory_order_relaxed);
+}
 
-    entries.push_back(*entry);
+
+auto UnpackBinaryResourcePackageEntries(
+  std::span<std::byte const> file_bytes
+) -> std::optional<std::vector<resource_package::Entry>> {
+  ByteSpanIstream is{file_bytes};
+  auto tables{ReadPackageTables(is, file_bytes.size())};
+
+  if (!tables) {
+    return std::nullopt;
   }
 
-  return entries;
+  return std::move(tables->entries);
 }
 
 
@@ -279,40 +859,29 @@ auto PeekBinaryResourcePackage(
       return std::nullopt;
     }
 
-    auto const header{HeaderSerializer::Read(is)};
+    auto const tables{ReadPackageTables(is, package_size)};
 
-    if (!header) {
+    if (!tables) {
       return std::nullopt;
     }
 
     ResourcePackageInfo package_info;
-    package_info.entries.reserve(header->resource_count);
-
-    for (std::size_t i{0}; i < header->resource_count; i++) {
-      auto const entry{EntrySerializer::Read(is, i)};
+    package_info.entries.reserve(tables->entries.size());
 
-      if (!entry || !IsEntryValid(*entry, package_size)) {
-        return std::nullopt;
-      }
-
-      auto const type{ToRttrType(entry->runtime_type)};
+    for (auto const& entry : tables->entries) {
+      auto const type{ToRttrType(entry.runtime_type)};
 
       if (!type) {
         return std::nullopt;
       }
 
-      auto const last_pos = is.tellg();
-      if (!is.seekg(entry->name_offset, std::ios::beg)) {
+      if (!is.seekg(entry.name_offset, std::ios::beg)) {
         return std::nullopt;
       }
 
-      std::string name(entry->name_size, '\0');
-
-      if (!is.read(name.data(), entry->name_size)) {
-        return std::nullopt;
-      }
+      std::string name(entry.name_size, '\0');
 
-      if (!is.seekg(last_pos, std::ios::beg)) {
+      if (!is.read(name.data(), entry.name_size)) {
         return std::nullopt;
       }
 
@@ -330,47 +899,32 @@ auto LoadBinaryResourcePackageSubresource(
   std::filesystem::path const& file_path_abs,
   std::size_t const entry_idx
 ) -> std::optional<ResourcePackageSubresource> {
-  std::ifstream is{file_path_abs, std::ios::binary};
+  auto const view{ResourcePackageView::Open(file_path_abs)};
 
-  if (!is || !is.seekg(0, std::ios::end)) {
+  if (!view) {
     return std::nullopt;
   }
 
-  auto const package_size{is.tellg()};
+  auto const subresource_view{view->GetSubresource(entry_idx)};
 
-  auto const header{HeaderSerializer::Read(is)};
-
-  if (!header || header->resource_count <= entry_idx) {
-    return std::nullopt;
-  }
-
-  auto const entry{EntrySerializer::Read(is, entry_idx)};
-
-  if (!entry || !IsEntryValid(*entry, package_size)) {
-    return std::nullopt;
-  }
-
-  ResourcePackageSubresource subresource;
-  subresource.payload_kind = entry->payload_kind;
-
-  if (!is.seekg(entry->name_offset, std::ios::beg)) {
+  if (!subresource_view) {
     return std::nullopt;
   }
 
-  subresource.name.resize(entry->name_size);
-  if (!is.read(subresource.name.data(), static_cast<std::streamsize>(subresource.name.size()))) {
-    return std::nullopt;
-  }
+  ResourcePackageSubresource subresource{
+    .name = std::string{subresource_view->name},
+    .bytes = {},
+    .payload_kind = subresource_view->payload_kind
+  };
 
+  if (subresource_view->codec == ResourcePackageCodec::kNone) {
+    subresource.bytes.assign(subresource_view->bytes.begin(), subresource_view->bytes.end());
+  } else {
+    subresource.bytes.resize(subresource_view->uncompressed_size);
 
-  if (!is.seekg(entry->data_offset, std::ios::beg)) {
-    return std::nullopt;
-  }
-
-  subresource.bytes.resize(entry->data_size);
-  if (!is.read(reinterpret_cast<char*>(subresource.bytes.data()),
-    static_cast<std::streamsize>(subresource.bytes.size()))) {
-    return std::nullopt;
+    if (!DecompressResourcePackagePayload(*subresource_view, subresource.bytes)) {
+      return std::nullopt;
+    }
   }
 
   return subresource;
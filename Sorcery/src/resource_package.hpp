@@ -3,16 +3,22 @@
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "Core.hpp"
+#include "observer_ptr.hpp"
 #include "Reflection.hpp"
 
 
 namespace sorcery {
+class JobSystem;
+
+
 enum class ResourcePackagePayloadKind: std::uint8_t {
   kInvalid  = 0,
   kTexture  = 1,
@@ -32,14 +38,32 @@ enum class ResourceRuntimeType : std::uint8_t {
 };
 
 
+enum class ResourcePackageCodec : std::uint8_t {
+  kNone = 0,
+  kLz4  = 1,
+  kZstd = 2,
+};
+
+
 namespace resource_package {
 extern SORCERYAPI std::uint32_t const kMagic;
+// Version 2 added payload alignment, checksums and the name lookup table. Version 3 added per-entry compression.
+// Older packages can still be read.
+constexpr std::uint32_t kLatestVersion{3};
+constexpr std::uint64_t kPayloadAlignment{64};
+// Compressed payloads are split into independently compressed chunks of this many uncompressed bytes.
+// The payload starts with the end offsets of the compressed chunks, relative to the end of the offset table.
+constexpr std::uint64_t kCompressionChunkSize{256 * 1024};
 
 
 struct Header {
   std::uint32_t magic;
   std::uint32_t version;
   std::uint32_t resource_count;
+
+  // Open addressing table of entry indices, keyed by name and runtime type. Zero sized in version 1 packages.
+  std::uint32_t lookup_bucket_count{0};
+  std::uint64_t lookup_table_offset{0};
 };
 
 
@@ -50,8 +74,18 @@ struct Entry {
   std::uint64_t name_offset;
   std::uint64_t name_size;
 
+  // Size of the stored, possibly compressed payload
   std::uint64_t data_offset;
   std::uint64_t data_size;
+
+  // Zero in version 1 packages
+  std::uint64_t name_hash{0};
+  // Calculated over the stored payload
+  std::uint64_t checksum{0};
+
+  // Uncompressed in version 1 and 2 packages
+  ResourcePackageCodec codec{ResourcePackageCodec::kNone};
+  std::uint64_t uncompressed_size{0};
 };
 }
 
@@ -82,11 +116,76 @@ struct ResourcePackageSubresource {
 };
 
 
+// Points into the memory of a ResourcePackageView, only valid while the view is alive.
+// The bytes are the stored payload, use DecompressResourcePackagePayload if codec is not kNone.
+struct ResourcePackageSubresourceView {
+  std::string_view name;
+  std::span<std::byte const> bytes;
+  ResourcePackagePayloadKind payload_kind;
+  ResourcePackageCodec codec;
+  std::uint64_t uncompressed_size;
+};
+
+
+// Read-only memory mapping of a binary resource package.
+// The header and the entry table are validated once when the file is opened, payloads are handed out in place.
+class ResourcePackageView {
+public:
+  // Views of the same file share a single mapping that is released when the last reference goes away.
+  [[nodiscard]] SORCERYAPI static auto Open(
+    std::filesystem::path const& file_path_abs
+  ) -> std::shared_ptr<ResourcePackageView const>;
+
+  ResourcePackageView(ResourcePackageView const&) = delete;
+  ResourcePackageView(ResourcePackageView&&) = delete;
+
+  SORCERYAPI ~ResourcePackageView();
+
+  auto operator=(ResourcePackageView const&) -> void = delete;
+  auto operator=(ResourcePackageView&&) -> void = delete;
+
+  [[nodiscard]] SORCERYAPI auto GetEntryCount() const noexcept -> std::size_t;
+  [[nodiscard]] SORCERYAPI auto GetSubresource(
+    std::size_t entry_idx
+  ) const noexcept -> std::optional<ResourcePackageSubresourceView>;
+  // Uses the lookup table of version 2 packages, falls back to a linear search for version 1 packages
+  [[nodiscard]] SORCERYAPI auto FindEntry(std::string_view name,
+                                          ResourceRuntimeType runtime_type) const noexcept -> std::optional<std::size_t>;
+  // Version 1 packages have no checksums and always pass
+  [[nodiscard]] SORCERYAPI auto VerifyChecksum(std::size_t entry_idx) const noexcept -> bool;
+  // Hints the OS to start paging in the payload so that consumers do not stall on page faults
+  SORCERYAPI auto Prefetch(std::size_t entry_idx) const noexcept -> void;
+
+private:
+  ResourcePackageView() = default;
+
+  void* file_{nullptr};
+  void* mapping_{nullptr};
+  std::span<std::byte const> bytes_;
+  resource_package::Header header_{};
+  std::vector<resource_package::Entry> entries_;
+};
+
+
+// Compresses the payloads in parallel on the job system. Payloads that do not shrink are stored uncompressed.
+// A compression level of zero selects the codec's default level.
 [[nodiscard]] SORCERYAPI
 auto PackBinaryResourcePackage(
-  std::span<ResourceImportResult const> imports
+  std::span<ResourceImportResult const> imports,
+  JobSystem& job_system,
+  ResourcePackageCodec codec = ResourcePackageCodec::kLz4,
+  int compression_level = 0
 ) -> std::optional<std::vector<std::byte>>;
 
+// Decompresses into out, which must be exactly uncompressed_size bytes large.
+// Chunks are decoded in parallel if a job system is passed.
+[[nodiscard]] SORCERYAPI
+auto DecompressResourcePackagePayload(
+  ResourcePackageSubresourceView const& subresource,
+  std::span<std::byte> out,
+  ObserverPtr<JobSystem> job_system = nullptr
+) -> bool;
+
 [[nodiscard]] SORCERYAPI
 auto UnpackBinaryResourcePackageEntries(
   std::span<std::byte const> file_bytes
@@ -24,4 +24,9 @@ Cubemap::~Cubemap() {
 auto Cubemap::GetTex() const noexcept -> graphics::SharedDeviceChildHandle<graphics::Texture> const& {
   return tex_;
 }
+
+
+auto Cubemap::GetGpuMemoryUsage() const noexcept -> std::size_t {
+  return tex_ ? static_cast<std::size_t>(tex_->GetAllocationSize()) : 0;
+}
 }
@@ -20,5 +20,7 @@ public:
   auto operator=(Cubemap&&) noexcept -> void = delete;
 
   [[nodiscard]] LEOPPHAPI auto GetTex() const noexcept -> graphics::SharedDeviceChildHandle<graphics::Texture> const&;
+
+  [[nodiscard]] LEOPPHAPI auto GetGpuMemoryUsage() const noexcept -> std::size_t override;
 };
 }
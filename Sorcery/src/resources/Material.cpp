@@ -4,9 +4,9 @@
 #include <cassert>
 
 #include "../app.hpp"
+#include "../job_task.hpp"
 #include "../Serialization.hpp"
 #undef FindResource
-#include "../job_system.hpp"
 #include "../material_resource.hpp"
 #include "../resource_manager.hpp"
 #include "../resource_reference.hpp"
@@ -51,12 +51,17 @@ auto Material::Serialize() const noexcept -> YAML::Node {
 
 
 auto Material::Deserialize(YAML::Node const& yaml_node, YamlDeserializeContext const& ctx) noexcept -> void {
+  SyncWait(App::Instance().GetJobSystem(), DeserializeAsync(yaml_node, ctx));
+}
+
+
+auto Material::DeserializeAsync(YAML::Node const yaml_node, YamlDeserializeContext const ctx) -> Task<> {
   auto const data{DeserializeMaterialResourceData(yaml_node, ctx)};
 
   if (!data) {
     // TODO log or something?
     assert("Failed to deserialize material resource data!" && false);
-    return;
+    co_return;
   }
 
   SetAlbedoVector(data->base_color, GpuResidencyPolicy::kDeferUpload);
@@ -66,85 +71,23 @@ auto Material::Deserialize(YAML::Node const& yaml_node, YamlDeserializeContext c
   SetBlendMode(data->blend_mode, GpuResidencyPolicy::kDeferUpload);
   SetAlphaThreshold(data->alpha_threshold, GpuResidencyPolicy::kDeferUpload);
 
-  struct JobData {
-    ResourceId res_id;
-    Texture2D* tex;
-  };
-
-  auto const loader_job_func{
-    [](JobData* const data) {
-      data->tex = App::Instance().GetResourceManager().GetOrLoad<Texture2D>(data->res_id);
-    }
-  };
-
-  ObserverPtr<Job> albedo_map_job{};
-  JobData albedo_map_job_data{};
-
-  ObserverPtr<Job> metallic_map_job{};
-  JobData metallic_map_job_data{};
-
-  ObserverPtr<Job> roughness_map_job{};
-  JobData roughness_map_job_data{};
-
-  ObserverPtr<Job> ao_map_job{};
-  JobData ao_map_job_data{};
-
-  ObserverPtr<Job> normal_map_job{};
-  JobData normal_map_job_data{};
-
-  ObserverPtr<Job> opacity_mask_job{};
-  JobData opacity_mask_job_data{};
-
-  if (data->base_color_map.IsValid()) {
-    albedo_map_job_data.res_id = data->base_color_map;
-    albedo_map_job = App::Instance().GetJobSystem().CreateJob(loader_job_func, &albedo_map_job_data);
-    App::Instance().GetJobSystem().Run(albedo_map_job);
-  }
-
-  if (data->metallic_map.IsValid()) {
-    metallic_map_job_data.res_id = data->metallic_map;
-    metallic_map_job = App::Instance().GetJobSystem().CreateJob(loader_job_func, &metallic_map_job_data);
-    App::Instance().GetJobSystem().Run(metallic_map_job);
-  }
-
-  if (data->roughness_map.IsValid()) {
-    roughness_map_job_data.res_id = data->roughness_map;
-    roughness_map_job = App::Instance().GetJobSystem().CreateJob(loader_job_func, &roughness_map_job_data);
-    App::Instance().GetJobSystem().Run(roughness_map_job);
-  }
-
-  if (data->ao_map.IsValid()) {
-    ao_map_job_data.res_id = data->ao_map;
-    ao_map_job = App::Instance().GetJobSystem().CreateJob(loader_job_func, &ao_map_job_data);
-    App::Instance().GetJobSystem().Run(ao_map_job);
-  }
-
-  if (data->normal_map.IsValid()) {
-    normal_map_job_data.res_id = data->normal_map;
-    normal_map_job = App::Instance().GetJobSystem().CreateJob(loader_job_func, &normal_map_job_data);
-    App::Instance().GetJobSystem().Run(normal_map_job);
-  }
-
-  if (data->opacity_map.IsValid()) {
-    opacity_mask_job_data.res_id = data->opacity_map;
-    opacity_mask_job = App::Instance().GetJobSystem().CreateJob(loader_job_func, &opacity_mask_job_data);
-    App::Instance().GetJobSystem().Run(opacity_mask_job);
-  }
+  // Request every texture before awaiting any of them so that they load in parallel.
+  // Each await resumes on the thread that completed that texture, so the rest runs wherever the last one lands.
+  auto& resource_manager{App::Instance().GetResourceManager()};
 
-  for (auto const job : {
-         albedo_map_job, metallic_map_job, roughness_map_job, ao_map_job, normal_map_job, opacity_mask_job
-       }) {
-    if (job) {
-      App::Instance().GetJobSystem().Wait(job);
-    }
-  }
+  auto const albedo_map{resource_manager.RequestLoad<Texture2D>(data->base_color_map)};
+  auto const metallic_map{resource_manager.RequestLoad<Texture2D>(data->metallic_map)};
+  auto const roughness_map{resource_manager.RequestLoad<Texture2D>(data->roughness_map)};
+  auto const ao_map{resource_manager.RequestLoad<Texture2D>(data->ao_map)};
+  auto const normal_map{resource_manager.RequestLoad<Texture2D>(data->normal_map)};
+  auto const opacity_mask{resource_manager.RequestLoad<Texture2D>(data->opacity_map)};
 
-  SetAlbedoMap(albedo_map_job_data.tex, GpuResidencyPolicy::kDeferUpload);
-  SetMetallicMap(metallic_map_job_data.tex, GpuResidencyPolicy::kDeferUpload);
-  SetRoughnessMap(roughness_map_job_data.tex, GpuResidencyPolicy::kDeferUpload);
-  SetAoMap(ao_map_job_data.tex, GpuResidencyPolicy::kDeferUpload);
-  SetNormalMap(normal_map_job_data.tex, GpuResidencyPolicy::kDeferUpload);
-  SetOpacityMask(opacity_mask_job_data.tex, GpuResidencyPolicy::kDeferUpload);
+  SetAlbedoMap(co_await albedo_map, GpuResidencyPolicy::kDeferUpload);
+  SetMetallicMap(co_await metallic_map, GpuResidencyPolicy::kDeferUpload);
+  SetRoughnessMap(co_await roughness_map, GpuResidencyPolicy::kDeferUpload);
+  SetAoMap(co_await ao_map, GpuResidencyPolicy::kDeferUpload);
+  SetNormalMap(co_await normal_map, GpuResidencyPolicy::kDeferUpload);
+  SetOpacityMask(co_await opacity_mask, GpuResidencyPolicy::kDeferUpload);
 
   UploadToGpu();
 }
@@ -241,6 +184,7 @@ auto Material::GetAlbedoMap() const -> Texture2D* {
 
 
 auto Material::SetAlbedoMap(Texture2D* const tex, GpuResidencyPolicy const gpu_policy) -> void {
+  OnReferenceChanged(albedo_map_, tex);
   albedo_map_ = tex;
   mShaderMtl.albedo_map_idx = albedo_map_ ? albedo_map_->GetTex()->GetShaderResource() : INVALID_RES_IDX;
 
@@ -256,6 +200,7 @@ auto Material::GetMetallicMap() const -> Texture2D* {
 
 
 auto Material::SetMetallicMap(Texture2D* const tex, GpuResidencyPolicy const gpu_policy) -> void {
+  OnReferenceChanged(metallic_map_, tex);
   metallic_map_ = tex;
   mShaderMtl.metallic_map_idx = metallic_map_ ? metallic_map_->GetTex()->GetShaderResource() : INVALID_RES_IDX;
 
@@ -271,6 +216,7 @@ auto Material::GetRoughnessMap() const -> Texture2D* {
 
 
 auto Material::SetRoughnessMap(Texture2D* const tex, GpuResidencyPolicy const gpu_policy) -> void {
+  OnReferenceChanged(roughness_map_, tex);
   roughness_map_ = tex;
   mShaderMtl.roughness_map_idx = roughness_map_ ? roughness_map_->GetTex()->GetShaderResource() : INVALID_RES_IDX;
 
@@ -286,6 +232,7 @@ auto Material::GetAoMap() const -> Texture2D* {
 
 
 auto Material::SetAoMap(Texture2D* const tex, GpuResidencyPolicy const gpu_policy) -> void {
+  OnReferenceChanged(ao_map_, tex);
   ao_map_ = tex;
   mShaderMtl.ao_map_idx = ao_map_ ? ao_map_->GetTex()->GetShaderResource() : INVALID_RES_IDX;
 
@@ -301,6 +248,7 @@ auto Material::GetNormalMap() const -> Texture2D* {
 
 
 auto Material::SetNormalMap(Texture2D* const tex, GpuResidencyPolicy const gpu_policy) -> void {
+  OnReferenceChanged(normal_map_, tex);
   normal_map_ = tex;
   mShaderMtl.normal_map_idx = normal_map_ ? normal_map_->GetTex()->GetShaderResource() : INVALID_RES_IDX;
 
@@ -344,6 +292,7 @@ auto Material::GetOpacityMask() const -> Texture2D* {
 
 
 auto Material::SetOpacityMask(Texture2D* const opacity_mask, GpuResidencyPolicy const gpu_policy) -> void {
+  OnReferenceChanged(opacity_mask_, opacity_mask);
   opacity_mask_ = opacity_mask;
   mShaderMtl.opacity_map_idx = opacity_mask_ ? opacity_mask_->GetTex()->GetShaderResource() : INVALID_RES_IDX;
 
@@ -369,6 +318,12 @@ auto Material::GetBuffer() const -> graphics::SharedDeviceChildHandle<graphics::
 }
 
 
+auto Material::GetGpuMemoryUsage() const noexcept -> std::size_t {
+  auto const& buf{cb_.GetBuffer()};
+  return buf ? static_cast<std::size_t>(buf->GetAllocationSize()) : 0;
+}
+
+
 auto Material::SetAlbedoVectorRefl(Vector3 const& albedo_vector) -> void {
   SetAlbedoVector(albedo_vector, GpuResidencyPolicy::kMakeResident);
 }
@@ -11,6 +11,10 @@
 
 
 namespace sorcery {
+template<typename T>
+class Task;
+
+
 class Material final : public NativeResource {
   RTTR_ENABLE(NativeResource)
   RTTR_REGISTRATION_FRIEND
@@ -40,6 +44,9 @@ public:
   auto Serialize() const noexcept -> YAML::Node override;
   SORCERYAPI
   auto Deserialize(YAML::Node const& yaml_node, YamlDeserializeContext const& ctx) noexcept -> void override;
+  // Completes once the referenced textures have loaded, without blocking a thread on them
+  [[nodiscard]] SORCERYAPI
+  auto DeserializeAsync(YAML::Node yaml_node, YamlDeserializeContext ctx) -> Task<void>;
 
   SORCERYAPI explicit Material(GpuResidencyPolicy gpu_policy);
   Material(Material const&) = delete;
@@ -121,6 +128,9 @@ public:
   [[nodiscard]] SORCERYAPI
   auto GetBuffer() const -> graphics::SharedDeviceChildHandle<graphics::Buffer> const&;
 
+  [[nodiscard]] SORCERYAPI
+  auto GetGpuMemoryUsage() const noexcept -> std::size_t override;
+
 private:
   // These are just for reflection and default to MakeResident
 
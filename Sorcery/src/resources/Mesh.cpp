@@ -3,8 +3,6 @@
 #include <algorithm>
 #include <iterator>
 
-#include <DirectXMesh.h>
-
 #include "../app.hpp"
 #include "../rendering/render_manager.hpp"
 
@@ -15,21 +13,95 @@ RTTR_REGISTRATION {
 
 
 namespace sorcery {
-Submesh::Submesh(SubmeshData const& data) :
-  first_meshlet_{data.first_meshlet},
-  meshlet_count_{data.meshlet_count},
+namespace {
+template<typename T>
+[[nodiscard]] auto GetMemoryUsage(std::vector<T> const& vec) noexcept -> std::size_t {
+  return vec.capacity() * sizeof(T);
+}
+
+
+[[nodiscard]] auto GetMemoryUsage(std::vector<Animation> const& animations) noexcept -> std::size_t {
+  auto ret{animations.capacity() * sizeof(Animation)};
+
+  for (auto const& anim : animations) {
+    ret += anim.name.capacity() + GetMemoryUsage(anim.node_anims);
+
+    for (auto const& node_anim : anim.node_anims) {
+      ret += GetMemoryUsage(node_anim.position_keys) + GetMemoryUsage(node_anim.rotation_keys) +
+        GetMemoryUsage(node_anim.scaling_keys);
+    }
+  }
+
+  return ret;
+}
+
+
+[[nodiscard]] auto GetMemoryUsage(std::vector<SkeletonNode> const& skeleton) noexcept -> std::size_t {
+  auto ret{skeleton.capacity() * sizeof(SkeletonNode)};
+
+  for (auto const& node : skeleton) {
+    ret += node.name.capacity();
+  }
+
+  return ret;
+}
+
+
+[[nodiscard]] auto GetMemoryUsage(std::vector<MaterialSlotInfo> const& mtl_slots) noexcept -> std::size_t {
+  auto ret{mtl_slots.capacity() * sizeof(MaterialSlotInfo)};
+
+  for (auto const& slot : mtl_slots) {
+    ret += slot.name.capacity();
+  }
+
+  return ret;
+}
+
+
+[[nodiscard]] auto GetMemoryUsage(std::vector<Submesh> const& submeshes) noexcept -> std::size_t {
+  auto ret{submeshes.capacity() * sizeof(Submesh)};
+
+  for (auto const& submesh : submeshes) {
+    ret += submesh.GetLodCount() * sizeof(SubmeshLodData);
+  }
+
+  return ret;
+}
+
+
+[[nodiscard]] auto GetMemoryUsage(MeshData const& data) noexcept -> std::size_t {
+  return sizeof(MeshData) + GetMemoryUsage(data.positions) + GetMemoryUsage(data.normals) +
+         GetMemoryUsage(data.tangents) + GetMemoryUsage(data.uvs) + GetMemoryUsage(data.bone_weights) +
+         GetMemoryUsage(data.bone_indices) + GetMemoryUsage(data.meshlets) + GetMemoryUsage(data.vertex_indices) +
+         GetMemoryUsage(data.triangle_indices) + GetMemoryUsage(data.cull_data) +
+         GetMemoryUsage(data.material_slots) + GetMemoryUsage(data.submeshes) + GetMemoryUsage(data.submesh_lods) +
+         GetMemoryUsage(data.animations) + GetMemoryUsage(data.skeleton) + GetMemoryUsage(data.bones);
+}
+
+
+[[nodiscard]] auto GetMemoryUsage(graphics::SharedDeviceChildHandle<graphics::Buffer> const& buf) -> std::size_t {
+  return buf ? static_cast<std::size_t>(buf->GetAllocationSize()) : 0;
+}
+}
+
+
+Submesh::Submesh(SubmeshData const& data, std::span<SubmeshLodData const> const lods) :
   base_vertex_{data.base_vertex},
   material_idx_{data.material_idx},
-  bounds_{data.bounds} {}
+  bounds_{data.bounds} {
+  lods_.reserve(lods.size() + 1);
+  lods_.emplace_back(0, data.first_meshlet, data.meshlet_count, 0.0f);
+  std::ranges::copy(lods, std::back_inserter(lods_));
+}
 
 
-auto Submesh::GetFirstMeshlet() const -> std::uint32_t {
-  return first_meshlet_;
+auto Submesh::GetFirstMeshlet(std::uint32_t const lod) const -> std::uint32_t {
+  return lods_[lod].first_meshlet;
 }
 
 
-auto Submesh::GetMeshletCount() const -> std::uint32_t {
-  return meshlet_count_;
+auto Submesh::GetMeshletCount(std::uint32_t const lod) const -> std::uint32_t {
+  return lods_[lod].meshlet_count;
 }
 
 
@@ -48,11 +120,32 @@ auto Submesh::GetBounds() const -> AABB const& {
 }
 
 
+auto Submesh::GetLodCount() const -> std::uint32_t {
+  return static_cast<std::uint32_t>(lods_.size());
+}
+
+
+auto Submesh::GetLodError(std::uint32_t const lod) const -> float {
+  return lods_[lod].error;
+}
+
+
+auto Submesh::SelectLod(float const max_error) const -> std::uint32_t {
+  auto const it{std::ranges::upper_bound(lods_, max_error, {}, &SubmeshLodData::error)};
+  return it == std::begin(lods_) ? 0 : static_cast<std::uint32_t>(it - std::begin(lods_) - 1);
+}
+
+
 Mesh::Mesh(MeshData data, ResourceResidencyPolicy const data_policy) {
   SetData(std::move(data), data_policy);
 }
 
 
+Mesh::Mesh(MeshView const& view, ResourceResidencyPolicy const data_policy) {
+  SetData(view, data_policy);
+}
+
+
 auto Mesh::SetData(MeshData data, ResourceResidencyPolicy const data_policy) -> void {
   // CPU data
   mesh_data_ = std::make_unique<MeshData>(std::move(data));
@@ -62,9 +155,11 @@ auto Mesh::SetData(MeshData data, ResourceResidencyPolicy const data_policy) ->
 
   submeshes_.clear();
   submeshes_.reserve(mesh_data_->submeshes.size());
-  std::ranges::for_each(mesh_data_->submeshes, [this](SubmeshData const& submesh) {
-    submeshes_.emplace_back(submesh);
-  });
+
+  for (std::uint32_t i{0}; i < mesh_data_->submeshes.size(); i++) {
+    submeshes_.emplace_back(mesh_data_->submeshes[i],
+      std::ranges::equal_range(mesh_data_->submesh_lods, i, {}, &SubmeshLodData::submesh_idx));
+  }
 
   animations_ = mesh_data_->animations;
   skeleton_ = mesh_data_->skeleton;
@@ -82,11 +177,90 @@ auto Mesh::SetData(MeshData data, ResourceResidencyPolicy const data_policy) ->
 }
 
 
+auto Mesh::SetData(MeshView const& view, ResourceResidencyPolicy const data_policy) -> void {
+  if (data_policy.gpu == GpuResidencyPolicy::kDeferUpload || data_policy.cpu == CpuResidencyPolicy::kKeepResident) {
+    SetData(view.ToMeshData(), data_policy);
+    return;
+  }
+
+  // CPU info
+
+  mesh_data_.reset();
+
+  meshlets_.assign(std::begin(view.GetMeshlets()), std::end(view.GetMeshlets()));
+  mtl_slots_ = view.ToMaterialSlots();
+
+  submeshes_.clear();
+  submeshes_.reserve(view.GetSubmeshes().size());
+
+  for (std::uint32_t i{0}; i < view.GetSubmeshes().size(); i++) {
+    submeshes_.emplace_back(view.GetSubmeshes()[i],
+      std::ranges::equal_range(view.GetSubmeshLods(), i, {}, &SubmeshLodData::submesh_idx));
+  }
+
+  animations_ = view.ToAnimations();
+  skeleton_ = view.ToSkeleton();
+  bones_.assign(std::begin(view.GetBones()), std::end(view.GetBones()));
+
+  bounds_ = view.GetBounds();
+  vertex_count_ = view.GetVertexCount();
+  primitive_count_ = view.GetTriangleIndices().size();
+  idx32_ = view.Has32BitVertexIndices();
+
+  // GPU data
+
+  // Streams the view cannot expose as is are decoded into temporary storage, the rest are uploaded straight from it
+  std::vector<Vector3> positions;
+  std::vector<Vector3> normals;
+  std::vector<Vector4> tangents;
+  std::vector<Vector2> uvs;
+  std::vector<Vector4> bone_weights;
+  std::vector<Vector<std::uint32_t, 4>> bone_indices;
+
+  auto const get_stream{
+    [&view]<typename T>(std::span<T const> const raw, std::vector<T>& decoded,
+                        std::vector<T> (MeshView::*const decode)() const) -> std::span<T const> {
+      if (!raw.empty()) {
+        return raw;
+      }
+
+      decoded = (view.*decode)();
+      return decoded;
+    }
+  };
+
+  CreateGpuBuffers(get_stream(view.GetPositions(), positions, &MeshView::ToPositions),
+    get_stream(view.GetNormals(), normals, &MeshView::ToNormals),
+    get_stream(view.GetTangents(), tangents, &MeshView::ToTangents), get_stream(view.GetUvs(), uvs, &MeshView::ToUvs),
+    get_stream(view.GetBoneWeights(), bone_weights, &MeshView::ToBoneWeights),
+    get_stream(view.GetBoneIndices(), bone_indices, &MeshView::ToBoneIndices), view.GetMeshlets(),
+    view.GetVertexIndices(), view.GetTriangleIndices(), view.GetCullData());
+}
+
+
 auto Mesh::UploadToGpu(CpuResidencyPolicy const cpu_policy) -> void {
   if (!mesh_data_) {
     return;
   }
 
+  CreateGpuBuffers(mesh_data_->positions, mesh_data_->normals, mesh_data_->tangents, mesh_data_->uvs,
+    mesh_data_->bone_weights, mesh_data_->bone_indices, mesh_data_->meshlets, mesh_data_->vertex_indices,
+    mesh_data_->triangle_indices, mesh_data_->cull_data);
+
+  if (cpu_policy == CpuResidencyPolicy::kReleaseAfterUpload) {
+    mesh_data_.reset();
+  }
+}
+
+
+auto Mesh::CreateGpuBuffers(std::span<Vector3 const> const positions, std::span<Vector3 const> const normals,
+                            std::span<Vector4 const> const tangents, std::span<Vector2 const> const uvs,
+                            std::span<Vector4 const> const bone_weights,
+                            std::span<Vector<std::uint32_t, 4> const> const bone_indices,
+                            std::span<MeshletData const> const meshlets,
+                            std::span<std::uint8_t const> const vertex_indices,
+                            std::span<MeshletTriangleData const> const triangle_indices,
+                            std::span<MeshletCullData const> const cull_data) -> void {
   auto const to_vec4{
     [](std::span<Vector3 const> const vectors, float const component4,
        std::vector<Vector4>& out) -> std::vector<Vector4>& {
@@ -108,28 +282,23 @@ auto Mesh::UploadToGpu(CpuResidencyPolicy const cpu_policy) -> void {
 
   using rendering::StructuredBuffer;
 
-  pos_buf_ = StructuredBuffer<Vector4>::New(gd, rm, to_vec4(mesh_data_->positions, 1, vec4_buf), false, true, true);
-  norm_buf_ = StructuredBuffer<Vector4>::New(gd, rm, to_vec4(mesh_data_->normals, 0, vec4_buf), false, true, true);
-  tan_buf_ = StructuredBuffer<Vector4>::New(gd, rm, to_vec4(mesh_data_->tangents, 0, vec4_buf), false, true, true);
-  uv_buf_ = StructuredBuffer<Vector2>::New(gd, rm, mesh_data_->uvs, false, true, false);
-  bone_weight_buf_ = mesh_data_->bone_weights.empty()
+  pos_buf_ = StructuredBuffer<Vector4>::New(gd, rm, to_vec4(positions, 1, vec4_buf), false, true, true);
+  norm_buf_ = StructuredBuffer<Vector4>::New(gd, rm, to_vec4(normals, 0, vec4_buf), false, true, true);
+  tan_buf_ = StructuredBuffer<Vector4>::New(gd, rm, tangents, false, true, true);
+  uv_buf_ = StructuredBuffer<Vector2>::New(gd, rm, uvs, false, true, false);
+  bone_weight_buf_ = bone_weights.empty()
                        ? StructuredBuffer<Vector4>{}
-                       : StructuredBuffer<Vector4>::New(gd, rm, mesh_data_->bone_weights, false, false, true);
-  bone_idx_buf_ = mesh_data_->bone_indices.empty()
+                       : StructuredBuffer<Vector4>::New(gd, rm, bone_weights, false, false, true);
+  bone_idx_buf_ = bone_indices.empty()
                     ? StructuredBuffer<Vector<std::uint32_t, 4>>{}
-                    : StructuredBuffer<Vector<std::uint32_t, 4>>::New(gd, rm, mesh_data_->bone_indices, false, false,
-                      true);
-  meshlet_buf_ = StructuredBuffer<MeshletData>::New(gd, rm, mesh_data_->meshlets, false);
-  vertex_idx_buf_ = gd.CreateBuffer(graphics::BufferDesc{mesh_data_->vertex_indices.size(), 1, false, true, false},
+                    : StructuredBuffer<Vector<std::uint32_t, 4>>::New(gd, rm, bone_indices, false, false, true);
+  meshlet_buf_ = StructuredBuffer<MeshletData>::New(gd, rm, meshlets, false);
+  vertex_idx_buf_ = gd.CreateBuffer(graphics::BufferDesc{vertex_indices.size(), 1, false, true, false},
     graphics::CpuAccess::kNone);
-  prim_idx_buf_ = StructuredBuffer<MeshletTriangleData>::New(gd, rm, mesh_data_->triangle_indices, false, true, false);
-  cull_data_buf_ = StructuredBuffer<MeshletCullData>::New(gd, rm, mesh_data_->cull_data, false, true, false);
-
-  rm.UpdateBuffer(*vertex_idx_buf_, 0, as_bytes(std::span{mesh_data_->vertex_indices}));
+  prim_idx_buf_ = StructuredBuffer<MeshletTriangleData>::New(gd, rm, triangle_indices, false, true, false);
+  cull_data_buf_ = StructuredBuffer<MeshletCullData>::New(gd, rm, cull_data, false, true, false);
 
-  if (cpu_policy == CpuResidencyPolicy::kReleaseAfterUpload) {
-    mesh_data_.reset();
-  }
+  rm.UpdateBuffer(*vertex_idx_buf_, 0, as_bytes(vertex_indices));
 }
 
 
@@ -231,4 +400,20 @@ auto Mesh::GetMeshletCount() const noexcept -> std::size_t {
 auto Mesh::Has32BitVertexIndices() const noexcept -> bool {
   return idx32_;
 }
+
+
+auto Mesh::GetCpuMemoryUsage() const noexcept -> std::size_t {
+  return (mesh_data_ ? GetMemoryUsage(*mesh_data_) : 0) + GetMemoryUsage(meshlets_) + GetMemoryUsage(mtl_slots_) +
+         GetMemoryUsage(submeshes_) + GetMemoryUsage(animations_) + GetMemoryUsage(skeleton_) +
+         GetMemoryUsage(bones_);
+}
+
+
+auto Mesh::GetGpuMemoryUsage() const noexcept -> std::size_t {
+  return GetMemoryUsage(pos_buf_.GetBuffer()) + GetMemoryUsage(norm_buf_.GetBuffer()) +
+         GetMemoryUsage(tan_buf_.GetBuffer()) + GetMemoryUsage(uv_buf_.GetBuffer()) +
+         GetMemoryUsage(bone_weight_buf_.GetBuffer()) + GetMemoryUsage(bone_idx_buf_.GetBuffer()) +
+         GetMemoryUsage(meshlet_buf_.GetBuffer()) + GetMemoryUsage(vertex_idx_buf_) +
+         GetMemoryUsage(prim_idx_buf_.GetBuffer()) + GetMemoryUsage(cull_data_buf_.GetBuffer());
+}
 }
@@ -8,7 +8,10 @@
 #include "Resource.hpp"
 #include "../Bounds.hpp"
 #include "../Math.hpp"
+#include "../mesh_blob.hpp"
 #include "../mesh_data.hpp"
+#include "../meshlet_builder.hpp"
+#include "../observer_ptr.hpp"
 #include "../resource_residency_policy.hpp"
 #include "../rendering/graphics.hpp"
 #include "../rendering/structured_buffer.hpp"
@@ -17,12 +20,12 @@
 namespace sorcery {
 class Submesh {
 public:
-  explicit Submesh(SubmeshData const& data);
+  Submesh(SubmeshData const& data, std::span<SubmeshLodData const> lods);
 
   [[nodiscard]] SORCERYAPI
-  auto GetFirstMeshlet() const -> std::uint32_t;
+  auto GetFirstMeshlet(std::uint32_t lod = 0) const -> std::uint32_t;
   [[nodiscard]] SORCERYAPI
-  auto GetMeshletCount() const -> std::uint32_t;
+  auto GetMeshletCount(std::uint32_t lod = 0) const -> std::uint32_t;
   [[nodiscard]] SORCERYAPI
   auto GetBaseVertex() const -> std::uint32_t;
   [[nodiscard]] SORCERYAPI
@@ -30,9 +33,18 @@ public:
   [[nodiscard]] SORCERYAPI
   auto GetBounds() const -> AABB const&;
 
+  // Includes the full detail geometry as LOD 0
+  [[nodiscard]] SORCERYAPI
+  auto GetLodCount() const -> std::uint32_t;
+  [[nodiscard]] SORCERYAPI
+  auto GetLodError(std::uint32_t lod) const -> float;
+  // Coarsest LOD whose object space error does not exceed the given one
+  [[nodiscard]] SORCERYAPI
+  auto SelectLod(float max_error) const -> std::uint32_t;
+
 private:
-  std::uint32_t first_meshlet_;
-  std::uint32_t meshlet_count_;
+  // Increasingly coarse, starting with the full detail geometry
+  std::vector<SubmeshLodData> lods_;
   std::uint32_t base_vertex_;
   std::uint32_t material_idx_;
   AABB bounds_;
@@ -77,6 +89,7 @@ public:
   Mesh(Mesh const&) = delete;
   Mesh(Mesh&& other) noexcept = delete;
   SORCERYAPI Mesh(MeshData data, ResourceResidencyPolicy data_policy);
+  SORCERYAPI Mesh(MeshView const& view, ResourceResidencyPolicy data_policy);
 
   ~Mesh() override = default;
 
@@ -85,6 +98,9 @@ public:
 
   SORCERYAPI
   auto SetData(MeshData data, ResourceResidencyPolicy data_policy) -> void;
+  // Uploads straight from the view unless the policy needs the CPU data to outlive it
+  SORCERYAPI
+  auto SetData(MeshView const& view, ResourceResidencyPolicy data_policy) -> void;
 
   SORCERYAPI
   auto UploadToGpu(CpuResidencyPolicy cpu_policy) -> void;
@@ -131,6 +147,21 @@ public:
   auto GetMeshletCount() const noexcept -> std::size_t;
   [[nodiscard]] SORCERYAPI
   auto Has32BitVertexIndices() const noexcept -> bool;
+
+  // CPU usage includes the retained MeshData, which honours the CpuResidencyPolicy the mesh was uploaded with
+  [[nodiscard]] SORCERYAPI
+  auto GetCpuMemoryUsage() const noexcept -> std::size_t override;
+  [[nodiscard]] SORCERYAPI
+  auto GetGpuMemoryUsage() const noexcept -> std::size_t override;
+
+private:
+  auto CreateGpuBuffers(std::span<Vector3 const> positions, std::span<Vector3 const> normals,
+                        std::span<Vector4 const> tangents, std::span<Vector2 const> uvs,
+                        std::span<Vector4 const> bone_weights,
+                        std::span<Vector<std::uint32_t, 4> const> bone_indices, std::span<MeshletData const> meshlets,
+                        std::span<std::uint8_t const> vertex_indices,
+                        std::span<MeshletTriangleData const> triangle_indices,
+                        std::span<MeshletCullData const> cull_data) -> void;
 };
 
 
@@ -155,7 +186,8 @@ template<typename IdxType, typename PosType>
                                    std::vector<MeshletTriangleData>& out_primitive_indices,
                                    std::vector<MeshletCullData>& out_cull_data,
                                    std::uint16_t max_verts_per_meshlet = kMeshletMaxVerts,
-                                   std::uint16_t max_prims_per_meshlet = kMeshletMaxPrims) -> bool;
+                                   std::uint16_t max_prims_per_meshlet = kMeshletMaxPrims,
+                                   ObserverPtr<JobSystem> job_system = nullptr) -> bool;
 }
 
 
@@ -10,4 +10,14 @@ auto Resource::GetId() const noexcept -> ResourceId const& {
 auto Resource::SetId(ResourceId const& res_id) -> void {
   id_ = res_id;
 }
+
+
+auto Resource::GetCpuMemoryUsage() const noexcept -> std::size_t {
+  return 0;
+}
+
+
+auto Resource::GetGpuMemoryUsage() const noexcept -> std::size_t {
+  return 0;
+}
 }
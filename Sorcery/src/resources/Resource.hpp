@@ -3,6 +3,8 @@
 #include "../Object.hpp"
 #include "../resource_id.hpp"
 
+#include <cstddef>
+
 
 namespace sorcery {
 class Resource : public Object {
@@ -12,6 +14,10 @@ public:
   [[nodiscard]] LEOPPHAPI auto GetId() const noexcept -> ResourceId const&;
   LEOPPHAPI auto SetId(ResourceId const& res_id) -> void;
 
+  // Approximate number of bytes the resource currently occupies in system and video memory
+  [[nodiscard]] LEOPPHAPI virtual auto GetCpuMemoryUsage() const noexcept -> std::size_t;
+  [[nodiscard]] LEOPPHAPI virtual auto GetGpuMemoryUsage() const noexcept -> std::size_t;
+
 private:
   ResourceId id_{Guid::Generate(), 0};
 };
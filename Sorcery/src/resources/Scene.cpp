@@ -1,6 +1,7 @@
 #include "Scene.hpp"
 
 #include <algorithm>
+#include <optional>
 #include <ranges>
 
 #include "../app.hpp"
@@ -9,7 +10,6 @@
 #include "../scene_objects/SceneObject.hpp"
 #undef FindResource
 #include "../entity_serialization.hpp"
-#include "../job_system.hpp"
 #include "../Reflection.hpp"
 #include "../resource_manager.hpp"
 
@@ -172,24 +172,13 @@ auto Scene::Load() -> void {
     sky_color_ = node.as<Vector3>(sky_color_);
   }
 
-  // Start a job to load the skybox
+  // Load the skybox in the background
 
-  struct SkyboxJobData {
-    ResourceId res_id;
-    Cubemap* cubemap;
-  } skybox_job_data;
-
-  ObserverPtr<Job> skybox_job;
+  std::optional<ResourceHandle<Cubemap>> skybox;
 
   if (auto const node{yaml_data_["skybox"]}) {
     if (auto const res_id{DeserializeResourceId(node, yaml_ctx_).value_or(ResourceId::Invalid())}; res_id.IsValid()) {
-      skybox_job_data.res_id = res_id;
-
-      skybox_job = App::Instance().GetJobSystem().CreateJob([](SkyboxJobData* const data) {
-        data->cubemap = App::Instance().GetResourceManager().GetOrLoad<Cubemap>(data->res_id);
-      }, &skybox_job_data);
-
-      App::Instance().GetJobSystem().Run(skybox_job);
+      skybox = App::Instance().GetResourceManager().RequestLoad<Cubemap>(res_id);
     }
   }
 
@@ -199,9 +188,9 @@ auto Scene::Load() -> void {
     AddEntity(std::move(entity_ptr));
   }
 
-  if (skybox_job) {
-    App::Instance().GetJobSystem().Wait(skybox_job);
-    skybox_ = skybox_job_data.cubemap;
+  // The skybox handle of the scene pins the cubemap from here on
+  if (skybox) {
+    SetSkybox(skybox->Wait());
   }
 }
 
@@ -275,7 +264,7 @@ auto Scene::SetSkyColor(Vector3 const& skyColor) noexcept -> void {
 
 
 auto Scene::GetSkybox() const noexcept -> Cubemap* {
-  return skybox_;
+  return skybox_.Get();
 }
 
 
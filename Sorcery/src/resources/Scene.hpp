@@ -2,6 +2,7 @@
 
 #include "Cubemap.hpp"
 #include "NativeResource.hpp"
+#include "../handle.hpp"
 #include "../Color.hpp"
 #include "../SkyMode.hpp"
 #include "../scene_objects/Entity.hpp"
@@ -84,7 +85,7 @@ private:
 
   Vector3 ambient_light_{20.0f / 255.0f};
 
-  Cubemap* skybox_{nullptr};
+  Handle<Cubemap> skybox_;
   SkyMode sky_mode_{SkyMode::Color};
   Vector3 sky_color_{0.F, 36.F / 255.F, 1.F};
   graphics::SharedDeviceChildHandle<graphics::Texture> irradiance_map_{};
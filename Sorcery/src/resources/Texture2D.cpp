@@ -68,4 +68,9 @@ auto Texture2D::GetHeight() const noexcept -> unsigned {
 auto Texture2D::GetChannelCount() const noexcept -> unsigned {
   return m_channel_count_;
 }
+
+
+auto Texture2D::GetGpuMemoryUsage() const noexcept -> std::size_t {
+  return tex_ ? static_cast<std::size_t>(tex_->GetAllocationSize()) : 0;
+}
 }
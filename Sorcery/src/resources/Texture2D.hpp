@@ -28,5 +28,7 @@ public:
   [[nodiscard]] LEOPPHAPI auto GetWidth() const noexcept -> unsigned;
   [[nodiscard]] LEOPPHAPI auto GetHeight() const noexcept -> unsigned;
   [[nodiscard]] LEOPPHAPI auto GetChannelCount() const noexcept -> unsigned;
+
+  [[nodiscard]] LEOPPHAPI auto GetGpuMemoryUsage() const noexcept -> std::size_t override;
 };
 }
@@ -81,6 +81,14 @@ auto CameraControllerComponent::Update() -> void {
 }
 
 
+auto CameraControllerComponent::GetUpdateAccess() const -> UpdateAccess {
+  return {
+    update_resources::kInput | update_resources::kTransforms | update_resources::kEntityTransform,
+    update_resources::kEntityTransform
+  };
+}
+
+
 CameraControllerComponent::CameraControllerComponent() {
   SetUpdatable(true);
 }
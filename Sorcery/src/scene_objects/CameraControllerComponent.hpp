@@ -12,6 +12,7 @@ public:
 
   LEOPPHAPI auto Start() -> void override;
   LEOPPHAPI auto Update() -> void override;
+  [[nodiscard]] LEOPPHAPI auto GetUpdateAccess() const -> UpdateAccess override;
 
   LEOPPHAPI CameraControllerComponent();
 
@@ -1,6 +1,7 @@
 #include "Component.hpp"
 
 #include "Entity.hpp"
+#include "../app.hpp"
 
 RTTR_REGISTRATION {
   rttr::registration::class_<sorcery::Component>{"Component"};
@@ -18,6 +19,16 @@ auto Component::OnBeforeDetachedFromEntity(Entity& entity) -> void {
 }
 
 
+auto Component::SetUpdatable(bool const updatable) -> void {
+  SceneObject::SetUpdatable(updatable);
+
+  // The update only visits the pools that are known to contain updatable components
+  if (updatable && entity_) {
+    App::Instance().GetComponentRegistry().OnBecameUpdatable(*this);
+  }
+}
+
+
 auto Component::GetEntity() const -> ObserverPtr<Entity> {
   return entity_;
 }
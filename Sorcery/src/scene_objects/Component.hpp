@@ -16,6 +16,8 @@ public:
   LEOPPHAPI virtual auto OnAfterAttachedToEntity(Entity& entity) -> void;
   LEOPPHAPI virtual auto OnBeforeDetachedFromEntity(Entity& entity) -> void;
 
+  LEOPPHAPI auto SetUpdatable(bool updatable) -> void override;
+
 protected:
   Component() = default;
   Component(Component const& other) = default;
@@ -6,6 +6,7 @@
 #include <iterator>
 #include <utility>
 
+#include "../app.hpp"
 #include "../Util.hpp"
 #include "../Resources/Scene.hpp"
 
@@ -74,14 +75,16 @@ auto Entity::OnBeforeExitingScene(Scene const& scene) -> void {
 }
 
 
-Entity::Entity() {
+Entity::Entity() :
+  id_{GetRegistry().CreateEntityId()} {
   SetName("New Entity");
   AddComponent(std::make_unique<TransformComponent>());
 }
 
 
 Entity::Entity(Entity const& other) :
-  SceneObject{other} {
+  SceneObject{other},
+  id_{GetRegistry().CreateEntityId()} {
   SetName(other.GetName());
 
   for (auto const& component : other.components_) {
@@ -94,7 +97,8 @@ Entity::Entity(Entity const& other) :
 
 
 Entity::Entity(Entity&& other) noexcept :
-  SceneObject{std::move(other)} {
+  SceneObject{std::move(other)},
+  id_{GetRegistry().CreateEntityId()} {
   SetName(other.GetName());
 
   while (!other.components_.empty()) {
@@ -109,6 +113,8 @@ Entity::~Entity() {
   while (!components_.empty()) {
     RemoveComponent(*components_.back());
   }
+
+  GetRegistry().ReleaseEntityId(id_);
 }
 
 
@@ -128,6 +134,8 @@ auto Entity::GetScene() const -> ObserverPtr<Scene const> {
 auto Entity::AddComponent(std::unique_ptr<Component> component) -> void {
   if (component) {
     components_.emplace_back(std::move(component));
+    IndexComponent(*components_.back());
+    GetRegistry().Register(id_, *components_.back());
     components_.back()->OnAfterAttachedToEntity(*this);
 
     if (scene_) {
@@ -148,9 +156,18 @@ auto Entity::RemoveComponent(Component& component) -> std::unique_ptr<Component>
     }
 
     (*it)->OnBeforeDetachedFromEntity(*this);
+    GetRegistry().Unregister(id_, **it);
 
     auto ret{std::move(*it)};
     components_.erase(it);
+
+    // Detaching is rare, so the lookup is simply rebuilt to find the next components of the types in order
+    component_lookup_.clear();
+
+    for (auto const& owned_component : components_) {
+      IndexComponent(*owned_component);
+    }
+
     return ret;
   }
 
@@ -171,6 +188,34 @@ auto Entity::FindEntityByName(std::string_view const name) -> Entity* {
 }
 
 
+auto Entity::GetRegistry() -> ComponentRegistry& {
+  return App::Instance().GetComponentRegistry();
+}
+
+
+auto Entity::IndexComponent(Component& component) -> void {
+  auto const index_as{
+    [this, &component](rttr::type const& type) {
+      if (auto const it{std::ranges::find(component_lookup_, type, &ComponentLookupEntry::type)};
+        it != std::end(component_lookup_)) {
+        it->count += 1;
+      } else {
+        component_lookup_.emplace_back(ComponentLookupEntry{type, &component, 1});
+      }
+    }
+  };
+
+  auto const type{rttr::type::get(component)};
+  index_as(type);
+
+  for (auto const& base_type : type.get_base_classes()) {
+    if (base_type.is_derived_from<Component>()) {
+      index_as(base_type);
+    }
+  }
+}
+
+
 auto Entity::GetComponentsForSerialization() const -> std::vector<Component*> {
   std::vector<Component*> ret;
   std::ranges::transform(components_, std::back_inserter(ret), [](auto const& component) {
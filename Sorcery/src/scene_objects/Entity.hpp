@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Component.hpp"
+#include "component_registry.hpp"
 #include "SceneObject.hpp"
 #include "TransformComponent.hpp"
 #include "../observer_ptr.hpp"
@@ -54,12 +55,29 @@ public:
   [[nodiscard]] LEOPPHAPI static auto FindEntityByName(std::string_view name) -> Entity*;
 
 private:
+  // A type of the attached components and the first component of that type in attachment order
+  struct ComponentLookupEntry {
+    rttr::type type;
+    Component* first;
+    int count;
+  };
+
+
+  [[nodiscard]] static auto GetRegistry() -> ComponentRegistry&;
+
+  auto IndexComponent(Component& component) -> void;
+
   [[nodiscard]] auto GetComponentsForSerialization() const -> std::vector<Component*>;
   auto SetComponentFromDeserialization(std::vector<Component*> components) -> void;
 
   ObserverPtr<Scene const> scene_{nullptr};
   mutable TransformComponent* transform_{nullptr};
+  ComponentRegistry::EntityId id_;
+  // Keeps the attachment order
   std::vector<std::unique_ptr<Component>> components_;
+  // Exact and base types of the attached components.
+  // Only attaching and detaching modifies it, so typed lookups take no lock and need no global map probe.
+  std::vector<ComponentLookupEntry> component_lookup_;
 };
 }
 
@@ -85,7 +85,7 @@ MeshComponentBase::~MeshComponentBase() = default;
 
 
 auto MeshComponentBase::GetMesh() const noexcept -> Mesh* {
-  return mesh_;
+  return mesh_.Get();
 }
 
 
@@ -95,13 +95,31 @@ auto MeshComponentBase::SetMesh(Mesh* const mesh) noexcept -> void {
 }
 
 
-auto MeshComponentBase::GetMaterials() const noexcept -> std::vector<Material*> const& {
-  return materials_;
+auto MeshComponentBase::GetMaterials() const -> std::vector<Material*> {
+  std::vector<Material*> materials;
+  materials.reserve(materials_.size());
+
+  for (auto const& mtl : materials_) {
+    materials.emplace_back(mtl.Get());
+  }
+
+  return materials;
+}
+
+
+auto MeshComponentBase::GetMaterial(int const idx) const -> Material* {
+  if (idx >= std::ssize(materials_)) {
+    throw std::runtime_error{
+      std::format("Invalid index {} while attempting to get material of mesh component.", idx)
+    };
+  }
+
+  return materials_[idx].Get();
 }
 
 
 auto MeshComponentBase::SetMaterials(std::vector<Material*> const& materials) -> void {
-  materials_ = materials;
+  materials_.assign(std::begin(materials), std::end(materials));
   ResizeMaterialListToSubmeshCount();
 }
 
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "Component.hpp"
+#include "../handle.hpp"
 #include "../Resources/Material.hpp"
 #include "../Resources/Mesh.hpp"
 
@@ -36,7 +37,8 @@ public:
   LEOPPHAPI virtual auto SetMesh(Mesh* mesh) noexcept -> void;
 
   // The returned vector is the same length as the Mesh's submesh count.
-  [[nodiscard]] LEOPPHAPI auto GetMaterials() const noexcept -> std::vector<Material*> const&;
+  [[nodiscard]] LEOPPHAPI auto GetMaterials() const -> std::vector<Material*>;
+  [[nodiscard]] LEOPPHAPI auto GetMaterial(int idx) const -> Material*;
   LEOPPHAPI auto SetMaterials(std::vector<Material*> const& materials) -> void;
   LEOPPHAPI auto SetMaterial(int idx, Material* mtl) -> void;
 
@@ -49,8 +51,8 @@ public:
 private:
   auto ResizeMaterialListToSubmeshCount() -> void;
 
-  std::vector<Material*> materials_;
-  Mesh* mesh_;
+  std::vector<Handle<Material>> materials_;
+  Handle<Mesh> mesh_;
   Matrix4 prev_model_mtx_{Matrix4::Identity()};
 
   static bool show_bounding_boxes_; // TODO this should be stripped when not compiling for Mage
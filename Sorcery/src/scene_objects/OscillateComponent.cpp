@@ -44,6 +44,11 @@ auto OscillateComponent::Update() -> void {
 }
 
 
+auto OscillateComponent::GetUpdateAccess() const -> UpdateAccess {
+  return {update_resources::kEntityTransform, update_resources::kEntityTransform};
+}
+
+
 OscillateComponent::OscillateComponent() {
   SetUpdatable(true);
 }
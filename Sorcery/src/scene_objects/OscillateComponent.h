@@ -14,6 +14,7 @@ public:
 
   auto Start() -> void override;
   auto Update() -> void override;
+  [[nodiscard]] auto GetUpdateAccess() const -> UpdateAccess override;
 
   LEOPPHAPI OscillateComponent();
 
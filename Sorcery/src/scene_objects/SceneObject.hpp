@@ -1,5 +1,6 @@
 #pragma once
 
+#include "update_access.hpp"
 #include "../Object.hpp"
 
 
@@ -26,10 +27,14 @@ public:
   LEOPPHAPI virtual auto OnBeforeExitingScene(Scene const& scene) -> void {}
 
   [[nodiscard]] LEOPPHAPI auto IsUpdatable() const -> bool;
-  LEOPPHAPI auto SetUpdatable(bool updatable) -> void;
+  LEOPPHAPI virtual auto SetUpdatable(bool updatable) -> void;
 
   LEOPPHAPI virtual auto Start() -> void {}
   LEOPPHAPI virtual auto Update() -> void {}
+  // Declares what Update touches so that it can run concurrently with others, defaults to everything
+  [[nodiscard]] LEOPPHAPI virtual auto GetUpdateAccess() const -> UpdateAccess {
+    return {update_resources::kAll, update_resources::kAll};
+  }
 
 private:
   bool updatable_{false};
@@ -84,6 +84,12 @@ auto SkinnedMeshComponent::Update() -> void {
 }
 
 
+auto SkinnedMeshComponent::GetUpdateAccess() const -> UpdateAccess {
+  // Playback only advances the state of the component
+  return {update_resources::kNone, update_resources::kNone};
+}
+
+
 SkinnedMeshComponent::SkinnedMeshComponent() {
   SetUpdatable(true);
 }
@@ -2,6 +2,7 @@
 
 #include <utility>
 
+#include "../app.hpp"
 #include "../Serialization.hpp"
 
 
@@ -23,7 +24,7 @@ auto TransformComponent::Clone() -> std::unique_ptr<SceneObject> {
   auto clone{std::make_unique<TransformComponent>(*this)};
   clone->mChildren.clear();
   clone->mParent = nullptr;
-  clone->SetParent(mParent);
+  clone->SetParent(mParent.Get());
 
   return clone;
 }
@@ -31,7 +32,7 @@ auto TransformComponent::Clone() -> std::unique_ptr<SceneObject> {
 
 auto TransformComponent::OnAfterAttachedToEntity(Entity& entity) -> void {
   Component::OnAfterAttachedToEntity(entity);
-  UpdateWorldDataRecursive();
+  SetChanged(true);
 }
 
 
@@ -46,36 +47,45 @@ auto TransformComponent::OnBeforeDetachedFromEntity(Entity& entity) -> void {
 }
 
 
+TransformComponent::TransformComponent() :
+  mNode{GetSystem().CreateNode()} {}
+
+
 TransformComponent::TransformComponent(TransformComponent const& other) :
   Component{other},
-  mLocalPosition{other.mLocalPosition},
-  mLocalRotation{other.mLocalRotation},
-  mLocalEulerAnglesHelp{other.mLocalEulerAnglesHelp},
-  mLocalScale{other.mLocalScale} {
-  UpdateWorldDataRecursive();
+  mNode{GetSystem().CreateNode()},
+  mLocalEulerAnglesHelp{other.mLocalEulerAnglesHelp} {
   // Explicitly not copying parent and children
+  GetSystem().SetLocalPosition(mNode, other.GetLocalPosition());
+  GetSystem().SetLocalRotation(mNode, other.GetLocalRotation());
+  GetSystem().SetLocalScale(mNode, other.GetLocalScale());
 }
 
 
 TransformComponent::TransformComponent(TransformComponent&& other) noexcept :
   Component{std::move(other)},
-  mLocalPosition{std::move(other.mLocalPosition)},
-  mLocalRotation{std::move(other.mLocalRotation)},
-  mLocalEulerAnglesHelp{std::move(other.mLocalEulerAnglesHelp)},
-  mLocalScale{std::move(other.mLocalScale)} {
-  UpdateWorldDataRecursive();
+  mNode{GetSystem().CreateNode()},
+  mLocalEulerAnglesHelp{std::move(other.mLocalEulerAnglesHelp)} {
   // Explicitly not copying parent and children
+  GetSystem().SetLocalPosition(mNode, other.GetLocalPosition());
+  GetSystem().SetLocalRotation(mNode, other.GetLocalRotation());
+  GetSystem().SetLocalScale(mNode, other.GetLocalScale());
+}
+
+
+TransformComponent::~TransformComponent() {
+  GetSystem().DestroyNode(mNode);
 }
 
 
 auto TransformComponent::GetWorldPosition() const -> Vector3 const& {
-  return mWorldPosition;
+  return GetSystem().GetWorldPosition(mNode);
 }
 
 
 auto TransformComponent::SetWorldPosition(Vector3 const& newPos) -> void {
   if (mParent != nullptr) {
-    SetLocalPosition(mParent->mWorldRotation.Conjugate().Rotate(newPos) - mParent->mWorldPosition);
+    SetLocalPosition(mParent->GetWorldRotation().Conjugate().Rotate(newPos) - mParent->GetWorldPosition());
   } else {
     SetLocalPosition(newPos);
   }
@@ -83,24 +93,23 @@ auto TransformComponent::SetWorldPosition(Vector3 const& newPos) -> void {
 
 
 auto TransformComponent::GetLocalPosition() const -> Vector3 const& {
-  return mLocalPosition;
+  return GetSystem().GetLocalPosition(mNode);
 }
 
 
 auto TransformComponent::SetLocalPosition(Vector3 const& newPos) -> void {
-  mLocalPosition = newPos;
-  UpdateWorldDataRecursive();
+  GetSystem().SetLocalPosition(mNode, newPos);
 }
 
 
 auto TransformComponent::GetWorldRotation() const -> Quaternion const& {
-  return mWorldRotation;
+  return GetSystem().GetWorldRotation(mNode);
 }
 
 
 auto TransformComponent::SetWorldRotation(Quaternion const& newRot) -> void {
   if (mParent != nullptr) {
-    SetLocalRotation(mParent->mWorldRotation.Conjugate() * newRot);
+    SetLocalRotation(mParent->GetWorldRotation().Conjugate() * newRot);
   } else {
     SetLocalRotation(newRot);
   }
@@ -108,14 +117,13 @@ auto TransformComponent::SetWorldRotation(Quaternion const& newRot) -> void {
 
 
 auto TransformComponent::GetLocalRotation() const -> Quaternion const& {
-  return mLocalRotation;
+  return GetSystem().GetLocalRotation(mNode);
 }
 
 
 auto TransformComponent::SetLocalRotation(Quaternion const& newRot) -> void {
-  mLocalRotation = newRot;
+  GetSystem().SetLocalRotation(mNode, newRot);
   mLocalEulerAnglesHelp = newRot.ToEulerAngles();
-  UpdateWorldDataRecursive();
 }
 
 
@@ -125,20 +133,19 @@ auto TransformComponent::GetLocalEulerAngles() const noexcept -> Vector3 const&
 
 
 auto TransformComponent::SetLocalEulerAngles(Vector3 const& eulerAngles) noexcept -> void {
-  mLocalRotation = Quaternion::FromEulerAngles(eulerAngles);
+  GetSystem().SetLocalRotation(mNode, Quaternion::FromEulerAngles(eulerAngles));
   mLocalEulerAnglesHelp = eulerAngles;
-  UpdateWorldDataRecursive();
 }
 
 
 auto TransformComponent::GetWorldScale() const -> Vector3 const& {
-  return mWorldScale;
+  return GetSystem().GetWorldScale(mNode);
 }
 
 
 auto TransformComponent::SetWorldScale(Vector3 const& newScale) -> void {
   if (mParent != nullptr) {
-    SetLocalScale(newScale / mParent->mWorldScale);
+    SetLocalScale(newScale / mParent->GetWorldScale());
   } else {
     SetLocalScale(newScale);
   }
@@ -146,21 +153,20 @@ auto TransformComponent::SetWorldScale(Vector3 const& newScale) -> void {
 
 
 auto TransformComponent::GetLocalScale() const -> Vector3 const& {
-  return mLocalScale;
+  return GetSystem().GetLocalScale(mNode);
 }
 
 
 auto TransformComponent::SetLocalScale(Vector3 const& newScale) -> void {
-  mLocalScale = newScale;
-  UpdateWorldDataRecursive();
+  GetSystem().SetLocalScale(mNode, newScale);
 }
 
 
 auto TransformComponent::Translate(Vector3 const& vector, Space const base) -> void {
   if (base == Space::World) {
-    SetWorldPosition(mWorldPosition + vector);
+    SetWorldPosition(GetWorldPosition() + vector);
   } else if (base == Space::Local) {
-    SetLocalPosition(mLocalPosition + mLocalRotation.Rotate(vector));
+    SetLocalPosition(GetLocalPosition() + GetLocalRotation().Rotate(vector));
   }
 }
 
@@ -172,9 +178,9 @@ auto TransformComponent::Translate(f32 const x, f32 const y, f32 const z, Space
 
 auto TransformComponent::Rotate(Quaternion const& rotation, Space const base) -> void {
   if (base == Space::World) {
-    SetLocalRotation(rotation * mLocalRotation);
+    SetLocalRotation(rotation * GetLocalRotation());
   } else if (base == Space::Local) {
-    SetLocalRotation(mLocalRotation * rotation);
+    SetLocalRotation(GetLocalRotation() * rotation);
   }
 }
 
@@ -186,9 +192,9 @@ auto TransformComponent::Rotate(Vector3 const& axis, f32 const amountDegrees, Sp
 
 auto TransformComponent::Rescale(Vector3 const& scaling, Space const base) -> void {
   if (base == Space::World) {
-    SetWorldScale(mWorldScale * scaling);
+    SetWorldScale(GetWorldScale() * scaling);
   } else if (base == Space::Local) {
-    SetLocalScale(mLocalScale * scaling);
+    SetLocalScale(GetLocalScale() * scaling);
   }
 }
 
@@ -199,22 +205,22 @@ auto TransformComponent::Rescale(f32 const x, f32 const y, f32 const z, Space co
 
 
 auto TransformComponent::GetRightAxis() const -> Vector3 const& {
-  return mRight;
+  return GetSystem().GetRightAxis(mNode);
 }
 
 
 auto TransformComponent::GetUpAxis() const -> Vector3 const& {
-  return mUp;
+  return GetSystem().GetUpAxis(mNode);
 }
 
 
 auto TransformComponent::GetForwardAxis() const -> Vector3 const& {
-  return mForward;
+  return GetSystem().GetForwardAxis(mNode);
 }
 
 
 auto TransformComponent::GetParent() const -> TransformComponent* {
-  return mParent;
+  return mParent.Get();
 }
 
 
@@ -229,7 +235,7 @@ auto TransformComponent::SetParent(TransformComponent* parent) -> void {
     mParent->mChildren.push_back(this);
   }
 
-  UpdateWorldDataRecursive();
+  GetSystem().SetParent(mNode, mParent ? mParent->mNode : TransformSystem::kInvalidNode);
 }
 
 
@@ -239,7 +245,7 @@ auto TransformComponent::GetChildren() const -> std::vector<TransformComponent*>
 
 
 auto TransformComponent::GetLocalToWorldMatrix() const noexcept -> Matrix4 const& {
-  return mLocalToWorldMtx;
+  return GetSystem().GetLocalToWorldMatrix(mNode);
 }
 
 
@@ -256,41 +262,16 @@ auto TransformComponent::CalculateLocalToWorldMatrixWithoutScale() const noexcep
 
 
 auto TransformComponent::HasChanged() const noexcept -> bool {
-  return mChanged;
+  return GetSystem().HasChanged(mNode);
 }
 
 
 auto TransformComponent::SetChanged(bool const changed) noexcept -> void {
-  mChanged = changed;
+  GetSystem().SetChanged(mNode, changed);
 }
 
 
-auto TransformComponent::UpdateWorldDataRecursive() -> void {
-  SetChanged(true);
-
-  mWorldPosition = mParent != nullptr
-                     ? mParent->mWorldPosition + mParent->mWorldRotation.Rotate(mLocalPosition)
-                     : mLocalPosition;
-  mWorldRotation = mParent != nullptr
-                     ? mParent->mWorldRotation * mLocalRotation
-                     : mLocalRotation;
-  mWorldScale = mParent != nullptr
-                  ? mParent->mWorldScale * mLocalScale
-                  : mLocalScale;
-
-  mForward = mWorldRotation.Rotate(Vector3::Forward());
-  mRight = mWorldRotation.Rotate(Vector3::Right());
-  mUp = mWorldRotation.Rotate(Vector3::Up());
-
-  // SRT transformation order
-
-  mLocalToWorldMtx[0] = Vector4{mRight * mWorldScale[0], 0};
-  mLocalToWorldMtx[1] = Vector4{mUp * mWorldScale[1], 0};
-  mLocalToWorldMtx[2] = Vector4{mForward * mWorldScale[2], 0};
-  mLocalToWorldMtx[3] = Vector4{mWorldPosition, 1};
-
-  for (auto* const child : mChildren) {
-    child->UpdateWorldDataRecursive();
-  }
+auto TransformComponent::GetSystem() -> TransformSystem& {
+  return App::Instance().GetTransformSystem();
 }
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Component.hpp"
+#include "transform_system.hpp"
+#include "../handle.hpp"
 #include "../Math.hpp"
 
 
@@ -21,11 +23,11 @@ public:
   LEOPPHAPI auto OnAfterAttachedToEntity(Entity& entity) -> void override;
   LEOPPHAPI auto OnBeforeDetachedFromEntity(Entity& entity) -> void override;
 
-  TransformComponent() = default;
+  LEOPPHAPI TransformComponent();
   LEOPPHAPI TransformComponent(TransformComponent const& other);
   LEOPPHAPI TransformComponent(TransformComponent&& other) noexcept;
 
-  ~TransformComponent() override = default;
+  LEOPPHAPI ~TransformComponent() override;
 
   auto operator=(TransformComponent const& other) -> void = delete;
   auto operator=(TransformComponent&& other) -> void = delete;
@@ -76,26 +78,13 @@ public:
   LEOPPHAPI auto SetChanged(bool changed) noexcept -> void;
 
 private:
-  auto UpdateWorldDataRecursive() -> void;
+  [[nodiscard]] static auto GetSystem() -> TransformSystem&;
 
-  Vector3 mLocalPosition{0, 0, 0};
-  Quaternion mLocalRotation{1, 0, 0, 0};
+  // Local and world data live in the transform system
+  TransformSystem::NodeId mNode;
   Vector3 mLocalEulerAnglesHelp{0, 0, 0};
-  Vector3 mLocalScale{1, 1, 1};
 
-  Vector3 mWorldPosition{mLocalPosition};
-  Quaternion mWorldRotation{mLocalRotation};
-  Vector3 mWorldScale{mLocalScale};
-
-  Vector3 mForward{Vector3::Forward()};
-  Vector3 mRight{Vector3::Right()};
-  Vector3 mUp{Vector3::Up()};
-
-  TransformComponent* mParent{nullptr};
+  Handle<TransformComponent> mParent;
   std::vector<TransformComponent*> mChildren;
-
-  Matrix4 mLocalToWorldMtx{Matrix4::Identity()};
-
-  bool mChanged{false};
 };
 }
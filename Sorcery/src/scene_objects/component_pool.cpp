@@ -0,0 +1,104 @@
+#include "component_pool.hpp"
+
+#include <cassert>
+
+
+namespace sorcery {
+auto ComponentPool::Insert(EntityId const entity, Component& component) -> void {
+  if (entity >= heads_.size()) {
+    heads_.resize(static_cast<std::size_t>(entity) + 1, kInvalidIndex);
+  }
+
+  auto const dense_idx{static_cast<std::uint32_t>(components_.size())};
+  components_.emplace_back(&component);
+  entities_.emplace_back(entity);
+  next_.emplace_back(kInvalidIndex);
+
+  auto* link{&heads_[entity]};
+
+  while (*link != kInvalidIndex) {
+    link = &next_[*link];
+  }
+
+  *link = dense_idx;
+}
+
+
+auto ComponentPool::Erase(EntityId const entity, Component const& component) -> void {
+  if (entity >= heads_.size()) {
+    return;
+  }
+
+  auto* link{&heads_[entity]};
+
+  while (*link != kInvalidIndex && components_[*link] != &component) {
+    link = &next_[*link];
+  }
+
+  if (*link == kInvalidIndex) {
+    return;
+  }
+
+  auto const dense_idx{*link};
+  *link = next_[dense_idx];
+
+  // The last component fills the gap
+  if (auto const last_idx{static_cast<std::uint32_t>(components_.size() - 1)}; dense_idx != last_idx) {
+    FindLinkTo(last_idx) = dense_idx;
+    components_[dense_idx] = components_[last_idx];
+    entities_[dense_idx] = entities_[last_idx];
+    next_[dense_idx] = next_[last_idx];
+  }
+
+  components_.pop_back();
+  entities_.pop_back();
+  next_.pop_back();
+}
+
+
+auto ComponentPool::Find(EntityId const entity) const -> Component* {
+  if (entity >= heads_.size() || heads_[entity] == kInvalidIndex) {
+    return nullptr;
+  }
+
+  return components_[heads_[entity]];
+}
+
+
+auto ComponentPool::FindAll(EntityId const entity, std::vector<Component*>& out) const -> void {
+  if (entity >= heads_.size()) {
+    return;
+  }
+
+  for (auto idx{heads_[entity]}; idx != kInvalidIndex; idx = next_[idx]) {
+    out.emplace_back(components_[idx]);
+  }
+}
+
+
+auto ComponentPool::GetComponents() const noexcept -> std::span<Component* const> {
+  return components_;
+}
+
+
+auto ComponentPool::MayContainUpdatable() const noexcept -> bool {
+  return may_contain_updatable_;
+}
+
+
+auto ComponentPool::SetMayContainUpdatable() noexcept -> void {
+  may_contain_updatable_ = true;
+}
+
+
+auto ComponentPool::FindLinkTo(std::uint32_t const dense_idx) -> std::uint32_t& {
+  auto* link{&heads_[entities_[dense_idx]]};
+
+  while (*link != dense_idx) {
+    assert(*link != kInvalidIndex);
+    link = &next_[*link];
+  }
+
+  return *link;
+}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../Core.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+namespace sorcery {
+class Component;
+
+
+// Sparse set of the components of a single type, keyed by entity id.
+// The components are densely packed for iteration, the components of an entity are chained through the dense array.
+class ComponentPool {
+public:
+  using EntityId = std::uint32_t;
+
+  LEOPPHAPI auto Insert(EntityId entity, Component& component) -> void;
+  LEOPPHAPI auto Erase(EntityId entity, Component const& component) -> void;
+
+  // Returns the first inserted component of the entity
+  [[nodiscard]] LEOPPHAPI auto Find(EntityId entity) const -> Component*;
+  LEOPPHAPI auto FindAll(EntityId entity, std::vector<Component*>& out) const -> void;
+
+  [[nodiscard]] LEOPPHAPI auto GetComponents() const noexcept -> std::span<Component* const>;
+
+  // Set once any component of the pool was updatable, the pool is skipped by the update otherwise
+  [[nodiscard]] LEOPPHAPI auto MayContainUpdatable() const noexcept -> bool;
+  LEOPPHAPI auto SetMayContainUpdatable() noexcept -> void;
+
+private:
+  constexpr static std::uint32_t kInvalidIndex{0xFFFFFFFF};
+
+  // Finds the link that points to the dense index, either the head of the entity or the next link of a component
+  [[nodiscard]] auto FindLinkTo(std::uint32_t dense_idx) -> std::uint32_t&;
+
+  std::vector<Component*> components_;
+  std::vector<EntityId> entities_;
+  std::vector<std::uint32_t> next_;
+  // Indexed by entity id, the dense index of the first inserted component of the entity
+  std::vector<std::uint32_t> heads_;
+  bool may_contain_updatable_{false};
+};
+}
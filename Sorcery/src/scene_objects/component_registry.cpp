@@ -0,0 +1,157 @@
+#include "component_registry.hpp"
+
+#include "Component.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <ranges>
+#include <utility>
+
+
+namespace sorcery {
+auto ComponentRegistry::CreateEntityId() -> EntityId {
+  std::unique_lock const lock{mutex_};
+
+  if (!free_entities_.empty()) {
+    auto const entity{free_entities_.back()};
+    free_entities_.pop_back();
+    return entity;
+  }
+
+  return entity_count_++;
+}
+
+
+auto ComponentRegistry::ReleaseEntityId(EntityId const entity) -> void {
+  std::unique_lock const lock{mutex_};
+  free_entities_.emplace_back(entity);
+}
+
+
+auto ComponentRegistry::Register(EntityId const entity, Component& component) -> void {
+  std::unique_lock const lock{mutex_};
+  auto const [it, inserted]{pools_.try_emplace(rttr::type::get(component).get_id())};
+  auto& pool{it->second};
+
+  if (inserted) {
+    pool_order_.emplace_back(&pool);
+  }
+
+  pool.Insert(entity, component);
+
+  if (component.IsUpdatable()) {
+    pool.SetMayContainUpdatable();
+  }
+}
+
+
+auto ComponentRegistry::Unregister(EntityId const entity, Component const& component) -> void {
+  std::unique_lock const lock{mutex_};
+
+  if (auto const it{pools_.find(rttr::type::get(component).get_id())}; it != std::end(pools_)) {
+    it->second.Erase(entity, component);
+  }
+}
+
+
+auto ComponentRegistry::OnBecameUpdatable(Component const& component) -> void {
+  std::unique_lock const lock{mutex_};
+
+  if (auto const it{pools_.find(rttr::type::get(component).get_id())}; it != std::end(pools_)) {
+    it->second.SetMayContainUpdatable();
+  }
+}
+
+
+auto ComponentRegistry::FindComponent(EntityId const entity, rttr::type const& type) const -> Component* {
+  std::shared_lock const lock{mutex_};
+
+  if (auto const pool{FindPool(type)}) {
+    if (auto const component{pool->Find(entity)}) {
+      return component;
+    }
+  }
+
+  for (auto const& derived_type : type.get_derived_classes()) {
+    if (auto const pool{FindPool(derived_type)}) {
+      if (auto const component{pool->Find(entity)}) {
+        return component;
+      }
+    }
+  }
+
+  return nullptr;
+}
+
+
+auto ComponentRegistry::FindComponents(EntityId const entity, rttr::type const& type,
+                                       std::vector<Component*>& out) const -> void {
+  std::shared_lock const lock{mutex_};
+  out.clear();
+
+  ForEachPool(type, [entity, &out](ComponentPool const& pool) {
+    pool.FindAll(entity, out);
+  });
+}
+
+
+auto ComponentRegistry::GetComponentsOfType(rttr::type const& type, std::vector<Component*>& out) const -> void {
+  std::shared_lock const lock{mutex_};
+  out.clear();
+
+  ForEachPool(type, [&out](ComponentPool const& pool) {
+    std::ranges::copy(pool.GetComponents(), std::back_inserter(out));
+  });
+}
+
+
+auto ComponentRegistry::GetUpdatableComponents(std::vector<Component*>& out) const -> void {
+  std::shared_lock const lock{mutex_};
+  out.clear();
+
+  for (auto const& pool : pools_ | std::views::values) {
+    if (!pool.MayContainUpdatable()) {
+      continue;
+    }
+
+    for (auto const component : pool.GetComponents()) {
+      if (component->IsUpdatable()) {
+        out.emplace_back(component);
+      }
+    }
+  }
+}
+
+
+auto ComponentRegistry::GetUpdateGroups(std::vector<UpdateGroup>& out) const -> void {
+  std::shared_lock const lock{mutex_};
+  out.clear();
+
+  for (auto const pool : pool_order_) {
+    if (!pool->MayContainUpdatable()) {
+      continue;
+    }
+
+    UpdateGroup group;
+
+    for (auto const component : pool->GetComponents()) {
+      if (component->IsUpdatable()) {
+        group.components.emplace_back(component);
+      }
+    }
+
+    if (!group.components.empty()) {
+      // Every instance of a type declares the same access
+      group.access = group.components.front()->GetUpdateAccess();
+      out.emplace_back(std::move(group));
+    }
+  }
+}
+
+
+auto ComponentRegistry::FindPool(rttr::type const& type) const -> ComponentPool const* {
+  auto const it{pools_.find(type.get_id())};
+  return it != std::end(pools_) ? &it->second : nullptr;
+}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "component_pool.hpp"
+#include "update_access.hpp"
+#include "../Core.hpp"
+#include "../Reflection.hpp"
+
+#include <concepts>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace sorcery {
+// Indexes the components attached to entities by their exact type.
+// Components stay owned by their entities, the pools only reference them.
+class ComponentRegistry {
+public:
+  using EntityId = ComponentPool::EntityId;
+
+  ComponentRegistry() = default;
+  ComponentRegistry(ComponentRegistry const&) = delete;
+  ComponentRegistry(ComponentRegistry&&) = delete;
+
+  ~ComponentRegistry() = default;
+
+  auto operator=(ComponentRegistry const&) -> void = delete;
+  auto operator=(ComponentRegistry&&) -> void = delete;
+
+  [[nodiscard]] LEOPPHAPI auto CreateEntityId() -> EntityId;
+  LEOPPHAPI auto ReleaseEntityId(EntityId entity) -> void;
+
+  LEOPPHAPI auto Register(EntityId entity, Component& component) -> void;
+  LEOPPHAPI auto Unregister(EntityId entity, Component const& component) -> void;
+  LEOPPHAPI auto OnBecameUpdatable(Component const& component) -> void;
+
+  // Looks up the pool of the type and the pools of its derived types
+  [[nodiscard]] LEOPPHAPI auto FindComponent(EntityId entity, rttr::type const& type) const -> Component*;
+  LEOPPHAPI auto FindComponents(EntityId entity, rttr::type const& type, std::vector<Component*>& out) const -> void;
+
+  LEOPPHAPI auto GetComponentsOfType(rttr::type const& type, std::vector<Component*>& out) const -> void;
+  // Only visits the pools of types that had updatable components
+  LEOPPHAPI auto GetUpdatableComponents(std::vector<Component*>& out) const -> void;
+  // One group per type with updatable components, in the order the types were first registered
+  LEOPPHAPI auto GetUpdateGroups(std::vector<UpdateGroup>& out) const -> void;
+
+  template<std::derived_from<Component> T>
+  [[nodiscard]] auto FindComponent(EntityId entity) const -> T*;
+
+  template<std::derived_from<Component> T>
+  auto FindComponents(EntityId entity, std::vector<T*>& out) const -> std::vector<T*>&;
+
+  template<std::derived_from<Component> T>
+  auto GetComponentsOfType(std::vector<T*>& out) const -> std::vector<T*>&;
+
+private:
+  [[nodiscard]] auto FindPool(rttr::type const& type) const -> ComponentPool const*;
+
+  template<typename Func>
+  auto ForEachPool(rttr::type const& type, Func&& func) const -> void;
+
+  std::unordered_map<rttr::type::type_id, ComponentPool> pools_;
+  // Pools are never erased so their addresses are stable
+  std::vector<ComponentPool*> pool_order_;
+  std::vector<EntityId> free_entities_;
+  EntityId entity_count_{0};
+  mutable std::shared_mutex mutex_;
+};
+}
+
+
+#include "component_registry.inl"
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <mutex>
+
+
+namespace sorcery {
+template<std::derived_from<Component> T>
+auto ComponentRegistry::FindComponent(EntityId const entity) const -> T* {
+  // The pools only match T and its derived types
+  return static_cast<T*>(FindComponent(entity, rttr::type::get<T>()));
+}
+
+
+template<std::derived_from<Component> T>
+auto ComponentRegistry::FindComponents(EntityId const entity, std::vector<T*>& out) const -> std::vector<T*>& {
+  std::vector<Component*> components;
+  FindComponents(entity, rttr::type::get<T>(), components);
+
+  out.clear();
+  out.reserve(components.size());
+
+  for (auto const component : components) {
+    out.emplace_back(static_cast<T*>(component));
+  }
+
+  return out;
+}
+
+
+template<std::derived_from<Component> T>
+auto ComponentRegistry::GetComponentsOfType(std::vector<T*>& out) const -> std::vector<T*>& {
+  std::shared_lock const lock{mutex_};
+
+  out.clear();
+
+  ForEachPool(rttr::type::get<T>(), [&out](ComponentPool const& pool) {
+    for (auto const component : pool.GetComponents()) {
+      out.emplace_back(static_cast<T*>(component));
+    }
+  });
+
+  return out;
+}
+
+
+template<typename Func>
+auto ComponentRegistry::ForEachPool(rttr::type const& type, Func&& func) const -> void {
+  if (auto const pool{FindPool(type)}) {
+    func(*pool);
+  }
+
+  for (auto const& derived_type : type.get_derived_classes()) {
+    if (auto const pool{FindPool(derived_type)}) {
+      func(*pool);
+    }
+  }
+}
+}
@@ -12,13 +12,8 @@ auto Entity::GetComponent() const -> T* {
              ? nullptr
              : components_.front().get();
   } else {
-    for (auto const& component : components_) {
-      if (auto const castPtr{rttr::rttr_cast<T*>(component.get())}) {
-        return castPtr;
-      }
-    }
-
-    return nullptr;
+    auto const entry{std::ranges::find(component_lookup_, rttr::type::get<T>(), &ComponentLookupEntry::type)};
+    return entry != std::end(component_lookup_) ? static_cast<T*>(entry->first) : nullptr;
   }
 }
 
@@ -33,6 +28,18 @@ auto Entity::GetComponents(std::vector<T*>& out) const -> std::vector<T*>& {
   } else {
     out.clear();
 
+    auto const entry{std::ranges::find(component_lookup_, rttr::type::get<T>(), &ComponentLookupEntry::type)};
+
+    if (entry == std::end(component_lookup_)) {
+      return out;
+    }
+
+    if (entry->count == 1) {
+      out.emplace_back(static_cast<T*>(entry->first));
+      return out;
+    }
+
+    // Several matches are returned in attachment order
     for (auto const& component : components_) {
       if (auto const castPtr{rttr::rttr_cast<T*>(component.get())}) {
         out.emplace_back(castPtr);
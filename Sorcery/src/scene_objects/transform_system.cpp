@@ -0,0 +1,397 @@
+#include "transform_system.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+
+
+namespace sorcery {
+auto TransformSystem::CreateNode() -> NodeId {
+  std::unique_lock const lock{mutex_};
+
+  NodeId node;
+
+  if (!free_nodes_.empty()) {
+    node = free_nodes_.back();
+    free_nodes_.pop_back();
+  } else {
+    if (node_count_ == kPageSize * kMaxPageCount) {
+      throw std::runtime_error{"Failed to create transform node: the maximum number of nodes has been reached."};
+    }
+
+    node = node_count_++;
+
+    if (auto& page{pages_[GetPageIndex(node)]}; !page) {
+      page = std::make_unique<Page>();
+    }
+  }
+
+  auto& page{GetPage(node)};
+  auto const idx{node % kPageSize};
+
+  page.local_positions[idx] = Vector3{0, 0, 0};
+  page.local_rotations[idx] = Quaternion{1, 0, 0, 0};
+  page.local_scales[idx] = Vector3{1, 1, 1};
+  page.world_positions[idx] = Vector3{0, 0, 0};
+  page.world_rotations[idx] = Quaternion{1, 0, 0, 0};
+  page.world_scales[idx] = Vector3{1, 1, 1};
+  page.rights[idx] = Vector3::Right();
+  page.ups[idx] = Vector3::Up();
+  page.forwards[idx] = Vector3::Forward();
+  page.local_to_world_mtxs[idx] = Matrix4::Identity();
+  page.parents[idx].store(kInvalidNode, std::memory_order_relaxed);
+  page.children[idx].clear();
+  page.alive[idx] = true;
+  // Calculations of the node's previous use that are still running must not clear the flag
+  page.stale_states[idx].fetch_add(kMarkIncrement, std::memory_order_release);
+  page.stale_states[idx].fetch_and(~kStaleBit, std::memory_order_release);
+  page.changed[idx].store(false, std::memory_order_relaxed);
+
+  return node;
+}
+
+
+auto TransformSystem::DestroyNode(NodeId const node) -> void {
+  std::unique_lock const lock{mutex_};
+
+  auto& page{GetPage(node)};
+  auto const idx{node % kPageSize};
+
+  if (auto const parent{page.parents[idx].load(std::memory_order_relaxed)}; parent != kInvalidNode) {
+    std::erase(GetPage(parent).children[parent % kPageSize], node);
+  }
+
+  for (auto const child : page.children[idx]) {
+    GetPage(child).parents[child % kPageSize].store(kInvalidNode, std::memory_order_relaxed);
+    MarkSubtreeStale(child);
+  }
+
+  // The orphans might have been stale already, in which case only the destroyed node could have reached them
+  std::ranges::copy(page.children[idx], std::back_inserter(*stale_roots_.Lock()));
+
+  page.children[idx].clear();
+  page.alive[idx] = false;
+  free_nodes_.emplace_back(node);
+}
+
+
+auto TransformSystem::GetParent(NodeId const node) const -> NodeId {
+  return GetPage(node).parents[node % kPageSize].load(std::memory_order_relaxed);
+}
+
+
+auto TransformSystem::SetParent(NodeId const node, NodeId const parent) -> void {
+  std::unique_lock const lock{mutex_};
+
+  auto& page{GetPage(node)};
+  auto const idx{node % kPageSize};
+
+  if (auto const old_parent{page.parents[idx].load(std::memory_order_relaxed)}; old_parent != kInvalidNode) {
+    std::erase(GetPage(old_parent).children[old_parent % kPageSize], node);
+  }
+
+  page.parents[idx].store(parent, std::memory_order_relaxed);
+
+  if (parent != kInvalidNode) {
+    GetPage(parent).children[parent % kPageSize].emplace_back(node);
+  }
+
+  // A node that was already stale is only reachable from its new parent's subtree if it becomes a root
+  MarkSubtreeStale(node);
+  stale_roots_.Lock()->emplace_back(node);
+}
+
+
+auto TransformSystem::GetLocalPosition(NodeId const node) const -> Vector3 const& {
+  return GetPage(node).local_positions[node % kPageSize];
+}
+
+
+auto TransformSystem::SetLocalPosition(NodeId const node, Vector3 const& position) -> void {
+  GetPage(node).local_positions[node % kPageSize] = position;
+  MarkStale(node);
+}
+
+
+auto TransformSystem::GetLocalRotation(NodeId const node) const -> Quaternion const& {
+  return GetPage(node).local_rotations[node % kPageSize];
+}
+
+
+auto TransformSystem::SetLocalRotation(NodeId const node, Quaternion const& rotation) -> void {
+  GetPage(node).local_rotations[node % kPageSize] = rotation;
+  MarkStale(node);
+}
+
+
+auto TransformSystem::GetLocalScale(NodeId const node) const -> Vector3 const& {
+  return GetPage(node).local_scales[node % kPageSize];
+}
+
+
+auto TransformSystem::SetLocalScale(NodeId const node, Vector3 const& scale) -> void {
+  GetPage(node).local_scales[node % kPageSize] = scale;
+  MarkStale(node);
+}
+
+
+auto TransformSystem::GetWorldPosition(NodeId const node) -> Vector3 const& {
+  Resolve(node);
+  return GetPage(node).world_positions[node % kPageSize];
+}
+
+
+auto TransformSystem::GetWorldRotation(NodeId const node) -> Quaternion const& {
+  Resolve(node);
+  return GetPage(node).world_rotations[node % kPageSize];
+}
+
+
+auto TransformSystem::GetWorldScale(NodeId const node) -> Vector3 const& {
+  Resolve(node);
+  return GetPage(node).world_scales[node % kPageSize];
+}
+
+
+auto TransformSystem::GetRightAxis(NodeId const node) -> Vector3 const& {
+  Resolve(node);
+  return GetPage(node).rights[node % kPageSize];
+}
+
+
+auto TransformSystem::GetUpAxis(NodeId const node) -> Vector3 const& {
+  Resolve(node);
+  return GetPage(node).ups[node % kPageSize];
+}
+
+
+auto TransformSystem::GetForwardAxis(NodeId const node) -> Vector3 const& {
+  Resolve(node);
+  return GetPage(node).forwards[node % kPageSize];
+}
+
+
+auto TransformSystem::GetLocalToWorldMatrix(NodeId const node) -> Matrix4 const& {
+  Resolve(node);
+  return GetPage(node).local_to_world_mtxs[node % kPageSize];
+}
+
+
+auto TransformSystem::HasChanged(NodeId const node) const noexcept -> bool {
+  return GetPage(node).changed[node % kPageSize].load(std::memory_order_relaxed);
+}
+
+
+auto TransformSystem::SetChanged(NodeId const node, bool const changed) noexcept -> void {
+  GetPage(node).changed[node % kPageSize].store(changed, std::memory_order_relaxed);
+}
+
+
+auto TransformSystem::UpdateWorldData(JobSystem& job_system) -> void {
+  std::vector<std::vector<NodeId>> nodes_by_depth;
+
+  {
+    std::unique_lock const lock{mutex_};
+    nodes_by_depth = CollectStaleNodes();
+  }
+
+  // The jobs executed while waiting for a level might change the hierarchy, so it must not be locked here.
+  // The nodes they write stay stale, because their stale states change during the calculation.
+  // Parents of a level are resolved by the time the level is processed, so its nodes are independent.
+  for (auto const& nodes : nodes_by_depth) {
+    job_system.ParallelFor(0, nodes.size(), [this, &nodes](std::size_t const i) {
+      auto const node{nodes[i]};
+      auto const state{GetPage(node).stale_states[node % kPageSize].load(std::memory_order_acquire)};
+      CalculateWorldData(node);
+      FinishCalculation(node, state);
+    }, kUpdateGrainSize);
+  }
+}
+
+
+auto TransformSystem::GetPage(NodeId const node) const noexcept -> Page& {
+  assert(pages_[GetPageIndex(node)]);
+  return *pages_[GetPageIndex(node)];
+}
+
+
+auto TransformSystem::GetPageIndex(NodeId const node) noexcept -> std::size_t {
+  return node / kPageSize;
+}
+
+
+auto TransformSystem::IsStale(NodeId const node) const noexcept -> bool {
+  return GetPage(node).stale_states[node % kPageSize].load(std::memory_order_acquire) & kStaleBit;
+}
+
+
+auto TransformSystem::MarkStale(NodeId const node) -> void {
+  auto& page{GetPage(node)};
+  auto const idx{node % kPageSize};
+
+  // Counted even if the node is already stale, so that a calculation running right now keeps it stale
+  if (page.stale_states[idx].fetch_add(kMarkIncrement, std::memory_order_release) & kStaleBit) {
+    page.changed[idx].store(true, std::memory_order_relaxed);
+    return;
+  }
+
+  // Reparenting on another thread must not change the children while they are visited
+  std::shared_lock const lock{mutex_};
+
+  if (MarkSubtreeStale(node)) {
+    stale_roots_.Lock()->emplace_back(node);
+  }
+}
+
+
+auto TransformSystem::MarkSubtreeStale(NodeId const node) -> bool {
+  auto& page{GetPage(node)};
+  auto const idx{node % kPageSize};
+
+  page.changed[idx].store(true, std::memory_order_relaxed);
+  page.stale_states[idx].fetch_add(kMarkIncrement, std::memory_order_release);
+
+  if (page.stale_states[idx].fetch_or(kStaleBit, std::memory_order_release) & kStaleBit) {
+    return false;
+  }
+
+  for (auto const child : page.children[idx]) {
+    MarkSubtreeStale(child);
+  }
+
+  return true;
+}
+
+
+auto TransformSystem::Resolve(NodeId const node) -> void {
+  if (!IsStale(node)) {
+    return;
+  }
+
+  // Readers of nodes with a common stale ancestor would otherwise write its world data concurrently
+  std::unique_lock const lock{mutex_};
+
+  std::vector<NodeId> stale_path;
+
+  for (auto path_node{node}; path_node != kInvalidNode; path_node = GetParent(path_node)) {
+    if (!IsStale(path_node)) {
+      break;
+    }
+
+    stale_path.emplace_back(path_node);
+  }
+
+  // The other descendants of the resolved ancestors stay stale, their roots are still recorded for the next sweep
+  for (auto const path_node : stale_path | std::views::reverse) {
+    auto const state{GetPage(path_node).stale_states[path_node % kPageSize].load(std::memory_order_acquire)};
+    CalculateWorldData(path_node);
+    FinishCalculation(path_node, state);
+  }
+}
+
+
+auto TransformSystem::CalculateWorldData(NodeId const node) -> void {
+  auto& page{GetPage(node)};
+  auto const idx{node % kPageSize};
+  auto const parent{page.parents[idx].load(std::memory_order_relaxed)};
+
+  auto const& local_position{page.local_positions[idx]};
+  auto const& local_rotation{page.local_rotations[idx]};
+  auto const& local_scale{page.local_scales[idx]};
+
+  auto& world_position{page.world_positions[idx]};
+  auto& world_rotation{page.world_rotations[idx]};
+  auto& world_scale{page.world_scales[idx]};
+
+  if (parent != kInvalidNode) {
+    auto const& parent_page{GetPage(parent)};
+    auto const parent_idx{parent % kPageSize};
+
+    world_position = parent_page.world_positions[parent_idx] + parent_page.world_rotations[parent_idx].
+                     Rotate(local_position);
+    world_rotation = parent_page.world_rotations[parent_idx] * local_rotation;
+    world_scale = parent_page.world_scales[parent_idx] * local_scale;
+  } else {
+    world_position = local_position;
+    world_rotation = local_rotation;
+    world_scale = local_scale;
+  }
+
+  page.forwards[idx] = world_rotation.Rotate(Vector3::Forward());
+  page.rights[idx] = world_rotation.Rotate(Vector3::Right());
+  page.ups[idx] = world_rotation.Rotate(Vector3::Up());
+
+  // SRT transformation order
+
+  auto& mtx{page.local_to_world_mtxs[idx]};
+  mtx[0] = Vector4{page.rights[idx] * world_scale[0], 0};
+  mtx[1] = Vector4{page.ups[idx] * world_scale[1], 0};
+  mtx[2] = Vector4{page.forwards[idx] * world_scale[2], 0};
+  mtx[3] = Vector4{world_position, 1};
+}
+
+
+auto TransformSystem::FinishCalculation(NodeId const node, std::uint32_t state) -> void {
+  // Nodes below a stale node have to stay stale, the parent's stale root also covers them
+  if (auto const parent{GetParent(node)}; parent != kInvalidNode && IsStale(parent)) {
+    return;
+  }
+
+  if (!GetPage(node).stale_states[node % kPageSize].compare_exchange_strong(state, state & ~kStaleBit,
+    std::memory_order_acq_rel)) {
+    // Marking stops at nodes that are already stale, so the node might not be recorded anywhere else
+    stale_roots_.Lock()->emplace_back(node);
+  }
+}
+
+
+auto TransformSystem::CollectStaleNodes() -> std::vector<std::vector<NodeId>> {
+  std::vector<NodeId> roots{std::move(*stale_roots_.Lock())};
+  std::ranges::sort(roots);
+  roots.erase(std::ranges::unique(roots).begin(), std::end(roots));
+
+  // Roots below other roots are visited from those, so every subtree is only collected once.
+  // Searched in a copy, because erasing moves the remaining roots around while the predicate runs.
+  std::vector<NodeId> const all_roots{roots};
+
+  std::erase_if(roots, [this, &all_roots](NodeId const root) {
+    if (!GetPage(root).alive[root % kPageSize]) {
+      return true;
+    }
+
+    for (auto ancestor{GetParent(root)}; ancestor != kInvalidNode; ancestor = GetParent(ancestor)) {
+      if (std::ranges::binary_search(all_roots, ancestor)) {
+        return true;
+      }
+    }
+
+    return false;
+  });
+
+  std::vector<std::vector<NodeId>> nodes_by_depth;
+
+  // Breadth first so that every level is contiguous. Resolving a node does not resolve its descendants, so the
+  // whole subtrees have to be visited even below nodes that are no longer stale.
+  for (std::size_t depth{0}; !roots.empty(); depth++) {
+    std::vector<NodeId> next_roots;
+    auto& level{nodes_by_depth.emplace_back()};
+
+    for (auto const node : roots) {
+      auto const& page{GetPage(node)};
+      auto const idx{node % kPageSize};
+
+      if (IsStale(node)) {
+        level.emplace_back(node);
+      }
+
+      std::ranges::copy(page.children[idx], std::back_inserter(next_roots));
+    }
+
+    roots = std::move(next_roots);
+  }
+
+  return nodes_by_depth;
+}
+}
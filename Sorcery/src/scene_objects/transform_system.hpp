@@ -0,0 +1,138 @@
+#pragma once
+
+#include "../Core.hpp"
+#include "../job_system.hpp"
+#include "../Math.hpp"
+#include "../mutex.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+
+namespace sorcery {
+// Stores the local and world data of all transforms in structure of arrays pages.
+// Writes only mark the node and its subtree stale and remember the node as a stale root. World data is recalculated
+// when it is read or when UpdateWorldData resolves the subtrees of the stale roots once, parent levels before child
+// levels.
+// Creating, destroying and reparenting nodes is thread safe. Local data of different nodes can be written concurrently,
+// and world data can be read concurrently, but not concurrently with writes or with UpdateWorldData.
+// Nodes written while UpdateWorldData runs, e.g. by jobs executed while it waits, stay stale for the next update.
+class TransformSystem {
+public:
+  using NodeId = std::uint32_t;
+  constexpr static NodeId kInvalidNode{0xFFFFFFFF};
+
+  TransformSystem() = default;
+  TransformSystem(TransformSystem const&) = delete;
+  TransformSystem(TransformSystem&&) = delete;
+
+  ~TransformSystem() = default;
+
+  auto operator=(TransformSystem const&) -> void = delete;
+  auto operator=(TransformSystem&&) -> void = delete;
+
+  [[nodiscard]] LEOPPHAPI auto CreateNode() -> NodeId;
+  LEOPPHAPI auto DestroyNode(NodeId node) -> void;
+
+  [[nodiscard]] LEOPPHAPI auto GetParent(NodeId node) const -> NodeId;
+  LEOPPHAPI auto SetParent(NodeId node, NodeId parent) -> void;
+
+  [[nodiscard]] LEOPPHAPI auto GetLocalPosition(NodeId node) const -> Vector3 const&;
+  LEOPPHAPI auto SetLocalPosition(NodeId node, Vector3 const& position) -> void;
+
+  [[nodiscard]] LEOPPHAPI auto GetLocalRotation(NodeId node) const -> Quaternion const&;
+  LEOPPHAPI auto SetLocalRotation(NodeId node, Quaternion const& rotation) -> void;
+
+  [[nodiscard]] LEOPPHAPI auto GetLocalScale(NodeId node) const -> Vector3 const&;
+  LEOPPHAPI auto SetLocalScale(NodeId node, Vector3 const& scale) -> void;
+
+  [[nodiscard]] LEOPPHAPI auto GetWorldPosition(NodeId node) -> Vector3 const&;
+  [[nodiscard]] LEOPPHAPI auto GetWorldRotation(NodeId node) -> Quaternion const&;
+  [[nodiscard]] LEOPPHAPI auto GetWorldScale(NodeId node) -> Vector3 const&;
+
+  [[nodiscard]] LEOPPHAPI auto GetRightAxis(NodeId node) -> Vector3 const&;
+  [[nodiscard]] LEOPPHAPI auto GetUpAxis(NodeId node) -> Vector3 const&;
+  [[nodiscard]] LEOPPHAPI auto GetForwardAxis(NodeId node) -> Vector3 const&;
+
+  [[nodiscard]] LEOPPHAPI auto GetLocalToWorldMatrix(NodeId node) -> Matrix4 const&;
+
+  [[nodiscard]] LEOPPHAPI auto HasChanged(NodeId node) const noexcept -> bool;
+  LEOPPHAPI auto SetChanged(NodeId node, bool changed) noexcept -> void;
+
+  // Recalculates the world data of all stale nodes.
+  // The hierarchy is only locked while the stale nodes are collected, not while the jobs of the sweep run.
+  LEOPPHAPI auto UpdateWorldData(JobSystem& job_system) -> void;
+
+private:
+  constexpr static std::size_t kPageSize{1024};
+  // Pages are never moved so that references to node data stay valid while other nodes are created
+  constexpr static std::size_t kMaxPageCount{4096};
+  constexpr static std::size_t kUpdateGrainSize{256};
+  constexpr static std::uint32_t kStaleBit{1};
+  constexpr static std::uint32_t kMarkIncrement{2};
+
+
+  struct Page {
+    std::array<Vector3, kPageSize> local_positions;
+    std::array<Quaternion, kPageSize> local_rotations;
+    std::array<Vector3, kPageSize> local_scales;
+
+    std::array<Vector3, kPageSize> world_positions;
+    std::array<Quaternion, kPageSize> world_rotations;
+    std::array<Vector3, kPageSize> world_scales;
+
+    std::array<Vector3, kPageSize> rights;
+    std::array<Vector3, kPageSize> ups;
+    std::array<Vector3, kPageSize> forwards;
+
+    std::array<Matrix4, kPageSize> local_to_world_mtxs;
+
+    // Atomic so that the sweep can read them while jobs executed during it reparent other nodes
+    std::array<std::atomic<NodeId>, kPageSize> parents;
+    std::array<std::vector<NodeId>, kPageSize> children;
+
+    std::array<bool, kPageSize> alive;
+    // The lowest bit is the stale flag, the rest counts how many times the node was marked. Calculations only clear
+    // the flag if the count did not change meanwhile, so a write racing with the calculation keeps the node stale.
+    // Atomic so that local writes to different nodes can mark shared descendants concurrently.
+    std::array<std::atomic<std::uint32_t>, kPageSize> stale_states;
+    std::array<std::atomic<bool>, kPageSize> changed;
+  };
+
+
+  [[nodiscard]] auto GetPage(NodeId node) const noexcept -> Page&;
+  [[nodiscard]] static auto GetPageIndex(NodeId node) noexcept -> std::size_t;
+
+  [[nodiscard]] auto IsStale(NodeId node) const noexcept -> bool;
+  // Locks the hierarchy unless the node is already stale
+  auto MarkStale(NodeId node) -> void;
+  // Expects the hierarchy to be locked. Nodes below a stale node are always stale, so marking stops at the first one
+  // that already is. Returns whether the node itself became stale.
+  auto MarkSubtreeStale(NodeId node) -> bool;
+  // Resolves the stale ancestors of the node first. Locks the hierarchy if there is anything to resolve.
+  auto Resolve(NodeId node) -> void;
+  // Expects the parent to be up to date
+  auto CalculateWorldData(NodeId node) -> void;
+  // Clears the stale flag set in the state loaded before the calculation, unless the node was marked since or its
+  // parent is stale again. Records the node as a stale root if it was marked.
+  auto FinishCalculation(NodeId node, std::uint32_t state) -> void;
+  // Expects the hierarchy to be locked. Groups the stale nodes below the stale roots by their depth below the root.
+  [[nodiscard]] auto CollectStaleNodes() -> std::vector<std::vector<NodeId>>;
+
+  std::array<std::unique_ptr<Page>, kMaxPageCount> pages_;
+  std::vector<NodeId> free_nodes_;
+  NodeId node_count_{0};
+
+  // Nodes that became stale on their own rather than through their parent. Might contain duplicates and dead nodes.
+  Mutex<std::vector<NodeId>> stale_roots_;
+
+  // Guards the hierarchy. Marking nodes stale only reads it, so concurrent local writes share it.
+  std::shared_mutex mutex_;
+};
+}
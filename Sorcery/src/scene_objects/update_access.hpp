@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+namespace sorcery {
+// Shared data that an Update function reads or writes besides the state of its own component.
+// Entity scoped resources only cover the entity that the component is attached to.
+namespace update_resources {
+// World and local transforms of any entity and the hierarchy itself
+constexpr std::uint32_t kTransforms{1 << 0};
+// Local transform of the entity
+constexpr std::uint32_t kEntityTransform{1 << 1};
+// Keyboard and mouse state
+constexpr std::uint32_t kInput{1 << 2};
+// Window and cursor state
+constexpr std::uint32_t kWindow{1 << 3};
+
+constexpr std::uint32_t kNone{0};
+constexpr std::uint32_t kAll{0xFFFFFFFF};
+constexpr std::uint32_t kEntityScoped{kEntityTransform};
+}
+
+
+class Component;
+
+
+struct UpdateAccess {
+  std::uint32_t reads;
+  std::uint32_t writes;
+};
+
+
+// Updatable components of a single type
+struct UpdateGroup {
+  UpdateAccess access;
+  std::vector<Component*> components;
+};
+}
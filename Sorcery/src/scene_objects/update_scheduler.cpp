@@ -0,0 +1,148 @@
+#include "update_scheduler.hpp"
+
+#include "Component.hpp"
+
+#include <algorithm>
+#include <utility>
+
+
+namespace sorcery {
+UpdateScheduler::UpdateScheduler(JobSystem& job_system, TransformSystem& transform_system) :
+  job_system_{&job_system},
+  transform_system_{&transform_system} {}
+
+
+auto UpdateScheduler::Update(std::span<UpdateGroup const> const groups) -> void {
+  if (deterministic_) {
+    for (auto const& group : groups) {
+      for (auto const component : group.components) {
+        component->Update();
+      }
+    }
+
+    return;
+  }
+
+  batches_.clear();
+
+  for (auto const& group : groups) {
+    if (batches_.empty() || std::ranges::any_of(batches_.back().groups, [&group](UpdateGroup const* const other) {
+      return Conflict(group.access, other->access);
+    })) {
+      batches_.emplace_back().access = UpdateAccess{update_resources::kNone, update_resources::kNone};
+    }
+
+    auto& batch{batches_.back()};
+    batch.groups.emplace_back(&group);
+    batch.access.reads |= group.access.reads;
+    batch.access.writes |= group.access.writes;
+  }
+
+  for (auto const& batch : batches_) {
+    // World transform reads resolve stale nodes, which is only safe to do concurrently if there are none
+    if (batch.access.reads & update_resources::kTransforms) {
+      transform_system_->UpdateWorldData(*job_system_);
+    }
+
+    if (batch.groups.size() == 1) {
+      UpdateGroupComponents(*batch.groups.front());
+    } else {
+      auto const batch_job{JobSystem::CreateJob([](void*) {})};
+
+      for (auto const group : batch.groups) {
+        job_system_->Run(JobSystem::CreateChildJob(batch_job, [this, group] {
+          UpdateGroupComponents(*group);
+        }));
+      }
+
+      job_system_->Wait(job_system_->Run(batch_job));
+    }
+
+    if (exception_) {
+      std::rethrow_exception(std::exchange(exception_, nullptr));
+    }
+  }
+}
+
+
+auto UpdateScheduler::IsDeterministic() const noexcept -> bool {
+  return deterministic_;
+}
+
+
+auto UpdateScheduler::SetDeterministic(bool const deterministic) noexcept -> void {
+  deterministic_ = deterministic;
+}
+
+
+auto UpdateScheduler::Conflict(UpdateAccess const& lhs, UpdateAccess const& rhs) noexcept -> bool {
+  // Groups can share entities, and world transforms depend on the local transforms of every entity
+  auto const widen{
+    [](std::uint32_t const resources) {
+      return resources & update_resources::kEntityTransform ? resources | update_resources::kTransforms : resources;
+    }
+  };
+
+  auto const lhs_writes{widen(lhs.writes)};
+  auto const rhs_writes{widen(rhs.writes)};
+  auto const lhs_accesses{widen(lhs.reads) | lhs_writes};
+  auto const rhs_accesses{widen(rhs.reads) | rhs_writes};
+
+  return (lhs_writes & rhs_accesses) != 0 || (rhs_writes & lhs_accesses) != 0;
+}
+
+
+auto UpdateScheduler::CanUpdateInParallel(UpdateGroup const& group) -> bool {
+  auto const& [reads, writes]{group.access};
+
+  if ((writes & ~update_resources::kEntityScoped) != 0) {
+    return false;
+  }
+
+  // The world transform of an instance could depend on the local transform that another instance writes
+  if ((writes & update_resources::kEntityTransform) != 0 && (reads & update_resources::kTransforms) != 0) {
+    return false;
+  }
+
+  if (writes == update_resources::kNone) {
+    return true;
+  }
+
+  // Entity scoped writes are only disjoint if every instance is on a different entity
+  std::vector<Entity*> entities;
+  entities.reserve(group.components.size());
+
+  for (auto const component : group.components) {
+    entities.emplace_back(component->GetEntity().Get());
+  }
+
+  std::ranges::sort(entities);
+  return std::ranges::adjacent_find(entities) == std::end(entities);
+}
+
+
+auto UpdateScheduler::UpdateGroupComponents(UpdateGroup const& group) -> void {
+  if (CanUpdateInParallel(group)) {
+    job_system_->ParallelFor(0, group.components.size(), [this, &group](std::size_t const i) {
+      UpdateComponent(*group.components[i]);
+    });
+  } else {
+    for (auto const component : group.components) {
+      UpdateComponent(*component);
+    }
+  }
+}
+
+
+auto UpdateScheduler::UpdateComponent(Component& component) -> void {
+  try {
+    component.Update();
+  } catch (...) {
+    std::unique_lock const lock{exception_mutex_};
+
+    if (!exception_) {
+      exception_ = std::current_exception();
+    }
+  }
+}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "transform_system.hpp"
+#include "update_access.hpp"
+#include "../Core.hpp"
+#include "../job_system.hpp"
+
+#include <exception>
+#include <mutex>
+#include <span>
+#include <vector>
+
+
+namespace sorcery {
+// Runs the Update functions of component groups on the job system.
+// Consecutive groups whose accesses do not conflict form a batch and run concurrently, batches run one after the other.
+// The instances of a group run in parallel unless they write shared resources or the same entity.
+class UpdateScheduler {
+public:
+  LEOPPHAPI UpdateScheduler(JobSystem& job_system, TransformSystem& transform_system);
+
+  // The groups are expected in update order.
+  // Rethrows the first exception thrown by an Update function after its batch finished.
+  LEOPPHAPI auto Update(std::span<UpdateGroup const> groups) -> void;
+
+  // Deterministic mode updates every component on the calling thread in group order
+  [[nodiscard]] LEOPPHAPI auto IsDeterministic() const noexcept -> bool;
+  LEOPPHAPI auto SetDeterministic(bool deterministic) noexcept -> void;
+
+private:
+  struct Batch {
+    std::vector<UpdateGroup const*> groups;
+    UpdateAccess access;
+  };
+
+
+  [[nodiscard]] static auto Conflict(UpdateAccess const& lhs, UpdateAccess const& rhs) noexcept -> bool;
+  [[nodiscard]] static auto CanUpdateInParallel(UpdateGroup const& group) -> bool;
+
+  auto UpdateGroupComponents(UpdateGroup const& group) -> void;
+  auto UpdateComponent(Component& component) -> void;
+
+  JobSystem* job_system_;
+  TransformSystem* transform_system_;
+  std::vector<Batch> batches_;
+  bool deterministic_{false};
+
+  std::exception_ptr exception_;
+  std::mutex exception_mutex_;
+};
+}
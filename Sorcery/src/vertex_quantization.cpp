@@ -0,0 +1,546 @@
+#include "vertex_quantization.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+
+namespace sorcery {
+namespace {
+constexpr float kSnorm16Max{32767.0f};
+constexpr float kUnorm16Max{65535.0f};
+constexpr float kUnorm8Max{255.0f};
+
+
+// The scalar kernels mirror the order of operations of the SIMD ones so that both produce bit identical results
+
+
+[[nodiscard]] auto EncodeUnitVector(Vector3 const& vec) noexcept -> PackedUnitVector {
+  auto const l1{std::abs(vec[0]) + std::abs(vec[1]) + std::abs(vec[2])};
+  auto x{l1 > 0.0f ? vec[0] / l1 : 0.0f};
+  auto y{l1 > 0.0f ? vec[1] / l1 : 0.0f};
+
+  if (vec[2] < 0.0f) {
+    auto const folded_x{(1.0f - std::abs(y)) * (x < 0.0f ? -1.0f : 1.0f)};
+    auto const folded_y{(1.0f - std::abs(x)) * (y < 0.0f ? -1.0f : 1.0f)};
+    x = folded_x;
+    y = folded_y;
+  }
+
+  return PackedUnitVector{
+    static_cast<std::int16_t>(std::nearbyint(std::min(1.0f, std::max(-1.0f, x)) * kSnorm16Max)),
+    static_cast<std::int16_t>(std::nearbyint(std::min(1.0f, std::max(-1.0f, y)) * kSnorm16Max))
+  };
+}
+
+
+[[nodiscard]] auto DecodeUnitVector(PackedUnitVector const& packed) noexcept -> Vector3 {
+  auto x{std::max(-1.0f, static_cast<float>(packed[0]) / kSnorm16Max)};
+  auto y{std::max(-1.0f, static_cast<float>(packed[1]) / kSnorm16Max)};
+  auto const z{1.0f - std::abs(x) - std::abs(y)};
+  auto const t{std::max(0.0f, -z)};
+  x = x + (x >= 0.0f ? -t : t);
+  y = y + (y >= 0.0f ? -t : t);
+  auto const length{std::sqrt(x * x + y * y + z * z)};
+  return Vector3{x / length, y / length, z / length};
+}
+
+
+// Round to nearest even, same as F16C
+[[nodiscard]] auto FloatToHalf(float const value) noexcept -> std::uint16_t {
+  auto const bits{std::bit_cast<std::uint32_t>(value)};
+  auto const sign{static_cast<std::uint16_t>((bits >> 16) & 0x8000u)};
+  auto const abs_bits{bits & 0x7FFFFFFFu};
+
+  // Inf and NaN, NaNs are quieted
+  if (abs_bits >= 0x7F800000u) {
+    return static_cast<std::uint16_t>(sign | 0x7C00u |
+                                      (abs_bits > 0x7F800000u ? 0x0200u | ((abs_bits >> 13) & 0x03FFu) : 0u));
+  }
+
+  // Rounds to a value that is too large for a half
+  if (abs_bits >= 0x477FF000u) {
+    return static_cast<std::uint16_t>(sign | 0x7C00u);
+  }
+
+  // Denormal halves, the float addition does the rounding
+  if (abs_bits < 0x38800000u) {
+    constexpr auto denorm_magic{std::bit_cast<float>(126u << 23)};
+    return static_cast<std::uint16_t>(sign | (std::bit_cast<std::uint32_t>(std::bit_cast<float>(abs_bits) +
+                                                                           denorm_magic) -
+                                              std::bit_cast<std::uint32_t>(denorm_magic)));
+  }
+
+  auto const mantissa_odd{(abs_bits >> 13) & 1u};
+  return static_cast<std::uint16_t>(sign | (abs_bits + (static_cast<std::uint32_t>(15 - 127) << 23) + 0x0FFFu +
+                                            mantissa_odd) >> 13);
+}
+
+
+[[nodiscard]] auto HalfToFloat(std::uint16_t const half) noexcept -> float {
+  constexpr std::uint32_t shifted_exp{0x7C00u << 13};
+  auto bits{static_cast<std::uint32_t>(half & 0x7FFFu) << 13};
+  auto const exp{bits & shifted_exp};
+  bits += static_cast<std::uint32_t>(127 - 15) << 23;
+
+  if (exp == shifted_exp) {
+    // Inf and NaN, NaNs are quieted like F16C does
+    bits += static_cast<std::uint32_t>(128 - 16) << 23;
+
+    if ((bits & 0x007FFFFFu) != 0) {
+      bits |= 0x00400000u;
+    }
+  } else if (exp == 0) {
+    // Denormals
+    bits += 1u << 23;
+    bits = std::bit_cast<std::uint32_t>(std::bit_cast<float>(bits) - std::bit_cast<float>(113u << 23));
+  }
+
+  return std::bit_cast<float>(bits | static_cast<std::uint32_t>(half & 0x8000u) << 16);
+}
+
+
+struct PositionQuantizationParams {
+  Vector3 min;
+  Vector3 scale;
+  Vector3 inv_scale;
+};
+
+
+[[nodiscard]] auto CalculatePositionQuantizationParams(AABB const& bounds) noexcept -> PositionQuantizationParams {
+  PositionQuantizationParams params{.min = bounds.min, .scale = Vector3{}, .inv_scale = Vector3{}};
+
+  for (std::size_t i{0}; i < 3; i++) {
+    if (auto const extent{bounds.max[i] - bounds.min[i]}; extent > 0.0f) {
+      params.scale[i] = extent / kUnorm16Max;
+      params.inv_scale[i] = kUnorm16Max / extent;
+    }
+  }
+
+  return params;
+}
+
+
+auto RedistributeWeightError(Vector4 const& weights, PackedBoneWeights& packed) noexcept -> void {
+  auto const sum{
+    static_cast<int>(packed[0]) + static_cast<int>(packed[1]) + static_cast<int>(packed[2]) +
+    static_cast<int>(packed[3])
+  };
+
+  if (sum == 0) {
+    return;
+  }
+
+  std::size_t largest_idx{0};
+
+  for (std::size_t i{1}; i < 4; i++) {
+    if (weights[i] > weights[largest_idx]) {
+      largest_idx = i;
+    }
+  }
+
+  packed[largest_idx] = static_cast<std::uint8_t>(std::clamp(static_cast<int>(packed[largest_idx]) + 255 - sum, 0,
+    255));
+}
+
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+// Deinterleaves four consecutive Vector3s
+auto LoadVector3x4(float const* const src, __m128& x, __m128& y, __m128& z) noexcept -> void {
+  auto const a{_mm_loadu_ps(src)}; // x0 y0 z0 x1
+  auto const b{_mm_loadu_ps(src + 4)}; // y1 z1 x2 y2
+  auto const c{_mm_loadu_ps(src + 8)}; // z2 x3 y3 z3
+  x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+  y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(3, 2, 0, 3)),
+    _MM_SHUFFLE(2, 0, 2, 0));
+  z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+
+// Interleaves into four consecutive Vector3s
+auto StoreVector3x4(float* const dst, __m128 const x, __m128 const y, __m128 const z) noexcept -> void {
+  auto const a{
+    _mm_shuffle_ps(_mm_unpacklo_ps(x, y), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0))
+  };
+  auto const b{
+    _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+      _MM_SHUFFLE(2, 0, 2, 0))
+  };
+  auto const c{
+    _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+      _MM_SHUFFLE(2, 0, 2, 0))
+  };
+  _mm_storeu_ps(dst, a);
+  _mm_storeu_ps(dst + 4, b);
+  _mm_storeu_ps(dst + 8, c);
+}
+
+
+[[nodiscard]] auto Abs(__m128 const value) noexcept -> __m128 {
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+}
+
+
+// Packs four vectors into x0 y0 x1 y1 x2 y2 x3 y3 octahedral snorm16 pairs
+[[nodiscard]] auto EncodeOctahedral(__m128 x, __m128 y, __m128 const z) noexcept -> __m128i {
+  auto const zero{_mm_setzero_ps()};
+  auto const one{_mm_set1_ps(1.0f)};
+  auto const minus_one{_mm_set1_ps(-1.0f)};
+
+  auto const l1{_mm_add_ps(_mm_add_ps(Abs(x), Abs(y)), Abs(z))};
+  auto const non_zero{_mm_cmpgt_ps(l1, zero)};
+  x = _mm_and_ps(_mm_div_ps(x, l1), non_zero);
+  y = _mm_and_ps(_mm_div_ps(y, l1), non_zero);
+
+  auto const folded_x{_mm_mul_ps(_mm_sub_ps(one, Abs(y)), _mm_blendv_ps(one, minus_one, _mm_cmplt_ps(x, zero)))};
+  auto const folded_y{_mm_mul_ps(_mm_sub_ps(one, Abs(x)), _mm_blendv_ps(one, minus_one, _mm_cmplt_ps(y, zero)))};
+  auto const fold{_mm_cmplt_ps(z, zero)};
+  x = _mm_blendv_ps(x, folded_x, fold);
+  y = _mm_blendv_ps(y, folded_y, fold);
+
+  auto const quantize{
+    [one, minus_one](__m128 const value) {
+      return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(one, _mm_max_ps(minus_one, value)), _mm_set1_ps(kSnorm16Max)));
+    }
+  };
+
+  // x0 x1 x2 x3 y0 y1 y2 y3 to x0 y0 x1 y1 x2 y2 x3 y3
+  auto const packed{_mm_packs_epi32(quantize(x), quantize(y))};
+  return _mm_unpacklo_epi16(packed, _mm_srli_si128(packed, 8));
+}
+
+
+// Unpacks four octahedral snorm16 pairs into normalized vectors
+auto DecodeOctahedral(__m128i const xy, __m128& x, __m128& y, __m128& z) noexcept -> void {
+  auto const zero{_mm_setzero_ps()};
+  auto const one{_mm_set1_ps(1.0f)};
+  auto const minus_one{_mm_set1_ps(-1.0f)};
+  auto const snorm_max{_mm_set1_ps(kSnorm16Max)};
+
+  auto const xy01{_mm_cvtepi32_ps(_mm_cvtepi16_epi32(xy))};
+  auto const xy23{_mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(xy, 8)))};
+
+  x = _mm_max_ps(_mm_div_ps(_mm_shuffle_ps(xy01, xy23, _MM_SHUFFLE(2, 0, 2, 0)), snorm_max), minus_one);
+  y = _mm_max_ps(_mm_div_ps(_mm_shuffle_ps(xy01, xy23, _MM_SHUFFLE(3, 1, 3, 1)), snorm_max), minus_one);
+  z = _mm_sub_ps(_mm_sub_ps(one, Abs(x)), Abs(y));
+  auto const t{_mm_max_ps(_mm_sub_ps(zero, z), zero)};
+  auto const minus_t{_mm_sub_ps(zero, t)};
+  x = _mm_add_ps(x, _mm_blendv_ps(t, minus_t, _mm_cmpge_ps(x, zero)));
+  y = _mm_add_ps(y, _mm_blendv_ps(t, minus_t, _mm_cmpge_ps(y, zero)));
+
+  auto const length{_mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)))};
+  x = _mm_div_ps(x, length);
+  y = _mm_div_ps(y, length);
+  z = _mm_div_ps(z, length);
+}
+
+
+// Bit of the packed y component that holds the handedness of tangents, for each interleaved pair
+[[nodiscard]] auto GetHandednessMask() noexcept -> __m128i {
+  return _mm_set1_epi32(0x00010000);
+}
+
+
+// The x y z x, y z x y, z x y z patterns that line up with three registers of interleaved Vector3s
+[[nodiscard]] auto SplatVector3x4(Vector3 const& vec) noexcept -> std::array<__m128, 3> {
+  return {
+    _mm_setr_ps(vec[0], vec[1], vec[2], vec[0]), _mm_setr_ps(vec[1], vec[2], vec[0], vec[1]),
+    _mm_setr_ps(vec[2], vec[0], vec[1], vec[2])
+  };
+}
+#endif
+}
+
+
+auto EncodeUnitVectors(std::span<Vector3 const> const vectors, std::span<PackedUnitVector> const out) noexcept -> void {
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  for (; i + 4 <= vectors.size(); i += 4) {
+    __m128 x, y, z;
+    LoadVector3x4(reinterpret_cast<float const*>(vectors.data() + i), x, y, z);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i), EncodeOctahedral(x, y, z));
+  }
+#endif
+
+  for (; i < vectors.size(); i++) {
+    out[i] = EncodeUnitVector(vectors[i]);
+  }
+}
+
+
+auto DecodeUnitVectors(std::span<PackedUnitVector const> const packed, std::span<Vector3> const out) noexcept -> void {
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  for (; i + 4 <= packed.size(); i += 4) {
+    __m128 x, y, z;
+    DecodeOctahedral(_mm_loadu_si128(reinterpret_cast<__m128i const*>(packed.data() + i)), x, y, z);
+    StoreVector3x4(reinterpret_cast<float*>(out.data() + i), x, y, z);
+  }
+#endif
+
+  for (; i < packed.size(); i++) {
+    out[i] = DecodeUnitVector(packed[i]);
+  }
+}
+
+
+auto EncodeTangents(std::span<Vector4 const> const tangents, std::span<PackedUnitVector> const out) noexcept -> void {
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  for (; i + 4 <= tangents.size(); i += 4) {
+    auto x{_mm_loadu_ps(tangents[i].GetData())};
+    auto y{_mm_loadu_ps(tangents[i + 1].GetData())};
+    auto z{_mm_loadu_ps(tangents[i + 2].GetData())};
+    auto w{_mm_loadu_ps(tangents[i + 3].GetData())};
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+
+    auto const handedness{_mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(w, _mm_setzero_ps())), GetHandednessMask())};
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i),
+      _mm_or_si128(_mm_andnot_si128(GetHandednessMask(), EncodeOctahedral(x, y, z)), handedness));
+  }
+#endif
+
+  for (; i < tangents.size(); i++) {
+    out[i] = EncodeUnitVector(Vector3{tangents[i]});
+    out[i][1] = static_cast<std::int16_t>((out[i][1] & ~1) | (tangents[i][3] < 0.0f ? 1 : 0));
+  }
+}
+
+
+auto DecodeTangents(std::span<PackedUnitVector const> const packed, std::span<Vector4> const out) noexcept -> void {
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  auto const one{_mm_set1_ps(1.0f)};
+  auto const minus_one{_mm_set1_ps(-1.0f)};
+
+  for (; i + 4 <= packed.size(); i += 4) {
+    auto const xy{_mm_loadu_si128(reinterpret_cast<__m128i const*>(packed.data() + i))};
+    __m128 x, y, z;
+    DecodeOctahedral(_mm_andnot_si128(GetHandednessMask(), xy), x, y, z);
+    auto w{
+      _mm_blendv_ps(one, minus_one,
+        _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(xy, GetHandednessMask()), GetHandednessMask())))
+    };
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+
+    _mm_storeu_ps(out[i].GetData(), x);
+    _mm_storeu_ps(out[i + 1].GetData(), y);
+    _mm_storeu_ps(out[i + 2].GetData(), z);
+    _mm_storeu_ps(out[i + 3].GetData(), w);
+  }
+#endif
+
+  for (; i < packed.size(); i++) {
+    auto const dir{DecodeUnitVector(PackedUnitVector{packed[i][0], static_cast<std::int16_t>(packed[i][1] & ~1)})};
+    out[i] = Vector4{dir[0], dir[1], dir[2], (packed[i][1] & 1) != 0 ? -1.0f : 1.0f};
+  }
+}
+
+
+auto EncodeUvs(std::span<Vector2 const> const uvs, std::span<PackedUv> const out) noexcept -> void {
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  for (; i + 4 <= uvs.size(); i += 4) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i),
+      _mm256_cvtps_ph(_mm256_loadu_ps(reinterpret_cast<float const*>(uvs.data() + i)), _MM_FROUND_TO_NEAREST_INT));
+  }
+#endif
+
+  for (; i < uvs.size(); i++) {
+    out[i] = PackedUv{FloatToHalf(uvs[i][0]), FloatToHalf(uvs[i][1])};
+  }
+}
+
+
+auto DecodeUvs(std::span<PackedUv const> const packed, std::span<Vector2> const out) noexcept -> void {
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  for (; i + 4 <= packed.size(); i += 4) {
+    _mm256_storeu_ps(reinterpret_cast<float*>(out.data() + i),
+      _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(packed.data() + i))));
+  }
+#endif
+
+  for (; i < packed.size(); i++) {
+    out[i] = Vector2{HalfToFloat(packed[i][0]), HalfToFloat(packed[i][1])};
+  }
+}
+
+
+auto EncodePositions(std::span<Vector3 const> const positions, AABB const& bounds,
+                     std::span<PackedPosition> const out) noexcept -> void {
+  auto const params{CalculatePositionQuantizationParams(bounds)};
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  auto const min{SplatVector3x4(params.min)};
+  auto const inv_scale{SplatVector3x4(params.inv_scale)};
+  auto const zero{_mm_setzero_ps()};
+  auto const unorm_max{_mm_set1_ps(kUnorm16Max)};
+
+  for (; i + 4 <= positions.size(); i += 4) {
+    auto const src{reinterpret_cast<float const*>(positions.data() + i)};
+    std::array<__m128i, 3> quantized;
+
+    for (std::size_t j{0}; j < 3; j++) {
+      quantized[j] = _mm_cvtps_epi32(_mm_min_ps(unorm_max,
+        _mm_max_ps(zero, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + j * 4), min[j]), inv_scale[j]))));
+    }
+
+    auto const dst{reinterpret_cast<__m128i*>(out.data() + i)};
+    _mm_storeu_si128(dst, _mm_packus_epi32(quantized[0], quantized[1]));
+    _mm_storel_epi64(dst + 1, _mm_packus_epi32(quantized[2], quantized[2]));
+  }
+#endif
+
+  for (; i < positions.size(); i++) {
+    for (std::size_t j{0}; j < 3; j++) {
+      out[i][j] = static_cast<std::uint16_t>(std::nearbyint(std::min(kUnorm16Max,
+        std::max(0.0f, (positions[i][j] - params.min[j]) * params.inv_scale[j]))));
+    }
+  }
+}
+
+
+auto DecodePositions(std::span<PackedPosition const> const packed, AABB const& bounds,
+                     std::span<Vector3> const out) noexcept -> void {
+  auto const params{CalculatePositionQuantizationParams(bounds)};
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  auto const min{SplatVector3x4(params.min)};
+  auto const scale{SplatVector3x4(params.scale)};
+
+  for (; i + 4 <= packed.size(); i += 4) {
+    auto const src{reinterpret_cast<__m128i const*>(packed.data() + i)};
+    auto const first{_mm_loadu_si128(src)};
+    std::array const quantized{
+      _mm_cvtepu16_epi32(first), _mm_cvtepu16_epi32(_mm_srli_si128(first, 8)),
+      _mm_cvtepu16_epi32(_mm_loadl_epi64(src + 1))
+    };
+
+    auto const dst{reinterpret_cast<float*>(out.data() + i)};
+
+    for (std::size_t j{0}; j < 3; j++) {
+      _mm_storeu_ps(dst + j * 4, _mm_add_ps(min[j], _mm_mul_ps(_mm_cvtepi32_ps(quantized[j]), scale[j])));
+    }
+  }
+#endif
+
+  for (; i < packed.size(); i++) {
+    for (std::size_t j{0}; j < 3; j++) {
+      out[i][j] = params.min[j] + static_cast<float>(packed[i][j]) * params.scale[j];
+    }
+  }
+}
+
+
+auto EncodeBoneWeights(std::span<Vector4 const> const weights, std::span<PackedBoneWeights> const out) noexcept -> void {
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  auto const zero{_mm_setzero_ps()};
+  auto const one{_mm_set1_ps(1.0f)};
+  auto const unorm_max{_mm_set1_ps(kUnorm8Max)};
+
+  for (; i + 4 <= weights.size(); i += 4) {
+    std::array<__m128i, 4> quantized;
+
+    for (std::size_t j{0}; j < 4; j++) {
+      quantized[j] = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(one,
+        _mm_max_ps(zero, _mm_loadu_ps(weights[i + j].GetData()))), unorm_max));
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i),
+      _mm_packus_epi16(_mm_packus_epi32(quantized[0], quantized[1]), _mm_packus_epi32(quantized[2], quantized[3])));
+
+    for (std::size_t j{0}; j < 4; j++) {
+      RedistributeWeightError(weights[i + j], out[i + j]);
+    }
+  }
+#endif
+
+  for (; i < weights.size(); i++) {
+    for (std::size_t j{0}; j < 4; j++) {
+      out[i][j] = static_cast<std::uint8_t>(std::nearbyint(std::min(1.0f, std::max(0.0f, weights[i][j])) *
+                                                           kUnorm8Max));
+    }
+
+    RedistributeWeightError(weights[i], out[i]);
+  }
+}
+
+
+auto DecodeBoneWeights(std::span<PackedBoneWeights const> const packed, std::span<Vector4> const out) noexcept -> void {
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  auto const unorm_max{_mm_set1_ps(kUnorm8Max)};
+
+  for (; i + 4 <= packed.size(); i += 4) {
+    auto quantized{_mm_loadu_si128(reinterpret_cast<__m128i const*>(packed.data() + i))};
+
+    for (std::size_t j{0}; j < 4; j++) {
+      _mm_storeu_ps(out[i + j].GetData(), _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(quantized)), unorm_max));
+      quantized = _mm_srli_si128(quantized, 4);
+    }
+  }
+#endif
+
+  for (; i < packed.size(); i++) {
+    for (std::size_t j{0}; j < 4; j++) {
+      out[i][j] = static_cast<float>(packed[i][j]) / kUnorm8Max;
+    }
+  }
+}
+
+
+auto EncodeBoneIndices(std::span<Vector<std::uint32_t, 4> const> const indices,
+                       std::span<PackedBoneIndices> const out) noexcept -> bool {
+  if (!std::ranges::all_of(indices, [](Vector<std::uint32_t, 4> const& vertex_indices) {
+    return std::ranges::all_of(vertex_indices.GetData(), vertex_indices.GetData() + 4, [](std::uint32_t const idx) {
+      return idx <= 0xFF;
+    });
+  })) {
+    return false;
+  }
+
+  for (std::size_t i{0}; i < indices.size(); i++) {
+    for (std::size_t j{0}; j < 4; j++) {
+      out[i][j] = static_cast<std::uint8_t>(indices[i][j]);
+    }
+  }
+
+  return true;
+}
+
+
+auto DecodeBoneIndices(std::span<PackedBoneIndices const> const packed,
+                       std::span<Vector<std::uint32_t, 4>> const out) noexcept -> void {
+  std::size_t i{0};
+
+#ifdef LEOPPH_MATH_USE_INTRINSICS
+  for (; i + 4 <= packed.size(); i += 4) {
+    auto quantized{_mm_loadu_si128(reinterpret_cast<__m128i const*>(packed.data() + i))};
+
+    for (std::size_t j{0}; j < 4; j++) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out[i + j].GetData()), _mm_cvtepu8_epi32(quantized));
+      quantized = _mm_srli_si128(quantized, 4);
+    }
+  }
+#endif
+
+  for (; i < packed.size(); i++) {
+    for (std::size_t j{0}; j < 4; j++) {
+      out[i][j] = packed[i][j];
+    }
+  }
+}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "Bounds.hpp"
+#include "Core.hpp"
+#include "Math.hpp"
+
+
+namespace sorcery {
+// Unit vector mapped onto an octahedron, two snorm16 components.
+// Packed tangents store their handedness in the lowest bit of the second component, set meaning negative.
+using PackedUnitVector = Vector<std::int16_t, 2>;
+// Two IEEE 754 half precision floats
+using PackedUv = Vector<std::uint16_t, 2>;
+// unorm16 coordinates relative to the bounding box of the mesh
+using PackedPosition = Vector<std::uint16_t, 3>;
+// unorm8 weights that sum to 255
+using PackedBoneWeights = Vector<std::uint8_t, 4>;
+using PackedBoneIndices = Vector<std::uint8_t, 4>;
+
+
+// Worst case errors of a round trip through the packed formats, the direction and position bounds are measured
+
+// Radians between the original and the decoded unit vector
+constexpr float kPackedUnitVectorMaxError{0.00007f};
+// Radians, the handedness bit costs the tangent direction some precision
+constexpr float kPackedTangentMaxError{0.00015f};
+// Relative to the magnitude of the coordinate, below 2^-14 the error is an absolute 2^-25 instead
+constexpr float kPackedUvMaxRelativeError{1.0f / 2048.0f};
+// Per axis, relative to the extent of the bounding box along that axis, half a step plus float rounding
+constexpr float kPackedPositionMaxError{0.52f / 65535.0f};
+// Absolute, per weight, for weights summing to one
+constexpr float kPackedBoneWeightMaxError{2.5f / 255.0f};
+
+
+// The output spans must be at least as long as the input spans.
+// All kernels process four elements at a time when intrinsics are enabled and produce the same results as the scalar path.
+
+LEOPPHAPI auto EncodeUnitVectors(std::span<Vector3 const> vectors, std::span<PackedUnitVector> out) noexcept -> void;
+LEOPPHAPI auto DecodeUnitVectors(std::span<PackedUnitVector const> packed, std::span<Vector3> out) noexcept -> void;
+
+// The handedness is the sign of w, decoded tangents have a w of 1 or -1
+LEOPPHAPI auto EncodeTangents(std::span<Vector4 const> tangents, std::span<PackedUnitVector> out) noexcept -> void;
+LEOPPHAPI auto DecodeTangents(std::span<PackedUnitVector const> packed, std::span<Vector4> out) noexcept -> void;
+
+LEOPPHAPI auto EncodeUvs(std::span<Vector2 const> uvs, std::span<PackedUv> out) noexcept -> void;
+LEOPPHAPI auto DecodeUvs(std::span<PackedUv const> packed, std::span<Vector2> out) noexcept -> void;
+
+// Positions outside the bounds are clamped
+LEOPPHAPI auto EncodePositions(std::span<Vector3 const> positions, AABB const& bounds,
+                               std::span<PackedPosition> out) noexcept -> void;
+LEOPPHAPI auto DecodePositions(std::span<PackedPosition const> packed, AABB const& bounds,
+                               std::span<Vector3> out) noexcept -> void;
+
+// The rounding error is moved to the largest weight so that the packed weights still sum to 255
+LEOPPHAPI auto EncodeBoneWeights(std::span<Vector4 const> weights, std::span<PackedBoneWeights> out) noexcept -> void;
+LEOPPHAPI auto DecodeBoneWeights(std::span<PackedBoneWeights const> packed, std::span<Vector4> out) noexcept -> void;
+
+// Fails without touching the output if any of the indices does not fit into 8 bits
+[[nodiscard]] LEOPPHAPI auto EncodeBoneIndices(std::span<Vector<std::uint32_t, 4> const> indices,
+                                               std::span<PackedBoneIndices> out) noexcept -> bool;
+LEOPPHAPI auto DecodeBoneIndices(std::span<PackedBoneIndices const> packed,
+                                 std::span<Vector<std::uint32_t, 4>> out) noexcept -> void;
+}
@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+
+#include "scene_objects/Component.hpp"
+#include "scene_objects/component_registry.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+template<int Tag>
+class TestComponent final : public Component {
+public:
+  [[nodiscard]] auto Clone() -> std::unique_ptr<SceneObject> override {
+    return std::make_unique<TestComponent>(*this);
+  }
+
+
+  std::uint64_t value{0};
+};
+
+
+using ComponentA = TestComponent<0>;
+using ComponentB = TestComponent<1>;
+using ComponentC = TestComponent<2>;
+
+
+struct TestEntity {
+  ComponentRegistry::EntityId id;
+  std::vector<std::unique_ptr<Component>> components;
+};
+
+
+// Every entity gets an A, half of them a B, a quarter of them a C, in a random order
+auto MakeEntities(ComponentRegistry& registry, std::size_t const count, std::mt19937& rng) -> std::vector<TestEntity> {
+  std::vector<TestEntity> entities;
+  entities.reserve(count);
+
+  for (std::size_t i{0}; i < count; i++) {
+    auto& entity{entities.emplace_back(registry.CreateEntityId())};
+    entity.components.emplace_back(std::make_unique<ComponentA>());
+
+    if (i % 2 == 0) {
+      entity.components.emplace_back(std::make_unique<ComponentB>());
+    }
+
+    if (i % 4 == 0) {
+      entity.components.emplace_back(std::make_unique<ComponentC>());
+    }
+
+    std::ranges::shuffle(entity.components, rng);
+
+    for (auto const& component : entity.components) {
+      registry.Register(entity.id, *component);
+    }
+  }
+
+  return entities;
+}
+
+
+// The lookup the registry replaced, a cast over the components of the entity
+template<typename T>
+auto ScanForComponent(TestEntity const& entity) -> T* {
+  for (auto const& component : entity.components) {
+    if (auto const casted{rttr::rttr_cast<T*>(component.get())}) {
+      return casted;
+    }
+  }
+
+  return nullptr;
+}
+}
+
+
+TEST(ComponentRegistryTest, ComponentsAreFoundByType) {
+  ComponentRegistry registry;
+  std::mt19937 rng{42};
+  auto const entities{MakeEntities(registry, 100, rng)};
+
+  for (auto const& entity : entities) {
+    EXPECT_EQ(registry.FindComponent<ComponentA>(entity.id), ScanForComponent<ComponentA>(entity));
+    EXPECT_EQ(registry.FindComponent<ComponentB>(entity.id), ScanForComponent<ComponentB>(entity));
+    EXPECT_EQ(registry.FindComponent<ComponentC>(entity.id), ScanForComponent<ComponentC>(entity));
+  }
+
+  std::vector<ComponentA*> as;
+  std::vector<ComponentB*> bs;
+  std::vector<ComponentC*> cs;
+  EXPECT_EQ(registry.GetComponentsOfType(as).size(), 100);
+  EXPECT_EQ(registry.GetComponentsOfType(bs).size(), 50);
+  EXPECT_EQ(registry.GetComponentsOfType(cs).size(), 25);
+}
+
+
+TEST(ComponentRegistryTest, UnregisteredComponentsAreNotFound) {
+  ComponentRegistry registry;
+  auto const entity{registry.CreateEntityId()};
+  ComponentA first;
+  ComponentA second;
+
+  registry.Register(entity, first);
+  registry.Register(entity, second);
+  EXPECT_EQ(registry.FindComponent<ComponentA>(entity), &first);
+
+  std::vector<ComponentA*> found;
+  EXPECT_EQ(registry.FindComponents(entity, found).size(), 2);
+
+  registry.Unregister(entity, first);
+  EXPECT_EQ(registry.FindComponent<ComponentA>(entity), &second);
+
+  registry.Unregister(entity, second);
+  EXPECT_EQ(registry.FindComponent<ComponentA>(entity), nullptr);
+  EXPECT_TRUE(registry.GetComponentsOfType(found).empty());
+}
+
+
+TEST(ComponentRegistryTest, ReleasedEntityIdsAreReused) {
+  ComponentRegistry registry;
+  auto const entity{registry.CreateEntityId()};
+  registry.ReleaseEntityId(entity);
+  EXPECT_EQ(registry.CreateEntityId(), entity);
+  EXPECT_NE(registry.CreateEntityId(), entity);
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(ComponentRegistryTest, DISABLED_MixedComponentsOfLargeEntityCounts) {
+  constexpr std::size_t kEntityCount{100'000};
+  constexpr int kRepeatCount{20};
+
+  ComponentRegistry registry;
+  std::mt19937 rng{42};
+
+  auto const register_begin{std::chrono::steady_clock::now()};
+  auto entities{MakeEntities(registry, kEntityCount, rng)};
+  auto const register_time{std::chrono::steady_clock::now() - register_begin};
+
+  auto const measure{
+    [](auto&& func) {
+      auto const begin{std::chrono::steady_clock::now()};
+
+      for (auto i{0}; i < kRepeatCount; i++) {
+        func();
+      }
+
+      return std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - begin}.count() / kRepeatCount;
+    }
+  };
+
+  std::vector<ComponentB*> bs;
+  auto const pool_iteration_time{
+    measure([&] {
+      for (auto const b : registry.GetComponentsOfType(bs)) {
+        b->value++;
+      }
+    })
+  };
+
+  auto const scan_iteration_time{
+    measure([&] {
+      for (auto const& entity : entities) {
+        if (auto const b{ScanForComponent<ComponentB>(entity)}) {
+          b->value++;
+        }
+      }
+    })
+  };
+
+  std::uint64_t checksum{0};
+  auto const pool_lookup_time{
+    measure([&] {
+      for (auto const& entity : entities) {
+        if (auto const c{registry.FindComponent<ComponentC>(entity.id)}) {
+          checksum += c->value++;
+        }
+      }
+    })
+  };
+
+  auto const scan_lookup_time{
+    measure([&] {
+      for (auto const& entity : entities) {
+        if (auto const c{ScanForComponent<ComponentC>(entity)}) {
+          checksum += c->value++;
+        }
+      }
+    })
+  };
+
+  // Detach and reattach the components of a random tenth of the entities
+  std::vector<std::size_t> edited(kEntityCount);
+  std::iota(std::begin(edited), std::end(edited), std::size_t{0});
+  std::ranges::shuffle(edited, rng);
+  edited.resize(kEntityCount / 10);
+
+  auto const remove_add_time{
+    measure([&] {
+      for (auto const idx : edited) {
+        for (auto const& component : entities[idx].components) {
+          registry.Unregister(entities[idx].id, *component);
+        }
+      }
+
+      for (auto const idx : edited) {
+        for (auto const& component : entities[idx].components) {
+          registry.Register(entities[idx].id, *component);
+        }
+      }
+    })
+  };
+
+  EXPECT_EQ(registry.GetComponentsOfType(bs).size(), kEntityCount / 2);
+
+  std::cout << std::format("{} entities, {} components\n", kEntityCount, kEntityCount * 7 / 4);
+  std::cout << std::format("register all: {} ms\n",
+    std::chrono::duration<double, std::milli>{register_time}.count());
+  std::cout << std::format("iterate B: pools {} ms, entity scan {} ms\n", pool_iteration_time, scan_iteration_time);
+  std::cout << std::format("look up C on every entity: pools {} ms, entity scan {} ms\n", pool_lookup_time,
+    scan_lookup_time);
+  std::cout << std::format("remove and add the components of {} entities: {} ms\n", edited.size(), remove_add_time);
+  std::cout << std::format("checksum {}\n", checksum);
+}
+}
@@ -0,0 +1,503 @@
+#include <gtest/gtest.h>
+
+#include "job_profiler.hpp"
+#include "job_system.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+struct JsonValue {
+  using Array = std::vector<JsonValue>;
+  using Object = std::vector<std::pair<std::string, JsonValue>>;
+
+  [[nodiscard]] auto Find(std::string_view const key) const -> JsonValue const* {
+    if (auto const obj{std::get_if<Object>(&value)}) {
+      for (auto const& [name, member] : *obj) {
+        if (name == key) {
+          return &member;
+        }
+      }
+    }
+
+    return nullptr;
+  }
+
+
+  [[nodiscard]] auto FindString(std::string_view const key) const -> std::optional<std::string> {
+    if (auto const member{Find(key)}; member && std::holds_alternative<std::string>(member->value)) {
+      return std::get<std::string>(member->value);
+    }
+
+    return std::nullopt;
+  }
+
+
+  [[nodiscard]] auto FindNumber(std::string_view const key) const -> std::optional<double> {
+    if (auto const member{Find(key)}; member && std::holds_alternative<double>(member->value)) {
+      return std::get<double>(member->value);
+    }
+
+    return std::nullopt;
+  }
+
+
+  std::variant<std::nullptr_t, bool, double, std::string, Array, Object> value;
+};
+
+
+// Strict enough to reject what chrome://tracing and Perfetto would reject, returns nullopt on malformed input
+class JsonReader {
+public:
+  [[nodiscard]] static auto Parse(std::string_view const text) -> std::optional<JsonValue> {
+    JsonReader reader{text};
+    auto value{reader.ParseValue()};
+    reader.SkipWhitespace();
+
+    if (!value || reader.pos_ != text.size()) {
+      return std::nullopt;
+    }
+
+    return value;
+  }
+
+private:
+  explicit JsonReader(std::string_view const text) :
+    text_{text} {}
+
+
+  auto SkipWhitespace() -> void {
+    while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+                                   text_[pos_] == '\r')) {
+      pos_++;
+    }
+  }
+
+
+  auto Consume(char const c) -> bool {
+    SkipWhitespace();
+
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      pos_++;
+      return true;
+    }
+
+    return false;
+  }
+
+
+  auto ConsumeLiteral(std::string_view const literal) -> bool {
+    if (text_.substr(pos_).starts_with(literal)) {
+      pos_ += literal.size();
+      return true;
+    }
+
+    return false;
+  }
+
+
+  auto ParseValue() -> std::optional<JsonValue> {
+    SkipWhitespace();
+
+    if (pos_ >= text_.size()) {
+      return std::nullopt;
+    }
+
+    switch (text_[pos_]) {
+      case '{': {
+        return ParseObject();
+      }
+      case '[': {
+        return ParseArray();
+      }
+      case '"': {
+        if (auto str{ParseString()}) {
+          return JsonValue{std::move(*str)};
+        }
+        return std::nullopt;
+      }
+      default: {
+        if (ConsumeLiteral("true")) {
+          return JsonValue{true};
+        }
+        if (ConsumeLiteral("false")) {
+          return JsonValue{false};
+        }
+        if (ConsumeLiteral("null")) {
+          return JsonValue{nullptr};
+        }
+        return ParseNumber();
+      }
+    }
+  }
+
+
+  auto ParseObject() -> std::optional<JsonValue> {
+    pos_++;
+    JsonValue::Object obj;
+
+    if (Consume('}')) {
+      return JsonValue{std::move(obj)};
+    }
+
+    do {
+      SkipWhitespace();
+      auto key{ParseString()};
+
+      if (!key || !Consume(':')) {
+        return std::nullopt;
+      }
+
+      auto member{ParseValue()};
+
+      if (!member) {
+        return std::nullopt;
+      }
+
+      obj.emplace_back(std::move(*key), std::move(*member));
+    } while (Consume(','));
+
+    if (!Consume('}')) {
+      return std::nullopt;
+    }
+
+    return JsonValue{std::move(obj)};
+  }
+
+
+  auto ParseArray() -> std::optional<JsonValue> {
+    pos_++;
+    JsonValue::Array arr;
+
+    if (Consume(']')) {
+      return JsonValue{std::move(arr)};
+    }
+
+    do {
+      auto element{ParseValue()};
+
+      if (!element) {
+        return std::nullopt;
+      }
+
+      arr.emplace_back(std::move(*element));
+    } while (Consume(','));
+
+    if (!Consume(']')) {
+      return std::nullopt;
+    }
+
+    return JsonValue{std::move(arr)};
+  }
+
+
+  auto ParseString() -> std::optional<std::string> {
+    if (pos_ >= text_.size() || text_[pos_] != '"') {
+      return std::nullopt;
+    }
+
+    pos_++;
+    std::string str;
+
+    while (pos_ < text_.size() && text_[pos_] != '"') {
+      if (static_cast<unsigned char>(text_[pos_]) < 0x20) {
+        return std::nullopt;
+      }
+
+      if (text_[pos_] == '\\') {
+        // Escapes are kept verbatim, the trace only has to be well-formed
+        if (++pos_ >= text_.size() || std::string_view{R"("\/bfnrtu)"}.find(text_[pos_]) == std::string_view::npos) {
+          return std::nullopt;
+        }
+        str.push_back('\\');
+      }
+
+      str.push_back(text_[pos_++]);
+    }
+
+    if (pos_ >= text_.size()) {
+      return std::nullopt;
+    }
+
+    pos_++;
+    return str;
+  }
+
+
+  auto ParseNumber() -> std::optional<JsonValue> {
+    double number;
+    auto const [ptr, ec]{std::from_chars(text_.data() + pos_, text_.data() + text_.size(), number)};
+
+    if (ec != std::errc{} || ptr == text_.data() + pos_) {
+      return std::nullopt;
+    }
+
+    pos_ = static_cast<std::size_t>(ptr - text_.data());
+    return JsonValue{number};
+  }
+
+
+  std::string_view text_;
+  std::size_t pos_{0};
+};
+
+
+// Parses the trace and checks what every viewer relies on: named threads, balanced begin-end pairs per thread and
+// monotonic timestamps. Returns the number of job slices per thread.
+auto CheckChromeTrace(std::string const& trace, unsigned const thread_count) -> std::map<unsigned, std::size_t> {
+  std::map<unsigned, std::size_t> job_counts;
+
+  auto const root{JsonReader::Parse(trace)};
+  EXPECT_TRUE(root.has_value()) << "The trace is not valid JSON.";
+
+  if (!root) {
+    return job_counts;
+  }
+
+  EXPECT_EQ(root->FindString("displayTimeUnit"), "ns");
+  auto const events{root->Find("traceEvents")};
+  EXPECT_TRUE(events && std::holds_alternative<JsonValue::Array>(events->value));
+
+  if (!events || !std::holds_alternative<JsonValue::Array>(events->value)) {
+    return job_counts;
+  }
+
+  std::map<unsigned, std::vector<std::string>> open_slices;
+  std::map<unsigned, double> last_timestamps;
+  std::vector<bool> named_threads(thread_count, false);
+
+  for (auto const& event : std::get<JsonValue::Array>(events->value)) {
+    auto const ph{event.FindString("ph")};
+    auto const tid{event.FindNumber("tid")};
+    EXPECT_EQ(event.FindNumber("pid"), 0.0);
+    EXPECT_TRUE(ph && tid);
+
+    if (!ph || !tid) {
+      continue;
+    }
+
+    auto const thread_idx{static_cast<unsigned>(*tid)};
+    EXPECT_LT(thread_idx, thread_count);
+
+    if (thread_idx >= thread_count) {
+      continue;
+    }
+
+    if (*ph == "M") {
+      EXPECT_EQ(event.FindString("name"), "thread_name");
+      named_threads[thread_idx] = true;
+      continue;
+    }
+
+    // Metadata comes first so that viewers can label the thread before its slices
+    EXPECT_TRUE(named_threads[thread_idx]) << thread_idx;
+
+    auto const ts{event.FindNumber("ts")};
+    EXPECT_TRUE(ts.has_value());
+
+    if (ts) {
+      EXPECT_GE(*ts, last_timestamps[thread_idx]) << thread_idx;
+      last_timestamps[thread_idx] = *ts;
+    }
+
+    if (*ph == "B") {
+      auto const name{event.FindString("name")};
+      EXPECT_TRUE(name.has_value());
+      open_slices[thread_idx].emplace_back(name.value_or(""));
+
+      if (name == "Job") {
+        auto const args{event.Find("args")};
+        EXPECT_TRUE(args && args->FindString("job").has_value());
+        ++job_counts[thread_idx];
+      }
+    } else if (*ph == "E") {
+      EXPECT_FALSE(open_slices[thread_idx].empty()) << thread_idx;
+
+      if (!open_slices[thread_idx].empty()) {
+        open_slices[thread_idx].pop_back();
+      }
+    } else {
+      EXPECT_EQ(*ph, "i");
+      EXPECT_EQ(event.FindString("name"), "Steal");
+    }
+  }
+
+  for (unsigned i{0}; i < thread_count; i++) {
+    EXPECT_TRUE(named_threads[i]) << i;
+  }
+
+  // Parked slices may still be open when the snapshot is taken, jobs are closed before their thread parks again
+  for (auto const& [thread_idx, slices] : open_slices) {
+    for (auto const& slice : slices) {
+      EXPECT_EQ(slice, "Parked") << thread_idx;
+    }
+  }
+
+  return job_counts;
+}
+
+
+auto SumExecutedJobs(std::vector<JobThreadCounters> const& counters) -> std::uint64_t {
+  std::uint64_t sum{0};
+
+  for (auto const& thread_counters : counters) {
+    sum += thread_counters.executed_job_count;
+  }
+
+  return sum;
+}
+}
+
+
+TEST(JobProfilerTest, CountersAndTraceMatchTheRecordedEvents) {
+  JobProfiler profiler{2};
+  int outer_job;
+  int nested_job;
+
+  profiler.RecordEvent(0, JobEventType::kJobBegin, &outer_job);
+  profiler.RecordEvent(0, JobEventType::kJobBegin, &nested_job);
+  profiler.RecordEvent(0, JobEventType::kJobEnd, &nested_job);
+  profiler.RecordEvent(0, JobEventType::kJobEnd, &outer_job);
+
+  profiler.RecordEvent(1, JobEventType::kPark);
+  std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  profiler.RecordEvent(1, JobEventType::kUnpark);
+
+  for (auto i{0}; i < 3; i++) {
+    profiler.RecordStealAttempt(1);
+  }
+
+  profiler.RecordEvent(1, JobEventType::kSteal, &outer_job);
+
+  auto const counters{profiler.GetCounters()};
+  ASSERT_EQ(counters.size(), 2);
+
+  EXPECT_EQ(counters[0].executed_job_count, 2);
+  EXPECT_EQ(counters[0].park_count, 0);
+  EXPECT_EQ(counters[0].parked_time.count(), 0);
+  EXPECT_EQ(counters[0].dropped_event_count, 0);
+
+  EXPECT_EQ(counters[1].executed_job_count, 0);
+  EXPECT_EQ(counters[1].steal_attempt_count, 3);
+  EXPECT_EQ(counters[1].successful_steal_count, 1);
+  EXPECT_EQ(counters[1].park_count, 1);
+  EXPECT_GE(counters[1].parked_time, std::chrono::milliseconds{1});
+  EXPECT_EQ(counters[1].busy_time.count(), 0);
+  EXPECT_EQ(counters[1].dropped_event_count, 0);
+
+  std::ostringstream trace;
+  profiler.ExportChromeTrace(trace);
+  auto const job_counts{CheckChromeTrace(trace.str(), 2)};
+
+  EXPECT_EQ(job_counts.size(), 1);
+  EXPECT_EQ(job_counts.contains(0) ? job_counts.at(0) : 0, 2);
+}
+
+
+TEST(JobProfilerTest, OverwrittenEventsAreCountedAsDropped) {
+  constexpr std::uint64_t kJobCount{100'000};
+
+  JobProfiler profiler{1};
+  int job;
+
+  for (std::uint64_t i{0}; i < kJobCount; i++) {
+    profiler.RecordEvent(0, JobEventType::kJobBegin, &job);
+    profiler.RecordEvent(0, JobEventType::kJobEnd, &job);
+  }
+
+  auto const counters{profiler.GetCounters()};
+  ASSERT_EQ(counters.size(), 1);
+  EXPECT_EQ(counters[0].executed_job_count, kJobCount);
+  EXPECT_GT(counters[0].dropped_event_count, 0);
+
+  std::ostringstream trace;
+  profiler.ExportChromeTrace(trace);
+  auto const root{JsonReader::Parse(trace.str())};
+  ASSERT_TRUE(root.has_value());
+
+  auto const& events{std::get<JsonValue::Array>(root->Find("traceEvents")->value)};
+
+  // The thread name plus the surviving events. The snapshot may also drop the slot the writer would overwrite next.
+  auto const exported_event_count{events.size() - 1};
+  EXPECT_LE(exported_event_count + counters[0].dropped_event_count, 2 * kJobCount);
+  EXPECT_GE(exported_event_count + counters[0].dropped_event_count + 1, 2 * kJobCount);
+}
+
+
+TEST(JobProfilerTest, JobSystemExportsTheJobsItRan) {
+  constexpr std::uint64_t kChildCount{256};
+
+  JobSystem job_system{4};
+
+  if constexpr (!kJobSystemProfilingEnabled) {
+    std::ostringstream trace;
+    EXPECT_FALSE(job_system.ExportChromeTrace(trace));
+    EXPECT_TRUE(trace.str().empty());
+    EXPECT_TRUE(job_system.GetProfilingCounters().empty());
+    GTEST_SKIP() << "Job system profiling is compiled out.";
+  }
+
+  auto const parent{job_system.CreateJob([](void*) {})};
+
+  for (std::uint64_t i{0}; i < kChildCount; i++) {
+    job_system.Run(job_system.CreateChildJob(parent, [] {
+      std::this_thread::sleep_for(std::chrono::microseconds{50});
+    }));
+  }
+
+  job_system.Wait(job_system.Run(parent));
+
+  // A job completes before its end event is recorded, give the workers a moment to catch up
+  auto const deadline{std::chrono::steady_clock::now() + std::chrono::seconds{10}};
+  auto counters{job_system.GetProfilingCounters()};
+
+  while (SumExecutedJobs(counters) < kChildCount + 1 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    counters = job_system.GetProfilingCounters();
+  }
+
+  EXPECT_EQ(SumExecutedJobs(counters), kChildCount + 1);
+
+  std::uint64_t successful_steal_count{0};
+
+  for (auto const& thread_counters : counters) {
+    EXPECT_EQ(thread_counters.dropped_event_count, 0);
+    EXPECT_LE(thread_counters.successful_steal_count, thread_counters.steal_attempt_count);
+
+    if (thread_counters.executed_job_count == 0) {
+      EXPECT_EQ(thread_counters.busy_time.count(), 0);
+    }
+
+    successful_steal_count += thread_counters.successful_steal_count;
+  }
+
+  std::ostringstream trace;
+  ASSERT_TRUE(job_system.ExportChromeTrace(trace));
+  auto const job_counts{CheckChromeTrace(trace.str(), static_cast<unsigned>(counters.size()))};
+
+  std::uint64_t exported_job_count{0};
+
+  for (auto const& [thread_idx, job_count] : job_counts) {
+    EXPECT_EQ(job_count, counters[thread_idx].executed_job_count) << thread_idx;
+    exported_job_count += job_count;
+  }
+
+  EXPECT_EQ(exported_job_count, kChildCount + 1);
+  // The children are pushed onto the calling thread's queue, the workers can only get them by stealing
+  EXPECT_GT(successful_steal_count, 0);
+}
+}
@@ -0,0 +1,755 @@
+#include <gtest/gtest.h>
+
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+constexpr std::chrono::seconds kTimeout{10};
+
+
+// Waits for the flag without helping with the jobs, so only the workers can set it
+auto WaitWithoutHelping(std::atomic<bool> const& flag) -> bool {
+  auto const deadline{std::chrono::steady_clock::now() + kTimeout};
+
+  while (!flag.load(std::memory_order_acquire)) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+
+  return true;
+}
+
+
+// Deterministic busywork standing in for a job's payload
+auto SimulateWork(std::uint32_t state, int const iteration_count) -> std::uint32_t {
+  for (auto i{0}; i < iteration_count; i++) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+  }
+
+  return state;
+}
+
+
+// Sorts the samples and returns the value below which the given fraction of them lie
+auto GetPercentile(std::vector<double>& samples, double const fraction) -> double {
+  std::ranges::sort(samples);
+  auto const idx{static_cast<std::size_t>(fraction * static_cast<double>(samples.size()))};
+  return samples[std::min(idx, samples.size() - 1)];
+}
+
+
+// Thread counts the job system clamps to the hardware are skipped, they would repeat the largest measured count
+auto GetBenchmarkThreadCounts() -> std::vector<unsigned> {
+  std::vector<unsigned> thread_counts;
+
+  for (auto thread_count{2u}; thread_count <= 64; thread_count *= 2) {
+    if (thread_count <= std::max(std::thread::hardware_concurrency(), 2u)) {
+      thread_counts.emplace_back(thread_count);
+    }
+  }
+
+  return thread_counts;
+}
+}
+
+
+TEST(JobSystemTest, ParentCompletesAfterItsChildren) {
+  JobSystem job_system{4};
+  std::atomic<int> finished_child_count{0};
+
+  auto const parent{job_system.CreateJob([](void*) {})};
+
+  for (auto i{0}; i < 64; i++) {
+    job_system.Run(job_system.CreateChildJob(parent, [&finished_child_count] {
+      finished_child_count.fetch_add(1, std::memory_order_relaxed);
+    }));
+  }
+
+  job_system.Wait(job_system.Run(parent));
+
+  EXPECT_EQ(finished_child_count.load(), 64);
+}
+
+
+TEST(JobSystemTest, ContinuationRunsAfterAncestorAndItsChildren) {
+  JobSystem job_system{4};
+
+  for (auto iteration{0}; iteration < 1000; iteration++) {
+    std::atomic<int> finished_child_count{0};
+    std::atomic<int> seen_child_count{-1};
+
+    auto const ancestor{job_system.CreateJob([](void*) {})};
+
+    for (auto i{0}; i < 4; i++) {
+      job_system.Run(job_system.CreateChildJob(ancestor, [&finished_child_count] {
+        finished_child_count.fetch_add(1, std::memory_order_relaxed);
+      }));
+    }
+
+    auto const continuation{
+      job_system.CreateJob([&finished_child_count, &seen_child_count] {
+        seen_child_count.store(finished_child_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      })
+    };
+
+    JobSystem::AddContinuation(ancestor, continuation);
+    auto const continuation_handle{job_system.Run(continuation)};
+    job_system.Run(ancestor);
+    job_system.Wait(continuation_handle);
+
+    ASSERT_EQ(seen_child_count.load(), 4);
+  }
+}
+
+
+TEST(JobSystemTest, ContinuationWithMultipleAncestorsRunsOnce) {
+  JobSystem job_system{4};
+
+  for (auto iteration{0}; iteration < 1000; iteration++) {
+    std::atomic<int> finished_ancestor_count{0};
+    std::atomic<int> run_count{0};
+    std::atomic<int> seen_ancestor_count{-1};
+
+    std::array<ObserverPtr<Job>, kMaxJobContinuationCount> ancestors;
+
+    for (auto& ancestor : ancestors) {
+      ancestor = job_system.CreateJob([&finished_ancestor_count] {
+        finished_ancestor_count.fetch_add(1, std::memory_order_relaxed);
+      });
+    }
+
+    auto const continuation{
+      job_system.CreateJob([&finished_ancestor_count, &run_count, &seen_ancestor_count] {
+        seen_ancestor_count.store(finished_ancestor_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        run_count.fetch_add(1, std::memory_order_relaxed);
+      })
+    };
+
+    for (auto const ancestor : ancestors) {
+      JobSystem::AddContinuation(ancestor, continuation);
+    }
+
+    auto const continuation_handle{job_system.Run(continuation)};
+
+    for (auto const ancestor : ancestors) {
+      job_system.Run(ancestor);
+    }
+
+    job_system.Wait(continuation_handle);
+
+    ASSERT_EQ(run_count.load(), 1);
+    ASSERT_EQ(seen_ancestor_count.load(), static_cast<int>(ancestors.size()));
+  }
+}
+
+
+TEST(JobSystemTest, AddingTooManyContinuationsThrows) {
+  JobSystem job_system{2};
+
+  auto const ancestor{job_system.CreateJob([](void*) {})};
+  std::vector<ObserverPtr<Job>> continuations;
+
+  for (auto i{0}; i < kMaxJobContinuationCount; i++) {
+    continuations.emplace_back(job_system.CreateJob([](void*) {}));
+    JobSystem::AddContinuation(ancestor, continuations.back());
+  }
+
+  auto const extra_continuation{job_system.CreateJob([](void*) {})};
+  EXPECT_THROW(JobSystem::AddContinuation(ancestor, extra_continuation), std::runtime_error);
+
+  auto const extra_continuation_handle{job_system.Run(extra_continuation)};
+  std::vector<JobWaitHandle> continuation_handles;
+
+  for (auto const continuation : continuations) {
+    continuation_handles.emplace_back(job_system.Run(continuation));
+  }
+
+  job_system.Run(ancestor);
+
+  for (auto const handle : continuation_handles) {
+    job_system.Wait(handle);
+  }
+
+  job_system.Wait(extra_continuation_handle);
+}
+
+
+TEST(JobSystemTest, ParkedWorkersWakeUpForNewJobs) {
+  JobSystem job_system{4};
+
+  for (auto iteration{0}; iteration < 20; iteration++) {
+    // Long enough for every worker to spin out and park
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    std::atomic<bool> executed{false};
+    job_system.Run(job_system.CreateJob([&executed] {
+      executed.store(true, std::memory_order_release);
+    }));
+
+    ASSERT_TRUE(WaitWithoutHelping(executed));
+  }
+}
+
+
+TEST(JobSystemTest, PoolGrowsBeyondManyPendingJobs) {
+  JobSystem job_system{4};
+  constexpr auto job_count{20'000};
+
+  std::atomic<int> executed_count{0};
+  std::vector<ObserverPtr<Job>> jobs;
+  jobs.reserve(job_count);
+
+  // A fixed ring would have to hand out slots of jobs that have not even run yet
+  for (auto i{0}; i < job_count; i++) {
+    jobs.emplace_back(job_system.CreateJob([&executed_count] {
+      executed_count.fetch_add(1, std::memory_order_relaxed);
+    }));
+  }
+
+  std::vector<JobWaitHandle> handles;
+  handles.reserve(job_count);
+
+  for (auto const job : jobs) {
+    handles.emplace_back(job_system.Run(job));
+  }
+
+  for (auto const handle : handles) {
+    job_system.Wait(handle);
+  }
+
+  EXPECT_EQ(executed_count.load(), job_count);
+}
+
+
+TEST(JobSystemTest, WaitingOnACompletedJobIgnoresItsReuse) {
+  JobSystem job_system{4};
+
+  std::atomic<bool> executed{false};
+
+  // Like the render job, which is waited on a frame after it has completed
+  auto const waited_job{
+    job_system.CreateJob([&executed] {
+      executed.store(true, std::memory_order_release);
+    })
+  };
+  auto const waited_handle{job_system.Run(waited_job)};
+  ASSERT_TRUE(WaitWithoutHelping(executed));
+
+  ObserverPtr<Job> reusing_job;
+
+  // Freed jobs are reused oldest first, the pool may still hold the jobs of earlier tests
+  for (auto i{0}; i < 1'000'000 && !reusing_job; i++) {
+    if (auto const job{job_system.CreateJob([](void*) {})}; job.Get() == waited_job.Get()) {
+      reusing_job = job;
+    } else {
+      job_system.Wait(job_system.Run(job));
+    }
+  }
+
+  ASSERT_TRUE(reusing_job);
+
+  // The reusing job is not even running, so only the generation can tell that the waited run has completed
+  job_system.Wait(waited_handle);
+  job_system.Wait(job_system.Run(reusing_job));
+}
+
+
+TEST(JobSystemTest, JobsOutliveTheThreadThatCreatedThem) {
+  JobSystem job_system{4};
+
+  for (auto iteration{0}; iteration < 50; iteration++) {
+    std::vector<ObserverPtr<Job>> jobs;
+
+    std::thread{
+      [&job_system, &jobs] {
+        for (auto i{0}; i < 100; i++) {
+          // Large enough to go through the job data arena
+          std::array<char, 256> payload{};
+          jobs.emplace_back(job_system.CreateJob([payload] {
+            static_cast<void>(payload);
+          }));
+        }
+      }
+    }.join();
+
+    std::vector<JobWaitHandle> handles;
+
+    for (auto const job : jobs) {
+      handles.emplace_back(job_system.Run(job));
+    }
+
+    for (auto const handle : handles) {
+      job_system.Wait(handle);
+    }
+  }
+}
+
+
+TEST(JobSystemTest, HigherPriorityJobsRunFirst) {
+  // Without workers the queued jobs only run when the test thread executes them
+  JobSystem job_system{1};
+  std::vector<JobPriority> execution_order;
+
+  for (auto const priority : {JobPriority::kBackground, JobPriority::kNormal, JobPriority::kFrameCritical}) {
+    for (auto i{0}; i < 3; i++) {
+      auto const job{
+        job_system.CreateJob([&execution_order, priority] {
+          execution_order.emplace_back(priority);
+        })
+      };
+      job->priority = priority;
+      job_system.Run(job);
+    }
+  }
+
+  while (job_system.TryExecuteOneJob()) {}
+
+  ASSERT_EQ(execution_order.size(), 9);
+  EXPECT_TRUE(std::ranges::is_sorted(execution_order));
+}
+
+
+TEST(JobSystemTest, FrameCriticalJobsOvertakeBackgroundFloods) {
+  constexpr auto kBackgroundJobCount{8000};
+  constexpr std::chrono::microseconds kBackgroundJobDuration{250};
+  constexpr auto kSampleCount{20};
+  // A frame-critical job only has to wait for the background jobs already running, far less than the flood's length
+  constexpr std::chrono::milliseconds kMaxLatency{20};
+
+  using Clock = std::chrono::steady_clock;
+
+  std::atomic<bool> cancel_background{false};
+  std::atomic<int> finished_background_count{0};
+  JobSystem job_system{4};
+
+  auto const flood{job_system.CreateJob([](void*) {})};
+  flood->priority = JobPriority::kBackground;
+
+  for (auto i{0}; i < kBackgroundJobCount; i++) {
+    auto const job{
+      job_system.CreateChildJob(flood, [&cancel_background, &finished_background_count, kBackgroundJobDuration] {
+        auto const end{Clock::now() + kBackgroundJobDuration};
+
+        while (!cancel_background.load(std::memory_order_relaxed) && Clock::now() < end) {}
+
+        finished_background_count.fetch_add(1, std::memory_order_relaxed);
+      })
+    };
+    job->priority = JobPriority::kBackground;
+    job_system.Run(job);
+  }
+
+  auto const flood_handle{job_system.Run(flood)};
+  auto max_latency{Clock::duration::zero()};
+
+  for (auto i{0}; i < kSampleCount; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+
+    std::atomic<bool> executed{false};
+    Clock::time_point execution_time;
+
+    auto const job{
+      job_system.CreateJob([&executed, &execution_time] {
+        execution_time = Clock::now();
+        executed.store(true, std::memory_order_release);
+      })
+    };
+    job->priority = JobPriority::kFrameCritical;
+
+    auto const submit_time{Clock::now()};
+    job_system.Run(job);
+
+    ASSERT_TRUE(WaitWithoutHelping(executed));
+    max_latency = std::max(max_latency, execution_time - submit_time);
+  }
+
+  // Otherwise the frame-critical jobs had nothing to overtake
+  EXPECT_LT(finished_background_count.load(), kBackgroundJobCount);
+  EXPECT_LT(max_latency, kMaxLatency);
+
+  cancel_background.store(true, std::memory_order_relaxed);
+  job_system.Wait(flood_handle);
+}
+
+
+TEST(JobSystemTest, BlockingIoJobsRunOnIoThreads) {
+  JobSystem job_system{1};
+
+  std::atomic<bool> executed{false};
+  std::thread::id io_thread_id;
+
+  auto const job{
+    job_system.CreateJob([&executed, &io_thread_id] {
+      io_thread_id = std::this_thread::get_id();
+      executed.store(true, std::memory_order_release);
+    })
+  };
+  job->priority = JobPriority::kBlockingIo;
+  job_system.Run(job);
+
+  ASSERT_TRUE(WaitWithoutHelping(executed));
+  EXPECT_NE(io_thread_id, std::this_thread::get_id());
+}
+
+
+TEST(JobSystemTest, DestroyingTheSystemWhileJobsPushIoJobs) {
+  for (auto iteration{0}; iteration < 50; iteration++) {
+    JobSystem job_system{4};
+    std::atomic<bool> started{false};
+
+    // Keeps pushing I/O jobs from the workers until the system stops them
+    for (auto i{0}; i < 8; i++) {
+      job_system.Run(job_system.CreateJob([&job_system, &started] {
+        started.store(true, std::memory_order_release);
+
+        for (auto j{0}; j < 100; j++) {
+          auto const io_job{job_system.CreateJob([] {})};
+          io_job->priority = JobPriority::kBlockingIo;
+          job_system.Run(io_job);
+        }
+      }));
+    }
+
+    ASSERT_TRUE(WaitWithoutHelping(started));
+  }
+}
+
+
+TEST(JobSystemTest, ParallelForVisitsEveryIndexOnce) {
+  JobSystem job_system{4};
+  std::vector<std::atomic<int>> visit_counts(100'000);
+
+  job_system.ParallelFor(0, visit_counts.size(), [&visit_counts](std::size_t const idx) {
+    visit_counts[idx].fetch_add(1, std::memory_order_relaxed);
+  }, 64);
+
+  for (auto const& count : visit_counts) {
+    ASSERT_EQ(count.load(), 1);
+  }
+}
+
+
+TEST(JobSystemTest, ParallelReduceOfBooleans) {
+  JobSystem job_system{4};
+
+  for (auto iteration{0}; iteration < 100; iteration++) {
+    auto const all{
+      job_system.ParallelReduce(0, 100'000, true, [](std::size_t const idx) {
+        return idx != 99'999;
+      }, [](bool const lhs, bool const rhs) {
+        return lhs && rhs;
+      }, 64)
+    };
+
+    auto const any{
+      job_system.ParallelReduce(0, 100'000, false, [](std::size_t const idx) {
+        return idx == 5;
+      }, [](bool const lhs, bool const rhs) {
+        return lhs || rhs;
+      }, 64)
+    };
+
+    ASSERT_FALSE(all);
+    ASSERT_TRUE(any);
+  }
+}
+
+
+TEST(JobSystemTest, ParallelReduceOfIntegers) {
+  JobSystem job_system{4};
+
+  std::vector<std::uint64_t> values(1'000'000);
+  std::iota(values.begin(), values.end(), 0);
+
+  auto const sum{
+    job_system.ParallelReduce(0, values.size(), std::uint64_t{0}, [&values](std::size_t const idx) {
+      return values[idx];
+    }, [](std::uint64_t const lhs, std::uint64_t const rhs) {
+      return lhs + rhs;
+    })
+  };
+
+  EXPECT_EQ(sum, std::uint64_t{999'999} * 1'000'000 / 2);
+}
+
+
+TEST(JobSystemTest, StressNestedGraphs) {
+  for (auto const thread_count : {2u, 4u, 8u}) {
+    JobSystem job_system{thread_count};
+    std::atomic<int> counter{0};
+
+    for (auto iteration{0}; iteration < 2000; iteration++) {
+      // first -> (parent with four children) -> last
+      auto const first{
+        job_system.CreateJob([&counter] {
+          counter.fetch_add(1, std::memory_order_relaxed);
+        })
+      };
+      auto const parent{job_system.CreateJob([](void*) {})};
+      auto const last{
+        job_system.CreateJob([&counter] {
+          counter.fetch_add(100, std::memory_order_relaxed);
+        })
+      };
+
+      for (auto i{0}; i < 4; i++) {
+        job_system.Run(job_system.CreateChildJob(parent, [&counter] {
+          counter.fetch_add(1, std::memory_order_relaxed);
+        }));
+      }
+
+      JobSystem::AddContinuation(first, parent);
+      JobSystem::AddContinuation(parent, last);
+      auto const last_handle{job_system.Run(last)};
+      job_system.Run(parent);
+      job_system.Run(first);
+      job_system.Wait(last_handle);
+    }
+
+    ASSERT_EQ(counter.load(), 2000 * 105) << thread_count << " threads";
+  }
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(JobSystemTest, DISABLED_GraphThroughputVersusSpawnThenWait) {
+  // Four dependent stages per chain, like extract -> cull -> skin -> record over independent batches
+  constexpr auto kStageCount{4};
+  constexpr auto kChainCount{64};
+  constexpr auto kWorkIterationCount{2000};
+  constexpr auto kFrameCount{200};
+
+  std::cout << std::format("Hardware threads: {}\n", std::thread::hardware_concurrency());
+
+  for (auto const thread_count : GetBenchmarkThreadCounts()) {
+    JobSystem job_system{thread_count};
+    std::atomic<std::uint32_t> sink{0};
+
+    auto const make_work{
+      [&sink](std::uint32_t const seed) {
+        return [&sink, seed] {
+          sink.fetch_add(SimulateWork(seed, kWorkIterationCount), std::memory_order_relaxed);
+        };
+      }
+    };
+
+    auto const measure{
+      [](auto&& run_frame) {
+        auto const start{std::chrono::steady_clock::now()};
+
+        for (auto frame{0}; frame < kFrameCount; frame++) {
+          run_frame();
+        }
+
+        auto const ms{std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - start}.count()};
+        return static_cast<double>(kFrameCount * kStageCount * kChainCount) / ms;
+      }
+    };
+
+    // The whole frame is submitted up front, the test thread only waits once
+    auto const graph_jobs_per_ms{
+      measure([&] {
+        auto const frame{job_system.CreateJob([](void*) {})};
+
+        for (auto chain{0}; chain < kChainCount; chain++) {
+          std::array<ObserverPtr<Job>, kStageCount> stages;
+
+          for (auto stage{0}; stage < kStageCount; stage++) {
+            stages[stage] = job_system.CreateChildJob(frame, make_work(chain * kStageCount + stage + 1));
+
+            if (stage > 0) {
+              JobSystem::AddContinuation(stages[stage - 1], stages[stage]);
+            }
+          }
+
+          for (auto stage{kStageCount - 1}; stage >= 0; stage--) {
+            job_system.Run(stages[stage]);
+          }
+        }
+
+        job_system.Wait(job_system.Run(frame));
+      })
+    };
+
+    // Every stage is spawned as independent jobs that the test thread waits on one by one
+    auto const spawn_then_wait_jobs_per_ms{
+      measure([&] {
+        std::vector<JobWaitHandle> handles;
+
+        for (auto stage{0}; stage < kStageCount; stage++) {
+          handles.clear();
+
+          for (auto chain{0}; chain < kChainCount; chain++) {
+            handles.emplace_back(job_system.Run(job_system.CreateJob(make_work(chain * kStageCount + stage + 1))));
+          }
+
+          for (auto const handle : handles) {
+            job_system.Wait(handle);
+          }
+        }
+      })
+    };
+
+    std::cout << std::format("{} threads: {:.1f} jobs/ms as a graph, {:.1f} jobs/ms spawning then waiting ({})\n",
+      thread_count, graph_jobs_per_ms, spawn_then_wait_jobs_per_ms, sink.load());
+  }
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(JobSystemTest, DISABLED_EmptyJobThroughputAndWakeLatency) {
+  constexpr auto kEmptyJobCount{200'000};
+  constexpr auto kWakeSampleCount{200};
+  // Long enough for the workers to spin out and park
+  constexpr std::chrono::milliseconds kIdleTime{5};
+
+  using Clock = std::chrono::steady_clock;
+
+  for (auto const thread_count : GetBenchmarkThreadCounts()) {
+    JobSystem job_system{thread_count};
+
+    auto const start{Clock::now()};
+    auto const parent{job_system.CreateJob([](void*) {})};
+
+    for (auto i{0}; i < kEmptyJobCount; i++) {
+      job_system.Run(job_system.CreateChildJob(parent, [](void*) {}));
+    }
+
+    job_system.Wait(job_system.Run(parent));
+    auto const empty_jobs_per_ms{
+      kEmptyJobCount / std::chrono::duration<double, std::milli>{Clock::now() - start}.count()
+    };
+
+    // Time from submitting a job to a parked system until a worker starts it
+    std::vector<double> wake_latencies_us;
+
+    for (auto i{0}; i < kWakeSampleCount; i++) {
+      std::this_thread::sleep_for(kIdleTime);
+
+      std::atomic<bool> executed{false};
+      Clock::time_point execution_time;
+      auto const submit_time{Clock::now()};
+
+      job_system.Run(job_system.CreateJob([&executed, &execution_time] {
+        execution_time = Clock::now();
+        executed.store(true, std::memory_order_release);
+      }));
+
+      ASSERT_TRUE(WaitWithoutHelping(executed));
+      wake_latencies_us.emplace_back(std::chrono::duration<double, std::micro>{execution_time - submit_time}.count());
+    }
+
+    std::cout << std::format("{} threads: {:.0f} empty jobs/ms, wake latency p50 {:.1f} us, p99 {:.1f} us\n",
+      thread_count, empty_jobs_per_ms, GetPercentile(wake_latencies_us, 0.5), GetPercentile(wake_latencies_us, 0.99));
+  }
+
+  // What the workers did before the eventcount: sleep on a mutex and condition variable until notified
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  auto submitted{false};
+  Clock::time_point wake_time;
+  std::atomic<bool> woken{false};
+
+  std::jthread sleeper{
+    [&](std::stop_token const& stop_token) {
+      while (!stop_token.stop_requested()) {
+        std::unique_lock lock{mutex};
+        cond_var.wait(lock, [&] { return submitted || stop_token.stop_requested(); });
+
+        if (submitted) {
+          submitted = false;
+          wake_time = Clock::now();
+          woken.store(true, std::memory_order_release);
+        }
+      }
+    }
+  };
+
+  std::vector<double> cond_var_latencies_us;
+
+  for (auto i{0}; i < kWakeSampleCount; i++) {
+    std::this_thread::sleep_for(kIdleTime);
+
+    woken.store(false, std::memory_order_relaxed);
+    auto const submit_time{Clock::now()};
+
+    {
+      std::scoped_lock const lock{mutex};
+      submitted = true;
+    }
+
+    cond_var.notify_all();
+    ASSERT_TRUE(WaitWithoutHelping(woken));
+    cond_var_latencies_us.emplace_back(std::chrono::duration<double, std::micro>{wake_time - submit_time}.count());
+  }
+
+  sleeper.request_stop();
+
+  {
+    std::scoped_lock const lock{mutex};
+  }
+
+  cond_var.notify_all();
+
+  std::cout << std::format("Condition variable baseline: wake latency p50 {:.1f} us, p99 {:.1f} us\n",
+    GetPercentile(cond_var_latencies_us, 0.5), GetPercentile(cond_var_latencies_us, 0.99));
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(JobSystemTest, DISABLED_ParallelForElementCountAndGrainSizeSweep) {
+  constexpr std::size_t kTotalElementCount{50'000'000};
+
+  auto thread_counts{GetBenchmarkThreadCounts()};
+  thread_counts.insert(thread_counts.begin(), 1);
+
+  for (auto const thread_count : thread_counts) {
+    JobSystem job_system{thread_count};
+
+    for (std::size_t const element_count : {1'000, 100'000, 10'000'000}) {
+      std::vector<float> values(element_count);
+      // Same total amount of work for every element count
+      auto const repeat_count{std::max(kTotalElementCount / element_count, std::size_t{1})};
+
+      for (std::size_t const grain_size : {JobSystem::kAutoGrainSize, std::size_t{64}, std::size_t{1024},
+                                           std::size_t{16'384}}) {
+        auto const start{std::chrono::steady_clock::now()};
+
+        for (std::size_t i{0}; i < repeat_count; i++) {
+          job_system.ParallelFor(0, element_count, [&values](std::size_t const idx) {
+            values[idx] = std::sqrt(static_cast<float>(idx)) * 0.5f + values[idx];
+          }, grain_size);
+        }
+
+        auto const ns{std::chrono::duration<double, std::nano>{std::chrono::steady_clock::now() - start}.count()};
+
+        std::cout << std::format("{} threads, {} elements, grain size {}: {:.2f} ns per element\n", thread_count,
+          element_count, grain_size == JobSystem::kAutoGrainSize ? "auto" : std::to_string(grain_size),
+          ns / static_cast<double>(repeat_count * element_count));
+      }
+    }
+  }
+}
+}
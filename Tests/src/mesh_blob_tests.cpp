@@ -0,0 +1,354 @@
+#include <gtest/gtest.h>
+
+#include "Math.hpp"
+#include "mesh_blob.hpp"
+#include "mesh_data.hpp"
+#include "Serialization.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+constexpr std::uint32_t kTestMeshletVertexCount{64};
+constexpr std::uint32_t kTestMeshletTriangleCount{124};
+constexpr std::uint32_t kTestSkeletonSize{64};
+constexpr std::size_t kTestKeysPerNodeAnim{30};
+
+
+// Skinned mesh with a bone per skeleton node and animations that key every node
+auto MakeSkinnedMesh(std::uint32_t const vertex_count, std::size_t const anim_count, std::mt19937& rng) -> MeshData {
+  std::uniform_real_distribution<float> coord_dist{-1.0f, 1.0f};
+  std::uniform_real_distribution<float> weight_dist{0.0f, 1.0f};
+  std::uniform_int_distribution<std::uint32_t> bone_dist{0, kTestSkeletonSize - 1};
+
+  MeshData mesh;
+  mesh.positions.reserve(vertex_count);
+  mesh.normals.reserve(vertex_count);
+  mesh.tangents.reserve(vertex_count);
+  mesh.uvs.reserve(vertex_count);
+  mesh.bone_weights.reserve(vertex_count);
+  mesh.bone_indices.reserve(vertex_count);
+
+  for (std::uint32_t i{0}; i < vertex_count; i++) {
+    mesh.positions.emplace_back(coord_dist(rng), coord_dist(rng), coord_dist(rng));
+    mesh.normals.emplace_back(Normalized(Vector3{coord_dist(rng), coord_dist(rng), 1.0f}));
+    // The field by field format has no handedness, it reads every tangent as right-handed
+    mesh.tangents.emplace_back(Vector3{1.0f, 0.0f, 0.0f}, 1.0f);
+    mesh.uvs.emplace_back(weight_dist(rng), weight_dist(rng));
+    mesh.bone_weights.emplace_back(weight_dist(rng), weight_dist(rng), weight_dist(rng), weight_dist(rng));
+    mesh.bone_indices.emplace_back(bone_dist(rng), bone_dist(rng), bone_dist(rng), bone_dist(rng));
+  }
+
+  auto const meshlet_count{(vertex_count + kTestMeshletVertexCount - 1) / kTestMeshletVertexCount};
+
+  for (std::uint32_t i{0}; i < meshlet_count; i++) {
+    auto const vert_offset{i * kTestMeshletVertexCount};
+    auto const vert_count{std::min(kTestMeshletVertexCount, vertex_count - vert_offset)};
+    mesh.meshlets.emplace_back(vert_count, vert_offset, kTestMeshletTriangleCount, i * kTestMeshletTriangleCount);
+    mesh.cull_data.emplace_back(BoundingSphere{.center = Vector3{0}, .radius = 1.0f}, Vector<std::uint8_t, 4>{0},
+      0.0f);
+
+    for (std::uint32_t j{0}; j < kTestMeshletTriangleCount; j++) {
+      mesh.triangle_indices.emplace_back(j % vert_count, (j + 1) % vert_count, (j + 2) % vert_count);
+    }
+  }
+
+  mesh.vertex_indices.resize(static_cast<std::size_t>(vertex_count) * sizeof(std::uint32_t));
+
+  for (std::uint32_t i{0}; i < vertex_count; i++) {
+    std::memcpy(mesh.vertex_indices.data() + i * sizeof(std::uint32_t), &i, sizeof(std::uint32_t));
+  }
+
+  mesh.material_slots = {{"Body"}, {"Clothes"}};
+  mesh.submeshes.emplace_back(0, meshlet_count, 0, 1, AABB{.min = Vector3{-1}, .max = Vector3{1}});
+
+  for (std::uint32_t i{0}; i < kTestSkeletonSize; i++) {
+    mesh.skeleton.emplace_back(std::format("Node{}", i), Matrix4::Identity(),
+      i == 0 ? std::nullopt : std::optional{(i - 1) / 2});
+    mesh.bones.emplace_back(Matrix4::Identity(), i);
+  }
+
+  for (std::size_t i{0}; i < anim_count; i++) {
+    auto& anim{mesh.animations.emplace_back(std::format("Animation{}", i), 10.0f, 30.0f)};
+
+    for (std::uint32_t j{0}; j < kTestSkeletonSize; j++) {
+      auto& node_anim{anim.node_anims.emplace_back()};
+      node_anim.node_idx = j;
+
+      for (std::size_t k{0}; k < kTestKeysPerNodeAnim; k++) {
+        auto const timestamp{static_cast<float>(k)};
+        node_anim.position_keys.emplace_back(timestamp, Vector3{coord_dist(rng)});
+        node_anim.rotation_keys.emplace_back(timestamp, Quaternion{});
+        node_anim.scaling_keys.emplace_back(timestamp, Vector3{1});
+      }
+    }
+  }
+
+  mesh.bounds = AABB{.min = Vector3{-1}, .max = Vector3{1}};
+  mesh.idx32 = true;
+  return mesh;
+}
+
+
+template<typename T>
+auto AppendBytes(std::span<T const> const data, std::vector<std::byte>& bytes) -> void {
+  std::ranges::copy(as_bytes(data), std::back_inserter(bytes));
+}
+
+
+// The field by field layout that the model importer wrote before the blob format
+auto SerializeLegacyMesh(MeshData const& mesh_data) -> std::vector<std::byte> {
+  std::vector<std::byte> bytes;
+
+  SerializeToBinary(mesh_data.positions.size(), bytes);
+  SerializeToBinary(mesh_data.meshlets.size(), bytes);
+  SerializeToBinary(mesh_data.vertex_indices.size(), bytes);
+  SerializeToBinary(mesh_data.triangle_indices.size(), bytes);
+  SerializeToBinary(mesh_data.material_slots.size(), bytes);
+  SerializeToBinary(mesh_data.submeshes.size(), bytes);
+  SerializeToBinary(mesh_data.animations.size(), bytes);
+  SerializeToBinary(mesh_data.skeleton.size(), bytes);
+  SerializeToBinary(mesh_data.bones.size(), bytes);
+
+  AppendBytes(std::span{mesh_data.positions}, bytes);
+  AppendBytes(std::span{mesh_data.normals}, bytes);
+
+  for (auto const& tangent : mesh_data.tangents) {
+    AppendBytes(std::span{&tangent[0], 3}, bytes);
+  }
+
+  AppendBytes(std::span{mesh_data.uvs}, bytes);
+  AppendBytes(std::span{mesh_data.bone_weights}, bytes);
+  AppendBytes(std::span{mesh_data.bone_indices}, bytes);
+  AppendBytes(std::span{mesh_data.meshlets}, bytes);
+  AppendBytes(std::span{mesh_data.vertex_indices}, bytes);
+  AppendBytes(std::span{mesh_data.triangle_indices}, bytes);
+  AppendBytes(std::span{mesh_data.cull_data}, bytes);
+
+  for (auto const& mtl_slot : mesh_data.material_slots) {
+    SerializeToBinary(mtl_slot.name, bytes);
+  }
+
+  for (auto const& submesh : mesh_data.submeshes) {
+    SerializeToBinary(submesh.first_meshlet, bytes);
+    SerializeToBinary(submesh.meshlet_count, bytes);
+    SerializeToBinary(submesh.base_vertex, bytes);
+    SerializeToBinary(submesh.material_idx, bytes);
+
+    for (auto i{0}; i < 3; i++) {
+      SerializeToBinary(submesh.bounds.min[i], bytes);
+    }
+
+    for (auto i{0}; i < 3; i++) {
+      SerializeToBinary(submesh.bounds.max[i], bytes);
+    }
+  }
+
+  for (auto const& [name, duration, ticks_per_second, node_anims] : mesh_data.animations) {
+    SerializeToBinary(name, bytes);
+    SerializeToBinary(duration, bytes);
+    SerializeToBinary(ticks_per_second, bytes);
+    SerializeToBinary(node_anims.size(), bytes);
+
+    for (auto const& [position_keys, rotation_keys, scaling_keys, node_idx] : node_anims) {
+      SerializeToBinary(node_idx, bytes);
+      SerializeToBinary(position_keys.size(), bytes);
+      SerializeToBinary(rotation_keys.size(), bytes);
+      SerializeToBinary(scaling_keys.size(), bytes);
+      AppendBytes(std::span{position_keys}, bytes);
+      AppendBytes(std::span{rotation_keys}, bytes);
+      AppendBytes(std::span{scaling_keys}, bytes);
+    }
+  }
+
+  for (auto const& [name, transform, parent_idx] : mesh_data.skeleton) {
+    SerializeToBinary(name, bytes);
+    SerializeToBinary(parent_idx.has_value(), bytes);
+
+    if (parent_idx) {
+      SerializeToBinary(*parent_idx, bytes);
+    }
+
+    AppendBytes(std::span{transform.GetData(), 16}, bytes);
+  }
+
+  for (auto const& [offset_mtx, skeleton_node_idx] : mesh_data.bones) {
+    AppendBytes(std::span{offset_mtx.GetData(), 16}, bytes);
+    SerializeToBinary(skeleton_node_idx, bytes);
+  }
+
+  for (auto i{0}; i < 3; i++) {
+    SerializeToBinary(mesh_data.bounds.min[i], bytes);
+  }
+
+  for (auto i{0}; i < 3; i++) {
+    SerializeToBinary(mesh_data.bounds.max[i], bytes);
+  }
+
+  SerializeToBinary(mesh_data.idx32, bytes);
+  return bytes;
+}
+
+
+template<typename T>
+auto IsSameStream(std::vector<T> const& lhs, std::vector<T> const& rhs) -> bool {
+  return std::ranges::equal(as_bytes(std::span{lhs}), as_bytes(std::span{rhs}));
+}
+
+
+auto ExpectSameMeshData(MeshData const& actual, MeshData const& expected) -> void {
+  EXPECT_TRUE(IsSameStream(actual.positions, expected.positions));
+  EXPECT_TRUE(IsSameStream(actual.normals, expected.normals));
+  EXPECT_TRUE(IsSameStream(actual.tangents, expected.tangents));
+  EXPECT_TRUE(IsSameStream(actual.uvs, expected.uvs));
+  EXPECT_TRUE(IsSameStream(actual.bone_weights, expected.bone_weights));
+  EXPECT_TRUE(IsSameStream(actual.bone_indices, expected.bone_indices));
+  EXPECT_TRUE(IsSameStream(actual.meshlets, expected.meshlets));
+  EXPECT_TRUE(IsSameStream(actual.vertex_indices, expected.vertex_indices));
+  EXPECT_TRUE(IsSameStream(actual.triangle_indices, expected.triangle_indices));
+  EXPECT_TRUE(IsSameStream(actual.cull_data, expected.cull_data));
+  EXPECT_TRUE(IsSameStream(actual.submeshes, expected.submeshes));
+  EXPECT_TRUE(IsSameStream(actual.bones, expected.bones));
+  EXPECT_EQ(actual.idx32, expected.idx32);
+
+  ASSERT_EQ(actual.material_slots.size(), expected.material_slots.size());
+
+  for (std::size_t i{0}; i < actual.material_slots.size(); i++) {
+    EXPECT_EQ(actual.material_slots[i].name, expected.material_slots[i].name);
+  }
+
+  ASSERT_EQ(actual.skeleton.size(), expected.skeleton.size());
+
+  for (std::size_t i{0}; i < actual.skeleton.size(); i++) {
+    EXPECT_EQ(actual.skeleton[i].name, expected.skeleton[i].name);
+    EXPECT_EQ(actual.skeleton[i].parent_idx, expected.skeleton[i].parent_idx);
+  }
+
+  ASSERT_EQ(actual.animations.size(), expected.animations.size());
+
+  for (std::size_t i{0}; i < actual.animations.size(); i++) {
+    auto const& actual_anim{actual.animations[i]};
+    auto const& expected_anim{expected.animations[i]};
+    EXPECT_EQ(actual_anim.name, expected_anim.name);
+    ASSERT_EQ(actual_anim.node_anims.size(), expected_anim.node_anims.size());
+
+    for (std::size_t j{0}; j < actual_anim.node_anims.size(); j++) {
+      EXPECT_EQ(actual_anim.node_anims[j].node_idx, expected_anim.node_anims[j].node_idx);
+      EXPECT_TRUE(IsSameStream(actual_anim.node_anims[j].position_keys, expected_anim.node_anims[j].position_keys));
+      EXPECT_TRUE(IsSameStream(actual_anim.node_anims[j].rotation_keys, expected_anim.node_anims[j].rotation_keys));
+      EXPECT_TRUE(IsSameStream(actual_anim.node_anims[j].scaling_keys, expected_anim.node_anims[j].scaling_keys));
+    }
+  }
+}
+}
+
+
+TEST(MeshBlobTest, BlobsRoundTripThroughMeshView) {
+  std::mt19937 rng{42};
+  auto const mesh{MakeSkinnedMesh(1000, 3, rng)};
+  auto const blob{SerializeMeshBlob(mesh)};
+
+  auto const view{MeshView::Parse(blob)};
+  ASSERT_TRUE(view);
+  EXPECT_EQ(view->GetVertexCount(), mesh.positions.size());
+  EXPECT_EQ(view->GetAnimations().size(), 3);
+  EXPECT_EQ(view->GetString(view->GetAnimations()[2].name), "Animation2");
+  ExpectSameMeshData(view->ToMeshData(), mesh);
+}
+
+
+TEST(MeshBlobTest, LegacyPayloadsMatchTheirBlobs) {
+  std::mt19937 rng{42};
+  auto const mesh{MakeSkinnedMesh(1000, 3, rng)};
+  auto const legacy_bytes{SerializeLegacyMesh(mesh)};
+
+  EXPECT_FALSE(MeshView::IsMeshBlob(legacy_bytes));
+
+  auto const legacy_mesh{DeserializeLegacyMeshData(legacy_bytes)};
+  ASSERT_TRUE(legacy_mesh);
+  ExpectSameMeshData(*legacy_mesh, mesh);
+}
+
+
+TEST(MeshBlobTest, TruncatedBlobsAreRejected) {
+  std::mt19937 rng{42};
+  auto const blob{SerializeMeshBlob(MakeSkinnedMesh(100, 1, rng))};
+  EXPECT_FALSE(MeshView::Parse(std::span{blob}.first(blob.size() - 16)));
+  EXPECT_FALSE(MeshView::Parse(std::span{blob}.first(16)));
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(MeshBlobTest, DISABLED_BlobAndLegacyParsingOfLargeSkinnedMeshes) {
+  constexpr std::uint32_t kVertexCount{5'000'000};
+  constexpr std::size_t kAnimationCount{200};
+  constexpr int kRepeatCount{5};
+
+  std::mt19937 rng{42};
+  auto const legacy_bytes{SerializeLegacyMesh(MakeSkinnedMesh(kVertexCount, kAnimationCount, rng))};
+  rng.seed(42);
+  auto const blob{SerializeMeshBlob(MakeSkinnedMesh(kVertexCount, kAnimationCount, rng))};
+
+  auto const measure{
+    [](auto&& func) {
+      auto best{std::chrono::steady_clock::duration::max()};
+
+      for (auto i{0}; i < kRepeatCount; i++) {
+        auto const begin{std::chrono::steady_clock::now()};
+        func();
+        best = std::min(best, std::chrono::steady_clock::now() - begin);
+      }
+
+      return std::chrono::duration<double, std::milli>{best}.count();
+    }
+  };
+
+  std::size_t checksum{0};
+
+  auto const legacy_time{
+    measure([&] {
+      auto const mesh{DeserializeLegacyMeshData(legacy_bytes)};
+      ASSERT_TRUE(mesh);
+      checksum += mesh->positions.size() + mesh->animations.size();
+    })
+  };
+
+  auto const view_time{
+    measure([&] {
+      auto const view{MeshView::Parse(blob)};
+      ASSERT_TRUE(view);
+      checksum += view->GetPositions().size() + view->GetAnimations().size();
+    })
+  };
+
+  auto const materialize_time{
+    measure([&] {
+      auto const view{MeshView::Parse(blob)};
+      ASSERT_TRUE(view);
+      auto const mesh{view->ToMeshData()};
+      checksum += mesh.positions.size() + mesh.animations.size();
+    })
+  };
+
+  EXPECT_EQ(checksum, 3 * kRepeatCount * (kVertexCount + kAnimationCount));
+
+  std::cout << std::format("{} vertices, {} animations, {} node animations\n", kVertexCount, kAnimationCount,
+    kAnimationCount * kTestSkeletonSize);
+  std::cout << std::format("legacy payload: {:.1f} MiB, blob: {:.1f} MiB\n",
+    static_cast<double>(legacy_bytes.size()) / (1 << 20), static_cast<double>(blob.size()) / (1 << 20));
+  std::cout << std::format("field by field parsing: {:.2f} ms\n", legacy_time);
+  std::cout << std::format("MeshView::Parse: {:.2f} ms\n", view_time);
+  std::cout << std::format("MeshView::Parse and ToMeshData: {:.2f} ms\n", materialize_time);
+}
+}
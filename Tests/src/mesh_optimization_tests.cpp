@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include "Math.hpp"
+#include "mesh_data.hpp"
+#include "mesh_optimization.hpp"
+#include "meshlet_builder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+// Mirrors MeshProcessingData of the model importer without the skinning streams
+struct TestMesh {
+  std::vector<Vector3> positions;
+  std::vector<Vector3> normals;
+  std::vector<Vector2> uvs;
+  std::vector<Vector4> tangents;
+  std::vector<unsigned> indices;
+};
+
+
+struct OptimizationSteps {
+  bool deduplicate_vertices;
+  bool optimize_vertex_cache;
+  bool optimize_vertex_fetch;
+};
+
+
+// Sphere or torus with a vertex per triangle corner and its triangles in random order,
+// like the output of an exporter that neither welds vertices nor optimizes for locality
+auto MakeUnweldedSurface(bool const torus, unsigned const ring_count, unsigned const segment_count) -> TestMesh {
+  auto const get_vertex{
+    [&](unsigned const ring, unsigned const segment) {
+      auto const u{static_cast<float>(segment) / static_cast<float>(segment_count)};
+      auto const v{static_cast<float>(ring) / static_cast<float>(ring_count)};
+      auto const phi{2 * std::numbers::pi_v<float> * u};
+
+      if (torus) {
+        auto const theta{2 * std::numbers::pi_v<float> * v};
+        Vector3 const normal{std::cos(theta) * std::cos(phi), std::sin(theta), std::cos(theta) * std::sin(phi)};
+        return std::array{normal * 0.25f + Vector3{std::cos(phi), 0.0f, std::sin(phi)}, normal, Vector3{u, v, 0.0f}};
+      }
+
+      auto const theta{std::numbers::pi_v<float> * v};
+      Vector3 const normal{std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+      return std::array{normal, normal, Vector3{u, v, 0.0f}};
+    }
+  };
+
+  std::vector<std::array<std::array<unsigned, 2>, 3>> triangles;
+
+  for (unsigned ring{0}; ring < ring_count; ring++) {
+    for (unsigned segment{0}; segment < segment_count; segment++) {
+      // Seams get their own vertices so that the texture coordinates do not wrap
+      triangles.push_back({{{ring, segment}, {ring, segment + 1}, {ring + 1, segment}}});
+      triangles.push_back({{{ring, segment + 1}, {ring + 1, segment + 1}, {ring + 1, segment}}});
+    }
+  }
+
+  std::ranges::shuffle(triangles, std::mt19937{42});
+
+  TestMesh mesh;
+
+  for (auto const& triangle : triangles) {
+    for (auto const& [ring, segment] : triangle) {
+      auto const [position, normal, uv]{get_vertex(ring, segment)};
+      mesh.indices.push_back(static_cast<unsigned>(mesh.positions.size()));
+      mesh.positions.push_back(position);
+      mesh.normals.push_back(normal);
+      mesh.uvs.emplace_back(uv[0], uv[1]);
+      mesh.tangents.emplace_back(-std::sin(2 * std::numbers::pi_v<float> * uv[0]), 0.0f,
+        std::cos(2 * std::numbers::pi_v<float> * uv[0]), 1.0f);
+    }
+  }
+
+  return mesh;
+}
+
+
+// The optimization stage of the model importer
+auto Optimize(TestMesh& mesh, OptimizationSteps const& steps) -> void {
+  auto const remap_vertices{
+    [&mesh](std::span<std::uint32_t const> const remap, std::size_t const vertex_count) {
+      RemapVertices(mesh.positions, remap, vertex_count);
+      RemapVertices(mesh.normals, remap, vertex_count);
+      RemapVertices(mesh.uvs, remap, vertex_count);
+      RemapVertices(mesh.tangents, remap, vertex_count);
+    }
+  };
+
+  std::vector<std::uint32_t> remap;
+
+  if (steps.deduplicate_vertices) {
+    std::array const streams{
+      VertexStream{std::as_bytes(std::span{mesh.positions}), sizeof(Vector3)},
+      VertexStream{std::as_bytes(std::span{mesh.normals}), sizeof(Vector3)},
+      VertexStream{std::as_bytes(std::span{mesh.uvs}), sizeof(Vector2)},
+      VertexStream{std::as_bytes(std::span{mesh.tangents}), sizeof(Vector4)}
+    };
+
+    auto const unique_count{GenerateVertexRemap(streams, mesh.positions.size(), remap)};
+    RemapIndices(mesh.indices, remap);
+    remap_vertices(remap, unique_count);
+  }
+
+  if (steps.optimize_vertex_cache) {
+    OptimizeVertexCache(mesh.indices, mesh.positions.size());
+  }
+
+  if (steps.optimize_vertex_fetch) {
+    auto const referenced_count{OptimizeVertexFetch(mesh.indices, mesh.positions.size(), remap)};
+    remap_vertices(remap, referenced_count);
+  }
+}
+}
+
+
+TEST(MeshOptimizationTest, DeduplicationWeldsIdenticalCorners) {
+  auto mesh{MakeUnweldedSurface(false, 20, 40)};
+  ASSERT_EQ(mesh.positions.size(), 20 * 40 * 6);
+
+  Optimize(mesh, {.deduplicate_vertices = true, .optimize_vertex_cache = false, .optimize_vertex_fetch = false});
+
+  EXPECT_EQ(mesh.positions.size(), 21 * 41);
+  EXPECT_EQ(mesh.normals.size(), mesh.positions.size());
+  EXPECT_TRUE(std::ranges::all_of(mesh.indices, [&mesh](unsigned const idx) { return idx < mesh.positions.size(); }));
+}
+
+
+TEST(MeshOptimizationTest, CacheOptimizationLowersAcmr) {
+  auto mesh{MakeUnweldedSurface(true, 60, 120)};
+  Optimize(mesh, {.deduplicate_vertices = true, .optimize_vertex_cache = false, .optimize_vertex_fetch = false});
+  auto const before{AnalyzeVertexCache(mesh.indices, mesh.positions.size())};
+
+  Optimize(mesh, {.deduplicate_vertices = false, .optimize_vertex_cache = true, .optimize_vertex_fetch = false});
+  auto const after{AnalyzeVertexCache(mesh.indices, mesh.positions.size())};
+
+  EXPECT_LT(after.acmr, before.acmr);
+  EXPECT_LT(after.acmr, 0.8f);
+  EXPECT_LT(after.atvr, before.atvr);
+}
+
+
+TEST(MeshOptimizationTest, FetchOptimizationOrdersVerticesByFirstUse) {
+  auto mesh{MakeUnweldedSurface(false, 20, 40)};
+  Optimize(mesh, {.deduplicate_vertices = true, .optimize_vertex_cache = true, .optimize_vertex_fetch = true});
+
+  unsigned next_vertex{0};
+
+  for (auto const idx : mesh.indices) {
+    ASSERT_LE(idx, next_vertex);
+
+    if (idx == next_vertex) {
+      next_vertex++;
+    }
+  }
+
+  EXPECT_EQ(next_vertex, mesh.positions.size());
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(MeshOptimizationTest, DISABLED_MeshletCountAndFootprintPerStep) {
+  constexpr std::array<std::pair<std::string_view, OptimizationSteps>, 4> kConfigs{
+    {
+      {"none", {false, false, false}},
+      {"dedup", {true, false, false}},
+      {"dedup+cache", {true, true, false}},
+      {"dedup+cache+fetch", {true, true, true}}
+    }
+  };
+
+  constexpr auto kVertexSize{sizeof(Vector3) + sizeof(Vector3) + sizeof(Vector2) + sizeof(Vector4)};
+
+  for (auto const torus : {false, true}) {
+    auto const source{MakeUnweldedSurface(torus, 400, 800)};
+    std::cout << std::format("Unwelded {} of {} triangles\n", torus ? "torus" : "sphere", source.indices.size() / 3);
+
+    for (auto const& [name, steps] : kConfigs) {
+      auto mesh{source};
+      Optimize(mesh, steps);
+      auto const stats{AnalyzeVertexCache(mesh.indices, mesh.positions.size())};
+
+      std::vector<MeshletData> meshlets;
+      std::vector<std::uint32_t> vertex_indices;
+      std::vector<MeshletTriangleData> triangles;
+      std::vector<MeshletCullData> cull_data;
+      ASSERT_TRUE(BuildMeshlets(mesh.indices, mesh.positions, meshlets, vertex_indices, triangles, cull_data,
+        kMeshletMaxVerts, kMeshletMaxPrims));
+
+      auto const vertex_bytes{mesh.positions.size() * kVertexSize};
+      auto const meshlet_bytes{
+        meshlets.size() * (sizeof(MeshletData) + sizeof(MeshletCullData)) +
+        vertex_indices.size() * sizeof(std::uint32_t) + triangles.size() * sizeof(MeshletTriangleData)
+      };
+
+      std::cout << std::format(
+        "{:<18} {:>8} verts ACMR {:>5.3f} ATVR {:>5.3f} {:>6} meshlets {:>5.1f} verts/meshlet "
+        "{:>6.1f} MiB vertices {:>5.1f} MiB meshlets\n",
+        name, mesh.positions.size(), stats.acmr, stats.atvr, meshlets.size(),
+        static_cast<double>(vertex_indices.size()) / static_cast<double>(meshlets.size()),
+        static_cast<double>(vertex_bytes) / (1 << 20), static_cast<double>(meshlet_bytes) / (1 << 20));
+    }
+  }
+}
+}
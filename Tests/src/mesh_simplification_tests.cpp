@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include "Math.hpp"
+#include "mesh_simplification.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+struct TestMesh {
+  std::vector<Vector3> positions;
+  std::vector<unsigned> indices;
+};
+
+
+// Height field over the unit square with a few smooth bumps, so that collapses have to move the surface
+auto MakeBumpyGrid(unsigned const quads_per_side) -> TestMesh {
+  TestMesh mesh;
+  auto const vertices_per_side{quads_per_side + 1};
+
+  for (unsigned y{0}; y < vertices_per_side; y++) {
+    for (unsigned x{0}; x < vertices_per_side; x++) {
+      auto const u{static_cast<float>(x) / static_cast<float>(quads_per_side)};
+      auto const v{static_cast<float>(y) / static_cast<float>(quads_per_side)};
+      auto const height{0.05f * std::sin(u * 9.0f) * std::cos(v * 7.0f) + 0.02f * std::sin((u + v) * 23.0f)};
+      mesh.positions.emplace_back(u, height, v);
+    }
+  }
+
+  for (unsigned y{0}; y < quads_per_side; y++) {
+    for (unsigned x{0}; x < quads_per_side; x++) {
+      auto const i0{y * vertices_per_side + x};
+      auto const i1{i0 + 1};
+      auto const i2{i0 + vertices_per_side};
+      auto const i3{i2 + 1};
+      mesh.indices.insert(mesh.indices.end(), {i0, i2, i1, i1, i2, i3});
+    }
+  }
+
+  return mesh;
+}
+
+
+auto ClosestPointOnTriangle(Vector3 const& p, Vector3 const& a, Vector3 const& b, Vector3 const& c) -> Vector3 {
+  auto const ab{b - a};
+  auto const ac{c - a};
+  auto const ap{p - a};
+
+  auto const d1{Dot(ab, ap)};
+  auto const d2{Dot(ac, ap)};
+
+  if (d1 <= 0 && d2 <= 0) {
+    return a;
+  }
+
+  auto const bp{p - b};
+  auto const d3{Dot(ab, bp)};
+  auto const d4{Dot(ac, bp)};
+
+  if (d3 >= 0 && d4 <= d3) {
+    return b;
+  }
+
+  if (auto const vc{d1 * d4 - d3 * d2}; vc <= 0 && d1 >= 0 && d3 <= 0) {
+    return a + ab * (d1 / (d1 - d3));
+  }
+
+  auto const cp{p - c};
+  auto const d5{Dot(ab, cp)};
+  auto const d6{Dot(ac, cp)};
+
+  if (d6 >= 0 && d5 <= d6) {
+    return c;
+  }
+
+  if (auto const vb{d5 * d2 - d1 * d6}; vb <= 0 && d2 >= 0 && d6 <= 0) {
+    return a + ac * (d2 / (d2 - d6));
+  }
+
+  if (auto const va{d3 * d6 - d5 * d4}; va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0) {
+    return b + (c - b) * ((d4 - d3) / (d4 - d3 + d5 - d6));
+  }
+
+  auto const denom{1.0f / (d1 * d4 - d3 * d2 + d5 * d2 - d1 * d6 + d3 * d6 - d5 * d4)};
+  auto const vb{(d5 * d2 - d1 * d6) * denom};
+  auto const vc{(d1 * d4 - d3 * d2) * denom};
+  return a + ab * vb + ac * vc;
+}
+
+
+auto DistanceToSurface(Vector3 const& point, std::span<Vector3 const> const positions,
+                       std::span<unsigned const> const indices) -> float {
+  auto min_distance{std::numeric_limits<float>::max()};
+
+  for (std::size_t i{0}; i < indices.size(); i += 3) {
+    auto const closest{
+      ClosestPointOnTriangle(point, positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]])
+    };
+    min_distance = std::min(min_distance, Distance(point, closest));
+  }
+
+  return min_distance;
+}
+
+
+// Largest distance of the original vertices from the simplified surface and of the simplified triangles' centroids
+// from the original surface
+auto MeasureDeviation(TestMesh const& mesh, std::span<unsigned const> const simplified_indices) -> float {
+  auto deviation{0.0f};
+
+  for (auto const& position : mesh.positions) {
+    deviation = std::max(deviation, DistanceToSurface(position, mesh.positions, simplified_indices));
+  }
+
+  for (std::size_t i{0}; i < simplified_indices.size(); i += 3) {
+    auto const centroid{
+      (mesh.positions[simplified_indices[i]] + mesh.positions[simplified_indices[i + 1]] + mesh.positions[
+         simplified_indices[i + 2]]) / 3.0f
+    };
+    deviation = std::max(deviation, DistanceToSurface(centroid, mesh.positions, mesh.indices));
+  }
+
+  return deviation;
+}
+}
+
+
+TEST(MeshSimplificationTest, ReportedErrorBoundsTheDeviation) {
+  auto const mesh{MakeBumpyGrid(48)};
+
+  // Simplified from the previous level like the LOD chains of the model importer, so the errors add up
+  std::vector<unsigned> prev_indices{mesh.indices};
+  auto chain_error{0.0f};
+
+  for (auto lod{1}; lod < 5; lod++) {
+    std::vector<unsigned> indices;
+    chain_error += SimplifyMesh(prev_indices, mesh.positions, prev_indices.size() / 2,
+      std::numeric_limits<float>::max(), indices);
+
+    ASSERT_LT(indices.size(), prev_indices.size());
+    EXPECT_LE(MeasureDeviation(mesh, indices), chain_error * 1.001f + 1e-5f) << "LOD " << lod;
+
+    prev_indices = std::move(indices);
+  }
+
+  EXPECT_GT(chain_error, 0);
+}
+
+
+TEST(MeshSimplificationTest, StopsAtTheErrorLimit) {
+  auto const mesh{MakeBumpyGrid(32)};
+  constexpr auto max_error{0.002f};
+
+  std::vector<unsigned> indices;
+  auto const error{SimplifyMesh(mesh.indices, mesh.positions, 0, max_error, indices)};
+
+  EXPECT_LE(error, max_error);
+  EXPECT_LT(indices.size(), mesh.indices.size());
+  EXPECT_LE(MeasureDeviation(mesh, indices), max_error * 1.001f + 1e-5f);
+}
+
+
+TEST(MeshSimplificationTest, FlatSurfacesSimplifyWithoutError) {
+  auto mesh{MakeBumpyGrid(16)};
+
+  for (auto& position : mesh.positions) {
+    position[1] = 0;
+  }
+
+  std::vector<unsigned> indices;
+  EXPECT_EQ(SimplifyMesh(mesh.indices, mesh.positions, mesh.indices.size() / 4, 0, indices), 0);
+  EXPECT_LE(indices.size(), mesh.indices.size() / 2);
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(MeshSimplificationTest, DISABLED_ThroughputOfMultiMillionTriangleMeshes) {
+  auto const mesh{MakeBumpyGrid(1500)};
+  auto const triangle_count{mesh.indices.size() / 3};
+
+  std::vector<unsigned> indices;
+  auto const start{std::chrono::steady_clock::now()};
+  auto const error{
+    SimplifyMesh(mesh.indices, mesh.positions, mesh.indices.size() / 2, std::numeric_limits<float>::max(), indices)
+  };
+  auto const duration{std::chrono::duration<double>(std::chrono::steady_clock::now() - start)};
+
+  std::cout << std::format("Simplified {} triangles to {} in {:.2f} s, {:.2f} million triangles per second, error {}.\n",
+    triangle_count, indices.size() / 3, duration.count(), static_cast<double>(triangle_count) / duration.count() / 1e6,
+    error);
+
+  EXPECT_LE(indices.size(), mesh.indices.size() / 2 + mesh.indices.size() / 10);
+}
+}
@@ -0,0 +1,371 @@
+#include <gtest/gtest.h>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <DirectXMesh.h>
+
+#include "job_system.hpp"
+#include "Math.hpp"
+#include "mesh_data.hpp"
+#include "meshlet_builder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <string_view>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+struct TestMesh {
+  std::vector<Vector3> positions;
+  std::vector<std::uint32_t> indices;
+};
+
+
+struct Meshlets {
+  std::vector<MeshletData> meshlets;
+  std::vector<std::uint32_t> vertex_indices;
+  std::vector<MeshletTriangleData> triangles;
+  std::vector<MeshletCullData> cull_data;
+};
+
+
+struct MeshletStats {
+  std::size_t meshlet_count;
+  double avg_vertex_count;
+  double avg_triangle_count;
+  // Relative to the radius of the mesh
+  double avg_sphere_radius;
+  // Share of the meshlets that the normal cones cull, averaged over viewpoints around the mesh
+  double cone_cull_rate;
+};
+
+
+// Unit sphere with its triangles in random order, like the output of a tool that does not optimize for locality
+auto MakeShuffledSphere(unsigned const ring_count, unsigned const segment_count) -> TestMesh {
+  TestMesh mesh;
+
+  for (unsigned ring{0}; ring <= ring_count; ring++) {
+    auto const theta{std::numbers::pi_v<float> * static_cast<float>(ring) / static_cast<float>(ring_count)};
+
+    for (unsigned segment{0}; segment < segment_count; segment++) {
+      auto const phi{2 * std::numbers::pi_v<float> * static_cast<float>(segment) / static_cast<float>(segment_count)};
+      mesh.positions.emplace_back(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+    }
+  }
+
+  std::vector<std::array<std::uint32_t, 3>> triangles;
+
+  for (unsigned ring{0}; ring < ring_count; ring++) {
+    for (unsigned segment{0}; segment < segment_count; segment++) {
+      auto const i0{ring * segment_count + segment};
+      auto const i1{ring * segment_count + (segment + 1) % segment_count};
+      auto const i2{i0 + segment_count};
+      auto const i3{i1 + segment_count};
+
+      // Outward facing with counter-clockwise winding
+      if (ring != 0) {
+        triangles.push_back({i0, i1, i2});
+      }
+
+      if (ring != ring_count - 1) {
+        triangles.push_back({i1, i3, i2});
+      }
+    }
+  }
+
+  std::ranges::shuffle(triangles, std::mt19937{42});
+
+  for (auto const& triangle : triangles) {
+    mesh.indices.insert(mesh.indices.end(), std::begin(triangle), std::end(triangle));
+  }
+
+  return mesh;
+}
+
+
+auto GetTriangleVertex(Meshlets const& meshlets, MeshletData const& meshlet, MeshletTriangleData const& triangle,
+                       int const corner) -> std::uint32_t {
+  auto const local_idx{corner == 0 ? triangle.idx0 : corner == 1 ? triangle.idx1 : triangle.idx2};
+  return meshlets.vertex_indices[meshlet.vert_offset + local_idx];
+}
+
+
+// Replicates the normal cone test of meshlet_culling.hlsli for an untransformed mesh
+auto IsConeCulled(MeshletCullData const& cull_data, Vector3 const& view_pos) -> bool {
+  if (cull_data.normal_cone[3] == 0xFF) {
+    return false;
+  }
+
+  Vector3 axis;
+
+  for (auto i{0}; i < 3; i++) {
+    axis[i] = static_cast<float>(cull_data.normal_cone[i]) / 255.0f * 2.0f - 1.0f;
+  }
+
+  axis = Normalized(axis);
+  auto const cutoff{static_cast<float>(cull_data.normal_cone[3]) / 255.0f};
+  auto const apex{cull_data.bounding_sphere.center - axis * cull_data.apex_offset};
+  return Dot(Normalized(view_pos - apex), -axis) > cutoff;
+}
+
+
+// Viewpoints spread over a sphere of the specified radius with a Fibonacci lattice
+auto MakeViewpoints(std::size_t const count, float const radius) -> std::vector<Vector3> {
+  std::vector<Vector3> viewpoints;
+  auto const golden_angle{std::numbers::pi_v<float> * (3.0f - std::sqrt(5.0f))};
+
+  for (std::size_t i{0}; i < count; i++) {
+    auto const y{1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / static_cast<float>(count)};
+    auto const ring_radius{std::sqrt(1.0f - y * y)};
+    auto const phi{golden_angle * static_cast<float>(i)};
+    viewpoints.emplace_back(Vector3{std::cos(phi) * ring_radius, y, std::sin(phi) * ring_radius} * radius);
+  }
+
+  return viewpoints;
+}
+
+
+// Every triangle is emitted exactly once, the limits hold, the spheres are bounding and the cones are conservative
+auto ExpectValid(TestMesh const& mesh, Meshlets const& meshlets, std::string_view const name) -> void {
+  ASSERT_EQ(meshlets.meshlets.size(), meshlets.cull_data.size()) << name;
+
+  std::vector<std::array<std::uint32_t, 3>> expected_triangles;
+  std::vector<std::array<std::uint32_t, 3>> emitted_triangles;
+
+  auto const normalize_rotation{
+    [](std::array<std::uint32_t, 3> triangle) {
+      std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+      return triangle;
+    }
+  };
+
+  for (std::size_t i{0}; i < mesh.indices.size(); i += 3) {
+    expected_triangles.push_back(normalize_rotation({mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]}));
+  }
+
+  auto const viewpoints{MakeViewpoints(64, 3)};
+
+  for (std::size_t i{0}; i < meshlets.meshlets.size(); i++) {
+    auto const& meshlet{meshlets.meshlets[i]};
+    auto const& cull_data{meshlets.cull_data[i]};
+
+    ASSERT_LE(meshlet.vert_count, kMeshletMaxVerts) << name;
+    ASSERT_LE(meshlet.prim_count, kMeshletMaxPrims) << name;
+
+    for (std::uint32_t j{0}; j < meshlet.vert_count; j++) {
+      auto const& position{mesh.positions[meshlets.vertex_indices[meshlet.vert_offset + j]]};
+      ASSERT_LE(Distance(position, cull_data.bounding_sphere.center), cull_data.bounding_sphere.radius * 1.0001f)
+        << name << " meshlet " << i;
+    }
+
+    for (std::uint32_t j{0}; j < meshlet.prim_count; j++) {
+      auto const& triangle{meshlets.triangles[meshlet.prim_offset + j]};
+      emitted_triangles.push_back(normalize_rotation({
+        GetTriangleVertex(meshlets, meshlet, triangle, 0), GetTriangleVertex(meshlets, meshlet, triangle, 1),
+        GetTriangleVertex(meshlets, meshlet, triangle, 2)
+      }));
+    }
+
+    for (auto const& viewpoint : viewpoints) {
+      if (!IsConeCulled(cull_data, viewpoint)) {
+        continue;
+      }
+
+      for (std::uint32_t j{0}; j < meshlet.prim_count; j++) {
+        auto const& triangle{meshlets.triangles[meshlet.prim_offset + j]};
+        auto const& p0{mesh.positions[GetTriangleVertex(meshlets, meshlet, triangle, 0)]};
+        auto const& p1{mesh.positions[GetTriangleVertex(meshlets, meshlet, triangle, 1)]};
+        auto const& p2{mesh.positions[GetTriangleVertex(meshlets, meshlet, triangle, 2)]};
+        ASSERT_LE(Dot(Normalized(Cross(p1 - p0, p2 - p0)), Normalized(viewpoint - p0)), 1e-3f)
+          << name << " culled a front facing triangle of meshlet " << i;
+      }
+    }
+  }
+
+  std::ranges::sort(expected_triangles);
+  std::ranges::sort(emitted_triangles);
+  EXPECT_EQ(emitted_triangles, expected_triangles) << name;
+}
+
+
+auto MeasureMeshlets(TestMesh const& mesh, Meshlets const& meshlets) -> MeshletStats {
+  MeshletStats stats{.meshlet_count = meshlets.meshlets.size()};
+
+  auto mesh_radius{0.0f};
+
+  for (auto const& position : mesh.positions) {
+    mesh_radius = std::max(mesh_radius, Length(position));
+  }
+
+  for (auto const& meshlet : meshlets.meshlets) {
+    stats.avg_vertex_count += meshlet.vert_count;
+    stats.avg_triangle_count += meshlet.prim_count;
+  }
+
+  for (auto const& cull_data : meshlets.cull_data) {
+    stats.avg_sphere_radius += cull_data.bounding_sphere.radius / mesh_radius;
+  }
+
+  auto const viewpoints{MakeViewpoints(256, 3 * mesh_radius)};
+  std::size_t culled_count{0};
+
+  for (auto const& viewpoint : viewpoints) {
+    culled_count += std::ranges::count_if(meshlets.cull_data, [&viewpoint](MeshletCullData const& cull_data) {
+      return IsConeCulled(cull_data, viewpoint);
+    });
+  }
+
+  auto const meshlet_count{static_cast<double>(stats.meshlet_count)};
+  stats.avg_vertex_count /= meshlet_count;
+  stats.avg_triangle_count /= meshlet_count;
+  stats.avg_sphere_radius /= meshlet_count;
+  stats.cone_cull_rate = static_cast<double>(culled_count) / (meshlet_count * static_cast<double>(viewpoints.size()));
+  return stats;
+}
+
+
+auto BuildWithBuilder(TestMesh const& mesh, ObserverPtr<JobSystem> const job_system = nullptr) -> Meshlets {
+  Meshlets meshlets;
+  EXPECT_TRUE(BuildMeshlets(mesh.indices, mesh.positions, meshlets.meshlets, meshlets.vertex_indices,
+    meshlets.triangles, meshlets.cull_data, kMeshletMaxVerts, kMeshletMaxPrims, job_system));
+  return meshlets;
+}
+
+
+// The meshletization that the engine used before it had its own builder
+auto BuildWithDirectXMesh(TestMesh const& mesh) -> Meshlets {
+  std::vector<DirectX::XMFLOAT3> dx_positions;
+  dx_positions.reserve(mesh.positions.size());
+
+  for (auto const& position : mesh.positions) {
+    dx_positions.emplace_back(position[0], position[1], position[2]);
+  }
+
+  std::vector<DirectX::Meshlet> dx_meshlets;
+  std::vector<std::uint8_t> unique_vertex_ib;
+  std::vector<DirectX::MeshletTriangle> dx_triangles;
+
+  EXPECT_TRUE(SUCCEEDED(
+    DirectX::ComputeMeshlets(mesh.indices.data(), mesh.indices.size() / 3, dx_positions.data(), dx_positions.size(),
+      nullptr, dx_meshlets, unique_vertex_ib, dx_triangles, kMeshletMaxVerts, kMeshletMaxPrims)));
+
+  Meshlets meshlets;
+  meshlets.vertex_indices.resize(unique_vertex_ib.size() / sizeof(std::uint32_t));
+  std::memcpy(meshlets.vertex_indices.data(), unique_vertex_ib.data(), unique_vertex_ib.size());
+
+  std::vector<DirectX::CullData> dx_cull_data(dx_meshlets.size());
+
+  EXPECT_TRUE(SUCCEEDED(
+    DirectX::ComputeCullData(dx_positions.data(), dx_positions.size(), dx_meshlets.data(), dx_meshlets.size(),
+      meshlets.vertex_indices.data(), meshlets.vertex_indices.size(), dx_triangles.data(), dx_triangles.size(),
+      dx_cull_data.data())));
+
+  for (auto const& meshlet : dx_meshlets) {
+    meshlets.meshlets.push_back(MeshletData{
+      .vert_count = meshlet.VertCount, .vert_offset = meshlet.VertOffset, .prim_count = meshlet.PrimCount,
+      .prim_offset = meshlet.PrimOffset,
+    });
+  }
+
+  for (auto const& triangle : dx_triangles) {
+    meshlets.triangles.push_back(MeshletTriangleData{.idx0 = triangle.i0, .idx1 = triangle.i1, .idx2 = triangle.i2});
+  }
+
+  for (auto const& cull_data : dx_cull_data) {
+    auto const& center{cull_data.BoundingSphere.Center};
+    meshlets.cull_data.push_back(MeshletCullData{
+      .bounding_sphere = BoundingSphere{Vector3{center.x, center.y, center.z}, cull_data.BoundingSphere.Radius},
+      .normal_cone = Vector<std::uint8_t, 4>{
+        cull_data.NormalCone.x, cull_data.NormalCone.y, cull_data.NormalCone.z, cull_data.NormalCone.w
+      },
+      .apex_offset = cull_data.ApexOffset,
+    });
+  }
+
+  return meshlets;
+}
+
+
+template<typename Func>
+auto MeasureMilliseconds(Func&& func) -> double {
+  auto const start{std::chrono::steady_clock::now()};
+  func();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+auto PrintStats(std::string_view const name, MeshletStats const& stats, double const milliseconds) -> void {
+  std::cout << std::format(
+    "{:<24} {:>9.1f} ms {:>8} meshlets {:>6.1f} verts {:>6.1f} tris {:>6.3f} sphere radius {:>5.1f}% cone culled\n",
+    name, milliseconds, stats.meshlet_count, stats.avg_vertex_count, stats.avg_triangle_count,
+    stats.avg_sphere_radius, stats.cone_cull_rate * 100);
+}
+}
+
+
+TEST(MeshletBuilderTest, ProducesValidMeshlets) {
+  auto const mesh{MakeShuffledSphere(200, 400)};
+  ExpectValid(mesh, BuildWithBuilder(mesh), "BuildMeshlets");
+}
+
+
+TEST(MeshletBuilderTest, JobSystemDoesNotChangeTheOutput) {
+  JobSystem job_system{4};
+  // Spans several partitions
+  auto const mesh{MakeShuffledSphere(300, 600)};
+
+  auto const serial{BuildWithBuilder(mesh)};
+  auto const parallel{BuildWithBuilder(mesh, ObserverPtr{&job_system})};
+
+  ASSERT_EQ(serial.meshlets.size(), parallel.meshlets.size());
+  EXPECT_EQ(serial.vertex_indices, parallel.vertex_indices);
+  ASSERT_EQ(serial.triangles.size(), parallel.triangles.size());
+
+  for (std::size_t i{0}; i < serial.meshlets.size(); i++) {
+    ASSERT_EQ(serial.meshlets[i].vert_offset, parallel.meshlets[i].vert_offset);
+    ASSERT_EQ(serial.meshlets[i].prim_offset, parallel.meshlets[i].prim_offset);
+    ASSERT_EQ(serial.cull_data[i].bounding_sphere.center, parallel.cull_data[i].bounding_sphere.center);
+    ASSERT_EQ(serial.cull_data[i].bounding_sphere.radius, parallel.cull_data[i].bounding_sphere.radius);
+    ASSERT_EQ(serial.cull_data[i].normal_cone, parallel.cull_data[i].normal_cone);
+    ASSERT_EQ(serial.cull_data[i].apex_offset, parallel.cull_data[i].apex_offset);
+  }
+
+  for (std::size_t i{0}; i < serial.triangles.size(); i++) {
+    ASSERT_EQ(serial.triangles[i].idx0, parallel.triangles[i].idx0);
+    ASSERT_EQ(serial.triangles[i].idx1, parallel.triangles[i].idx1);
+    ASSERT_EQ(serial.triangles[i].idx2, parallel.triangles[i].idx2);
+  }
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(MeshletBuilderTest, DISABLED_CompareWithDirectXMesh) {
+  JobSystem job_system;
+  auto const mesh{MakeShuffledSphere(600, 1200)};
+  std::cout << std::format("Shuffled sphere of {} triangles\n", mesh.indices.size() / 3);
+
+  Meshlets dx_meshlets;
+  auto const dx_time{MeasureMilliseconds([&] { dx_meshlets = BuildWithDirectXMesh(mesh); })};
+  ExpectValid(mesh, dx_meshlets, "DirectXMesh");
+  PrintStats("DirectXMesh", MeasureMeshlets(mesh, dx_meshlets), dx_time);
+
+  Meshlets meshlets;
+  auto const serial_time{MeasureMilliseconds([&] { meshlets = BuildWithBuilder(mesh); })};
+  ExpectValid(mesh, meshlets, "BuildMeshlets");
+  PrintStats("BuildMeshlets", MeasureMeshlets(mesh, meshlets), serial_time);
+
+  auto const parallel_time{MeasureMilliseconds([&] { meshlets = BuildWithBuilder(mesh, ObserverPtr{&job_system}); })};
+  PrintStats("BuildMeshlets parallel", MeasureMeshlets(mesh, meshlets), parallel_time);
+}
+}
@@ -0,0 +1,374 @@
+#include <gtest/gtest.h>
+
+#include "handle.hpp"
+#include "Object.hpp"
+#include "Reflection.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+class TestTexture final : public Object {
+  RTTR_ENABLE(Object)
+};
+
+
+// Reports its pointer properties like the transform parent and the material texture maps
+class TestNode final : public Object {
+  RTTR_ENABLE(Object)
+
+public:
+  [[nodiscard]] auto GetParent() const noexcept -> TestNode* {
+    return parent_;
+  }
+
+
+  auto SetParent(TestNode* const parent) -> void {
+    OnReferenceChanged(parent_, parent);
+    parent_ = parent;
+  }
+
+
+  [[nodiscard]] auto GetTexture() const noexcept -> TestTexture* {
+    return texture_;
+  }
+
+
+  auto SetTexture(TestTexture* const texture) -> void {
+    OnReferenceChanged(texture_, texture);
+    texture_ = texture;
+  }
+
+private:
+  TestNode* parent_{nullptr};
+  TestTexture* texture_{nullptr};
+};
+
+
+// Stores its texture without reporting it, destroying the texture leaves the property dangling
+class UnreportingNode final : public Object {
+  RTTR_ENABLE(Object)
+
+public:
+  [[nodiscard]] auto GetTexture() const noexcept -> TestTexture* {
+    return texture_;
+  }
+
+
+  auto SetTexture(TestTexture* const texture) -> void {
+    texture_ = texture;
+  }
+
+private:
+  TestTexture* texture_{nullptr};
+};
+}
+}
+
+
+RTTR_REGISTRATION {
+  rttr::registration::class_<sorcery::TestTexture>{"Test Texture"};
+
+  rttr::registration::class_<sorcery::TestNode>{"Test Node"}
+    .property("parent", &sorcery::TestNode::GetParent, &sorcery::TestNode::SetParent)
+    .property("texture", &sorcery::TestNode::GetTexture, &sorcery::TestNode::SetTexture);
+
+  rttr::registration::class_<sorcery::UnreportingNode>{"Unreporting Node"}
+    .property("texture", &sorcery::UnreportingNode::GetTexture, &sorcery::UnreportingNode::SetTexture);
+}
+
+
+namespace sorcery {
+namespace {
+constexpr std::size_t kSharedTextureCount{16};
+
+
+// Textures first, then nodes forming a tree with four children per node, each node sampling one of the textures
+auto MakeScene(std::size_t const object_count) -> std::vector<std::unique_ptr<Object>> {
+  std::vector<std::unique_ptr<Object>> objects;
+  objects.reserve(object_count);
+
+  std::vector<TestTexture*> textures;
+
+  for (std::size_t i{0}; i < kSharedTextureCount; i++) {
+    textures.emplace_back(static_cast<TestTexture*>(objects.emplace_back(std::make_unique<TestTexture>()).get()));
+  }
+
+  std::vector<TestNode*> nodes;
+
+  for (std::size_t i{0}; objects.size() < object_count; i++) {
+    auto const node{static_cast<TestNode*>(objects.emplace_back(std::make_unique<TestNode>()).get())};
+    node->SetParent(i == 0 ? nullptr : nodes[(i - 1) / 4]);
+    node->SetTexture(textures[i % textures.size()]);
+    nodes.emplace_back(node);
+  }
+
+  return objects;
+}
+
+
+// What Object::~Object did before the reverse-reference index: visit every pointer property of every live object
+auto NullReferencesByScanning(std::span<std::unique_ptr<Object> const> const live_objects, Object const* const target)
+  -> void {
+  for (auto const& obj : live_objects) {
+    if (obj.get() == target) {
+      continue;
+    }
+
+    for (auto const prop : rttr::type::get(*obj).get_properties()) {
+      if (prop.get_type().is_pointer()) {
+        if (prop.get_value(*obj).get_value<Object*>() == target) {
+          [[maybe_unused]] auto const success{prop.set_value(*obj, nullptr)};
+          assert(success);
+        }
+      }
+    }
+  }
+}
+
+
+// Destroys the objects in creation order, the order in which a scene releases them
+auto MeasureTeardown(std::vector<std::unique_ptr<Object>> objects, bool const scan_all_objects) -> double {
+  auto const start{std::chrono::steady_clock::now()};
+
+  for (std::size_t i{0}; i < objects.size(); i++) {
+    if (scan_all_objects) {
+      NullReferencesByScanning(std::span{objects}.subspan(i), objects[i].get());
+    }
+
+    objects[i].reset();
+  }
+
+  return std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - start}.count();
+}
+}
+
+
+TEST(ObjectTest, DestroyingATargetNullsItsReferrers) {
+  auto const texture{std::make_unique<TestTexture>()};
+  auto parent{std::make_unique<TestNode>()};
+  auto texture_to_destroy{std::make_unique<TestTexture>()};
+  TestNode node;
+
+  node.SetParent(parent.get());
+  node.SetTexture(texture_to_destroy.get());
+  EXPECT_TRUE(parent->IsReferenced());
+  EXPECT_TRUE(texture_to_destroy->IsReferenced());
+
+  texture_to_destroy.reset();
+  EXPECT_EQ(node.GetTexture(), nullptr);
+  EXPECT_EQ(node.GetParent(), parent.get());
+
+  parent.reset();
+  EXPECT_EQ(node.GetParent(), nullptr);
+
+  node.SetTexture(texture.get());
+  EXPECT_TRUE(texture->IsReferenced());
+  node.SetTexture(nullptr);
+  EXPECT_FALSE(texture->IsReferenced());
+}
+
+
+TEST(ObjectTest, ReplacedReferencesAreNotNulled) {
+  auto first{std::make_unique<TestTexture>()};
+  auto const second{std::make_unique<TestTexture>()};
+  TestNode node;
+
+  node.SetTexture(first.get());
+  node.SetTexture(second.get());
+  EXPECT_FALSE(first->IsReferenced());
+
+  first.reset();
+  EXPECT_EQ(node.GetTexture(), second.get());
+}
+
+
+TEST(ObjectTest, DestroyedReferrersAreForgotten) {
+  auto const texture{std::make_unique<TestTexture>()};
+
+  {
+    TestNode node;
+    node.SetTexture(texture.get());
+    EXPECT_TRUE(texture->IsReferenced());
+  }
+
+  EXPECT_FALSE(texture->IsReferenced());
+}
+
+
+TEST(ObjectTest, ReusedSlotsStartUnreferenced) {
+  auto texture{std::make_unique<TestTexture>()};
+  TestNode node;
+  node.SetTexture(texture.get());
+
+  // Nulling the texture map counts down the reference while the texture is being destroyed
+  texture.reset();
+  ASSERT_EQ(node.GetTexture(), nullptr);
+
+  // Slots are reused last released first
+  auto const reusing_object{std::make_unique<TestTexture>()};
+  EXPECT_FALSE(reusing_object->IsReferenced());
+
+  node.SetTexture(reusing_object.get());
+  EXPECT_TRUE(reusing_object->IsReferenced());
+  node.SetTexture(nullptr);
+  EXPECT_FALSE(reusing_object->IsReferenced());
+}
+
+
+TEST(ObjectTest, HandlesToDestroyedObjectsDoNotCountTowardsTheReusingObject) {
+  auto texture{std::make_unique<TestTexture>()};
+  Handle<TestTexture> const handle{texture.get()};
+  EXPECT_TRUE(texture->IsReferenced());
+
+  texture.reset();
+  auto const reusing_object{std::make_unique<TestTexture>()};
+  EXPECT_EQ(handle.Get(), nullptr);
+
+  {
+    auto const copy{handle};
+    EXPECT_FALSE(reusing_object->IsReferenced());
+  }
+
+  EXPECT_FALSE(reusing_object->IsReferenced());
+}
+
+
+TEST(ObjectTest, HandlesCanBeReleasedWhileTheirTargetIsDestroyed) {
+  for (auto i{0}; i < 200; i++) {
+    auto texture{std::make_unique<TestTexture>()};
+    Handle<TestTexture> const handle{texture.get()};
+    std::atomic_flag start;
+
+    // Resolves, copies and drops handles like render and load jobs do
+    std::jthread pinning_thread{
+      [&handle, &start] {
+        start.wait(false);
+
+        for (auto j{0}; j < 1000; j++) {
+          auto const copy{handle};
+          [[maybe_unused]] auto const object{copy.Get()};
+        }
+      }
+    };
+
+    start.test_and_set();
+    start.notify_one();
+    texture.reset();
+
+    auto const reusing_object{std::make_unique<TestTexture>()};
+    pinning_thread.join();
+    ASSERT_FALSE(reusing_object->IsReferenced()) << i;
+  }
+}
+
+
+TEST(ObjectTest, UnreportedPointerPropertiesFailInDebugBuilds) {
+  EXPECT_DEBUG_DEATH({
+    auto texture{std::make_unique<TestTexture>()};
+    UnreportingNode node;
+    node.SetTexture(texture.get());
+    texture.reset();
+  }, "");
+}
+
+
+TEST(ObjectTest, SceneTeardownNullsEveryReference) {
+  auto objects{MakeScene(1000)};
+  std::vector<TestNode*> nodes;
+
+  for (auto const& obj : std::span{objects}.subspan(kSharedTextureCount)) {
+    nodes.emplace_back(static_cast<TestNode*>(obj.get()));
+  }
+
+  // Drops the textures and every other node, the remaining nodes must not point to any of them
+  for (std::size_t i{0}; i < objects.size(); i++) {
+    if (i < kSharedTextureCount || i % 2 == 0) {
+      objects[i].reset();
+    }
+  }
+
+  for (std::size_t i{1}; i < nodes.size(); i++) {
+    if (objects[kSharedTextureCount + i]) {
+      EXPECT_EQ(nodes[i]->GetTexture(), nullptr) << i;
+
+      auto const parent_alive{objects[kSharedTextureCount + (i - 1) / 4] != nullptr};
+      EXPECT_EQ(nodes[i]->GetParent(), parent_alive ? nodes[(i - 1) / 4] : nullptr) << i;
+    }
+  }
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(ObjectTest, DISABLED_TeardownOfLargeScenes) {
+  for (std::size_t const object_count : {5'000, 20'000, 50'000}) {
+    auto const scan_ms{MeasureTeardown(MakeScene(object_count), true)};
+    auto const index_ms{MeasureTeardown(MakeScene(object_count), false)};
+
+    std::cout << std::format("Destroyed {} objects in {:.1f} ms by scanning all objects, in {:.1f} ms through the "
+                             "reverse-reference index.\n", object_count, scan_ms, index_ms);
+  }
+}
+
+
+// Run with --gtest_also_run_disabled_tests, in release builds as the debug reference check makes the teardown quadratic
+TEST(ObjectTest, DISABLED_HandleResolutionVersusPointerDereference) {
+  constexpr std::size_t kObjectCount{100'000};
+  constexpr int kRepeatCount{20};
+
+  std::vector<std::unique_ptr<TestTexture>> textures;
+  textures.reserve(kObjectCount);
+
+  for (std::size_t i{0}; i < kObjectCount; i++) {
+    textures.emplace_back(std::make_unique<TestTexture>())->SetName(std::string(i % 16, 'x'));
+  }
+
+  // Visit the objects in a random order so that neither the objects nor the slots are walked linearly
+  std::ranges::shuffle(textures, std::mt19937{42});
+
+  std::vector<TestTexture*> pointers;
+  std::vector<Handle<TestTexture>> handles;
+
+  for (auto const& texture : textures) {
+    pointers.emplace_back(texture.get());
+    handles.emplace_back(texture.get());
+  }
+
+  auto const measure{
+    [](auto const& refs) {
+      std::size_t checksum{0};
+      auto const start{std::chrono::steady_clock::now()};
+
+      for (auto i{0}; i < kRepeatCount; i++) {
+        for (auto const& ref : refs) {
+          checksum += ref->GetName().size();
+        }
+      }
+
+      auto const ns{std::chrono::duration<double, std::nano>{std::chrono::steady_clock::now() - start}.count()};
+      return std::pair{ns / (kRepeatCount * refs.size()), checksum};
+    }
+  };
+
+  auto const [pointer_ns, pointer_checksum]{measure(pointers)};
+  auto const [handle_ns, handle_checksum]{measure(handles)};
+  EXPECT_EQ(pointer_checksum, handle_checksum);
+
+  std::cout << std::format("Accessed {} objects in {:.2f} ns per pointer dereference, in {:.2f} ns per handle "
+                           "resolution.\n", kObjectCount, pointer_ns, handle_ns);
+}
+}
@@ -0,0 +1,508 @@
+#include <gtest/gtest.h>
+
+#include "job_system.hpp"
+#include "handle.hpp"
+#include "job_task.hpp"
+#include "resource_manager.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+class FakeResource final : public Resource {
+public:
+  explicit FakeResource(std::size_t const cpu_bytes) :
+    cpu_bytes_{cpu_bytes} {}
+
+
+  [[nodiscard]] auto GetCpuMemoryUsage() const noexcept -> std::size_t override {
+    return cpu_bytes_;
+  }
+
+private:
+  std::size_t cpu_bytes_;
+};
+
+
+// Stands in for the file system: every load blocks an I/O thread for a while before it produces a resource
+class DelayedResourceLoader final : public ResourceLoader {
+public:
+  explicit DelayedResourceLoader(std::chrono::microseconds const delay) :
+    delay_{delay} {}
+
+
+  auto Load(std::shared_ptr<ResourceLoadRequest> request,
+            std::filesystem::path const path_abs) -> Task<MaybeNull<std::unique_ptr<Resource>>> override {
+    auto const res_id{request->GetId()};
+
+    co_await RunLoadIo(std::move(request), [this] {
+      std::this_thread::sleep_for(delay_);
+      return true;
+    });
+
+    load_count_.fetch_add(1, std::memory_order_relaxed);
+
+    // Odd indices stand for missing or corrupt files
+    if (fail_odd_indices_ && res_id.GetIdxInFile() % 2 != 0) {
+      co_return nullptr;
+    }
+
+    co_return std::make_unique<FakeResource>(kFakeResourceSize);
+  }
+
+
+  [[nodiscard]] auto GetLoadCount() const noexcept -> int {
+    return load_count_.load(std::memory_order_relaxed);
+  }
+
+
+  auto FailOddIndices() noexcept -> void {
+    fail_odd_indices_ = true;
+  }
+
+
+  constexpr static std::size_t kFakeResourceSize{1024};
+
+private:
+  std::chrono::microseconds delay_;
+  std::atomic<int> load_count_{0};
+  bool fail_odd_indices_{false};
+};
+
+
+auto MapFakeResources(ResourceManager& resource_manager, int const count) -> std::vector<ResourceId> {
+  auto const guid{Guid::Generate()};
+
+  std::vector<ResourceId> ids;
+  std::map<ResourceId, ResourceManager::ResourceDescription> res_mappings;
+
+  for (auto i{0}; i < count; i++) {
+    ids.emplace_back(guid, i);
+    res_mappings.emplace(ids.back(), ResourceManager::ResourceDescription{
+      std::format("Fake {}", i), rttr::type::get<Resource>()
+    });
+  }
+
+  resource_manager.UpdateMappings(std::move(res_mappings), {{guid, "fake.bin"}});
+  return ids;
+}
+
+
+// The loaded-resource table before sharding: one reader-writer lock over an ordered tree
+class SingleLockResourceTable {
+public:
+  auto Find(ResourceId const& res_id) -> Resource* {
+    std::shared_lock const lock{mutex_};
+    auto const it{resources_.find(res_id)};
+    return it != std::end(resources_) ? it->second.get() : nullptr;
+  }
+
+
+  auto Add(std::unique_ptr<Resource> resource) -> void {
+    std::unique_lock const lock{mutex_};
+    auto const res_id{resource->GetId()};
+    resources_.try_emplace(res_id, std::move(resource));
+  }
+
+
+  auto Remove(ResourceId const& res_id) -> std::unique_ptr<Resource> {
+    std::unique_lock const lock{mutex_};
+    auto node{resources_.extract(res_id)};
+    return node ? std::move(node.mapped()) : nullptr;
+  }
+
+private:
+  std::shared_mutex mutex_;
+  std::map<ResourceId, std::unique_ptr<Resource>> resources_;
+};
+
+
+auto MakeFakeResource(ResourceId const& res_id) -> std::unique_ptr<Resource> {
+  auto resource{std::make_unique<FakeResource>(DelayedResourceLoader::kFakeResourceSize)};
+  resource->SetId(res_id);
+  return resource;
+}
+}
+
+
+TEST(ResourceManagerTest, RequestLoadDoesNotStallTheCallingThread) {
+  constexpr auto resource_count{1000};
+  constexpr std::chrono::milliseconds delay{2};
+
+  JobSystem job_system;
+  auto loader{std::make_unique<DelayedResourceLoader>(delay)};
+  auto const& loader_ref{*loader};
+  ResourceManager resource_manager{job_system, std::move(loader)};
+  auto const ids{MapFakeResources(resource_manager, resource_count)};
+
+  std::vector<ResourceHandle<>> handles;
+  handles.reserve(ids.size());
+
+  std::chrono::steady_clock::duration total_stall{0};
+  std::chrono::steady_clock::duration max_stall{0};
+
+  for (auto const& id : ids) {
+    auto const start{std::chrono::steady_clock::now()};
+    handles.emplace_back(resource_manager.RequestLoad(id));
+    auto const stall{std::chrono::steady_clock::now() - start};
+
+    total_stall += stall;
+    max_stall = std::max(max_stall, stall);
+  }
+
+  std::cout << std::format("Requesting {} loads stalled the calling thread for {} in total, {} at most per call.\n",
+    resource_count, std::chrono::duration_cast<std::chrono::microseconds>(total_stall),
+    std::chrono::duration_cast<std::chrono::microseconds>(max_stall));
+
+  // Loading synchronously would block for the delay of every single resource
+  EXPECT_LT(total_stall, resource_count * delay / 20);
+
+  for (auto const& handle : handles) {
+    handle.Wait();
+    ASSERT_TRUE(handle.IsReady());
+  }
+
+  EXPECT_EQ(loader_ref.GetLoadCount(), resource_count);
+}
+
+
+TEST(ResourceManagerTest, ConcurrentRequestsShareOneLoad) {
+  JobSystem job_system;
+  auto loader{std::make_unique<DelayedResourceLoader>(std::chrono::milliseconds{20})};
+  auto const& loader_ref{*loader};
+  ResourceManager resource_manager{job_system, std::move(loader)};
+  auto const ids{MapFakeResources(resource_manager, 1)};
+
+  auto const first{resource_manager.RequestLoad(ids[0])};
+  auto const second{resource_manager.RequestLoad(ids[0])};
+  EXPECT_TRUE(second.IsPending());
+
+  EXPECT_NE(first.Wait(), nullptr);
+  EXPECT_EQ(second.Wait(), first.Get());
+  EXPECT_EQ(loader_ref.GetLoadCount(), 1);
+
+  // Loaded resources complete new requests immediately
+  auto const third{resource_manager.RequestLoad(ids[0])};
+  EXPECT_TRUE(third.IsReady());
+  EXPECT_EQ(third.Get(), first.Get());
+  EXPECT_EQ(loader_ref.GetLoadCount(), 1);
+}
+
+
+TEST(ResourceManagerTest, FailedLoadsFailTheirRequests) {
+  JobSystem job_system;
+  auto loader{std::make_unique<DelayedResourceLoader>(std::chrono::microseconds{100})};
+  loader->FailOddIndices();
+  ResourceManager resource_manager{job_system, std::move(loader)};
+  auto const ids{MapFakeResources(resource_manager, 2)};
+
+  auto const loaded{resource_manager.RequestLoad(ids[0])};
+  auto const failed{resource_manager.RequestLoad(ids[1])};
+  auto const unmapped{resource_manager.RequestLoad(ResourceId{Guid::Generate(), 0})};
+
+  EXPECT_NE(loaded.Wait(), nullptr);
+  EXPECT_EQ(failed.Wait(), nullptr);
+  EXPECT_TRUE(failed.IsFailed());
+  EXPECT_TRUE(unmapped.IsFailed());
+
+  EXPECT_TRUE(resource_manager.IsLoaded(ids[0]));
+  EXPECT_FALSE(resource_manager.IsLoaded(ids[1]));
+}
+
+
+TEST(ResourceManagerTest, AwaitingAHandleResumesOnceTheLoadCompletes) {
+  JobSystem job_system;
+  ResourceManager resource_manager{
+    job_system, std::make_unique<DelayedResourceLoader>(std::chrono::milliseconds{5})
+  };
+  auto const ids{MapFakeResources(resource_manager, 8)};
+
+  auto const load_all{
+    [&]() -> Task<int> {
+      std::vector<ResourceHandle<>> handles;
+
+      for (auto const& id : ids) {
+        handles.emplace_back(resource_manager.RequestLoad(id));
+      }
+
+      auto loaded_count{0};
+
+      for (auto const& handle : handles) {
+        if (co_await handle) {
+          loaded_count += 1;
+        }
+      }
+
+      co_return loaded_count;
+    }
+  };
+
+  EXPECT_EQ(SyncWait(job_system, load_all()), 8);
+}
+
+
+TEST(ResourceManagerTest, WaitingRunsTheLoadAheadOfHigherPriorityJobs) {
+  // Without compute workers the queued jobs only run when the test thread executes them
+  JobSystem job_system{1};
+  ResourceManager resource_manager{job_system, std::make_unique<DelayedResourceLoader>(std::chrono::milliseconds{1})};
+  auto const ids{MapFakeResources(resource_manager, 1)};
+
+  auto const handle{resource_manager.RequestLoad(ids[0])};
+
+  constexpr auto job_count{100};
+  std::atomic<int> executed_count{0};
+
+  for (auto i{0}; i < job_count; i++) {
+    job_system.Run(job_system.CreateJob([&executed_count] {
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      executed_count.fetch_add(1, std::memory_order_relaxed);
+    }));
+  }
+
+  // The background step of the load would otherwise only run after every normal priority job
+  EXPECT_NE(handle.Wait(), nullptr);
+  EXPECT_LT(executed_count.load(), job_count / 2);
+
+  while (job_system.TryExecuteOneJob()) {}
+  EXPECT_EQ(executed_count.load(), job_count);
+}
+
+
+TEST(ResourceManagerTest, EvictionSparesHeldResources) {
+  constexpr auto resource_count{16};
+
+  JobSystem job_system;
+  ResourceManager resource_manager{job_system, std::make_unique<DelayedResourceLoader>(std::chrono::microseconds{0})};
+  auto const ids{MapFakeResources(resource_manager, resource_count)};
+
+  // 0-3 are held through their requests, 4-7 through object handles, 8 was handed out by GetOrLoad
+  std::vector<ResourceHandle<>> held_requests;
+  std::vector<Handle<Resource>> held_handles;
+
+  for (auto i{0}; i < resource_count; i++) {
+    if (i == 8) {
+      ASSERT_NE(resource_manager.GetOrLoad(ids[i]), nullptr);
+      continue;
+    }
+
+    auto const request{resource_manager.RequestLoad(ids[i])};
+    auto const res{request.Wait()};
+    ASSERT_NE(res, nullptr);
+
+    if (i < 4) {
+      held_requests.emplace_back(request);
+    } else if (i < 8) {
+      held_handles.emplace_back(res);
+    }
+  }
+
+  // The working set is four times the budget
+  resource_manager.SetMemoryBudget({.cpu_bytes = resource_count / 4 * DelayedResourceLoader::kFakeResourceSize});
+
+  // The first call only takes the second chance of the recently loaded resources
+  resource_manager.EnforceMemoryBudget();
+  resource_manager.EnforceMemoryBudget();
+
+  for (auto i{0}; i < resource_count; i++) {
+    EXPECT_EQ(resource_manager.IsLoaded(ids[i]), i <= 8) << i;
+  }
+
+  for (auto const& request : held_requests) {
+    EXPECT_NE(request.Get(), nullptr);
+  }
+
+  for (auto const& handle : held_handles) {
+    EXPECT_NE(handle.Get(), nullptr);
+  }
+
+  EXPECT_EQ(resource_manager.GetCacheStats().eviction_count, 7);
+
+  held_requests.clear();
+  held_handles.clear();
+
+  resource_manager.EnforceMemoryBudget();
+  resource_manager.EnforceMemoryBudget();
+
+  // Only the GetOrLoad pointer is still unaccounted for
+  EXPECT_TRUE(resource_manager.IsLoaded(ids[8]));
+  EXPECT_EQ(resource_manager.GetCacheStats().eviction_count, 12);
+  EXPECT_EQ(resource_manager.GetCacheStats().cpu_bytes, resource_count / 4 * DelayedResourceLoader::kFakeResourceSize);
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(ResourceManagerTest, DISABLED_CoroutineAndBlockingLoadsOfLargeScenes) {
+  constexpr auto kResourceCount{5000};
+  constexpr std::chrono::microseconds kDelay{200};
+  constexpr std::size_t kFrameElementCount{100'000};
+
+  using Clock = std::chrono::steady_clock;
+
+  JobSystem job_system;
+  std::vector<float> frame_data(kFrameElementCount);
+
+  // Keeps rendering frames on the job system while the loads are in flight, returns the average frame time
+  auto const render_frames_until{
+    [&job_system, &frame_data](auto&& is_done) {
+      auto frame_count{0};
+      auto const start{Clock::now()};
+
+      while (!is_done()) {
+        job_system.ParallelFor(0, frame_data.size(), [&frame_data](std::size_t const idx) {
+          frame_data[idx] = std::sqrt(frame_data[idx] + static_cast<float>(idx));
+        });
+        frame_count += 1;
+      }
+
+      auto const elapsed{std::chrono::duration<double, std::milli>{Clock::now() - start}.count()};
+      return std::pair{elapsed, frame_count > 0 ? elapsed / frame_count : 0.0};
+    }
+  };
+
+  // Loads block an I/O thread and resume their coroutines on the compute workers
+  auto loader{std::make_unique<DelayedResourceLoader>(kDelay)};
+  auto const& loader_ref{*loader};
+  ResourceManager resource_manager{job_system, std::move(loader)};
+  auto const ids{MapFakeResources(resource_manager, kResourceCount)};
+
+  std::vector<ResourceHandle<>> handles;
+  handles.reserve(ids.size());
+
+  for (auto const& id : ids) {
+    handles.emplace_back(resource_manager.RequestLoad(id));
+  }
+
+  auto const [coroutine_ms, coroutine_frame_ms]{
+    render_frames_until([&loader_ref] {
+      return loader_ref.GetLoadCount() == kResourceCount;
+    })
+  };
+
+  for (auto const& handle : handles) {
+    ASSERT_NE(handle.Wait(), nullptr);
+  }
+
+  // What the loads did before: one compute job per resource that blocks its worker for the whole read
+  std::vector<std::unique_ptr<Resource>> blocking_resources(kResourceCount);
+  std::atomic<int> blocking_load_count{0};
+
+  for (auto i{0}; i < kResourceCount; i++) {
+    job_system.Run(job_system.CreateJob([&blocking_resources, &blocking_load_count, i, kDelay] {
+      std::this_thread::sleep_for(kDelay);
+      blocking_resources[i] = std::make_unique<FakeResource>(DelayedResourceLoader::kFakeResourceSize);
+      blocking_load_count.fetch_add(1, std::memory_order_release);
+    }));
+  }
+
+  auto const [blocking_ms, blocking_frame_ms]{
+    render_frames_until([&blocking_load_count] {
+      return blocking_load_count.load(std::memory_order_acquire) == kResourceCount;
+    })
+  };
+
+  std::cout << std::format("Loaded {} resources in {:.1f} ms through coroutines, {:.3f} ms per frame meanwhile.\n",
+    kResourceCount, coroutine_ms, coroutine_frame_ms);
+  std::cout << std::format("Loaded {} resources in {:.1f} ms through blocking jobs, {:.3f} ms per frame meanwhile.\n",
+    kResourceCount, blocking_ms, blocking_frame_ms);
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(ResourceManagerTest, DISABLED_ContendedLookupsAndInserts) {
+  constexpr auto kResourceCount{10'000};
+  constexpr auto kOperationsPerThread{200'000};
+  // One in this many operations inserts a resource and removes the one the thread inserted before
+  constexpr auto kInsertInterval{20};
+
+  JobSystem job_system;
+  auto const guid{Guid::Generate()};
+
+  for (auto const thread_count : {1, 2, 4, 8, 16, 32}) {
+    auto const measure{
+      [thread_count, &guid](auto&& find, auto&& add, auto&& remove) {
+        std::atomic<bool> go{false};
+        std::vector<std::jthread> threads;
+
+        for (auto thread_idx{0}; thread_idx < thread_count; thread_idx++) {
+          threads.emplace_back([&, thread_idx] {
+            std::mt19937 gen{static_cast<std::uint32_t>(thread_idx)};
+            std::uniform_int_distribution<int> idx_dist{0, kResourceCount - 1};
+            // Every thread inserts into its own id range above the preloaded resources
+            auto next_insert_idx{kResourceCount + thread_idx * kOperationsPerThread};
+            std::optional<ResourceId> inserted;
+
+            while (!go.load(std::memory_order_acquire)) {}
+
+            for (auto op{0}; op < kOperationsPerThread; op++) {
+              if (op % kInsertInterval == 0) {
+                if (inserted) {
+                  remove(*inserted);
+                }
+
+                inserted.emplace(guid, next_insert_idx++);
+                add(MakeFakeResource(*inserted));
+              } else {
+                EXPECT_NE(find(ResourceId{guid, idx_dist(gen)}), nullptr);
+              }
+            }
+          });
+        }
+
+        auto const start{std::chrono::steady_clock::now()};
+        go.store(true, std::memory_order_release);
+        threads.clear();
+
+        return static_cast<double>(thread_count * kOperationsPerThread) /
+               std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - start}.count();
+      }
+    };
+
+    ResourceManager resource_manager{job_system};
+    SingleLockResourceTable single_lock_table;
+
+    for (auto i{0}; i < kResourceCount; i++) {
+      resource_manager.Add(MakeFakeResource(ResourceId{guid, i}));
+      single_lock_table.Add(MakeFakeResource(ResourceId{guid, i}));
+    }
+
+    auto const sharded_ops_per_ms{
+      measure([&](ResourceId const& res_id) {
+        return resource_manager.GetOrLoad(res_id);
+      }, [&](std::unique_ptr<Resource> resource) {
+        resource_manager.Add(std::move(resource));
+      }, [&](ResourceId const& res_id) {
+        [[maybe_unused]] auto const removed{resource_manager.Remove(res_id)};
+      })
+    };
+
+    auto const single_lock_ops_per_ms{
+      measure([&](ResourceId const& res_id) {
+        return single_lock_table.Find(res_id);
+      }, [&](std::unique_ptr<Resource> resource) {
+        single_lock_table.Add(std::move(resource));
+      }, [&](ResourceId const& res_id) {
+        [[maybe_unused]] auto const removed{single_lock_table.Remove(res_id)};
+      })
+    };
+
+    std::cout << std::format("{} threads: {:.0f} ops/ms through the sharded table, {:.0f} ops/ms through one lock\n",
+      thread_count, sharded_ops_per_ms, single_lock_ops_per_ms);
+  }
+}
+}
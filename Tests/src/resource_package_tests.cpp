@@ -0,0 +1,673 @@
+#include <gtest/gtest.h>
+
+#include "job_system.hpp"
+#include "resource_package.hpp"
+#include "resources/Mesh.hpp"
+#include "resources/Texture2D.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+
+
+namespace sorcery {
+namespace {
+// Removes the package file once the test is done with it. Views of it have to be released first.
+class TemporaryPackageFile {
+public:
+  TemporaryPackageFile(std::string_view const file_name, std::span<std::byte const> const bytes) :
+    path_{std::filesystem::temp_directory_path() / file_name} {
+    std::ofstream{path_, std::ios::binary}.write(reinterpret_cast<char const*>(bytes.data()),
+      static_cast<std::streamsize>(bytes.size()));
+  }
+
+
+  TemporaryPackageFile(TemporaryPackageFile const&) = delete;
+  TemporaryPackageFile(TemporaryPackageFile&&) = delete;
+
+
+  ~TemporaryPackageFile() {
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+  }
+
+
+  auto operator=(TemporaryPackageFile const&) -> void = delete;
+  auto operator=(TemporaryPackageFile&&) -> void = delete;
+
+
+  [[nodiscard]] auto GetPath() const noexcept -> std::filesystem::path const& {
+    return path_;
+  }
+
+private:
+  std::filesystem::path path_;
+};
+
+
+struct TestImport {
+  ResourceImportResult import_result;
+  ResourceRuntimeType runtime_type;
+};
+
+
+// Small and large, compressible and incompressible payloads, plus one name shared by two runtime types
+auto MakeImports() -> std::vector<TestImport> {
+  std::vector<TestImport> imports;
+  std::mt19937 gen{11};
+
+  auto const add_import{
+    [&imports](std::string name, bool const is_mesh, std::vector<std::byte> bytes) {
+      imports.emplace_back(ResourceImportResult{
+        .payload_kind = is_mesh ? ResourcePackagePayloadKind::kMesh : ResourcePackagePayloadKind::kTexture,
+        .runtime_type = is_mesh ? rttr::type::get<Mesh>() : rttr::type::get<Texture2D>(),
+        .name = std::move(name),
+        .bytes = std::move(bytes)
+      }, is_mesh ? ResourceRuntimeType::kMesh : ResourceRuntimeType::kTexture2D);
+    }
+  };
+
+  for (auto const size : {std::size_t{0}, std::size_t{100}, std::size_t{70'000}, std::size_t{600'000}}) {
+    std::vector<std::byte> repeating_bytes(size);
+
+    for (std::size_t i{0}; i < size; i++) {
+      repeating_bytes[i] = static_cast<std::byte>(i % 7 * 31);
+    }
+
+    std::vector<std::byte> random_bytes(size);
+    std::uniform_int_distribution<int> byte_dist{0, 255};
+
+    for (auto& byte : random_bytes) {
+      byte = static_cast<std::byte>(byte_dist(gen));
+    }
+
+    add_import(std::format("repeating_{}", size), size % 2 == 0, std::move(repeating_bytes));
+    add_import(std::format("random_{}", size), size % 2 != 0, std::move(random_bytes));
+  }
+
+  add_import("shared_name", true, std::vector(300, std::byte{1}));
+  add_import("shared_name", false, std::vector(500, std::byte{2}));
+  return imports;
+}
+
+
+auto PackImports(std::span<TestImport const> const imports, JobSystem& job_system,
+                 ResourcePackageCodec const codec) -> std::vector<std::byte> {
+  std::vector<ResourceImportResult> import_results;
+
+  for (auto const& import : imports) {
+    import_results.emplace_back(import.import_result);
+  }
+
+  auto package_bytes{PackBinaryResourcePackage(import_results, job_system, codec)};
+  EXPECT_TRUE(package_bytes);
+  return package_bytes ? std::move(*package_bytes) : std::vector<std::byte>{};
+}
+
+
+// Rewrites the header and entry table of an uncompressed latest version package in the layout of an older version.
+// The older tables are smaller, so the names, the lookup table and the payloads stay where the entries point.
+auto DowngradePackage(std::vector<std::byte> package_bytes, std::uint32_t const version) -> std::vector<std::byte> {
+  auto const entries{UnpackBinaryResourcePackageEntries(package_bytes)};
+  EXPECT_TRUE(entries);
+
+  std::uint32_t lookup_bucket_count;
+  std::uint64_t lookup_table_offset;
+  std::memcpy(&lookup_bucket_count, package_bytes.data() + 3 * sizeof(std::uint32_t), sizeof(lookup_bucket_count));
+  std::memcpy(&lookup_table_offset, package_bytes.data() + 4 * sizeof(std::uint32_t), sizeof(lookup_table_offset));
+
+  std::size_t offset{0};
+
+  auto const write{
+    [&package_bytes, &offset](auto const value) {
+      std::memcpy(package_bytes.data() + offset, &value, sizeof(value));
+      offset += sizeof(value);
+    }
+  };
+
+  write(resource_package::kMagic);
+  write(version);
+  write(static_cast<std::uint32_t>(entries ? entries->size() : 0));
+
+  if (version >= 2) {
+    write(lookup_bucket_count);
+    write(lookup_table_offset);
+  }
+
+  for (auto const& entry : entries ? *entries : std::vector<resource_package::Entry>{}) {
+    EXPECT_EQ(entry.codec, ResourcePackageCodec::kNone);
+    write(entry.payload_kind);
+    write(entry.runtime_type);
+    write(entry.name_offset);
+    write(entry.name_size);
+    write(entry.data_offset);
+    write(entry.data_size);
+
+    if (version >= 2) {
+      write(entry.name_hash);
+      write(entry.checksum);
+    }
+  }
+
+  return package_bytes;
+}
+
+
+auto ExpectMatchesImports(ResourcePackageView const& view, std::span<TestImport const> const imports) -> void {
+  ASSERT_EQ(view.GetEntryCount(), imports.size());
+
+  for (std::size_t i{0}; i < imports.size(); i++) {
+    auto const& import_result{imports[i].import_result};
+    auto const subresource{view.GetSubresource(i)};
+    ASSERT_TRUE(subresource) << i;
+
+    EXPECT_EQ(subresource->name, import_result.name) << i;
+    EXPECT_EQ(subresource->payload_kind, import_result.payload_kind) << i;
+    EXPECT_TRUE(view.VerifyChecksum(i)) << i;
+    EXPECT_EQ(view.FindEntry(import_result.name, imports[i].runtime_type), i) << import_result.name;
+
+    std::vector<std::byte> bytes(subresource->uncompressed_size);
+    ASSERT_TRUE(DecompressResourcePackagePayload(*subresource, bytes)) << i;
+    EXPECT_EQ(bytes, import_result.bytes) << i;
+  }
+
+  EXPECT_FALSE(view.GetSubresource(imports.size()));
+  EXPECT_FALSE(view.FindEntry("missing", ResourceRuntimeType::kMesh));
+  EXPECT_FALSE(view.FindEntry("repeating_100", ResourceRuntimeType::kScene));
+}
+
+
+// The loading pattern the mapping replaced: open the file for every subresource, re-read the header and entry table,
+// then copy the payload into a fresh buffer
+auto ReadSubresourceThroughStream(std::filesystem::path const& path, std::size_t const table_size,
+                                  resource_package::Entry const& entry) -> std::vector<std::byte> {
+  std::ifstream is{path, std::ios::binary};
+  is.seekg(0, std::ios::end);
+  [[maybe_unused]] auto const package_size{is.tellg()};
+  is.seekg(0, std::ios::beg);
+
+  std::vector<char> tables(table_size);
+  is.read(tables.data(), static_cast<std::streamsize>(tables.size()));
+
+  std::string name(entry.name_size, '\0');
+  is.seekg(static_cast<std::streamoff>(entry.name_offset), std::ios::beg);
+  is.read(name.data(), static_cast<std::streamsize>(name.size()));
+
+  std::vector<std::byte> bytes(entry.data_size);
+  is.seekg(static_cast<std::streamoff>(entry.data_offset), std::ios::beg);
+  is.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  return bytes;
+}
+
+
+// Stands in for a loader consuming the payload
+auto SumBytes(std::span<std::byte const> const bytes) -> std::uint64_t {
+  return std::accumulate(bytes.begin(), bytes.end(), std::uint64_t{0}, [](std::uint64_t const sum, std::byte const b) {
+    return sum + std::to_integer<std::uint64_t>(b);
+  });
+}
+
+
+auto GetWorkingSetSize() -> std::size_t {
+  PROCESS_MEMORY_COUNTERS counters{};
+  GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+  return counters.WorkingSetSize;
+}
+
+
+// A displaced grid in the stream layout of a mesh: positions, normals and UVs, then triangle indices
+auto MakeMeshPayload(std::uint32_t const grid_size, float const frequency) -> std::vector<std::byte> {
+  std::vector<float> positions;
+  std::vector<float> normals;
+  std::vector<float> uvs;
+  std::vector<std::uint32_t> indices;
+
+  for (std::uint32_t z{0}; z < grid_size; z++) {
+    for (std::uint32_t x{0}; x < grid_size; x++) {
+      auto const u{static_cast<float>(x) / static_cast<float>(grid_size - 1)};
+      auto const v{static_cast<float>(z) / static_cast<float>(grid_size - 1)};
+      auto const height{std::sin(u * frequency) * std::cos(v * frequency)};
+      positions.insert(positions.end(), {u * 100.0f, height * 5.0f, v * 100.0f});
+
+      auto const normal_x{-std::cos(u * frequency) * std::cos(v * frequency)};
+      auto const normal_z{std::sin(u * frequency) * std::sin(v * frequency)};
+      auto const normal_length{std::sqrt(normal_x * normal_x + 1.0f + normal_z * normal_z)};
+      normals.insert(normals.end(), {normal_x / normal_length, 1.0f / normal_length, normal_z / normal_length});
+
+      uvs.insert(uvs.end(), {u, v});
+
+      if (x + 1 < grid_size && z + 1 < grid_size) {
+        auto const idx{z * grid_size + x};
+        indices.insert(indices.end(), {idx, idx + grid_size, idx + 1, idx + 1, idx + grid_size, idx + grid_size + 1});
+      }
+    }
+  }
+
+  std::vector<std::byte> bytes;
+
+  auto const append{
+    [&bytes](auto const& stream) {
+      auto const stream_bytes{std::as_bytes(std::span{stream})};
+      bytes.insert(bytes.end(), stream_bytes.begin(), stream_bytes.end());
+    }
+  };
+
+  append(positions);
+  append(normals);
+  append(uvs);
+  append(indices);
+  return bytes;
+}
+
+
+// A DDS file of BC1 blocks with a full mip chain. The endpoints follow smooth gradients, the indices are noisy.
+auto MakeDdsPayload(std::uint32_t const size, std::uint32_t const seed) -> std::vector<std::byte> {
+  std::vector<std::byte> bytes(128);
+  std::memcpy(bytes.data(), "DDS ", 4);
+
+  std::mt19937 gen{seed};
+  std::uniform_int_distribution<std::uint32_t> index_dist;
+
+  for (auto mip_size{size}; mip_size >= 4; mip_size /= 2) {
+    for (std::uint32_t block_y{0}; block_y < mip_size / 4; block_y++) {
+      for (std::uint32_t block_x{0}; block_x < mip_size / 4; block_x++) {
+        auto const to_565{
+          [](std::uint32_t const r, std::uint32_t const g, std::uint32_t const b) {
+            return static_cast<std::uint16_t>((r >> 3) << 11 | (g >> 2) << 5 | b >> 3);
+          }
+        };
+
+        auto const r{block_x * 1024 / mip_size % 256};
+        auto const g{block_y * 1024 / mip_size % 256};
+        std::array const block{
+          to_565(r, g, 64), to_565(std::min(r + 24, 255u), std::min(g + 24, 255u), 96)
+        };
+
+        auto const block_indices{index_dist(gen)};
+        auto const block_bytes{std::as_bytes(std::span{block})};
+        bytes.insert(bytes.end(), block_bytes.begin(), block_bytes.end());
+        bytes.insert(bytes.end(), reinterpret_cast<std::byte const*>(&block_indices),
+          reinterpret_cast<std::byte const*>(&block_indices) + sizeof(block_indices));
+      }
+    }
+  }
+
+  return bytes;
+}
+}
+
+
+TEST(ResourcePackageTest, LatestVersionRoundTrips) {
+  JobSystem job_system{4};
+  auto const imports{MakeImports()};
+
+  for (auto const codec : {ResourcePackageCodec::kNone, ResourcePackageCodec::kLz4, ResourcePackageCodec::kZstd}) {
+    TemporaryPackageFile const file{
+      std::format("sorcery_package_v3_{}.bin", static_cast<int>(codec)), PackImports(imports, job_system, codec)
+    };
+    auto const view{ResourcePackageView::Open(file.GetPath())};
+    ASSERT_TRUE(view);
+    ExpectMatchesImports(*view, imports);
+
+    auto const subresource{view->GetSubresource(0)};
+    ASSERT_TRUE(subresource);
+
+    // Parallel decompression produces the same bytes
+    std::vector<std::byte> bytes(subresource->uncompressed_size);
+    ASSERT_TRUE(DecompressResourcePackagePayload(*subresource, bytes, ObserverPtr{&job_system}));
+    EXPECT_EQ(bytes, imports[0].import_result.bytes);
+  }
+}
+
+
+TEST(ResourcePackageTest, IncompressiblePayloadsAreStoredUncompressed) {
+  JobSystem job_system{4};
+  auto const imports{MakeImports()};
+  auto const entries{UnpackBinaryResourcePackageEntries(PackImports(imports, job_system, ResourcePackageCodec::kLz4))};
+  ASSERT_TRUE(entries);
+
+  for (std::size_t i{0}; i < imports.size(); i++) {
+    if (imports[i].import_result.name.starts_with("random_")) {
+      EXPECT_EQ((*entries)[i].codec, ResourcePackageCodec::kNone) << imports[i].import_result.name;
+    } else if (imports[i].import_result.name == "repeating_600000") {
+      EXPECT_EQ((*entries)[i].codec, ResourcePackageCodec::kLz4);
+      EXPECT_LT((*entries)[i].data_size, (*entries)[i].uncompressed_size);
+    }
+  }
+}
+
+
+TEST(ResourcePackageTest, OlderVersionsAreReadable) {
+  JobSystem job_system{4};
+  auto const imports{MakeImports()};
+  auto const package_bytes{PackImports(imports, job_system, ResourcePackageCodec::kNone)};
+
+  // Version 1 packages have no lookup table and are searched linearly, version 2 ones have no compression
+  for (std::uint32_t const version : {1, 2}) {
+    TemporaryPackageFile const file{
+      std::format("sorcery_package_v{}.bin", version), DowngradePackage(package_bytes, version)
+    };
+    auto const view{ResourcePackageView::Open(file.GetPath())};
+    ASSERT_TRUE(view) << version;
+    ExpectMatchesImports(*view, imports);
+
+    auto const info{PeekBinaryResourcePackage(file.GetPath())};
+    ASSERT_TRUE(info) << version;
+    ASSERT_EQ(info->entries.size(), imports.size());
+
+    for (std::size_t i{0}; i < imports.size(); i++) {
+      EXPECT_EQ(info->entries[i].name, imports[i].import_result.name);
+      EXPECT_EQ(info->entries[i].runtime_type, imports[i].import_result.runtime_type);
+    }
+  }
+}
+
+
+TEST(ResourcePackageTest, CorruptedPayloadsFailTheChecksum) {
+  JobSystem job_system{4};
+  auto const imports{MakeImports()};
+  auto package_bytes{PackImports(imports, job_system, ResourcePackageCodec::kLz4)};
+  auto const entries{UnpackBinaryResourcePackageEntries(package_bytes)};
+  ASSERT_TRUE(entries);
+
+  constexpr std::size_t corrupted_idx{3};
+  ASSERT_GT((*entries)[corrupted_idx].data_size, 0);
+  package_bytes[(*entries)[corrupted_idx].data_offset + (*entries)[corrupted_idx].data_size / 2] ^= std::byte{0x40};
+
+  TemporaryPackageFile const file{"sorcery_package_corrupted.bin", package_bytes};
+  auto const view{ResourcePackageView::Open(file.GetPath())};
+  ASSERT_TRUE(view);
+
+  for (std::size_t i{0}; i < imports.size(); i++) {
+    EXPECT_EQ(view->VerifyChecksum(i), i != corrupted_idx) << i;
+  }
+
+  EXPECT_FALSE(view->VerifyChecksum(imports.size()));
+}
+
+
+TEST(ResourcePackageTest, TruncatedPackagesAreRejected) {
+  JobSystem job_system{4};
+  auto package_bytes{PackImports(MakeImports(), job_system, ResourcePackageCodec::kLz4)};
+  auto const entries{UnpackBinaryResourcePackageEntries(package_bytes)};
+  ASSERT_TRUE(entries);
+
+  // Cuts off the last payload, whose entry then points past the end of the file
+  package_bytes.resize(entries->back().data_offset + entries->back().data_size / 2);
+  EXPECT_FALSE(UnpackBinaryResourcePackageEntries(package_bytes));
+
+  TemporaryPackageFile const file{"sorcery_package_truncated.bin", package_bytes};
+  EXPECT_FALSE(ResourcePackageView::Open(file.GetPath()));
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(ResourcePackageTest, DISABLED_NameLookupInLargePackages) {
+  JobSystem job_system{4};
+  std::mt19937 gen{5};
+
+  for (std::size_t const entry_count : {1'000, 10'000, 100'000}) {
+    std::vector<ResourceImportResult> imports;
+    imports.reserve(entry_count);
+
+    for (std::size_t i{0}; i < entry_count; i++) {
+      imports.emplace_back(ResourcePackagePayloadKind::kMesh, rttr::type::get<Mesh>(),
+        std::format("Assets/Models/Level{}/Mesh{}.mesh", i % 16, i), std::vector(16, std::byte{1}));
+    }
+
+    auto const package_bytes{PackBinaryResourcePackage(imports, job_system, ResourcePackageCodec::kNone)};
+    ASSERT_TRUE(package_bytes);
+
+    std::vector<std::string> lookup_names;
+    std::uniform_int_distribution<std::size_t> idx_dist{0, entry_count - 1};
+
+    for (auto i{0}; i < 1'000; i++) {
+      lookup_names.emplace_back(imports[idx_dist(gen)].name);
+    }
+
+    auto const measure_lookups{
+      [&lookup_names](std::string_view const file_name, std::vector<std::byte> const& bytes) {
+        TemporaryPackageFile const file{file_name, bytes};
+        auto const view{ResourcePackageView::Open(file.GetPath())};
+        EXPECT_TRUE(view);
+
+        auto const start{std::chrono::steady_clock::now()};
+
+        for (auto const& name : lookup_names) {
+          EXPECT_TRUE(view->FindEntry(name, ResourceRuntimeType::kMesh));
+        }
+
+        return std::chrono::duration<double, std::nano>{std::chrono::steady_clock::now() - start}.count() /
+               static_cast<double>(lookup_names.size());
+      }
+    };
+
+    auto const table_ns{measure_lookups("sorcery_package_lookup_v3.bin", *package_bytes)};
+    auto const linear_ns{measure_lookups("sorcery_package_lookup_v1.bin", DowngradePackage(*package_bytes, 1))};
+
+    std::cout << std::format("{} entries: {:.0f} ns per lookup through the table, {:.0f} ns per linear lookup.\n",
+      entry_count, table_ns, linear_ns);
+  }
+}
+
+
+// Run with --gtest_also_run_disabled_tests. Building the package takes about twice its size in memory.
+// The first pass is only cold if the OS file cache does not hold the package yet, e.g. after a reboot.
+TEST(ResourcePackageTest, DISABLED_MappedAndStreamedLoadsOfLargePackages) {
+  constexpr std::size_t kEntryCount{10'000};
+  constexpr std::size_t kPackageSize{std::size_t{2} << 30};
+  constexpr std::size_t kPayloadSize{kPackageSize / kEntryCount};
+  // Sampling the working set after every load would dominate the small loads
+  constexpr std::size_t kWorkingSetSampleInterval{100};
+
+  std::optional<TemporaryPackageFile> file;
+  std::vector<resource_package::Entry> entries;
+
+  {
+    JobSystem job_system{4};
+    std::mt19937 gen{8};
+    std::uniform_int_distribution<int> byte_dist{0, 255};
+    std::vector<ResourceImportResult> imports;
+    imports.reserve(kEntryCount);
+
+    for (std::size_t i{0}; i < kEntryCount; i++) {
+      std::vector<std::byte> bytes(kPayloadSize);
+      std::ranges::generate(bytes, [&] { return static_cast<std::byte>(byte_dist(gen)); });
+      imports.emplace_back(ResourcePackagePayloadKind::kMesh, rttr::type::get<Mesh>(), std::format("Mesh{}", i),
+        std::move(bytes));
+    }
+
+    auto package_bytes{PackBinaryResourcePackage(imports, job_system, ResourcePackageCodec::kNone)};
+    ASSERT_TRUE(package_bytes);
+    imports.clear();
+    imports.shrink_to_fit();
+
+    entries = *UnpackBinaryResourcePackageEntries(*package_bytes);
+    file.emplace("sorcery_package_large.bin", *package_bytes);
+  }
+
+  // Everything in front of the first name is the header and the tables
+  auto const table_size{
+    std::ranges::min(entries | std::views::transform([](resource_package::Entry const& entry) {
+      return entry.name_offset;
+    }))
+  };
+
+  std::vector<std::size_t> load_order(kEntryCount);
+  std::iota(load_order.begin(), load_order.end(), std::size_t{0});
+  std::ranges::shuffle(load_order, std::mt19937{3});
+
+  struct PassResult {
+    double ms;
+    std::size_t peak_working_set;
+    std::uint64_t checksum;
+  };
+
+  auto const measure_pass{
+    [&load_order](auto&& load) {
+      auto const start{std::chrono::steady_clock::now()};
+      auto peak_working_set{GetWorkingSetSize()};
+      std::uint64_t checksum{0};
+
+      for (std::size_t i{0}; i < load_order.size(); i++) {
+        checksum += load(load_order[i]);
+
+        if (i % kWorkingSetSampleInterval == 0) {
+          peak_working_set = std::max(peak_working_set, GetWorkingSetSize());
+        }
+      }
+
+      return PassResult{
+        std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - start}.count(), peak_working_set,
+        checksum
+      };
+    }
+  };
+
+  auto const stream_pass{
+    [&] {
+      return measure_pass([&](std::size_t const entry_idx) {
+        return SumBytes(ReadSubresourceThroughStream(file->GetPath(), table_size, entries[entry_idx]));
+      });
+    }
+  };
+
+  auto const print{
+    [](std::string_view const label, PassResult const& result) {
+      std::cout << std::format("{}: {:.0f} ms, peak working set {} MiB\n", label, result.ms,
+        result.peak_working_set >> 20);
+    }
+  };
+
+  // The first pass over a fresh mapping pays for the page faults, the second one finds the pages mapped
+  auto view{ResourcePackageView::Open(file->GetPath())};
+  ASSERT_TRUE(view);
+
+  auto const map_pass{
+    [&] {
+      return measure_pass([&view](std::size_t const entry_idx) {
+        view->Prefetch(entry_idx);
+        return SumBytes(view->GetSubresource(entry_idx)->bytes);
+      });
+    }
+  };
+
+  auto const first_map{map_pass()};
+  auto const warm_map{map_pass()};
+  view.reset();
+
+  auto const first_stream{stream_pass()};
+  auto const warm_stream{stream_pass()};
+
+  EXPECT_EQ(first_map.checksum, warm_map.checksum);
+  EXPECT_EQ(first_stream.checksum, warm_map.checksum);
+  EXPECT_EQ(warm_stream.checksum, warm_map.checksum);
+
+  std::cout << std::format("{} entries of {} KiB\n", kEntryCount, kPayloadSize >> 10);
+  print("mapped, first pass", first_map);
+  print("mapped, warm", warm_map);
+  print("ifstream, first pass", first_stream);
+  print("ifstream, warm", warm_stream);
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(ResourcePackageTest, DISABLED_CodecAndLevelMatrix) {
+  JobSystem job_system;
+
+  std::vector<ResourceImportResult> meshes;
+  std::vector<ResourceImportResult> textures;
+
+  for (std::uint32_t i{0}; i < 8; i++) {
+    meshes.emplace_back(ResourcePackagePayloadKind::kMesh, rttr::type::get<Mesh>(), std::format("Mesh{}", i),
+      MakeMeshPayload(256 + 64 * i, 3.0f + static_cast<float>(i)));
+    textures.emplace_back(ResourcePackagePayloadKind::kTexture, rttr::type::get<Texture2D>(),
+      std::format("Texture{}", i), MakeDdsPayload(i % 2 == 0 ? 2048 : 1024, i));
+  }
+
+  struct CodecLevel {
+    ResourcePackageCodec codec;
+    int level;
+    std::string_view label;
+  };
+
+  constexpr std::array codec_levels{
+    CodecLevel{ResourcePackageCodec::kNone, 0, "none"},
+    CodecLevel{ResourcePackageCodec::kLz4, 3, "lz4hc 3"},
+    CodecLevel{ResourcePackageCodec::kLz4, 9, "lz4hc 9"},
+    CodecLevel{ResourcePackageCodec::kLz4, 12, "lz4hc 12"},
+    CodecLevel{ResourcePackageCodec::kZstd, 1, "zstd 1"},
+    CodecLevel{ResourcePackageCodec::kZstd, 3, "zstd 3"},
+    CodecLevel{ResourcePackageCodec::kZstd, 9, "zstd 9"},
+    CodecLevel{ResourcePackageCodec::kZstd, 19, "zstd 19"},
+  };
+
+  for (auto const& [payload_label, imports] : {std::pair{"mesh", &meshes}, std::pair{"dds", &textures}}) {
+    std::size_t raw_size{0};
+
+    for (auto const& import : *imports) {
+      raw_size += import.bytes.size();
+    }
+
+    std::cout << std::format("{} payloads, {} MiB:\n", payload_label, raw_size >> 20);
+
+    for (auto const& [codec, level, label] : codec_levels) {
+      auto const pack_start{std::chrono::steady_clock::now()};
+      auto const package_bytes{PackBinaryResourcePackage(*imports, job_system, codec, level)};
+      auto const pack_ms{
+        std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - pack_start}.count()
+      };
+      ASSERT_TRUE(package_bytes);
+
+      TemporaryPackageFile const file{"sorcery_package_codecs.bin", *package_bytes};
+      auto const view{ResourcePackageView::Open(file.GetPath())};
+      ASSERT_TRUE(view);
+
+      std::vector<std::byte> out;
+      auto const unpack_start{std::chrono::steady_clock::now()};
+
+      for (std::size_t i{0}; i < view->GetEntryCount(); i++) {
+        auto const subresource{view->GetSubresource(i)};
+        ASSERT_TRUE(subresource);
+
+        if (subresource->codec == ResourcePackageCodec::kNone) {
+          out.assign(subresource->bytes.begin(), subresource->bytes.end());
+        } else {
+          out.resize(subresource->uncompressed_size);
+          ASSERT_TRUE(DecompressResourcePackagePayload(*subresource, out, ObserverPtr{&job_system}));
+        }
+
+        ASSERT_EQ(out, (*imports)[i].bytes);
+      }
+
+      auto const unpack_s{std::chrono::duration<double>{std::chrono::steady_clock::now() - unpack_start}.count()};
+
+      std::cout << std::format("  {}: size ratio {:.3f}, pack {:.0f} ms, unpack {:.0f} MiB/s\n", label,
+        static_cast<double>(package_bytes->size()) / static_cast<double>(raw_size), pack_ms,
+        static_cast<double>(raw_size >> 20) / unpack_s);
+    }
+  }
+}
+}
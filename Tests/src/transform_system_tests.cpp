@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+
+#include "job_system.hpp"
+#include "Math.hpp"
+#include "scene_objects/transform_system.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <span>
+#include <thread>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+constexpr float kTolerance{1e-4f};
+
+
+// Recursion over the local data, the way TransformComponent calculated world positions before the transform system
+auto CalculateReferenceWorldPosition(TransformSystem const& transform_system, TransformSystem::NodeId const node)
+  -> Vector3 {
+  auto const parent{transform_system.GetParent(node)};
+
+  if (parent == TransformSystem::kInvalidNode) {
+    return transform_system.GetLocalPosition(node);
+  }
+
+  auto parent_rotation{Quaternion{1, 0, 0, 0}};
+
+  for (auto ancestor{parent}; ancestor != TransformSystem::kInvalidNode; ancestor = transform_system.GetParent(
+         ancestor)) {
+    parent_rotation = transform_system.GetLocalRotation(ancestor) * parent_rotation;
+  }
+
+  return CalculateReferenceWorldPosition(transform_system, parent) + parent_rotation.Rotate(
+           transform_system.GetLocalPosition(node));
+}
+
+
+auto ExpectMatchesReference(TransformSystem& transform_system, std::span<TransformSystem::NodeId const> const nodes)
+  -> void {
+  for (auto const node : nodes) {
+    auto const expected{CalculateReferenceWorldPosition(transform_system, node)};
+    auto const& actual{transform_system.GetWorldPosition(node)};
+
+    for (auto i{0}; i < 3; i++) {
+      ASSERT_NEAR(actual[i], expected[i], kTolerance) << "node " << node;
+    }
+  }
+}
+}
+
+
+TEST(TransformSystemTest, WorldDataFollowsTheHierarchy) {
+  JobSystem job_system{4};
+  TransformSystem transform_system;
+
+  auto const parent{transform_system.CreateNode()};
+  auto const child{transform_system.CreateNode()};
+  transform_system.SetParent(child, parent);
+
+  transform_system.SetLocalPosition(parent, Vector3{1, 2, 3});
+  transform_system.SetLocalRotation(parent, Quaternion{Vector3::Up(), 90});
+  transform_system.SetLocalPosition(child, Vector3{0, 0, 1});
+  transform_system.UpdateWorldData(job_system);
+
+  ExpectMatchesReference(transform_system, std::vector{parent, child});
+  EXPECT_TRUE(transform_system.HasChanged(child));
+}
+
+
+TEST(TransformSystemTest, NestedStaleRootsWithIdsOutOfDepthOrderAreResolved) {
+  JobSystem job_system{4};
+  TransformSystem transform_system;
+  std::mt19937 gen{7};
+
+  // Deeper nodes get lower ids, so the sorted stale roots list descendants before their ancestors
+  std::vector<TransformSystem::NodeId> nodes(2000);
+  std::ranges::generate(nodes, [&transform_system] { return transform_system.CreateNode(); });
+  std::ranges::reverse(nodes);
+
+  for (std::size_t i{1}; i < nodes.size(); i++) {
+    transform_system.SetParent(nodes[i], nodes[std::uniform_int_distribution<std::size_t>{0, i - 1}(gen)]);
+  }
+
+  std::uniform_real_distribution offset_dist{-1.0f, 1.0f};
+
+  for (auto const node : nodes) {
+    transform_system.SetLocalPosition(node, Vector3{offset_dist(gen), offset_dist(gen), offset_dist(gen)});
+    transform_system.SetLocalRotation(node, Quaternion{Vector3::Up(), offset_dist(gen) * 180});
+  }
+
+  transform_system.UpdateWorldData(job_system);
+
+  for (auto frame{0}; frame < 20; frame++) {
+    // Writing descendants before their ancestors records every written node as its own stale root
+    std::vector<TransformSystem::NodeId> edited_nodes;
+    std::ranges::sample(nodes, std::back_inserter(edited_nodes), 200, gen);
+    std::ranges::sort(edited_nodes);
+
+    for (auto const node : edited_nodes) {
+      transform_system.SetLocalPosition(node, transform_system.GetLocalPosition(node) + Vector3{0, 0.1f, 0});
+    }
+
+    transform_system.UpdateWorldData(job_system);
+    ExpectMatchesReference(transform_system, nodes);
+  }
+}
+
+
+TEST(TransformSystemTest, NodesReparentedDuringTheUpdateStayStale) {
+  JobSystem job_system{4};
+  TransformSystem transform_system;
+
+  auto const left{transform_system.CreateNode()};
+  auto const right{transform_system.CreateNode()};
+  transform_system.SetLocalPosition(left, Vector3{-100, 0, 0});
+  transform_system.SetLocalPosition(right, Vector3{100, 0, 0});
+
+  // Deep chains below both parents so that every update has several levels to sweep
+  std::vector<TransformSystem::NodeId> nodes{left, right};
+  std::vector<TransformSystem::NodeId> moving_nodes;
+
+  for (auto i{0}; i < 64; i++) {
+    auto parent{i % 2 == 0 ? left : right};
+
+    for (auto depth{0}; depth < 16; depth++) {
+      auto const node{transform_system.CreateNode()};
+      transform_system.SetParent(node, parent);
+      transform_system.SetLocalPosition(node, Vector3{0, 1, 0});
+      nodes.emplace_back(node);
+      parent = node;
+    }
+
+    moving_nodes.emplace_back(nodes[nodes.size() - 16]);
+  }
+
+  for (auto frame{0}; frame < 200; frame++) {
+    transform_system.SetLocalPosition(left, Vector3{-100, static_cast<float>(frame), 0});
+    transform_system.SetLocalPosition(right, Vector3{100, static_cast<float>(-frame), 0});
+
+    std::atomic_flag start;
+
+    // Reparenting like jobs executed while the update waits for a level
+    std::jthread reparenting_thread{
+      [&transform_system, &moving_nodes, &start, left, right] {
+        start.wait(false);
+
+        for (std::size_t i{0}; i < moving_nodes.size(); i++) {
+          auto const node{moving_nodes[i]};
+          transform_system.SetParent(node, transform_system.GetParent(node) == left ? right : left);
+        }
+      }
+    };
+
+    start.test_and_set();
+    start.notify_one();
+    transform_system.UpdateWorldData(job_system);
+    reparenting_thread.join();
+
+    ExpectMatchesReference(transform_system, nodes);
+  }
+}
+
+
+// Run with --gtest_also_run_disabled_tests
+TEST(TransformSystemTest, DISABLED_RandomEditsOfLargeHierarchies) {
+  JobSystem job_system;
+  constexpr std::size_t node_count{100'000};
+  constexpr std::size_t root_count{100};
+  constexpr auto frame_count{50};
+
+  for (auto const edited_fraction : {0.001, 0.01, 0.1}) {
+    // One system is updated by the sweep before reading, the other one resolves the stale nodes as they are read
+    TransformSystem swept_system;
+    TransformSystem resolved_system;
+    std::vector<TransformSystem::NodeId> nodes;
+    std::mt19937 gen{17};
+
+    for (std::size_t i{0}; i < node_count; i++) {
+      auto const node{swept_system.CreateNode()};
+      static_cast<void>(resolved_system.CreateNode());
+
+      // Parents always come first, so reparenting to a lower index cannot form a cycle
+      if (i >= root_count) {
+        auto const parent{nodes[std::uniform_int_distribution<std::size_t>{0, i - 1}(gen)]};
+        swept_system.SetParent(node, parent);
+        resolved_system.SetParent(node, parent);
+      }
+
+      nodes.emplace_back(node);
+    }
+
+    swept_system.UpdateWorldData(job_system);
+    resolved_system.UpdateWorldData(job_system);
+
+    std::uniform_real_distribution offset_dist{-1.0f, 1.0f};
+    std::chrono::steady_clock::duration swept_time{0};
+    std::chrono::steady_clock::duration resolved_time{0};
+
+    auto const read_all{
+      [&nodes](TransformSystem& transform_system) {
+        auto sum{0.0f};
+
+        for (auto const node : nodes) {
+          sum += transform_system.GetWorldPosition(node)[1];
+        }
+
+        return sum;
+      }
+    };
+
+    for (auto frame{0}; frame < frame_count; frame++) {
+      for (auto i{0}; i < static_cast<int>(edited_fraction * node_count); i++) {
+        auto const node_idx{std::uniform_int_distribution<std::size_t>{root_count, node_count - 1}(gen)};
+
+        // Mostly moves, some reparenting
+        if (i % 10 == 0) {
+          auto const parent{nodes[std::uniform_int_distribution<std::size_t>{0, node_idx - 1}(gen)]};
+          swept_system.SetParent(nodes[node_idx], parent);
+          resolved_system.SetParent(nodes[node_idx], parent);
+        } else {
+          Vector3 const position{offset_dist(gen), offset_dist(gen), offset_dist(gen)};
+          swept_system.SetLocalPosition(nodes[node_idx], position);
+          resolved_system.SetLocalPosition(nodes[node_idx], position);
+        }
+      }
+
+      auto const sweep_start{std::chrono::steady_clock::now()};
+      swept_system.UpdateWorldData(job_system);
+      auto const swept_sum{read_all(swept_system)};
+      auto const resolve_start{std::chrono::steady_clock::now()};
+      auto const resolved_sum{read_all(resolved_system)};
+      auto const resolve_end{std::chrono::steady_clock::now()};
+
+      ASSERT_NEAR(swept_sum, resolved_sum, std::abs(swept_sum) * 1e-4f);
+      swept_time += resolve_start - sweep_start;
+      resolved_time += resolve_end - resolve_start;
+    }
+
+    auto const to_ms_per_frame{
+      [](std::chrono::steady_clock::duration const duration) {
+        return std::chrono::duration<double, std::milli>{duration}.count() / frame_count;
+      }
+    };
+
+    std::cout << std::format("{} nodes, {:.1f}% edited per frame: {:.2f} ms with the sweep, {:.2f} ms resolving on "
+                             "read.\n", node_count, edited_fraction * 100, to_ms_per_frame(swept_time),
+      to_ms_per_frame(resolved_time));
+  }
+}
+}
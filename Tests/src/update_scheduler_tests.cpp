@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include "job_system.hpp"
+#include "scene_objects/Component.hpp"
+#include "scene_objects/transform_system.hpp"
+#include "scene_objects/update_scheduler.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+constexpr float kFrameTime{1.0f / 60.0f};
+
+
+// Same update and access as OscillateComponent, on a node of a standalone transform system instead of an entity
+class OscillatingComponent final : public Component {
+public:
+  OscillatingComponent(TransformSystem& transform_system, TransformSystem::NodeId const node, float const speed) :
+    transform_system_{&transform_system},
+    node_{node},
+    speed_{speed} {}
+
+
+  [[nodiscard]] auto Clone() -> std::unique_ptr<SceneObject> override {
+    return std::make_unique<OscillatingComponent>(*this);
+  }
+
+
+  auto Update() -> void override {
+    auto const this_frame_progress{speed_ * kFrameTime};
+    cur_dist_ += going_backward_ ? -this_frame_progress : this_frame_progress;
+
+    transform_system_->SetLocalPosition(node_, transform_system_->GetLocalPosition(node_) + Vector3{1, 0, 0} *
+                                               this_frame_progress * (going_backward_ ? -1.f : 1.f));
+
+    if (std::abs(cur_dist_) >= kDistance) {
+      going_backward_ = !going_backward_;
+    }
+  }
+
+
+  [[nodiscard]] auto GetUpdateAccess() const -> UpdateAccess override {
+    return {update_resources::kEntityTransform, update_resources::kEntityTransform};
+  }
+
+private:
+  constexpr static float kDistance{2};
+
+  TransformSystem* transform_system_;
+  TransformSystem::NodeId node_;
+  float speed_;
+  float cur_dist_{0};
+  bool going_backward_{false};
+};
+
+
+// Same update and access as the animation playback of SkinnedMeshComponent
+class AnimatedComponent final : public Component {
+public:
+  explicit AnimatedComponent(float const duration) :
+    duration_{duration} {}
+
+
+  [[nodiscard]] auto Clone() -> std::unique_ptr<SceneObject> override {
+    return std::make_unique<AnimatedComponent>(*this);
+  }
+
+
+  auto Update() -> void override {
+    cur_anim_delta_time_ += kFrameTime;
+    cur_animation_time_ticks_ = std::fmod(cur_anim_delta_time_ * 25.0f, duration_);
+  }
+
+
+  [[nodiscard]] auto GetUpdateAccess() const -> UpdateAccess override {
+    return {update_resources::kNone, update_resources::kNone};
+  }
+
+
+  [[nodiscard]] auto GetAnimationTime() const noexcept -> float {
+    return cur_animation_time_ticks_;
+  }
+
+private:
+  float duration_;
+  float cur_anim_delta_time_{0};
+  float cur_animation_time_ticks_{0};
+};
+
+
+// Samples a world position that depends on the oscillating parents
+class TrackingComponent final : public Component {
+public:
+  TrackingComponent(TransformSystem& transform_system, TransformSystem::NodeId const node) :
+    transform_system_{&transform_system},
+    node_{node} {}
+
+
+  [[nodiscard]] auto Clone() -> std::unique_ptr<SceneObject> override {
+    return std::make_unique<TrackingComponent>(*this);
+  }
+
+
+  auto Update() -> void override {
+    samples_.emplace_back(transform_system_->GetWorldPosition(node_));
+  }
+
+
+  [[nodiscard]] auto GetUpdateAccess() const -> UpdateAccess override {
+    return {update_resources::kTransforms, update_resources::kNone};
+  }
+
+
+  [[nodiscard]] auto GetSamples() const noexcept -> std::vector<Vector3> const& {
+    return samples_;
+  }
+
+private:
+  TransformSystem* transform_system_;
+  TransformSystem::NodeId node_;
+  std::vector<Vector3> samples_;
+};
+
+
+class TestWorld {
+public:
+  explicit TestWorld(JobSystem& job_system, bool const deterministic) :
+    scheduler_{job_system, transform_system_} {
+    scheduler_.SetDeterministic(deterministic);
+
+    auto const root{transform_system_.CreateNode()};
+    transform_system_.SetLocalPosition(root, Vector3{0, 1, 0});
+
+    for (auto i{0}; i < kInstanceCount; i++) {
+      auto const oscillating_node{transform_system_.CreateNode()};
+      transform_system_.SetParent(oscillating_node, root);
+      transform_system_.SetLocalPosition(oscillating_node, Vector3{0, 0, static_cast<float>(i)});
+
+      auto const tracked_node{transform_system_.CreateNode()};
+      transform_system_.SetParent(tracked_node, oscillating_node);
+      transform_system_.SetLocalRotation(tracked_node, Quaternion{Vector3::Up(), static_cast<float>(i)});
+
+      oscillating_.emplace_back(std::make_unique<OscillatingComponent>(transform_system_, oscillating_node,
+        1.0f + 0.1f * static_cast<float>(i)));
+      animated_.emplace_back(std::make_unique<AnimatedComponent>(1.0f + static_cast<float>(i % 7)));
+      tracking_.emplace_back(std::make_unique<TrackingComponent>(transform_system_, tracked_node));
+    }
+
+    // Oscillate and skinned mesh groups share a batch, the tracking group has to wait for their transform writes
+    groups_.resize(3);
+    groups_[0].access = oscillating_.front()->GetUpdateAccess();
+    groups_[1].access = animated_.front()->GetUpdateAccess();
+    groups_[2].access = tracking_.front()->GetUpdateAccess();
+
+    for (auto i{0}; i < kInstanceCount; i++) {
+      groups_[0].components.emplace_back(oscillating_[i].get());
+      groups_[1].components.emplace_back(animated_[i].get());
+      groups_[2].components.emplace_back(tracking_[i].get());
+    }
+  }
+
+
+  auto Update() -> void {
+    scheduler_.Update(groups_);
+  }
+
+
+  [[nodiscard]] auto GetAnimated() const noexcept -> std::vector<std::unique_ptr<AnimatedComponent>> const& {
+    return animated_;
+  }
+
+
+  [[nodiscard]] auto GetTracking() const noexcept -> std::vector<std::unique_ptr<TrackingComponent>> const& {
+    return tracking_;
+  }
+
+
+  constexpr static int kInstanceCount{500};
+
+private:
+  TransformSystem transform_system_;
+  UpdateScheduler scheduler_;
+  std::vector<std::unique_ptr<OscillatingComponent>> oscillating_;
+  std::vector<std::unique_ptr<AnimatedComponent>> animated_;
+  std::vector<std::unique_ptr<TrackingComponent>> tracking_;
+  std::vector<UpdateGroup> groups_;
+};
+}
+
+
+TEST(UpdateSchedulerTest, DeterministicModeCanBeToggled) {
+  JobSystem job_system{2};
+  TransformSystem transform_system;
+  UpdateScheduler scheduler{job_system, transform_system};
+
+  EXPECT_FALSE(scheduler.IsDeterministic());
+  scheduler.SetDeterministic(true);
+  EXPECT_TRUE(scheduler.IsDeterministic());
+  scheduler.SetDeterministic(false);
+  EXPECT_FALSE(scheduler.IsDeterministic());
+}
+
+
+TEST(UpdateSchedulerTest, ParallelUpdatesMatchDeterministicUpdates) {
+  JobSystem job_system{4};
+  TestWorld deterministic_world{job_system, true};
+  TestWorld parallel_world{job_system, false};
+
+  for (auto frame{0}; frame < 200; frame++) {
+    deterministic_world.Update();
+    parallel_world.Update();
+  }
+
+  for (auto i{0}; i < TestWorld::kInstanceCount; i++) {
+    ASSERT_EQ(deterministic_world.GetAnimated()[i]->GetAnimationTime(),
+      parallel_world.GetAnimated()[i]->GetAnimationTime()) << i;
+
+    auto const& deterministic_samples{deterministic_world.GetTracking()[i]->GetSamples()};
+    auto const& parallel_samples{parallel_world.GetTracking()[i]->GetSamples()};
+    ASSERT_EQ(deterministic_samples.size(), parallel_samples.size());
+
+    for (std::size_t j{0}; j < deterministic_samples.size(); j++) {
+      ASSERT_EQ(deterministic_samples[j], parallel_samples[j]) << i << " " << j;
+    }
+  }
+}
+}
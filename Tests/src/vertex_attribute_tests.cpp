@@ -0,0 +1,275 @@
+#include <gtest/gtest.h>
+
+#include "job_system.hpp"
+#include "Math.hpp"
+#include "Util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+constexpr float kTolerance{1e-5f};
+
+
+struct TestMesh {
+  std::vector<Vector3> positions;
+  std::vector<Vector2> uvs;
+  std::vector<unsigned> indices;
+};
+
+
+// Smooth height field over the unit square with uvs following x and z
+auto MakeBumpyGrid(unsigned const quads_per_side) -> TestMesh {
+  TestMesh mesh;
+  auto const vertices_per_side{quads_per_side + 1};
+
+  for (unsigned y{0}; y < vertices_per_side; y++) {
+    for (unsigned x{0}; x < vertices_per_side; x++) {
+      auto const u{static_cast<float>(x) / static_cast<float>(quads_per_side)};
+      auto const v{static_cast<float>(y) / static_cast<float>(quads_per_side)};
+      mesh.positions.emplace_back(u, 0.1f * std::sin(u * 9.0f) * std::cos(v * 7.0f), v);
+      mesh.uvs.emplace_back(u, v);
+    }
+  }
+
+  for (unsigned y{0}; y < quads_per_side; y++) {
+    for (unsigned x{0}; x < quads_per_side; x++) {
+      auto const i0{y * vertices_per_side + x};
+      auto const i1{i0 + 1};
+      auto const i2{i0 + vertices_per_side};
+      auto const i3{i2 + 1};
+      mesh.indices.insert(mesh.indices.end(), {i0, i2, i1, i1, i2, i3});
+    }
+  }
+
+  return mesh;
+}
+
+
+// Random triangles, optionally sharing vertices, with a face count that is not a multiple of the SIMD width
+auto MakeTriangleSoup(std::size_t const face_count, bool const share_vertices) -> TestMesh {
+  std::mt19937 gen{42};
+  std::uniform_real_distribution dist{-1.0f, 1.0f};
+
+  TestMesh mesh;
+  auto const vertex_count{share_vertices ? face_count / 2 + 3 : face_count * 3};
+
+  for (std::size_t i{0}; i < vertex_count; i++) {
+    mesh.positions.emplace_back(dist(gen), dist(gen), dist(gen));
+    mesh.uvs.emplace_back(dist(gen), dist(gen));
+  }
+
+  std::uniform_int_distribution<unsigned> idx_dist{0, static_cast<unsigned>(vertex_count - 1)};
+
+  for (std::size_t i{0}; i < face_count; i++) {
+    if (share_vertices) {
+      mesh.indices.insert(mesh.indices.end(), {idx_dist(gen), idx_dist(gen), idx_dist(gen)});
+    } else {
+      auto const first{static_cast<unsigned>(i * 3)};
+      mesh.indices.insert(mesh.indices.end(), {first, first + 1, first + 2});
+    }
+  }
+
+  return mesh;
+}
+
+
+// The per face normals that CalculateNormals produced before it accumulated adjacent faces
+auto CalculatePerFaceNormals(TestMesh const& mesh) -> std::vector<Vector3> {
+  std::vector<Vector3> out(mesh.positions.size());
+
+  for (std::size_t i{0}; i < mesh.indices.size(); i += 3) {
+    Vector3 const& vertex1{mesh.positions[mesh.indices[i]]};
+    Vector3 const& vertex2{mesh.positions[mesh.indices[i + 1]]};
+    Vector3 const& vertex3{mesh.positions[mesh.indices[i + 2]]};
+
+    Vector3 const edge1{Normalized(vertex2 - vertex1)};
+    Vector3 const edge2{Normalized(vertex3 - vertex1)};
+    Vector3 const normal{Normalized(Cross(edge1, edge2))};
+
+    for (auto j{0}; j < 3; j++) {
+      out[mesh.indices[i + j]] = normal;
+    }
+  }
+
+  return out;
+}
+
+
+// Serial scalar versions of the accumulating kernels, one face at a time
+auto CalculateReferenceNormals(TestMesh const& mesh) -> std::vector<Vector3> {
+  std::vector<Vector3> sums(mesh.positions.size(), Vector3{0});
+
+  for (std::size_t i{0}; i < mesh.indices.size(); i += 3) {
+    auto const& vertex1{mesh.positions[mesh.indices[i]]};
+    auto const& vertex2{mesh.positions[mesh.indices[i + 1]]};
+    auto const& vertex3{mesh.positions[mesh.indices[i + 2]]};
+    auto const weighted_normal{Cross(vertex2 - vertex1, vertex3 - vertex1)};
+
+    for (auto j{0}; j < 3; j++) {
+      sums[mesh.indices[i + j]] += weighted_normal;
+    }
+  }
+
+  std::vector<Vector3> out;
+
+  for (auto const& sum : sums) {
+    out.emplace_back(Length(sum) > 0 ? Normalized(sum) : Vector3::Up());
+  }
+
+  return out;
+}
+
+
+auto CalculateReferenceTangents(TestMesh const& mesh, std::span<Vector3 const> const normals) -> std::vector<Vector4> {
+  std::vector<Vector3> tangent_sums(mesh.positions.size(), Vector3{0});
+  std::vector<Vector3> bitangent_sums(mesh.positions.size(), Vector3{0});
+
+  for (std::size_t i{0}; i < mesh.indices.size(); i += 3) {
+    auto const idx1{mesh.indices[i]};
+    auto const idx2{mesh.indices[i + 1]};
+    auto const idx3{mesh.indices[i + 2]};
+
+    auto const edge1{mesh.positions[idx2] - mesh.positions[idx1]};
+    auto const edge2{mesh.positions[idx3] - mesh.positions[idx1]};
+    auto const uv_edge1{mesh.uvs[idx2] - mesh.uvs[idx1]};
+    auto const uv_edge2{mesh.uvs[idx3] - mesh.uvs[idx1]};
+
+    auto const det{uv_edge1[0] * uv_edge2[1] - uv_edge2[0] * uv_edge1[1]};
+    auto const sign{det > 0 ? 1.0f : det < 0 ? -1.0f : 0.0f};
+
+    for (auto const idx : {idx1, idx2, idx3}) {
+      tangent_sums[idx] += (edge1 * uv_edge2[1] - edge2 * uv_edge1[1]) * sign;
+      bitangent_sums[idx] += (edge2 * uv_edge1[0] - edge1 * uv_edge2[0]) * sign;
+    }
+  }
+
+  std::vector<Vector4> out;
+
+  for (std::size_t i{0}; i < mesh.positions.size(); i++) {
+    auto const normal{Normalized(normals[i])};
+    auto const tangent{Normalized(tangent_sums[i] - normal * Dot(normal, tangent_sums[i]))};
+    auto const handedness{Dot(Cross(normal, tangent), bitangent_sums[i]) < 0 ? -1.0f : 1.0f};
+    out.emplace_back(tangent[0], tangent[1], tangent[2], handedness);
+  }
+
+  return out;
+}
+
+
+auto ExpectNear(Vector3 const& actual, Vector3 const& expected, float const tolerance, std::size_t const idx) -> void {
+  for (auto i{0}; i < 3; i++) {
+    ASSERT_NEAR(actual[i], expected[i], tolerance) << "vertex " << idx;
+  }
+}
+}
+
+
+TEST(VertexAttributeTest, NormalsOfUnsharedVerticesMatchThePerFaceNormals) {
+  auto const mesh{MakeTriangleSoup(1001, false)};
+
+  std::vector<Vector3> normals;
+  CalculateNormals(mesh.positions, mesh.indices, normals);
+  auto const expected{CalculatePerFaceNormals(mesh)};
+
+  ASSERT_EQ(normals.size(), expected.size());
+
+  for (std::size_t i{0}; i < normals.size(); i++) {
+    ExpectNear(normals[i], expected[i], kTolerance, i);
+  }
+}
+
+
+TEST(VertexAttributeTest, NormalsMatchTheSerialReference) {
+  auto mesh{MakeTriangleSoup(20'001, true)};
+  // Vertices without faces get an arbitrary unit normal
+  mesh.positions.emplace_back(0, 0, 0);
+
+  std::vector<Vector3> normals;
+  CalculateNormals(mesh.positions, mesh.indices, normals);
+  auto const expected{CalculateReferenceNormals(mesh)};
+
+  ASSERT_EQ(normals.size(), expected.size());
+
+  for (std::size_t i{0}; i < normals.size(); i++) {
+    ExpectNear(normals[i], expected[i], kTolerance, i);
+  }
+
+  EXPECT_EQ(normals.back(), Vector3::Up());
+}
+
+
+TEST(VertexAttributeTest, TangentsMatchTheSerialReference) {
+  auto const mesh{MakeBumpyGrid(120)};
+
+  std::vector<Vector3> normals;
+  CalculateNormals(mesh.positions, mesh.indices, normals);
+
+  std::vector<Vector4> tangents;
+  CalculateTangents(mesh.positions, normals, mesh.uvs, mesh.indices, tangents);
+  auto const expected{CalculateReferenceTangents(mesh, normals)};
+
+  ASSERT_EQ(tangents.size(), expected.size());
+
+  for (std::size_t i{0}; i < tangents.size(); i++) {
+    ExpectNear(Vector3{tangents[i]}, Vector3{expected[i]}, 1e-4f, i);
+    ASSERT_EQ(tangents[i][3], expected[i][3]) << "vertex " << i;
+    ASSERT_NEAR(Dot(Vector3{tangents[i]}, normals[i]), 0, 1e-4f) << "vertex " << i;
+  }
+}
+
+
+TEST(VertexAttributeTest, MirroredUvsFlipTheHandedness) {
+  auto mesh{MakeBumpyGrid(8)};
+
+  for (auto& position : mesh.positions) {
+    position[1] = 0;
+  }
+
+  std::vector<Vector3> normals;
+  CalculateNormals(mesh.positions, mesh.indices, normals);
+
+  std::vector<Vector4> tangents;
+  CalculateTangents(mesh.positions, normals, mesh.uvs, mesh.indices, tangents);
+
+  for (auto& uv : mesh.uvs) {
+    uv[0] = -uv[0];
+  }
+
+  std::vector<Vector4> mirrored_tangents;
+  CalculateTangents(mesh.positions, normals, mesh.uvs, mesh.indices, mirrored_tangents);
+
+  for (std::size_t i{0}; i < tangents.size(); i++) {
+    ExpectNear(normals[i], Vector3::Up(), kTolerance, i);
+    ExpectNear(Vector3{tangents[i]}, Vector3::Right(), kTolerance, i);
+    ExpectNear(Vector3{mirrored_tangents[i]}, Vector3::Left(), kTolerance, i);
+    ASSERT_EQ(tangents[i][3], -mirrored_tangents[i][3]) << "vertex " << i;
+  }
+}
+
+
+TEST(VertexAttributeTest, JobSystemDoesNotChangeTheResults) {
+  JobSystem job_system{4};
+  // Several chunks of faces and vertices
+  auto const mesh{MakeBumpyGrid(300)};
+
+  std::vector<Vector3> serial_normals;
+  std::vector<Vector3> parallel_normals;
+  CalculateNormals(mesh.positions, mesh.indices, serial_normals);
+  CalculateNormals(mesh.positions, mesh.indices, parallel_normals, ObserverPtr{&job_system});
+  EXPECT_EQ(serial_normals, parallel_normals);
+
+  std::vector<Vector4> serial_tangents;
+  std::vector<Vector4> parallel_tangents;
+  CalculateTangents(mesh.positions, serial_normals, mesh.uvs, mesh.indices, serial_tangents);
+  CalculateTangents(mesh.positions, serial_normals, mesh.uvs, mesh.indices, parallel_tangents,
+    ObserverPtr{&job_system});
+  EXPECT_EQ(serial_tangents, parallel_tangents);
+}
+}
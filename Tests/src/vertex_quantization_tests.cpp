@@ -0,0 +1,399 @@
+#include <gtest/gtest.h>
+
+#include "Bounds.hpp"
+#include "Math.hpp"
+#include "vertex_quantization.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <span>
+#include <vector>
+
+
+namespace sorcery {
+namespace {
+// atan2 of the cross and dot products stays accurate for tiny angles, unlike acos of the dot product
+auto AngleBetween(Vector3 const& a, Vector3 const& b) -> double {
+  auto const ax{static_cast<double>(a[0])}, ay{static_cast<double>(a[1])}, az{static_cast<double>(a[2])};
+  auto const bx{static_cast<double>(b[0])}, by{static_cast<double>(b[1])}, bz{static_cast<double>(b[2])};
+  auto const cx{ay * bz - az * by}, cy{az * bx - ax * bz}, cz{ax * by - ay * bx};
+  return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), ax * bx + ay * by + az * bz);
+}
+
+
+// Random directions plus the axes, the octant diagonals and vectors on the fold of the octahedron
+auto MakeUnitVectors() -> std::vector<Vector3> {
+  std::vector<Vector3> vectors;
+
+  for (auto const x : {-1.0f, 0.0f, 1.0f}) {
+    for (auto const y : {-1.0f, 0.0f, 1.0f}) {
+      for (auto const z : {-1.0f, -0.0f, 0.0f, 1.0f}) {
+        if (x != 0.0f || y != 0.0f || z != 0.0f) {
+          vectors.emplace_back(Normalized(Vector3{x, y, z}));
+        }
+      }
+    }
+  }
+
+  std::mt19937 gen{3};
+  std::normal_distribution component_dist{0.0f, 1.0f};
+
+  for (auto i{0}; i < 100'003; i++) {
+    vectors.emplace_back(Normalized(Vector3{component_dist(gen), component_dist(gen), component_dist(gen)}));
+  }
+
+  return vectors;
+}
+
+
+// The kernels take the SIMD path for all but the last few elements of a span, single elements always take the scalar
+// path. Both have to produce bit identical results, including the signs of zeros and the payloads of NaNs.
+template<typename In, typename Out, typename Kernel>
+auto ExpectSimdMatchesScalar(std::span<In const> const in, Kernel const& kernel) -> void {
+  std::vector<Out> batch(in.size());
+  kernel(in, std::span{batch});
+
+  for (std::size_t i{0}; i < in.size(); i++) {
+    Out single;
+    kernel(in.subspan(i, 1), std::span{&single, 1});
+    ASSERT_EQ(std::memcmp(&batch[i], &single, sizeof(Out)), 0) << i;
+  }
+}
+
+
+auto MakeUvs() -> std::vector<Vector2> {
+  std::vector<Vector2> uvs{
+    Vector2{0.0f, -0.0f}, Vector2{0.5f, 1.0f}, Vector2{-2.0f, 2048.0f}, Vector2{1e-5f, -3e-8f},
+    Vector2{65504.0f, 65520.0f}, Vector2{-1e6f, std::numeric_limits<float>::infinity()},
+    Vector2{std::numeric_limits<float>::quiet_NaN(), 1.0f + 1.0f / 4096.0f}
+  };
+
+  std::mt19937 gen{5};
+  std::uniform_real_distribution uv_dist{-4.0f, 4.0f};
+
+  for (auto i{0}; i < 10'001; i++) {
+    uvs.emplace_back(uv_dist(gen), uv_dist(gen));
+  }
+
+  return uvs;
+}
+
+
+auto MakeBoneWeights() -> std::vector<Vector4> {
+  std::vector<Vector4> weights{
+    Vector4{1, 0, 0, 0}, Vector4{0, 0, 0, 0}, Vector4{0.25f, 0.25f, 0.25f, 0.25f},
+    Vector4{0.5f, 0.25f, 0.25f, 0}, Vector4{0.002f, 0.002f, 0.002f, 0.994f}
+  };
+
+  std::mt19937 gen{9};
+  std::uniform_real_distribution weight_dist{0.0f, 1.0f};
+
+  for (auto i{0}; i < 10'002; i++) {
+    Vector4 vertex_weights{weight_dist(gen), weight_dist(gen), weight_dist(gen), weight_dist(gen)};
+    auto const sum{vertex_weights[0] + vertex_weights[1] + vertex_weights[2] + vertex_weights[3]};
+    weights.emplace_back(vertex_weights / sum);
+  }
+
+  return weights;
+}
+}
+
+
+TEST(VertexQuantizationTest, UnitVectorsRoundTripWithinTheErrorBound) {
+  auto const vectors{MakeUnitVectors()};
+  std::vector<PackedUnitVector> packed(vectors.size());
+  std::vector<Vector3> decoded(vectors.size());
+  EncodeUnitVectors(vectors, packed);
+  DecodeUnitVectors(packed, decoded);
+
+  for (std::size_t i{0}; i < vectors.size(); i++) {
+    ASSERT_LE(AngleBetween(vectors[i], decoded[i]), kPackedUnitVectorMaxError) << i;
+  }
+}
+
+
+TEST(VertexQuantizationTest, OctahedralEncodingOfTheAxes) {
+  std::vector const axes{
+    Vector3{0, 0, 1}, Vector3{1, 0, 0}, Vector3{0, -1, 0}, Vector3{0, 0, -1}, Vector3{0, 0, 0}
+  };
+  std::vector<PackedUnitVector> packed(axes.size());
+  EncodeUnitVectors(axes, packed);
+
+  // The upper hemisphere maps onto the inner diamond, the lower one is folded onto the corners
+  EXPECT_EQ(packed[0][0], 0);
+  EXPECT_EQ(packed[0][1], 0);
+  EXPECT_EQ(packed[1][0], 32767);
+  EXPECT_EQ(packed[1][1], 0);
+  EXPECT_EQ(packed[2][0], 0);
+  EXPECT_EQ(packed[2][1], -32767);
+  EXPECT_EQ(std::abs(packed[3][0]), 32767);
+  EXPECT_EQ(std::abs(packed[3][1]), 32767);
+
+  // Zero vectors have no direction, they decode to the one the center of the octahedron stands for
+  std::vector<Vector3> decoded(axes.size());
+  DecodeUnitVectors(packed, decoded);
+  EXPECT_LE(AngleBetween(decoded[4], Vector3{0, 0, 1}), kPackedUnitVectorMaxError);
+}
+
+
+TEST(VertexQuantizationTest, EveryPackedUnitVectorDecodesToUnitLength) {
+  std::vector<PackedUnitVector> packed;
+
+  for (auto x{-32768}; x <= 32767; x += 127) {
+    for (auto y{-32768}; y <= 32767; y += 131) {
+      packed.emplace_back(static_cast<std::int16_t>(x), static_cast<std::int16_t>(y));
+    }
+  }
+
+  std::vector<Vector3> decoded(packed.size());
+  DecodeUnitVectors(packed, decoded);
+
+  for (std::size_t i{0}; i < packed.size(); i++) {
+    ASSERT_NEAR(Length(decoded[i]), 1.0f, 1e-6f) << packed[i][0] << " " << packed[i][1];
+  }
+}
+
+
+TEST(VertexQuantizationTest, TangentsKeepTheirHandedness) {
+  auto const directions{MakeUnitVectors()};
+  std::vector<Vector4> tangents;
+
+  for (std::size_t i{0}; i < directions.size(); i++) {
+    tangents.emplace_back(directions[i][0], directions[i][1], directions[i][2], i % 3 == 0 ? -1.0f : 1.0f);
+  }
+
+  std::vector<PackedUnitVector> packed(tangents.size());
+  std::vector<Vector4> decoded(tangents.size());
+  EncodeTangents(tangents, packed);
+  DecodeTangents(packed, decoded);
+
+  for (std::size_t i{0}; i < tangents.size(); i++) {
+    ASSERT_EQ((packed[i][1] & 1) != 0, tangents[i][3] < 0.0f) << i;
+    ASSERT_EQ(decoded[i][3], tangents[i][3]) << i;
+    ASSERT_LE(AngleBetween(Vector3{tangents[i]}, Vector3{decoded[i]}), kPackedTangentMaxError) << i;
+  }
+}
+
+
+TEST(VertexQuantizationTest, UvsRoundTripWithinTheErrorBound) {
+  auto const uvs{MakeUvs()};
+  std::vector<PackedUv> packed(uvs.size());
+  std::vector<Vector2> decoded(uvs.size());
+  EncodeUvs(uvs, packed);
+  DecodeUvs(packed, decoded);
+
+  for (std::size_t i{0}; i < uvs.size(); i++) {
+    for (std::size_t j{0}; j < 2; j++) {
+      auto const original{uvs[i][j]};
+
+      if (std::isnan(original)) {
+        EXPECT_TRUE(std::isnan(decoded[i][j])) << i;
+      } else if (std::abs(original) >= 65520.0f) {
+        // Rounds beyond the largest half
+        EXPECT_EQ(decoded[i][j], std::copysign(std::numeric_limits<float>::infinity(), original)) << i;
+      } else if (std::abs(original) < 0x1p-14f) {
+        EXPECT_LE(std::abs(decoded[i][j] - original), 0x1p-25f) << i;
+      } else {
+        EXPECT_LE(std::abs(decoded[i][j] - original), std::abs(original) * kPackedUvMaxRelativeError) << i;
+      }
+    }
+  }
+
+  // Halves represent these exactly
+  EXPECT_EQ(decoded[1][0], 0.5f);
+  EXPECT_EQ(decoded[2][1], 2048.0f);
+  EXPECT_EQ(decoded[4][0], 65504.0f);
+  EXPECT_TRUE(std::signbit(decoded[0][1]));
+}
+
+
+TEST(VertexQuantizationTest, PositionsRoundTripWithinTheErrorBound) {
+  AABB const bounds{.min = Vector3{-3, 10, 0}, .max = Vector3{5, 10.5f, 1000}};
+  std::vector<Vector3> positions{bounds.min, bounds.max};
+
+  std::mt19937 gen{13};
+  std::uniform_real_distribution t_dist{0.0f, 1.0f};
+
+  for (auto i{0}; i < 10'003; i++) {
+    positions.emplace_back(bounds.min + (bounds.max - bounds.min) * Vector3{t_dist(gen), t_dist(gen), t_dist(gen)});
+  }
+
+  std::vector<PackedPosition> packed(positions.size());
+  std::vector<Vector3> decoded(positions.size());
+  EncodePositions(positions, bounds, packed);
+  DecodePositions(packed, bounds, decoded);
+
+  for (std::size_t i{0}; i < positions.size(); i++) {
+    for (std::size_t j{0}; j < 3; j++) {
+      ASSERT_LE(std::abs(decoded[i][j] - positions[i][j]), (bounds.max[j] - bounds.min[j]) * kPackedPositionMaxError)
+        << i;
+    }
+  }
+}
+
+
+TEST(VertexQuantizationTest, PositionsOutsideTheBoundsAreClamped) {
+  AABB const bounds{.min = Vector3{0, 0, 2}, .max = Vector3{1, 1, 2}};
+  std::vector const positions{Vector3{-5, 0.5f, 2}, Vector3{7, 2, -1}};
+  std::vector<PackedPosition> packed(positions.size());
+  std::vector<Vector3> decoded(positions.size());
+  EncodePositions(positions, bounds, packed);
+  DecodePositions(packed, bounds, decoded);
+
+  EXPECT_EQ(packed[0][0], 0);
+  EXPECT_EQ(packed[1][0], 65535);
+  EXPECT_EQ(packed[1][1], 65535);
+
+  // Flat axes decode to their only coordinate
+  EXPECT_EQ(decoded[0][2], 2.0f);
+  EXPECT_EQ(decoded[1][2], 2.0f);
+}
+
+
+TEST(VertexQuantizationTest, BoneWeightsSumTo255) {
+  auto const weights{MakeBoneWeights()};
+  std::vector<PackedBoneWeights> packed(weights.size());
+  std::vector<Vector4> decoded(weights.size());
+  EncodeBoneWeights(weights, packed);
+  DecodeBoneWeights(packed, decoded);
+
+  for (std::size_t i{0}; i < weights.size(); i++) {
+    auto const sum{static_cast<int>(packed[i][0]) + packed[i][1] + packed[i][2] + packed[i][3]};
+
+    if (weights[i][0] + weights[i][1] + weights[i][2] + weights[i][3] == 0.0f) {
+      ASSERT_EQ(sum, 0) << i;
+      continue;
+    }
+
+    ASSERT_EQ(sum, 255) << i;
+
+    for (std::size_t j{0}; j < 4; j++) {
+      ASSERT_LE(std::abs(decoded[i][j] - weights[i][j]), kPackedBoneWeightMaxError) << i;
+    }
+  }
+
+  // Every quarter rounds up to 64, the first of the largest weights gives back the excess unit
+  EXPECT_EQ(packed[2][0], 63);
+  EXPECT_EQ(packed[2][1], 64);
+  EXPECT_EQ(packed[2][2], 64);
+  EXPECT_EQ(packed[2][3], 64);
+
+  EXPECT_EQ(packed[3][0], 127);
+  EXPECT_EQ(packed[3][1], 64);
+  EXPECT_EQ(packed[3][2], 64);
+
+  // The small weights round up to 1, the largest one gives back the excess
+  EXPECT_EQ(packed[4][0], 1);
+  EXPECT_EQ(packed[4][3], 252);
+}
+
+
+TEST(VertexQuantizationTest, BoneIndicesThatDoNotFitAreRejected) {
+  std::vector<Vector<std::uint32_t, 4>> indices{
+    Vector<std::uint32_t, 4>{0u, 1u, 254u, 255u}, Vector<std::uint32_t, 4>{7u, 7u, 7u, 7u}
+  };
+  std::vector<PackedBoneIndices> packed(indices.size());
+  ASSERT_TRUE(EncodeBoneIndices(indices, packed));
+
+  std::vector<Vector<std::uint32_t, 4>> decoded(indices.size());
+  DecodeBoneIndices(packed, decoded);
+  EXPECT_EQ(std::memcmp(decoded.data(), indices.data(), indices.size() * sizeof(indices[0])), 0);
+
+  indices[1][2] = 256;
+  std::vector<PackedBoneIndices> untouched(indices.size(), PackedBoneIndices{9});
+  EXPECT_FALSE(EncodeBoneIndices(indices, untouched));
+  EXPECT_EQ(untouched[0][0], 9);
+}
+
+
+TEST(VertexQuantizationTest, SimdPathsMatchTheScalarPath) {
+  auto const vectors{MakeUnitVectors()};
+  ExpectSimdMatchesScalar<Vector3, PackedUnitVector>(vectors, [](auto const in, auto const out) {
+    EncodeUnitVectors(in, out);
+  });
+
+  std::vector<PackedUnitVector> packed_vectors(vectors.size());
+  EncodeUnitVectors(vectors, packed_vectors);
+  ExpectSimdMatchesScalar<PackedUnitVector, Vector3>(packed_vectors, [](auto const in, auto const out) {
+    DecodeUnitVectors(in, out);
+  });
+
+  std::vector<Vector4> tangents;
+
+  for (std::size_t i{0}; i < vectors.size(); i++) {
+    tangents.emplace_back(vectors[i][0], vectors[i][1], vectors[i][2], i % 2 == 0 ? -1.0f : 1.0f);
+  }
+
+  ExpectSimdMatchesScalar<Vector4, PackedUnitVector>(tangents, [](auto const in, auto const out) {
+    EncodeTangents(in, out);
+  });
+
+  std::vector<PackedUnitVector> packed_tangents(tangents.size());
+  EncodeTangents(tangents, packed_tangents);
+  ExpectSimdMatchesScalar<PackedUnitVector, Vector4>(packed_tangents, [](auto const in, auto const out) {
+    DecodeTangents(in, out);
+  });
+
+  auto const uvs{MakeUvs()};
+  ExpectSimdMatchesScalar<Vector2, PackedUv>(uvs, [](auto const in, auto const out) {
+    EncodeUvs(in, out);
+  });
+
+  // Every half, including denormals, infinities and NaNs
+  std::vector<PackedUv> packed_uvs;
+
+  for (std::uint32_t half{0}; half <= 0xFFFF; half += 2) {
+    packed_uvs.emplace_back(static_cast<std::uint16_t>(half), static_cast<std::uint16_t>(half + 1));
+  }
+
+  ExpectSimdMatchesScalar<PackedUv, Vector2>(packed_uvs, [](auto const in, auto const out) {
+    DecodeUvs(in, out);
+  });
+
+  AABB const bounds{.min = Vector3{-1, -2, -3}, .max = Vector3{1, 2, 3}};
+  std::vector<Vector3> positions;
+
+  for (auto const& vec : vectors) {
+    // Some of them end up outside the bounds
+    positions.emplace_back(vec * Vector3{1.5f, 2.5f, 3.5f});
+  }
+
+  ExpectSimdMatchesScalar<Vector3, PackedPosition>(positions, [&bounds](auto const in, auto const out) {
+    EncodePositions(in, bounds, out);
+  });
+
+  std::vector<PackedPosition> packed_positions(positions.size());
+  EncodePositions(positions, bounds, packed_positions);
+  ExpectSimdMatchesScalar<PackedPosition, Vector3>(packed_positions, [&bounds](auto const in, auto const out) {
+    DecodePositions(in, bounds, out);
+  });
+
+  auto const weights{MakeBoneWeights()};
+  ExpectSimdMatchesScalar<Vector4, PackedBoneWeights>(weights, [](auto const in, auto const out) {
+    EncodeBoneWeights(in, out);
+  });
+
+  std::vector<PackedBoneWeights> packed_weights(weights.size());
+  EncodeBoneWeights(weights, packed_weights);
+  ExpectSimdMatchesScalar<PackedBoneWeights, Vector4>(packed_weights, [](auto const in, auto const out) {
+    DecodeBoneWeights(in, out);
+  });
+
+  std::vector<PackedBoneIndices> packed_indices;
+
+  for (auto i{0}; i < 1'001; i++) {
+    packed_indices.emplace_back(static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i * 7),
+      static_cast<std::uint8_t>(255 - i), static_cast<std::uint8_t>(i / 5));
+  }
+
+  ExpectSimdMatchesScalar<PackedBoneIndices, Vector<std::uint32_t, 4>>(packed_indices,
+    [](auto const in, auto const out) {
+      DecodeBoneIndices(in, out);
+    });
+}
+}